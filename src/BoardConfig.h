@@ -37,8 +37,8 @@
 /*                              Constants                                  */
 /***************************************************************************/
 
-// Selects on which I2C bus is connected compass as per Wiring library definition
-#define NAVCOMPASS_I2C Wire
+// I2C bus on which PMU, display and compass are connected, as per Wiring library definition
+#define SHARED_I2C Wire
 
 #define RF_CS0_PIN  18
 #define RF_MOSI_PIN 27
@@ -69,6 +69,31 @@
 #define PMU_I2C_SCL 22
 #define PMU_IRQ     35
 
+// Core affinity : radio ISRs and Micronet protocol processing run on PRO core so that SSD1306/compass I2C transfers,
+// NMEA decoding and Bluetooth/network writes, all executed on APP core, can't delay slot transmissions
+#define RF_CORE  0
+#define APP_CORE 1
+
+// Task priorities. RF task is above Bluedroid host and lwIP tasks which share its core, but below WiFi & BT controller.
+#define RF_TASK_PRIORITY           21
+#define POWER_TASK_PRIORITY        6
+#define PANEL_TASK_PRIORITY        5
+#define NMEA_TASK_PRIORITY         4
+#define COMPASS_TASK_PRIORITY      3
+#define HOUSEKEEPING_TASK_PRIORITY 2
+#define BOOT_TASK_PRIORITY         1
+#define SLEEP_TASK_PRIORITY        1
+
+// Task stack sizes in bytes. Check high-water marks with the profiling menu before reducing them.
+#define RX_TASK_STACK_SIZE           6144
+#define NMEA_TASK_STACK_SIZE         6144
+#define COMPASS_TASK_STACK_SIZE      4096
+#define HOUSEKEEPING_TASK_STACK_SIZE 4096
+#define PANEL_TASK_STACK_SIZE        6144
+#define POWER_TASK_STACK_SIZE        4096
+#define BOOT_TASK_STACK_SIZE         4096
+#define SLEEP_TASK_STACK_SIZE        3072
+
 /***************************************************************************/
 /*                                Types                                    */
 /***************************************************************************/
@@ -0,0 +1,216 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Compass raw data capture for offline tuning                   *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "CompassCapture.h"
+#include "Globals.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Maximum length of a CSV line
+#define COMPASS_CAPTURE_LINE_SIZE 192
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+static int PrintField(char *buffer, int size, float value);
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+CompassCapture::CompassCapture() : active(false), nbDropped(0)
+{
+}
+
+CompassCapture::~CompassCapture()
+{
+}
+
+/*
+  Start capturing. Must be called by the consumer task, which discards records left from a previous capture.
+*/
+void CompassCapture::Start()
+{
+    CompassCaptureRecord_t record;
+
+    while (recordQueue.Pop(&record))
+    {
+    }
+    nbDropped = 0;
+    active    = true;
+}
+
+void CompassCapture::Stop()
+{
+    active = false;
+}
+
+bool CompassCapture::IsActive()
+{
+    return active;
+}
+
+/*
+  Add a block of samples read from the accelerometer FIFO (compass task only). All samples of the block get the
+  time of the FIFO read, so that replay can rebuild the blocks processed by NavCompass.
+  @param time_us Time of the FIFO read
+  @param acc Acceleration samples
+  @param gyro Angular rate samples in deg/s, all zero if the device has no gyroscope
+  @param nbSamples Number of samples in the block
+*/
+void CompassCapture::AddAccSamples(uint32_t time_us, vec const *acc, vec const *gyro, uint32_t nbSamples)
+{
+    for (uint32_t i = 0; i < nbSamples; i++)
+    {
+        AddRecord(time_us, 'A', acc[i].x, acc[i].y, acc[i].z, gyro[i].x, gyro[i].y, gyro[i].z);
+    }
+}
+
+/*
+  Add a raw magnetic field sample and the heading and attitude computed from it (compass task only)
+*/
+void CompassCapture::AddMagSample(uint32_t time_us, vec const &mag, float heading_deg, float roll_deg, float pitch_deg)
+{
+    AddRecord(time_us, 'M', mag.x, mag.y, mag.z, heading_deg, roll_deg, pitch_deg);
+}
+
+/*
+  Add GNSS course and speed and the published heading (compass task only). Invalid values are given as NAN.
+*/
+void CompassCapture::AddNavData(uint32_t time_us, float cog_deg, float sog_kt, float magVar_deg, float magHdg_deg)
+{
+    AddRecord(time_us, 'N', cog_deg, sog_kt, magVar_deg, magHdg_deg, NAN, NAN);
+}
+
+void CompassCapture::AddRecord(uint32_t time_us, char type, float d0, float d1, float d2, float d3, float d4, float d5)
+{
+    CompassCaptureRecord_t *record = recordQueue.Reserve();
+
+    if (record == nullptr)
+    {
+        nbDropped++;
+        return;
+    }
+
+    record->time_us = time_us;
+    record->type    = type;
+    record->data[0] = d0;
+    record->data[1] = d1;
+    record->data[2] = d2;
+    record->data[3] = d3;
+    record->data[4] = d4;
+    record->data[5] = d5;
+    recordQueue.Commit();
+}
+
+/*
+  Print the description of the capture format followed by the compass configuration needed to replay it :
+  C,<heading vector>,<heading filter ms>,<hard iron x,y,z>,<soft iron matrix, row major>
+*/
+void CompassCapture::PrintHeader(Stream *stream)
+{
+    char   line[COMPASS_CAPTURE_LINE_SIZE];
+    int    length;
+    float *softIron = gConfiguration.eeprom.magSoftIron;
+
+    stream->print("# MicroNav compass capture, device ");
+    stream->println(gNavCompass.GetDeviceName());
+    stream->println("# A,time_us,accX,accY,accZ,gyroX,gyroY,gyroZ");
+    stream->println("# M,time_us,magX,magY,magZ,heading,roll,pitch");
+    stream->println("# N,time_us,cog,sog,magVar,magHdg");
+
+    length = snprintf(line, sizeof(line), "C,%d,%u,%.5g,%.5g,%.5g", gConfiguration.eeprom.compassHdgVector,
+                      (unsigned)gConfiguration.eeprom.headingFilter_ms, gConfiguration.eeprom.xMagOffset, gConfiguration.eeprom.yMagOffset,
+                      gConfiguration.eeprom.zMagOffset);
+    for (int i = 0; i < 9; i++)
+    {
+        length += snprintf(line + length, sizeof(line) - length, ",%.5g", softIron[i]);
+    }
+    stream->println(line);
+}
+
+/*
+  Print all buffered records as CSV lines (consumer task only). Each line is written at once so that it is not split
+  by NMEA sentences sent to the same link by other tasks.
+*/
+void CompassCapture::Print(Stream *stream)
+{
+    CompassCaptureRecord_t record;
+    char                   line[COMPASS_CAPTURE_LINE_SIZE];
+
+    while (recordQueue.Pop(&record))
+    {
+        uint32_t nbFields = (record.type == 'N') ? 4 : 6;
+        int      length   = snprintf(line, sizeof(line), "%c,%u", record.type, (unsigned)record.time_us);
+
+        for (uint32_t i = 0; i < nbFields; i++)
+        {
+            length += PrintField(line + length, sizeof(line) - length, record.data[i]);
+        }
+        length += snprintf(line + length, sizeof(line) - length, "\r\n");
+        stream->write((const uint8_t *)line, length);
+    }
+}
+
+/*
+  Get the number of records dropped because the console could not keep up with the sampling rate
+*/
+uint32_t CompassCapture::GetNbDropped()
+{
+    return nbDropped;
+}
+
+/*
+  Print a CSV field, left empty for invalid values
+*/
+static int PrintField(char *buffer, int size, float value)
+{
+    if (isnan(value))
+    {
+        return snprintf(buffer, size, ",");
+    }
+
+    return snprintf(buffer, size, ",%.5g", value);
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Compass raw data capture for offline tuning                   *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+
+#ifndef COMPASSCAPTURE_H_
+#define COMPASSCAPTURE_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "LockFreeQueue.h"
+#include "VectorMath.h"
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Number of records buffered between the compass task and the console. It holds about one second of data.
+#define COMPASS_CAPTURE_QUEUE_SIZE 128
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef struct
+{
+    uint32_t time_us; // Time at which the data has been read
+    char     type;    // 'A' acceleration & angular rate, 'M' magnetic field & heading, 'N' navigation data
+    float    data[6]; // Record values, see CompassCapture::Print()
+} CompassCaptureRecord_t;
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Buffer compass samples and navigation data in the compass task and print them as CSV lines on the console from a
+  lower priority task, so that the capture neither blocks sampling nor delays RF processing. Records which do not
+  fit in the queue are dropped and counted.
+*/
+class CompassCapture
+{
+  public:
+    CompassCapture();
+    virtual ~CompassCapture();
+
+    void     Start();
+    void     Stop();
+    bool     IsActive();
+    void     AddAccSamples(uint32_t time_us, vec const *acc, vec const *gyro, uint32_t nbSamples);
+    void     AddMagSample(uint32_t time_us, vec const &mag, float heading_deg, float roll_deg, float pitch_deg);
+    void     AddNavData(uint32_t time_us, float cog_deg, float sog_kt, float magVar_deg, float magHdg_deg);
+    void     PrintHeader(Stream *stream);
+    void     Print(Stream *stream);
+    uint32_t GetNbDropped();
+
+  private:
+    LockFreeQueue<CompassCaptureRecord_t, COMPASS_CAPTURE_QUEUE_SIZE> recordQueue;
+    volatile bool                                                     active;
+    volatile uint32_t                                                 nbDropped;
+
+    void AddRecord(uint32_t time_us, char type, float d0, float d1, float d2, float d3, float d4, float d5);
+};
+
+#endif /* COMPASSCAPTURE_H_ */
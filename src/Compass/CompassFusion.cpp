@@ -0,0 +1,345 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Tilt compensated heading from compass samples                 *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "CompassFusion.h"
+
+#include <math.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+CompassFusion::CompassFusion()
+    : forward({1.0f, 0.0f, 0.0f}), hardIron({0.0f, 0.0f, 0.0f}), headingTau_s(0.0f), filteredAcc({0.0f, 0.0f, 0.0f}), filteredSin(0.0f),
+      filteredCos(1.0f), lastMagSample_us(0), lastGyroSample_us(0), gyroRotation_deg(0.0f), boatUp({0.0f, 0.0f, 1.0f}), boatUpValid(false),
+      heading_deg(0.0f), roll_deg(0.0f), pitch_deg(0.0f), rot_degpmin(0.0f), nbAccSamples(0), nbMagSamples(0)
+{
+    static const float identity[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+    memcpy(softIron, identity, sizeof(softIron));
+}
+
+CompassFusion::~CompassFusion()
+{
+}
+
+/*
+  Set the sensor axis pointing to the bow. The axis pointing to the top of the boat is chosen again on the next sample
+  when it changes.
+  @param forward Unit vector along one of the sensor axes
+*/
+void CompassFusion::SetForwardVector(vec const &forward)
+{
+    if ((forward.x != this->forward.x) || (forward.y != this->forward.y) || (forward.z != this->forward.z))
+    {
+        this->forward = forward;
+        boatUpValid   = false;
+    }
+}
+
+/*
+  Set the magnetometer calibration applied to each magnetic field sample
+  @param hardIron Hard iron offsets, substracted from the raw field
+  @param softIron Soft iron correction matrix, row major, applied after the offsets
+*/
+void CompassFusion::SetCalibration(vec const &hardIron, float const *softIron)
+{
+    this->hardIron = hardIron;
+    memcpy(this->softIron, softIron, sizeof(this->softIron));
+}
+
+/*
+  Set the time constant of the heading filter
+  @param tau_s Time constant in seconds, 0 disables the filter
+*/
+void CompassFusion::SetHeadingFilter(float tau_s)
+{
+    headingTau_s = tau_s;
+}
+
+/*
+  Low-pass filter a block of acceleration samples read from the sensor FIFO and integrate the rotation around the
+  vertical measured by the gyroscope since the previous block.
+  @param time_us Time of the FIFO read
+  @param acc Acceleration samples
+  @param gyro Angular rate samples in deg/s, nullptr if the device has no gyroscope
+  @param nbSamples Number of samples in the block
+*/
+void CompassFusion::AddAccSamples(uint32_t time_us, vec const *acc, vec const *gyro, uint32_t nbSamples)
+{
+    if ((nbAccSamples == 0) && (nbSamples > 0))
+    {
+        // First sample : initialize filter
+        filteredAcc = acc[0];
+    }
+    VecFilterBlock(&filteredAcc, acc, nbSamples, COMPASSFUSION_ACC_FILTER_GAIN);
+
+    if ((nbSamples > 0) && (gyro != nullptr))
+    {
+        // Rotation around the vertical since previous block, from the mean angular rate of the block. Heading turns
+        // clockwise while the right-handed rotation around "Up" is counter-clockwise.
+        vec meanGyro = {0.0f, 0.0f, 0.0f};
+        for (uint32_t i = 0; i < nbSamples; i++)
+        {
+            meanGyro = {meanGyro.x + gyro[i].x, meanGyro.y + gyro[i].y, meanGyro.z + gyro[i].z};
+        }
+        if (nbAccSamples > 0)
+        {
+            float dt_s = (time_us - lastGyroSample_us) / 1000000.0f;
+            gyroRotation_deg -= VecDot(meanGyro, VecNormalize(filteredAcc)) * dt_s / nbSamples;
+        }
+        lastGyroSample_us = time_us;
+    }
+    nbAccSamples += nbSamples;
+}
+
+/*
+  Update heading, attitude and rate of turn with a new magnetic field sample. Ignored until acceleration samples have
+  been added, as heading needs a gravity vector.
+  @param time_us Time at which the sample has been read
+  @param mag Raw magnetic field, calibration is applied here
+  @return Heading of this sample alone, before filtering, in degrees
+*/
+float CompassFusion::AddMagSample(uint32_t time_us, vec const &mag)
+{
+    if (nbAccSamples == 0)
+    {
+        return heading_deg;
+    }
+
+    // Substract hard iron offsets and apply soft iron correction
+    vec raw = {mag.x - hardIron.x, mag.y - hardIron.y, mag.z - hardIron.z};
+    vec cal = {softIron[0] * raw.x + softIron[1] * raw.y + softIron[2] * raw.z, softIron[3] * raw.x + softIron[4] * raw.y + softIron[5] * raw.z,
+               softIron[6] * raw.x + softIron[7] * raw.y + softIron[8] * raw.z};
+
+    vec   up = VecNormalize(filteredAcc);
+    float hdgSin, hdgCos;
+    float rawHeading = ComputeHeading(up, cal, &hdgSin, &hdgCos);
+
+    // Attitude comes from the same normalized gravity vector, no additional transfer needed
+    ComputeAttitude(up);
+
+    float dt_s = 0.0f;
+    if (nbMagSamples > 0)
+    {
+        dt_s = (time_us - lastMagSample_us) / 1000000.0f;
+    }
+    lastMagSample_us = time_us;
+
+    // Gyroscope propagates the filtered heading between magnetic samples : the filter then only removes magnetic noise
+    // and the heading does not lag when turning
+    RotateHeading(gyroRotation_deg);
+    gyroRotation_deg = 0.0f;
+
+    // Filter gain is computed from the actual time between samples to keep the time constant whatever the sampling rate
+    float filtered_deg = FilterHeadingVector(&filteredSin, &filteredCos, hdgSin, hdgCos, dt_s, headingTau_s);
+    FilterRateOfTurn(filtered_deg, dt_s);
+    heading_deg = filtered_deg;
+    nbMagSamples++;
+
+    return rawHeading;
+}
+
+/*
+  Get the last filtered heading. It can be called from any task.
+  @return Magnetic heading in degrees
+*/
+float CompassFusion::GetHeading()
+{
+    return heading_deg;
+}
+
+/*
+  Get the last roll angle
+  @return Roll in degrees, positive when heeling to starboard
+*/
+float CompassFusion::GetRoll()
+{
+    return roll_deg;
+}
+
+/*
+  Get the last pitch angle
+  @return Pitch in degrees, positive when bow is up
+*/
+float CompassFusion::GetPitch()
+{
+    return pitch_deg;
+}
+
+/*
+  Get the last rate of turn
+  @return Rate of turn in degrees per minute, positive when turning to starboard
+*/
+float CompassFusion::GetRateOfTurn()
+{
+    return rot_degpmin;
+}
+
+uint32_t CompassFusion::GetNbAccSamples()
+{
+    return nbAccSamples;
+}
+
+uint32_t CompassFusion::GetNbMagSamples()
+{
+    return nbMagSamples;
+}
+
+/*
+  Rotate the filtered heading vector
+  @param angle_deg Rotation angle, positive clockwise
+*/
+void CompassFusion::RotateHeading(float angle_deg)
+{
+    if (angle_deg != 0.0f)
+    {
+        float angle_rad = angle_deg / VECMATH_RAD_TO_DEG;
+        float sinAngle  = sinf(angle_rad);
+        float cosAngle  = cosf(angle_rad);
+        float sinHdg    = filteredSin * cosAngle + filteredCos * sinAngle;
+
+        filteredCos = filteredCos * cosAngle - filteredSin * sinAngle;
+        filteredSin = sinHdg;
+    }
+}
+
+/*
+  Update the rate of turn from the variation of the filtered heading since the previous sample
+  @param heading_deg New filtered heading in degrees
+  @param dt_s Time since the previous sample, 0 for the first sample
+*/
+void CompassFusion::FilterRateOfTurn(float heading_deg, float dt_s)
+{
+    if (dt_s <= 0.0f)
+    {
+        return;
+    }
+
+    float delta_deg = heading_deg - this->heading_deg;
+    if (delta_deg >= 180.0f)
+    {
+        delta_deg -= 360.0f;
+    }
+    else if (delta_deg < -180.0f)
+    {
+        delta_deg += 360.0f;
+    }
+
+    float gain = 1.0f - expf(-dt_s / COMPASSFUSION_ROT_FILTER_S);
+    rot_degpmin += gain * (delta_deg * 60.0f / dt_s - rot_degpmin);
+}
+
+/*
+  Compute roll and pitch from the normalized gravity vector. The sensor axis pointing to the top of the boat is not
+  configured : it is chosen as the axis orthogonal to the heading vector which is the most aligned with gravity on the
+  first sample after boot or after a change of the heading vector, assuming the boat then heels less than 45°.
+  @param up Normalized acceleration vector, pointing up when the boat is at rest
+*/
+void CompassFusion::ComputeAttitude(vec const &up)
+{
+    if (!boatUpValid)
+    {
+        vec   axes[3]  = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+        float maxAlign = -1.0f;
+
+        for (int i = 0; i < 3; i++)
+        {
+            float align = VecDot(axes[i], up);
+            if ((fabsf(VecDot(axes[i], forward)) < 0.5f) && (fabsf(align) > maxAlign))
+            {
+                maxAlign = fabsf(align);
+                boatUp   = axes[i];
+                if (align < 0.0f)
+                {
+                    boatUp = {-axes[i].x, -axes[i].y, -axes[i].z};
+                }
+            }
+        }
+        boatUpValid = true;
+    }
+
+    // Starboard side dips when heeling to starboard
+    float upStarboard = VecDot(VecCross(forward, boatUp), up);
+    float upTop       = VecDot(boatUp, up);
+    float upForward   = VecDot(forward, up);
+    float upLateral2  = (upStarboard * upStarboard) + (upTop * upTop);
+
+    roll_deg  = FastAtan2(-upStarboard, upTop) * VECMATH_RAD_TO_DEG;
+    pitch_deg = FastAtan2(upForward, upLateral2 * FastInvSqrt(upLateral2 + VECMATH_EPSILON)) * VECMATH_RAD_TO_DEG;
+}
+
+/*
+  Compute tilt compensated heading from acceleration and calibrated magnetic field
+  @param up Normalized acceleration vector
+  @param mag Calibrated magnetic field vector, in any unit
+  @param hdgSin Receives the sine of the heading
+  @param hdgCos Receives the cosine of the heading
+  @return Heading in degrees
+*/
+float CompassFusion::ComputeHeading(vec const &up, vec const &mag, float *hdgSin, float *hdgCos)
+{
+    // M X U = E, cross magnetic field (magnetic north + inclination) with "Up" to produce "East"
+    vec E = VecCross(mag, up);
+    // U X E = N, cross "Up" with "East" to produce "North" (parallel to the ground). Since U is a unit vector
+    // orthogonal to E, N has the same norm as E : neither needs to be normalized to get the heading angle.
+    vec N = VecCross(up, E);
+
+    float east  = VecDot(E, forward);
+    float north = VecDot(N, forward);
+    float norm  = FastInvSqrt((east * east) + (north * north) + VECMATH_EPSILON);
+
+    *hdgSin = east * norm;
+    *hdgCos = north * norm;
+
+    float heading = FastAtan2(east, north) * VECMATH_RAD_TO_DEG;
+    if (heading < 0)
+        heading += 360;
+
+    return heading;
+}
@@ -0,0 +1,105 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Tilt compensated heading from compass samples                 *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef COMPASSFUSION_H_
+#define COMPASSFUSION_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "VectorMath.h"
+
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Low-pass filter gain of the gravity vector applied at each sample. Time constant is ~0.1s at accelerometer's 50Hz.
+#define COMPASSFUSION_ACC_FILTER_GAIN 0.2f
+// Time constant of the low-pass filter applied to the rate of turn, which is a derivative of the heading and thus noisy
+#define COMPASSFUSION_ROT_FILTER_S 1.0f
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Heading, attitude and rate of turn computed from acceleration, angular rate and magnetic field samples. There is no
+  hardware access nor configuration lookup here, so that the firmware and the host replay of a compass capture run the
+  very same code on the same samples.
+*/
+class CompassFusion
+{
+  public:
+    CompassFusion();
+    virtual ~CompassFusion();
+
+    void     SetForwardVector(vec const &forward);
+    void     SetCalibration(vec const &hardIron, float const *softIron);
+    void     SetHeadingFilter(float tau_s);
+    void     AddAccSamples(uint32_t time_us, vec const *acc, vec const *gyro, uint32_t nbSamples);
+    float    AddMagSample(uint32_t time_us, vec const &mag);
+    float    GetHeading();
+    float    GetRoll();
+    float    GetPitch();
+    float    GetRateOfTurn();
+    uint32_t GetNbAccSamples();
+    uint32_t GetNbMagSamples();
+
+  private:
+    vec               forward;
+    vec               hardIron;
+    float             softIron[9];
+    float             headingTau_s;
+    vec               filteredAcc;
+    float             filteredSin;
+    float             filteredCos;
+    uint32_t          lastMagSample_us;
+    uint32_t          lastGyroSample_us;
+    float             gyroRotation_deg;
+    vec               boatUp;
+    bool              boatUpValid;
+    volatile float    heading_deg;
+    volatile float    roll_deg;
+    volatile float    pitch_deg;
+    volatile float    rot_degpmin;
+    volatile uint32_t nbAccSamples;
+    volatile uint32_t nbMagSamples;
+
+    float ComputeHeading(vec const &up, vec const &mag, float *hdgSin, float *hdgCos);
+    void  ComputeAttitude(vec const &up);
+    void  RotateHeading(float angle_deg);
+    void  FilterRateOfTurn(float heading_deg, float dt_s);
+};
+
+#endif /* COMPASSFUSION_H_ */
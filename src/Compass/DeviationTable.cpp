@@ -0,0 +1,180 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Compass deviation table learned from GNSS course              *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "DeviationTable.h"
+
+#include <math.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define DEVIATION_SECTOR_DEG (360.0f / DEVIATION_NB_SECTORS)
+// Minimum speed over ground for the course to be accurate enough
+#define DEVIATION_MIN_SOG_KT 3.0f
+// Maximum rate of turn : GNSS course lags the heading when turning
+#define DEVIATION_MAX_ROT_DEGPMIN 30.0f
+// Samples further than this from the heading are considered to come from leeway, current or a bad fix
+#define DEVIATION_MAX_DEG 20.0f
+// Number of samples after which the running average becomes an exponential average
+#define DEVIATION_MAX_SAMPLES 500
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+DeviationTable::DeviationTable()
+{
+    Reset();
+    modified = false;
+}
+
+DeviationTable::~DeviationTable()
+{
+}
+
+/*
+  Load table from its EEPROM representation. Loaded sectors are considered as already learned.
+  @param eepromTable Deviation of each sector in DEVIATION_EEPROM_STEP_DEG units
+*/
+void DeviationTable::Load(int8_t const *eepromTable)
+{
+    for (uint32_t i = 0; i < DEVIATION_NB_SECTORS; i++)
+    {
+        deviation_deg[i] = eepromTable[i] * DEVIATION_EEPROM_STEP_DEG;
+        nbSamples[i]     = (eepromTable[i] != 0) ? DEVIATION_MAX_SAMPLES : 0;
+    }
+    modified = false;
+}
+
+/*
+  Store table in its EEPROM representation
+  @param eepromTable Deviation of each sector in DEVIATION_EEPROM_STEP_DEG units
+*/
+void DeviationTable::Store(int8_t *eepromTable)
+{
+    for (uint32_t i = 0; i < DEVIATION_NB_SECTORS; i++)
+    {
+        eepromTable[i] = (int8_t)lroundf(deviation_deg[i] / DEVIATION_EEPROM_STEP_DEG);
+    }
+    modified = false;
+}
+
+/*
+  Forget all learned deviation, typically after a new calibration of the compass
+*/
+void DeviationTable::Reset()
+{
+    memset(deviation_deg, 0, sizeof(deviation_deg));
+    memset(nbSamples, 0, sizeof(nbSamples));
+    modified = true;
+}
+
+/*
+  Update the sector of the heading with a new deviation sample, if the boat is moving straight at speed
+  @param heading_deg Compass heading, without deviation correction
+  @param magCourse_deg Course over ground corrected from magnetic variation
+  @param sog_kt Speed over ground
+  @param rot_degpmin Rate of turn
+  @return true if the sample has been used
+*/
+bool DeviationTable::Learn(float heading_deg, float magCourse_deg, float sog_kt, float rot_degpmin)
+{
+    if ((sog_kt < DEVIATION_MIN_SOG_KT) || (fabsf(rot_degpmin) > DEVIATION_MAX_ROT_DEGPMIN))
+    {
+        return false;
+    }
+
+    float sample_deg = magCourse_deg - heading_deg;
+    sample_deg -= 360.0f * floorf((sample_deg + 180.0f) / 360.0f);
+    if (fabsf(sample_deg) > DEVIATION_MAX_DEG)
+    {
+        return false;
+    }
+
+    uint32_t sector = (uint32_t)lroundf(heading_deg / DEVIATION_SECTOR_DEG) % DEVIATION_NB_SECTORS;
+
+    if (nbSamples[sector] < DEVIATION_MAX_SAMPLES)
+    {
+        nbSamples[sector]++;
+    }
+    deviation_deg[sector] += (sample_deg - deviation_deg[sector]) / nbSamples[sector];
+    modified = true;
+
+    return true;
+}
+
+/*
+  Get deviation to be added to a compass heading, linearly interpolated between sector centers
+  @param heading_deg Compass heading, without deviation correction
+  @return Deviation in degrees
+*/
+float DeviationTable::GetDeviation(float heading_deg)
+{
+    float    position = heading_deg / DEVIATION_SECTOR_DEG;
+    float    base     = floorf(position);
+    float    ratio    = position - base;
+    uint32_t sector   = (uint32_t)((int32_t)base % DEVIATION_NB_SECTORS + DEVIATION_NB_SECTORS) % DEVIATION_NB_SECTORS;
+    uint32_t next     = (sector + 1) % DEVIATION_NB_SECTORS;
+
+    return deviation_deg[sector] + ratio * (deviation_deg[next] - deviation_deg[sector]);
+}
+
+float DeviationTable::GetSectorDeviation(uint32_t sector)
+{
+    return deviation_deg[sector % DEVIATION_NB_SECTORS];
+}
+
+uint32_t DeviationTable::GetSectorSamples(uint32_t sector)
+{
+    return nbSamples[sector % DEVIATION_NB_SECTORS];
+}
+
+/*
+  Check if the table has been learned or reset since it was last loaded or stored
+*/
+bool DeviationTable::IsModified()
+{
+    return modified;
+}
@@ -0,0 +1,80 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Compass deviation table learned from GNSS course              *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef DEVIATIONTABLE_H_
+#define DEVIATIONTABLE_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Number of heading sectors of the table, each one is 15° wide
+#define DEVIATION_NB_SECTORS 24
+// Resolution of the deviation stored in EEPROM
+#define DEVIATION_EEPROM_STEP_DEG 0.25f
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Deviation of the compass for each heading sector, learned by comparing the compass heading with the magnetic course
+  over ground while the boat is moving straight at speed. Each sector is a running average of its samples, so that
+  the table keeps improving with time at the cost of a few operations per heading sample.
+*/
+class DeviationTable
+{
+  public:
+    DeviationTable();
+    virtual ~DeviationTable();
+
+    void     Load(int8_t const *eepromTable);
+    void     Store(int8_t *eepromTable);
+    void     Reset();
+    bool     Learn(float heading_deg, float magCourse_deg, float sog_kt, float rot_degpmin);
+    float    GetDeviation(float heading_deg);
+    float    GetSectorDeviation(uint32_t sector);
+    uint32_t GetSectorSamples(uint32_t sector);
+    bool     IsModified();
+
+  private:
+    float    deviation_deg[DEVIATION_NB_SECTORS];
+    uint16_t nbSamples[DEVIATION_NB_SECTORS];
+    bool     modified;
+};
+
+#endif /* DEVIATIONTABLE_H_ */
@@ -0,0 +1,266 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Driver for ICM-20948                                          *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "ICM20948Driver.h"
+#include "BoardConfig.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// IMU I2C address depends on AD0 pin level
+#define ICM20948_ADDR   0x69
+#define ICM20948_ADDR_1 0x68
+#define AK09916_ADDR    0x0c
+
+#define ICM20948_WHO_AM_I 0xea
+#define AK09916_WIA2      0x09
+
+// ICM-20948 registers, bank 0
+#define WHO_AM_I       0x00
+#define USER_CTRL      0x03
+#define PWR_MGMT_1     0x06
+#define PWR_MGMT_2     0x07
+#define INT_PIN_CFG    0x0f
+#define ACCEL_XOUT_H   0x2d
+#define FIFO_EN_2      0x67
+#define FIFO_RST       0x68
+#define FIFO_MODE      0x69
+#define FIFO_COUNTH    0x70
+#define FIFO_R_W       0x72
+#define REG_BANK_SEL   0x7f
+// ICM-20948 registers, bank 2
+#define GYRO_SMPLRT_DIV    0x00
+#define GYRO_CONFIG_1      0x01
+#define ACCEL_SMPLRT_DIV_1 0x10
+#define ACCEL_SMPLRT_DIV_2 0x11
+#define ACCEL_CONFIG       0x14
+// AK09916 registers
+#define WIA2  0x01
+#define ST1   0x10
+#define HXL   0x11
+#define CNTL2 0x31
+#define CNTL3 0x32
+
+#define PWR_MGMT_1_RESET     0x80
+#define USER_CTRL_FIFO_EN    0x40
+#define INT_PIN_CFG_BYPASS   0x02
+#define FIFO_COUNTH_MASK     0x1f
+#define ST1_DRDY             0x01
+// Sample rate divider from 1125Hz, to get 51Hz
+#define ICM20948_SMPLRT_DIV  21
+// FIFO sample : accelerometer then gyroscope, 3 big-endian words each
+#define ICM20948_SAMPLE_SIZE 12
+// Data registers from HXL to ST2. ST2 must be read to release the data registers.
+#define AK09916_DATA_SIZE    8
+
+// Sensitivities for +/-2g, 250dps and fixed magnetometer ranges
+#define ICM20948_MG_PER_LSB   (1000.0f / 16384.0f)
+#define ICM20948_DPS_PER_LSB  (1.0f / 131.0f)
+#define AK09916_GAUSS_PER_LSB 0.0015f
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+ICM20948Driver::ICM20948Driver() : imuAddr(ICM20948_ADDR)
+{
+}
+
+ICM20948Driver::~ICM20948Driver()
+{
+}
+
+bool ICM20948Driver::Init()
+{
+    uint8_t whoami = 0;
+
+    if (I2CRead(ICM20948_ADDR, WHO_AM_I, &whoami) && (whoami == ICM20948_WHO_AM_I))
+    {
+        imuAddr = ICM20948_ADDR;
+    }
+    else if (I2CRead(ICM20948_ADDR_1, WHO_AM_I, &whoami) && (whoami == ICM20948_WHO_AM_I))
+    {
+        imuAddr = ICM20948_ADDR_1;
+    }
+    else
+    {
+        return false;
+    }
+
+    SelectBank(0);
+    I2CWrite(imuAddr, PWR_MGMT_1_RESET, PWR_MGMT_1);
+    delay(10);
+    SelectBank(0);
+    I2CWrite(imuAddr, 0x01, PWR_MGMT_1); // 0x01=0b00000001 Wake up, auto select clock source
+    I2CWrite(imuAddr, 0x00, PWR_MGMT_2); // All axes of accelerometer & gyroscope on
+    // Magnetometer is accessed directly through the bypass of the auxiliary I2C master
+    I2CWrite(imuAddr, INT_PIN_CFG_BYPASS, INT_PIN_CFG);
+
+    SelectBank(2);
+    I2CWrite(imuAddr, ICM20948_SMPLRT_DIV, GYRO_SMPLRT_DIV);
+    I2CWrite(imuAddr, 0x19, GYRO_CONFIG_1); // 0x19=0b00011001 Low-pass filter 51Hz, Range: 250dps
+    I2CWrite(imuAddr, 0x00, ACCEL_SMPLRT_DIV_1);
+    I2CWrite(imuAddr, ICM20948_SMPLRT_DIV, ACCEL_SMPLRT_DIV_2);
+    I2CWrite(imuAddr, 0x19, ACCEL_CONFIG); // 0x19=0b00011001 Low-pass filter 50Hz, Range: +/-2g
+
+    // FIFO in stream mode with accelerometer & gyroscope samples
+    SelectBank(0);
+    I2CWrite(imuAddr, 0x1e, FIFO_EN_2); // 0x1e=0b00011110 Accelerometer, gyroscope X, Y & Z
+    I2CWrite(imuAddr, 0x00, FIFO_MODE);
+    I2CWrite(imuAddr, 0x1f, FIFO_RST);
+    I2CWrite(imuAddr, 0x00, FIFO_RST);
+    I2CWrite(imuAddr, USER_CTRL_FIFO_EN, USER_CTRL);
+
+    if (!I2CRead(AK09916_ADDR, WIA2, &whoami) || (whoami != AK09916_WIA2))
+    {
+        return false;
+    }
+    I2CWrite(AK09916_ADDR, 0x01, CNTL3); // Soft reset
+    delay(1);
+    I2CWrite(AK09916_ADDR, 0x04, CNTL2); // Continuous measurement mode 2, ODR 20Hz
+
+    return true;
+}
+
+const char *ICM20948Driver::GetDeviceName()
+{
+    return "ICM-20948";
+}
+
+void ICM20948Driver::GetMagneticField(vec *mag)
+{
+    uint8_t magBuffer[AK09916_DATA_SIZE];
+
+    I2CBurstRead(AK09916_ADDR, HXL, magBuffer, sizeof(magBuffer));
+
+    // AK09916 Y & Z axes are opposite to the ones of accelerometer & gyroscope
+    mag->x = ((int16_t)((magBuffer[1] << 8) | magBuffer[0])) * AK09916_GAUSS_PER_LSB;
+    mag->y = -((int16_t)((magBuffer[3] << 8) | magBuffer[2])) * AK09916_GAUSS_PER_LSB;
+    mag->z = -((int16_t)((magBuffer[5] << 8) | magBuffer[4])) * AK09916_GAUSS_PER_LSB;
+}
+
+void ICM20948Driver::GetAcceleration(vec *acc)
+{
+    uint8_t buffer[6];
+
+    I2CBurstRead(imuAddr, ACCEL_XOUT_H, buffer, 6);
+
+    acc->x = ((int16_t)((buffer[0] << 8) | buffer[1])) * ICM20948_MG_PER_LSB;
+    acc->y = ((int16_t)((buffer[2] << 8) | buffer[3])) * ICM20948_MG_PER_LSB;
+    acc->z = ((int16_t)((buffer[4] << 8) | buffer[5])) * ICM20948_MG_PER_LSB;
+}
+
+/*
+  Drain the FIFO. Burst reads of FIFO_R_W do not increment the register address, so that consecutive samples are read
+  in a single transaction.
+  @param acc Array receiving the acceleration samples
+  @param gyro Array receiving the angular rate samples, can be nullptr
+  @param maxSamples Size of the arrays
+  @return Number of samples read
+*/
+uint32_t ICM20948Driver::ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples)
+{
+    uint8_t  count[2];
+    uint8_t  buffer[NAVCOMPASS_I2C_MAX_BURST];
+    uint32_t nbSamples;
+
+    if (!I2CBurstRead(imuAddr, FIFO_COUNTH, count, sizeof(count)))
+    {
+        return 0;
+    }
+
+    nbSamples = (((count[0] & FIFO_COUNTH_MASK) << 8) | count[1]) / ICM20948_SAMPLE_SIZE;
+    if (nbSamples > maxSamples)
+    {
+        nbSamples = maxSamples;
+    }
+
+    for (uint32_t i = 0; i < nbSamples;)
+    {
+        uint32_t burstSamples = nbSamples - i;
+        if (burstSamples > sizeof(buffer) / ICM20948_SAMPLE_SIZE)
+        {
+            burstSamples = sizeof(buffer) / ICM20948_SAMPLE_SIZE;
+        }
+        if (!I2CBurstRead(imuAddr, FIFO_R_W, buffer, burstSamples * ICM20948_SAMPLE_SIZE))
+        {
+            return i;
+        }
+
+        for (uint8_t *sample = buffer; sample < buffer + burstSamples * ICM20948_SAMPLE_SIZE; sample += ICM20948_SAMPLE_SIZE, i++)
+        {
+            acc[i].x = ((int16_t)((sample[0] << 8) | sample[1])) * ICM20948_MG_PER_LSB;
+            acc[i].y = ((int16_t)((sample[2] << 8) | sample[3])) * ICM20948_MG_PER_LSB;
+            acc[i].z = ((int16_t)((sample[4] << 8) | sample[5])) * ICM20948_MG_PER_LSB;
+            if (gyro != nullptr)
+            {
+                gyro[i].x = ((int16_t)((sample[6] << 8) | sample[7])) * ICM20948_DPS_PER_LSB;
+                gyro[i].y = ((int16_t)((sample[8] << 8) | sample[9])) * ICM20948_DPS_PER_LSB;
+                gyro[i].z = ((int16_t)((sample[10] << 8) | sample[11])) * ICM20948_DPS_PER_LSB;
+            }
+        }
+    }
+
+    return nbSamples;
+}
+
+bool ICM20948Driver::HasGyroscope()
+{
+    return true;
+}
+
+/*
+  Check data-ready status of the magnetometer
+  @return true if a new sample can be read
+*/
+bool ICM20948Driver::IsMagneticFieldReady()
+{
+    uint8_t st1 = 0;
+
+    return I2CRead(AK09916_ADDR, ST1, &st1) && (st1 & ST1_DRDY);
+}
+
+void ICM20948Driver::SelectBank(uint8_t bank)
+{
+    I2CWrite(imuAddr, bank << 4, REG_BANK_SEL);
+}
@@ -0,0 +1,72 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Driver for ICM-20948                                          *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef ICM20948DRIVER_H_
+#define ICM20948DRIVER_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NavCompassDriver.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Driver for the ICM-20948 9-axis IMU. Its AK09916 magnetometer is accessed directly on the I2C bus by enabling the
+  bypass of the auxiliary I2C interface.
+*/
+class ICM20948Driver : public NavCompassDriver
+{
+  public:
+    ICM20948Driver();
+    virtual ~ICM20948Driver();
+
+    virtual bool        Init() override;
+    virtual const char *GetDeviceName() override;
+    virtual void        GetMagneticField(vec *mag) override;
+    virtual void        GetAcceleration(vec *acc) override;
+    virtual uint32_t    ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples) override;
+    virtual bool        HasGyroscope() override;
+    virtual bool        IsMagneticFieldReady() override;
+
+  private:
+    uint8_t imuAddr;
+
+    void SelectBank(uint8_t bank);
+};
+
+#endif /* ICM20948DRIVER_H_ */
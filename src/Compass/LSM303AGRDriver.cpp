@@ -0,0 +1,203 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Driver for LSM303AGR                                          *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "LSM303AGRDriver.h"
+#include "BoardConfig.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define LSM303AGR_ACC_ADDR 0x19
+#define LSM303AGR_MAG_ADDR 0x1E
+
+#define LSM303AGR_WHO_AM_I_A 0x33
+#define LSM303AGR_WHO_AM_I_M 0x40
+
+#define WHO_AM_I_A      0x0f
+#define CTRL_REG1_A     0x20
+#define CTRL_REG4_A     0x23
+#define CTRL_REG5_A     0x24
+#define OUT_X_L_A       0x28
+#define FIFO_CTRL_REG_A 0x2e
+#define FIFO_SRC_REG_A  0x2f
+#define WHO_AM_I_M      0x4f
+#define CFG_REG_A_M     0x60
+#define CFG_REG_B_M     0x61
+#define CFG_REG_C_M     0x62
+#define STATUS_REG_M    0x67
+#define OUTX_L_REG_M    0x68
+
+#define CTRL_REG5_A_FIFO_EN      0x40
+#define FIFO_CTRL_REG_A_STREAM   0x80
+#define FIFO_SRC_REG_A_OVRN      0x40
+#define FIFO_SRC_REG_A_EMPTY     0x20
+#define FIFO_SRC_REG_A_FSS_MASK  0x1f
+#define STATUS_REG_M_ZYXDA       0x08
+#define LSM303AGR_FIFO_DEPTH     32
+#define LSM303AGR_AUTO_INCREMENT 0x80
+
+// Sensitivities in high resolution mode, +/-2g range
+#define LSM303AGR_MG_PER_LSB    0.98f
+#define LSM303AGR_GAUSS_PER_LSB 0.0015f
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+LSM303AGRDriver::LSM303AGRDriver()
+{
+}
+
+LSM303AGRDriver::~LSM303AGRDriver()
+{
+}
+
+bool LSM303AGRDriver::Init()
+{
+    uint8_t whoami = 0;
+
+    if (!I2CRead(LSM303AGR_ACC_ADDR, WHO_AM_I_A, &whoami) || (whoami != LSM303AGR_WHO_AM_I_A))
+    {
+        return false;
+    }
+
+    if (!I2CRead(LSM303AGR_MAG_ADDR, WHO_AM_I_M, &whoami) || (whoami != LSM303AGR_WHO_AM_I_M))
+    {
+        return false;
+    }
+
+    // Acceleration
+    I2CWrite(LSM303AGR_ACC_ADDR, 0x47, CTRL_REG1_A); // 0x47=0b01000111 ODR 50Hz, all axes on
+    I2CWrite(LSM303AGR_ACC_ADDR, 0x88, CTRL_REG4_A); // 0x88=0b10001000 BDU, Range: +/-2g, high resolution
+    // FIFO in stream mode : samples acquired between two readings are kept instead of being overwritten
+    I2CWrite(LSM303AGR_ACC_ADDR, CTRL_REG5_A_FIFO_EN, CTRL_REG5_A);
+    I2CWrite(LSM303AGR_ACC_ADDR, FIFO_CTRL_REG_A_STREAM, FIFO_CTRL_REG_A);
+    // Magnetic field
+    I2CWrite(LSM303AGR_MAG_ADDR, 0x84, CFG_REG_A_M); // 0x84=0b10000100 Temperature compensation, ODR 20Hz, continuous mode
+    I2CWrite(LSM303AGR_MAG_ADDR, 0x03, CFG_REG_B_M); // 0x03=0b00000011 Offset cancellation, low-pass filter
+    I2CWrite(LSM303AGR_MAG_ADDR, 0x10, CFG_REG_C_M); // 0x10=0b00010000 BDU
+
+    return true;
+}
+
+const char *LSM303AGRDriver::GetDeviceName()
+{
+    return "LSM303AGR";
+}
+
+void LSM303AGRDriver::GetMagneticField(vec *mag)
+{
+    uint8_t magBuffer[6];
+
+    I2CBurstRead(LSM303AGR_MAG_ADDR, OUTX_L_REG_M, magBuffer, 6);
+
+    mag->x = ((int16_t)((magBuffer[1] << 8) | magBuffer[0])) * LSM303AGR_GAUSS_PER_LSB;
+    mag->y = ((int16_t)((magBuffer[3] << 8) | magBuffer[2])) * LSM303AGR_GAUSS_PER_LSB;
+    mag->z = ((int16_t)((magBuffer[5] << 8) | magBuffer[4])) * LSM303AGR_GAUSS_PER_LSB;
+}
+
+// Pop the oldest acceleration sample from the FIFO
+void LSM303AGRDriver::GetAcceleration(vec *acc)
+{
+    ReadSamples(acc, nullptr, 1);
+}
+
+/*
+  Drain the acceleration FIFO. With the FIFO enabled, auto-incremented reads roll over from OUT_Z_H_A to OUT_X_L_A,
+  so that consecutive samples are read in a single transaction.
+  @param acc Array receiving the samples
+  @param gyro Unused, the device has no gyroscope
+  @param maxSamples Size of the array
+  @return Number of samples read
+*/
+uint32_t LSM303AGRDriver::ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples)
+{
+    uint8_t  fifoSrc = 0;
+    uint8_t  buffer[NAVCOMPASS_I2C_MAX_BURST];
+    uint32_t nbSamples;
+
+    if (!I2CRead(LSM303AGR_ACC_ADDR, FIFO_SRC_REG_A, &fifoSrc) || (fifoSrc & FIFO_SRC_REG_A_EMPTY))
+    {
+        return 0;
+    }
+
+    nbSamples = (fifoSrc & FIFO_SRC_REG_A_OVRN) ? LSM303AGR_FIFO_DEPTH : (fifoSrc & FIFO_SRC_REG_A_FSS_MASK);
+    if (nbSamples > maxSamples)
+    {
+        nbSamples = maxSamples;
+    }
+
+    for (uint32_t i = 0; i < nbSamples;)
+    {
+        uint32_t burstSamples = nbSamples - i;
+        if (burstSamples > sizeof(buffer) / 6)
+        {
+            burstSamples = sizeof(buffer) / 6;
+        }
+        if (!I2CBurstRead(LSM303AGR_ACC_ADDR, OUT_X_L_A | LSM303AGR_AUTO_INCREMENT, buffer, burstSamples * 6))
+        {
+            return i;
+        }
+
+        // Registers contain a left-aligned 12-bit number
+        for (uint8_t *sample = buffer; sample < buffer + burstSamples * 6; sample += 6, i++)
+        {
+            acc[i].x = ((float)(((int16_t)((sample[1] << 8) | sample[0])) >> 4)) * LSM303AGR_MG_PER_LSB;
+            acc[i].y = ((float)(((int16_t)((sample[3] << 8) | sample[2])) >> 4)) * LSM303AGR_MG_PER_LSB;
+            acc[i].z = ((float)(((int16_t)((sample[5] << 8) | sample[4])) >> 4)) * LSM303AGR_MG_PER_LSB;
+        }
+    }
+
+    return nbSamples;
+}
+
+/*
+  Check data-ready status of the magnetometer
+  @return true if a new sample can be read
+*/
+bool LSM303AGRDriver::IsMagneticFieldReady()
+{
+    uint8_t sr = 0;
+
+    return I2CRead(LSM303AGR_MAG_ADDR, STATUS_REG_M, &sr) && (sr & STATUS_REG_M_ZYXDA);
+}
@@ -0,0 +1,62 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Driver for LSM303AGR                                          *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef LSM303AGRDRIVER_H_
+#define LSM303AGRDRIVER_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NavCompassDriver.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+class LSM303AGRDriver : public NavCompassDriver
+{
+  public:
+    LSM303AGRDriver();
+    virtual ~LSM303AGRDriver();
+
+    virtual bool        Init() override;
+    virtual const char *GetDeviceName() override;
+    virtual void        GetMagneticField(vec *mag) override;
+    virtual void        GetAcceleration(vec *acc) override;
+    virtual uint32_t    ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples) override;
+    virtual bool        IsMagneticFieldReady() override;
+};
+
+#endif /* LSM303AGRDRIVER_H_ */
@@ -30,7 +30,6 @@
 
 #include "LSM303DLHCDriver.h"
 #include "BoardConfig.h"
-#include <Wire.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
@@ -82,6 +81,15 @@
 #define TEMP_OUT_H_M    0x31
 #define TEMP_OUT_L_M    0x32
 
+#define CTRL_REG5_A_FIFO_EN       0x40
+#define FIFO_CTRL_REG_A_STREAM    0x80
+#define FIFO_SRC_REG_A_OVRN       0x40
+#define FIFO_SRC_REG_A_EMPTY      0x20
+#define FIFO_SRC_REG_A_FSS_MASK   0x1f
+#define SR_REG_M_DRDY             0x01
+#define LSM303DLHC_FIFO_DEPTH     32
+#define LSM303DLHC_AUTO_INCREMENT 0x80
+
 /***************************************************************************/
 /*                             Local types                                 */
 /***************************************************************************/
@@ -142,6 +150,9 @@ bool LSM303DLHCDriver::Init()
     // DLHC Acceleration register
     I2CWrite(accAddr, 0x47, CTRL_REG1_A); // 0x47=0b01000111 Normal Mode, ODR 50Hz, all axes on
     I2CWrite(accAddr, 0x08, CTRL_REG4_A); // 0x08=0b00001000 Range: +/-2 Gal, Sens.: 1mGal/LSB, highRes on
+    // FIFO in stream mode : samples acquired between two readings are kept instead of being overwritten
+    I2CWrite(accAddr, CTRL_REG5_A_FIFO_EN, CTRL_REG5_A);
+    I2CWrite(accAddr, FIFO_CTRL_REG_A_STREAM, FIFO_CTRL_REG_A);
     // DLHC Magnetic register
     I2CWrite(magAddr, 0x10, CRA_REG_M); // 0x10=0b00010000 ODR 15Hz
     I2CWrite(magAddr, 0x20, CRB_REG_M); // 0x20=0b00100000 Range: +/-1.3 Gauss gain: 1100LSB/Gauss
@@ -152,9 +163,9 @@ bool LSM303DLHCDriver::Init()
     return true;
 }
 
-string LSM303DLHCDriver::GetDeviceName()
+const char *LSM303DLHCDriver::GetDeviceName()
 {
-    return (string("LSM303DLHC"));
+    return "LSM303DLHC";
 }
 
 void LSM303DLHCDriver::GetMagneticField(vec *mag)
@@ -199,37 +210,63 @@ void LSM303DLHCDriver::GetAcceleration(vec *acc)
     acc->z = ((float)(az >> 4)) * mGal_per_LSB;
 }
 
-bool LSM303DLHCDriver::I2CRead(uint8_t i2cAddress, uint8_t address, uint8_t *data)
+/*
+  Drain the acceleration FIFO. With the FIFO enabled, auto-incremented reads roll over from OUT_Z_H_A to OUT_X_L_A,
+  so that consecutive samples are read in a single transaction.
+  @param acc Array receiving the samples
+  @param gyro Unused, the device has no gyroscope
+  @param maxSamples Size of the array
+  @return Number of samples read
+*/
+uint32_t LSM303DLHCDriver::ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples)
 {
-    NAVCOMPASS_I2C.beginTransmission(i2cAddress);
-    NAVCOMPASS_I2C.write(address);
-    if (NAVCOMPASS_I2C.endTransmission() != 0)
+    uint8_t  fifoSrc = 0;
+    uint8_t  buffer[NAVCOMPASS_I2C_MAX_BURST];
+    uint32_t nbSamples;
+
+    if (!I2CRead(accAddr, FIFO_SRC_REG_A, &fifoSrc) || (fifoSrc & FIFO_SRC_REG_A_EMPTY))
     {
-        return false;
+        return 0;
     }
-    NAVCOMPASS_I2C.requestFrom(i2cAddress, (uint8_t)1);
-    *data = NAVCOMPASS_I2C.read();
 
-    return (NAVCOMPASS_I2C.endTransmission() == 0);
-}
+    nbSamples = (fifoSrc & FIFO_SRC_REG_A_OVRN) ? LSM303DLHC_FIFO_DEPTH : (fifoSrc & FIFO_SRC_REG_A_FSS_MASK);
+    if (nbSamples > maxSamples)
+    {
+        nbSamples = maxSamples;
+    }
 
-bool LSM303DLHCDriver::I2CBurstRead(uint8_t i2cAddress, uint8_t address, uint8_t *buffer, uint8_t length)
-{
-    NAVCOMPASS_I2C.beginTransmission(i2cAddress);
-    NAVCOMPASS_I2C.write(address);
-    if (NAVCOMPASS_I2C.endTransmission() != 0)
+    for (uint32_t i = 0; i < nbSamples;)
     {
-        return false;
+        // Each read of the 6 output registers pops one sample from the FIFO
+        uint32_t burstSamples = nbSamples - i;
+        if (burstSamples > sizeof(buffer) / 6)
+        {
+            burstSamples = sizeof(buffer) / 6;
+        }
+        if (!I2CBurstRead(accAddr, OUT_X_L_A | LSM303DLHC_AUTO_INCREMENT, buffer, burstSamples * 6))
+        {
+            return i;
+        }
+
+        // Registers contain a left-aligned 12-bit number
+        for (uint8_t *sample = buffer; sample < buffer + burstSamples * 6; sample += 6, i++)
+        {
+            acc[i].x = ((float)(((int16_t)((sample[1] << 8) | sample[0])) >> 4)) * mGal_per_LSB;
+            acc[i].y = ((float)(((int16_t)((sample[3] << 8) | sample[2])) >> 4)) * mGal_per_LSB;
+            acc[i].z = ((float)(((int16_t)((sample[5] << 8) | sample[4])) >> 4)) * mGal_per_LSB;
+        }
     }
-    NAVCOMPASS_I2C.requestFrom(i2cAddress, (uint8_t)length);
-    NAVCOMPASS_I2C.readBytes(buffer, NAVCOMPASS_I2C.available());
-    return (NAVCOMPASS_I2C.endTransmission() == 0);
+
+    return nbSamples;
 }
 
-bool LSM303DLHCDriver::I2CWrite(uint8_t i2cAddress, uint8_t data, uint8_t address)
+/*
+  Check data-ready status of the magnetometer
+  @return true if a new sample can be read
+*/
+bool LSM303DLHCDriver::IsMagneticFieldReady()
 {
-    NAVCOMPASS_I2C.beginTransmission(i2cAddress);
-    NAVCOMPASS_I2C.write(address);
-    NAVCOMPASS_I2C.write(data);
-    return (NAVCOMPASS_I2C.endTransmission() == 0);
+    uint8_t sr = 0;
+
+    return I2CRead(magAddr, SR_REG_M, &sr) && (sr & SR_REG_M_DRDY);
 }
@@ -41,8 +41,6 @@
 /*                                Types                                    */
 /***************************************************************************/
 
-using string = std::string;
-
 /***************************************************************************/
 /*                               Classes                                   */
 /***************************************************************************/
@@ -53,20 +51,18 @@ class LSM303DLHCDriver : public NavCompassDriver
     LSM303DLHCDriver();
     virtual ~LSM303DLHCDriver();
 
-    virtual bool   Init() override;
-    virtual string GetDeviceName() override;
-    virtual void   GetMagneticField(vec *mag) override;
-    virtual void   GetAcceleration(vec *acc) override;
+    virtual bool        Init() override;
+    virtual const char *GetDeviceName() override;
+    virtual void        GetMagneticField(vec *mag) override;
+    virtual void        GetAcceleration(vec *acc) override;
+    virtual uint32_t    ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples) override;
+    virtual bool        IsMagneticFieldReady() override;
 
   private:
     uint8_t accAddr, magAddr;
     float   LSB_per_Gauss_XY;
     float   LSB_per_Gauss_Z;
     float   mGal_per_LSB;
-
-    bool I2CRead(uint8_t i2cAddress, uint8_t address, uint8_t *data);
-    bool I2CBurstRead(uint8_t i2cAddress, uint8_t address, uint8_t *buffer, uint8_t length);
-    bool I2CWrite(uint8_t i2cAddress, uint8_t data, uint8_t address);
 };
 
 #endif /* LSM303DLHDRIVER_H_ */
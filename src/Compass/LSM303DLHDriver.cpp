@@ -30,7 +30,6 @@
 
 #include "LSM303DLHDriver.h"
 #include "BoardConfig.h"
-#include <Wire.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
@@ -174,9 +173,9 @@ bool LSM303DLHDriver::Init()
 }
 
 // Return the name of the driven device
-string LSM303DLHDriver::GetDeviceName()
+const char *LSM303DLHDriver::GetDeviceName()
 {
-    return (string("LSM303DLH"));
+    return "LSM303DLH";
 }
 
 // Returns magnetic field measurements on X, Y and Z axis
@@ -231,37 +230,3 @@ void LSM303DLHDriver::GetAcceleration(vec *acc)
 }
 
 // TODO : Create a static class to drive I2C so that this code will not be duplicated for each compass driver
-bool LSM303DLHDriver::I2CRead(uint8_t i2cAddress, uint8_t address, uint8_t *data)
-{
-    NAVCOMPASS_I2C.beginTransmission(i2cAddress);
-    NAVCOMPASS_I2C.write(address);
-    if (NAVCOMPASS_I2C.endTransmission() != 0)
-    {
-        return false;
-    }
-    NAVCOMPASS_I2C.requestFrom(i2cAddress, (uint8_t)1);
-    *data = NAVCOMPASS_I2C.read();
-
-    return (NAVCOMPASS_I2C.endTransmission() == 0);
-}
-
-bool LSM303DLHDriver::I2CBurstRead(uint8_t i2cAddress, uint8_t address, uint8_t *buffer, uint8_t length)
-{
-    NAVCOMPASS_I2C.beginTransmission(i2cAddress);
-    NAVCOMPASS_I2C.write(address);
-    if (NAVCOMPASS_I2C.endTransmission() != 0)
-    {
-        return false;
-    }
-    NAVCOMPASS_I2C.requestFrom(i2cAddress, (uint8_t)length);
-    NAVCOMPASS_I2C.readBytes(buffer, NAVCOMPASS_I2C.available());
-    return (NAVCOMPASS_I2C.endTransmission() == 0);
-}
-
-bool LSM303DLHDriver::I2CWrite(uint8_t i2cAddress, uint8_t data, uint8_t address)
-{
-    NAVCOMPASS_I2C.beginTransmission(i2cAddress);
-    NAVCOMPASS_I2C.write(address);
-    NAVCOMPASS_I2C.write(data);
-    return (NAVCOMPASS_I2C.endTransmission() == 0);
-}
@@ -0,0 +1,260 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Driver for LSM6DS3 + LIS3MDL                                  *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "LSM6DS3LIS3MDLDriver.h"
+#include "BoardConfig.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// I2C addresses depend on SA0 pin level
+#define LSM6DS3_ADDR   0x6b
+#define LSM6DS3_ADDR_1 0x6a
+#define LIS3MDL_ADDR   0x1e
+#define LIS3MDL_ADDR_1 0x1c
+
+#define LSM6DS3_WHO_AM_I 0x69
+#define LIS3MDL_WHO_AM_I 0x3d
+
+// LSM6DS3 registers
+#define FIFO_CTRL3      0x08
+#define FIFO_CTRL5      0x0a
+#define WHO_AM_I        0x0f
+#define CTRL1_XL        0x10
+#define CTRL2_G         0x11
+#define CTRL3_C         0x12
+#define OUTX_L_XL       0x28
+#define FIFO_STATUS1    0x3a
+#define FIFO_STATUS3    0x3c
+#define FIFO_DATA_OUT_L 0x3e
+// LIS3MDL registers
+#define CTRL_REG1  0x20
+#define CTRL_REG2  0x21
+#define CTRL_REG3  0x22
+#define CTRL_REG4  0x23
+#define CTRL_REG5  0x24
+#define STATUS_REG 0x27
+#define OUT_X_L    0x28
+
+#define FIFO_STATUS2_EMPTY     0x10
+#define FIFO_STATUS2_DIFF_MASK 0x0f
+#define STATUS_REG_ZYXDA       0x08
+#define LIS3MDL_AUTO_INCREMENT 0x80
+
+// FIFO pattern with gyroscope and accelerometer at the same rate : GX, GY, GZ, XLX, XLY, XLZ
+#define LSM6DS3_PATTERN_WORDS 6
+
+// Sensitivities for +/-2g, 245dps and +/-4 gauss ranges
+#define LSM6DS3_MG_PER_LSB    0.061f
+#define LSM6DS3_DPS_PER_LSB   0.00875f
+#define LIS3MDL_GAUSS_PER_LSB (1.0f / 6842.0f)
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+LSM6DS3LIS3MDLDriver::LSM6DS3LIS3MDLDriver() : imuAddr(LSM6DS3_ADDR), magAddr(LIS3MDL_ADDR)
+{
+}
+
+LSM6DS3LIS3MDLDriver::~LSM6DS3LIS3MDLDriver()
+{
+}
+
+bool LSM6DS3LIS3MDLDriver::Init()
+{
+    uint8_t whoami = 0;
+
+    if (I2CRead(LSM6DS3_ADDR, WHO_AM_I, &whoami) && (whoami == LSM6DS3_WHO_AM_I))
+    {
+        imuAddr = LSM6DS3_ADDR;
+    }
+    else if (I2CRead(LSM6DS3_ADDR_1, WHO_AM_I, &whoami) && (whoami == LSM6DS3_WHO_AM_I))
+    {
+        imuAddr = LSM6DS3_ADDR_1;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (I2CRead(LIS3MDL_ADDR, WHO_AM_I, &whoami) && (whoami == LIS3MDL_WHO_AM_I))
+    {
+        magAddr = LIS3MDL_ADDR;
+    }
+    else if (I2CRead(LIS3MDL_ADDR_1, WHO_AM_I, &whoami) && (whoami == LIS3MDL_WHO_AM_I))
+    {
+        magAddr = LIS3MDL_ADDR_1;
+    }
+    else
+    {
+        return false;
+    }
+
+    // Accelerometer & gyroscope
+    I2CWrite(imuAddr, 0x44, CTRL3_C);  // 0x44=0b01000100 BDU, register address auto-increment
+    I2CWrite(imuAddr, 0x30, CTRL1_XL); // 0x30=0b00110000 ODR 52Hz, Range: +/-2g
+    I2CWrite(imuAddr, 0x30, CTRL2_G);  // 0x30=0b00110000 ODR 52Hz, Range: 245dps
+    // Both sensors in FIFO without decimation, continuous mode at 52Hz
+    I2CWrite(imuAddr, 0x09, FIFO_CTRL3); // 0x09=0b00001001 Gyroscope & accelerometer, no decimation
+    I2CWrite(imuAddr, 0x1e, FIFO_CTRL5); // 0x1e=0b00011110 FIFO ODR 52Hz, continuous mode
+    // Magnetometer
+    I2CWrite(magAddr, 0x74, CTRL_REG1); // 0x74=0b01110100 Ultra-high performance on X & Y, ODR 20Hz
+    I2CWrite(magAddr, 0x00, CTRL_REG2); // 0x00=0b00000000 Range: +/-4 gauss
+    I2CWrite(magAddr, 0x00, CTRL_REG3); // Continuous mode
+    I2CWrite(magAddr, 0x0c, CTRL_REG4); // 0x0c=0b00001100 Ultra-high performance on Z
+    I2CWrite(magAddr, 0x40, CTRL_REG5); // 0x40=0b01000000 BDU
+
+    return true;
+}
+
+const char *LSM6DS3LIS3MDLDriver::GetDeviceName()
+{
+    return "LSM6DS3+LIS3MDL";
+}
+
+void LSM6DS3LIS3MDLDriver::GetMagneticField(vec *mag)
+{
+    uint8_t magBuffer[6];
+
+    I2CBurstRead(magAddr, OUT_X_L | LIS3MDL_AUTO_INCREMENT, magBuffer, 6);
+
+    mag->x = ((int16_t)((magBuffer[1] << 8) | magBuffer[0])) * LIS3MDL_GAUSS_PER_LSB;
+    mag->y = ((int16_t)((magBuffer[3] << 8) | magBuffer[2])) * LIS3MDL_GAUSS_PER_LSB;
+    mag->z = ((int16_t)((magBuffer[5] << 8) | magBuffer[4])) * LIS3MDL_GAUSS_PER_LSB;
+}
+
+void LSM6DS3LIS3MDLDriver::GetAcceleration(vec *acc)
+{
+    uint8_t buffer[6];
+
+    I2CBurstRead(imuAddr, OUTX_L_XL, buffer, 6);
+
+    acc->x = ((int16_t)((buffer[1] << 8) | buffer[0])) * LSM6DS3_MG_PER_LSB;
+    acc->y = ((int16_t)((buffer[3] << 8) | buffer[2])) * LSM6DS3_MG_PER_LSB;
+    acc->z = ((int16_t)((buffer[5] << 8) | buffer[4])) * LSM6DS3_MG_PER_LSB;
+}
+
+/*
+  Drain the FIFO. FIFO_DATA_OUT_L/H are read as one stream : the register address rolls back to FIFO_DATA_OUT_L after
+  FIFO_DATA_OUT_H, so that consecutive samples are read in a single transaction.
+  @param acc Array receiving the acceleration samples
+  @param gyro Array receiving the angular rate samples, can be nullptr
+  @param maxSamples Size of the arrays
+  @return Number of samples read
+*/
+uint32_t LSM6DS3LIS3MDLDriver::ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples)
+{
+    uint8_t  status[4];
+    uint8_t  buffer[NAVCOMPASS_I2C_MAX_BURST];
+    uint32_t nbWords, pattern, nbSamples;
+
+    // FIFO_STATUS1 to FIFO_STATUS4 : number of unread words and position of the next word in the pattern
+    if (!I2CBurstRead(imuAddr, FIFO_STATUS1, status, sizeof(status)) || (status[1] & FIFO_STATUS2_EMPTY))
+    {
+        return 0;
+    }
+    nbWords = status[0] | ((status[1] & FIFO_STATUS2_DIFF_MASK) << 8);
+    pattern = status[2] | ((status[3] & 0x03) << 8);
+
+    // Skip the end of an incomplete pattern to be aligned on gyroscope X
+    if (pattern != 0)
+    {
+        uint32_t skip = LSM6DS3_PATTERN_WORDS - pattern;
+        if ((nbWords < skip) || !I2CBurstRead(imuAddr, FIFO_DATA_OUT_L, buffer, skip * 2))
+        {
+            return 0;
+        }
+        nbWords -= skip;
+    }
+
+    nbSamples = nbWords / LSM6DS3_PATTERN_WORDS;
+    if (nbSamples > maxSamples)
+    {
+        nbSamples = maxSamples;
+    }
+
+    for (uint32_t i = 0; i < nbSamples;)
+    {
+        uint32_t burstSamples = nbSamples - i;
+        if (burstSamples > sizeof(buffer) / (LSM6DS3_PATTERN_WORDS * 2))
+        {
+            burstSamples = sizeof(buffer) / (LSM6DS3_PATTERN_WORDS * 2);
+        }
+        if (!I2CBurstRead(imuAddr, FIFO_DATA_OUT_L, buffer, burstSamples * LSM6DS3_PATTERN_WORDS * 2))
+        {
+            return i;
+        }
+
+        for (uint8_t *sample = buffer; sample < buffer + burstSamples * LSM6DS3_PATTERN_WORDS * 2; sample += LSM6DS3_PATTERN_WORDS * 2, i++)
+        {
+            if (gyro != nullptr)
+            {
+                gyro[i].x = ((int16_t)((sample[1] << 8) | sample[0])) * LSM6DS3_DPS_PER_LSB;
+                gyro[i].y = ((int16_t)((sample[3] << 8) | sample[2])) * LSM6DS3_DPS_PER_LSB;
+                gyro[i].z = ((int16_t)((sample[5] << 8) | sample[4])) * LSM6DS3_DPS_PER_LSB;
+            }
+            acc[i].x = ((int16_t)((sample[7] << 8) | sample[6])) * LSM6DS3_MG_PER_LSB;
+            acc[i].y = ((int16_t)((sample[9] << 8) | sample[8])) * LSM6DS3_MG_PER_LSB;
+            acc[i].z = ((int16_t)((sample[11] << 8) | sample[10])) * LSM6DS3_MG_PER_LSB;
+        }
+    }
+
+    return nbSamples;
+}
+
+bool LSM6DS3LIS3MDLDriver::HasGyroscope()
+{
+    return true;
+}
+
+/*
+  Check data-ready status of the magnetometer
+  @return true if a new sample can be read
+*/
+bool LSM6DS3LIS3MDLDriver::IsMagneticFieldReady()
+{
+    uint8_t sr = 0;
+
+    return I2CRead(magAddr, STATUS_REG, &sr) && (sr & STATUS_REG_ZYXDA);
+}
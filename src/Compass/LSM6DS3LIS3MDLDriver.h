@@ -0,0 +1,70 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Driver for LSM6DS3 + LIS3MDL                                  *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef LSM6DS3LIS3MDLDRIVER_H_
+#define LSM6DS3LIS3MDLDRIVER_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NavCompassDriver.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Driver for the combination of a LSM6DS3 accelerometer & gyroscope and a LIS3MDL magnetometer with aligned axes, as
+  found on Pololu's MinIMU-9 v5 and AltIMU-10 v5 boards
+*/
+class LSM6DS3LIS3MDLDriver : public NavCompassDriver
+{
+  public:
+    LSM6DS3LIS3MDLDriver();
+    virtual ~LSM6DS3LIS3MDLDriver();
+
+    virtual bool        Init() override;
+    virtual const char *GetDeviceName() override;
+    virtual void        GetMagneticField(vec *mag) override;
+    virtual void        GetAcceleration(vec *acc) override;
+    virtual uint32_t    ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples) override;
+    virtual bool        HasGyroscope() override;
+    virtual bool        IsMagneticFieldReady() override;
+
+  private:
+    uint8_t imuAddr, magAddr;
+};
+
+#endif /* LSM6DS3LIS3MDLDRIVER_H_ */
@@ -0,0 +1,475 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Magnetometer calibration by ellipsoid fitting                 *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "MagCalibrator.h"
+
+#include <math.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Minimum number of samples before trying a fit
+#define MAGCAL_MIN_SAMPLES 50
+// Weight of the sphere prior, relative to the mean diagonal of the normal equations. The weight is multiplied by
+// MAGCAL_REGULARIZATION_STEP until the fit gives an ellipsoid, e.g. when the samples only cover a plane.
+#define MAGCAL_REGULARIZATION_MIN   1e-6
+#define MAGCAL_REGULARIZATION_STEP  10
+#define MAGCAL_REGULARIZATION_TRIES 5
+// An axis is not covered by the samples when their variance along it is below this fraction of the variance of samples
+// spread over a whole sphere, e.g. vertical axis when the boat only turns on flat water. Terms of this axis are then
+// held to the prior with this additional weight, otherwise they would fit the sensor noise.
+#define MAGCAL_COVERAGE_MIN     0.25
+#define MAGCAL_UNCOVERED_WEIGHT 1.0
+// Number of sweeps of the Jacobi eigenvalue algorithm, converges in less than 6 sweeps for 3x3 matrices
+#define MAGCAL_JACOBI_SWEEPS 10
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+/*
+  Class constructor
+*/
+MagCalibrator::MagCalibrator()
+{
+    Reset({0.0f, 0.0f, 0.0f});
+}
+
+/*
+  Class destructor
+*/
+MagCalibrator::~MagCalibrator()
+{
+}
+
+/*
+  Clear all accumulated samples
+  @param center Estimate of the ellipsoid center, e.g. the previous hard iron offset. Samples are accumulated
+  relatively to this point to improve numerical conditioning.
+*/
+void MagCalibrator::Reset(vec const &center)
+{
+    this->center = center;
+    nbSamples    = 0;
+    memset(moments, 0, sizeof(moments));
+}
+
+/*
+  Accumulate a raw magnetic field sample
+  @param mag Raw magnetic field
+*/
+void MagCalibrator::AddSample(vec const &mag)
+{
+    double x                      = mag.x - center.x;
+    double y                      = mag.y - center.y;
+    double z                      = mag.z - center.z;
+    double row[MAGCAL_NB_MOMENTS] = {x * x, y * y, z * z, 2 * x * y, 2 * x * z, 2 * y * z, 2 * x, 2 * y, 2 * z, 1};
+
+    // Moment matrix is symmetric : only its upper triangle is accumulated
+    for (int i = 0; i < MAGCAL_NB_MOMENTS; i++)
+    {
+        for (int j = i; j < MAGCAL_NB_MOMENTS; j++)
+        {
+            moments[i][j] += row[i] * row[j];
+        }
+    }
+
+    nbSamples++;
+}
+
+/*
+  Get the number of accumulated samples
+*/
+uint32_t MagCalibrator::GetNbSamples()
+{
+    return nbSamples;
+}
+
+/*
+  Fit the ellipsoid on the accumulated samples and convert it into hard & soft iron corrections. Samples are not
+  cleared, the fit can be refined with more samples.
+  @param calibration Structure receiving the calibration
+  @return true if the fit succeeded
+*/
+bool MagCalibrator::Solve(MagCalibration_t *calibration)
+{
+    double normal[MAGCAL_NB_MOMENTS][MAGCAL_NB_MOMENTS];
+    double column[MAGCAL_NB_MOMENTS];
+
+    if (nbSamples < MAGCAL_MIN_SAMPLES)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < MAGCAL_NB_MOMENTS; i++)
+    {
+        for (int j = i; j < MAGCAL_NB_MOMENTS; j++)
+        {
+            normal[i][j] = moments[i][j];
+            normal[j][i] = moments[i][j];
+        }
+    }
+
+    // Move the moments to the mean of the samples, i.e. the center of the turning circle when only heading changes.
+    // With T the transform of the terms, new moments are T.M.TT : T is applied to each row, then to each column.
+    double mean[3] = {normal[6][9] / (2 * nbSamples), normal[7][9] / (2 * nbSamples), normal[8][9] / (2 * nbSamples)};
+    for (int i = 0; i < MAGCAL_NB_MOMENTS; i++)
+    {
+        ShiftTerms(normal[i], mean);
+    }
+    for (int j = 0; j < MAGCAL_NB_MOMENTS; j++)
+    {
+        for (int i = 0; i < MAGCAL_NB_MOMENTS; i++)
+        {
+            column[i] = normal[i][j];
+        }
+        ShiftTerms(column, mean);
+        for (int i = 0; i < MAGCAL_NB_MOMENTS; i++)
+        {
+            normal[i][j] = column[i];
+        }
+    }
+
+    // Previous hard iron offset, relative to the mean : directions not covered by the samples keep it
+    double priorCenter[3] = {-mean[0], -mean[1], -mean[2]};
+    double regularization = MAGCAL_REGULARIZATION_MIN;
+    for (int i = 0; i < MAGCAL_REGULARIZATION_TRIES; i++)
+    {
+        if (Solve(calibration, normal, priorCenter, regularization))
+        {
+            calibration->offset.x += center.x + mean[0];
+            calibration->offset.y += center.y + mean[1];
+            calibration->offset.z += center.z + mean[2];
+            return true;
+        }
+        regularization *= MAGCAL_REGULARIZATION_STEP;
+    }
+
+    return false;
+}
+
+/*
+  Fit the ellipsoid with a given weight of the sphere prior
+  @param calibration Structure receiving the calibration, offset being relative to the origin of the moments
+  @param normal Moments of the samples. Upper left block is the normal matrix, last column is the right hand side.
+  @param priorCenter Center of the prior sphere, relative to the origin of the moments
+  @param regularization Weight of the prior, relative to the mean diagonal of the normal equations
+  @return true if the fit gives an ellipsoid
+*/
+bool MagCalibrator::Solve(MagCalibration_t *calibration, double normal[MAGCAL_NB_MOMENTS][MAGCAL_NB_MOMENTS], double const priorCenter[3],
+                          double regularization)
+{
+    double matrix[MAGCAL_NB_PARAMS][MAGCAL_NB_PARAMS];
+    double params[MAGCAL_NB_PARAMS];
+
+    // Regularize toward the sphere centered on the prior center which passes at the RMS distance of the samples. The
+    // origin of the moments being the mean of the samples, the sphere equation |u - c|² = r² becomes
+    // |u|² - 2c.u = mean(|u|²) : it is normalized by mean(|u|²) to match the form of the ellipsoid equation.
+    double trace = 0;
+    for (int i = 0; i < MAGCAL_NB_PARAMS; i++)
+    {
+        trace += normal[i][i];
+    }
+    double radius2                 = (normal[0][9] + normal[1][9] + normal[2][9]) / nbSamples;
+    double prior[MAGCAL_NB_PARAMS] = {1 / radius2, 1 / radius2, 1 / radius2, 0, 0, 0, -priorCenter[0] / radius2, -priorCenter[1] / radius2,
+                                      -priorCenter[2] / radius2};
+
+    // Lack of coverage of each axis, from 0 (covered) to 1 (samples in a plane orthogonal to the axis)
+    double uncovered[3];
+    for (int i = 0; i < 3; i++)
+    {
+        double coverage = (normal[i][9] / nbSamples) / (radius2 / 3);
+        uncovered[i]    = (coverage < MAGCAL_COVERAGE_MIN) ? 1 - coverage / MAGCAL_COVERAGE_MIN : 0;
+    }
+    // Axes involved in each term of the ellipsoid equation
+    static const int termAxes[MAGCAL_NB_PARAMS][2] = {{0, 0}, {1, 1}, {2, 2}, {0, 1}, {0, 2}, {1, 2}, {0, 0}, {1, 1}, {2, 2}};
+
+    for (int i = 0; i < MAGCAL_NB_PARAMS; i++)
+    {
+        double lambda = trace / MAGCAL_NB_PARAMS *
+                        (regularization + MAGCAL_UNCOVERED_WEIGHT * fmax(uncovered[termAxes[i][0]], uncovered[termAxes[i][1]]));
+
+        for (int j = 0; j < MAGCAL_NB_PARAMS; j++)
+        {
+            matrix[i][j] = normal[i][j];
+        }
+        matrix[i][i] += lambda;
+        params[i] = normal[i][9] + lambda * prior[i];
+    }
+
+    if (!CholeskySolve(matrix, params))
+    {
+        return false;
+    }
+
+    // Ellipsoid equation : (u - o)T.Q.(u - o) = k, with u the sample relative to the origin of the moments
+    double q[3][3] = {{params[0], params[3], params[4]}, {params[3], params[1], params[5]}, {params[4], params[5], params[2]}};
+    double b[3]    = {params[6], params[7], params[8]};
+    double eigenValues[3];
+    double eigenVectors[3][3];
+
+    EigenDecompose(q, eigenValues, eigenVectors);
+    if ((eigenValues[0] <= 0) || (eigenValues[1] <= 0) || (eigenValues[2] <= 0))
+    {
+        // Not an ellipsoid
+        return false;
+    }
+
+    // o = -Q^-1.b, computed with the eigen decomposition of Q
+    double o[3] = {0, 0, 0};
+    for (int i = 0; i < 3; i++)
+    {
+        double projection = 0;
+        for (int j = 0; j < 3; j++)
+        {
+            projection += eigenVectors[j][i] * b[j];
+        }
+        for (int j = 0; j < 3; j++)
+        {
+            o[j] -= eigenVectors[j][i] * projection / eigenValues[i];
+        }
+    }
+    double k = 1;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            k += o[i] * q[i][j] * o[j];
+        }
+    }
+    if (k <= 0)
+    {
+        return false;
+    }
+
+    // Soft iron matrix is the square root of Q/k, scaled so that the corrected field keeps the geometric mean radius
+    double radius = pow((eigenValues[0] / k) * (eigenValues[1] / k) * (eigenValues[2] / k), -1.0 / 6.0);
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            double value = 0;
+            for (int l = 0; l < 3; l++)
+            {
+                value += eigenVectors[i][l] * sqrt(eigenValues[l] / k) * eigenVectors[j][l];
+            }
+            calibration->softIron[i][j] = radius * value;
+        }
+    }
+    calibration->offset.x      = o[0];
+    calibration->offset.y      = o[1];
+    calibration->offset.z      = o[2];
+    calibration->fieldStrength = radius;
+
+    // Sum of squared algebraic residuals, derived from the normal equations : pT.N.p - 2.pT.r + n
+    double residual2 = nbSamples;
+    for (int i = 0; i < MAGCAL_NB_PARAMS; i++)
+    {
+        residual2 -= 2 * params[i] * normal[i][9];
+        for (int j = 0; j < MAGCAL_NB_PARAMS; j++)
+        {
+            residual2 += params[i] * normal[i][j] * params[j];
+        }
+    }
+    // Algebraic residual of a sample is k.(r² - 1), with r its normalized corrected radius : relative radius error is
+    // about residual / 2k
+    calibration->fitError_per = 100.0 * sqrt((residual2 > 0) ? residual2 / nbSamples : 0) / (2 * k);
+
+    return true;
+}
+
+/*
+  Express the equation terms of a sample u relatively to a new origin, i.e. compute the terms of u - shift as linear
+  combinations of the terms of u
+  @param terms Terms (or any vector in the basis of the terms), transformed in place
+  @param shift Position of the new origin relative to the current one
+*/
+void MagCalibrator::ShiftTerms(double terms[MAGCAL_NB_MOMENTS], double const shift[3])
+{
+    double x = -shift[0];
+    double y = -shift[1];
+    double z = -shift[2];
+
+    // (u.x + x)² = u.x² + x.2u.x + x²
+    terms[0] += x * terms[6] + x * x * terms[9];
+    terms[1] += y * terms[7] + y * y * terms[9];
+    terms[2] += z * terms[8] + z * z * terms[9];
+    // 2(u.x + x)(u.y + y) = 2u.x.u.y + y.2u.x + x.2u.y + 2xy
+    terms[3] += y * terms[6] + x * terms[7] + 2 * x * y * terms[9];
+    terms[4] += z * terms[6] + x * terms[8] + 2 * x * z * terms[9];
+    terms[5] += z * terms[7] + y * terms[8] + 2 * y * z * terms[9];
+    // 2(u.x + x) = 2u.x + 2x
+    terms[6] += 2 * x * terms[9];
+    terms[7] += 2 * y * terms[9];
+    terms[8] += 2 * z * terms[9];
+}
+
+/*
+  Solve a symmetric positive definite linear system with Cholesky decomposition
+  @param matrix System matrix, overwritten by its decomposition
+  @param vector Right hand side, overwritten by the solution
+  @return false if the matrix is not positive definite
+*/
+bool MagCalibrator::CholeskySolve(double matrix[MAGCAL_NB_PARAMS][MAGCAL_NB_PARAMS], double *vector)
+{
+    // Decomposition in the lower triangle : matrix = L.LT
+    for (int j = 0; j < MAGCAL_NB_PARAMS; j++)
+    {
+        double diagonal = matrix[j][j];
+        for (int k = 0; k < j; k++)
+        {
+            diagonal -= matrix[j][k] * matrix[j][k];
+        }
+        if (diagonal <= 0)
+        {
+            return false;
+        }
+        matrix[j][j] = sqrt(diagonal);
+
+        for (int i = j + 1; i < MAGCAL_NB_PARAMS; i++)
+        {
+            double value = matrix[i][j];
+            for (int k = 0; k < j; k++)
+            {
+                value -= matrix[i][k] * matrix[j][k];
+            }
+            matrix[i][j] = value / matrix[j][j];
+        }
+    }
+
+    // Forward substitution : L.y = b
+    for (int i = 0; i < MAGCAL_NB_PARAMS; i++)
+    {
+        for (int k = 0; k < i; k++)
+        {
+            vector[i] -= matrix[i][k] * vector[k];
+        }
+        vector[i] /= matrix[i][i];
+    }
+
+    // Backward substitution : LT.x = y
+    for (int i = MAGCAL_NB_PARAMS - 1; i >= 0; i--)
+    {
+        for (int k = i + 1; k < MAGCAL_NB_PARAMS; k++)
+        {
+            vector[i] -= matrix[k][i] * vector[k];
+        }
+        vector[i] /= matrix[i][i];
+    }
+
+    return true;
+}
+
+/*
+  Eigen decomposition of a symmetric 3x3 matrix with the cyclic Jacobi algorithm
+  @param matrix Symmetric matrix, not modified
+  @param eigenValues Array receiving the eigenvalues
+  @param eigenVectors Matrix receiving the eigenvectors in its columns
+*/
+void MagCalibrator::EigenDecompose(double matrix[3][3], double eigenValues[3], double eigenVectors[3][3])
+{
+    double a[3][3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            a[i][j]            = matrix[i][j];
+            eigenVectors[i][j] = (i == j) ? 1 : 0;
+        }
+    }
+
+    for (int sweep = 0; sweep < MAGCAL_JACOBI_SWEEPS; sweep++)
+    {
+        double offDiagonal = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+        if (offDiagonal < 1e-15 * (fabs(a[0][0]) + fabs(a[1][1]) + fabs(a[2][2])))
+        {
+            break;
+        }
+
+        for (int p = 0; p < 2; p++)
+        {
+            for (int q = p + 1; q < 3; q++)
+            {
+                if (a[p][q] == 0)
+                {
+                    continue;
+                }
+
+                // Rotation cancelling a[p][q]
+                double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                double t     = ((theta >= 0) ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+                double c     = 1 / sqrt(t * t + 1);
+                double s     = t * c;
+
+                for (int k = 0; k < 3; k++)
+                {
+                    double akp = a[k][p];
+                    double akq = a[k][q];
+                    a[k][p]    = c * akp - s * akq;
+                    a[k][q]    = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; k++)
+                {
+                    double apk = a[p][k];
+                    double aqk = a[q][k];
+                    a[p][k]    = c * apk - s * aqk;
+                    a[q][k]    = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; k++)
+                {
+                    double vkp         = eigenVectors[k][p];
+                    double vkq         = eigenVectors[k][q];
+                    eigenVectors[k][p] = c * vkp - s * vkq;
+                    eigenVectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        eigenValues[i] = a[i][i];
+    }
+}
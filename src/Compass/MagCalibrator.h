@@ -0,0 +1,93 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Magnetometer calibration by ellipsoid fitting                 *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef MAGCALIBRATOR_H_
+#define MAGCALIBRATOR_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NavCompassDriver.h"
+
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Number of parameters of the ellipsoid equation
+#define MAGCAL_NB_PARAMS 9
+// Number of accumulated moments per dimension : parameters and constant term
+#define MAGCAL_NB_MOMENTS (MAGCAL_NB_PARAMS + 1)
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef struct
+{
+    vec   offset;          // Hard iron offset, subtracted from raw magnetic field
+    float softIron[3][3];  // Soft iron matrix, applied after offset subtraction
+    float fieldStrength;   // Magnitude of the corrected magnetic field
+    float fitError_per;    // RMS deviation of the corrected field magnitude, in percent
+} MagCalibration_t;
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Incremental least-squares fit of an ellipsoid A.x² + B.y² + C.z² + 2D.xy + 2E.xz + 2F.yz + 2G.x + 2H.y + 2I.z = 1
+  on magnetic field samples. Only the moments of the equation terms are accumulated, so that memory does not depend
+  on the number of samples. They are moved to the mean of the samples before solving, and the fit is regularized
+  toward a sphere centered on the previous hard iron offset, so that directions not covered by the samples (e.g.
+  vertical axis when the boat only turns on flat water) keep their previous correction.
+*/
+class MagCalibrator
+{
+  public:
+    MagCalibrator();
+    virtual ~MagCalibrator();
+
+    void     Reset(vec const &center);
+    void     AddSample(vec const &mag);
+    uint32_t GetNbSamples();
+    bool     Solve(MagCalibration_t *calibration);
+
+  private:
+    vec      center;
+    uint32_t nbSamples;
+    double   moments[MAGCAL_NB_MOMENTS][MAGCAL_NB_MOMENTS];
+
+    bool        Solve(MagCalibration_t *calibration, double normal[MAGCAL_NB_MOMENTS][MAGCAL_NB_MOMENTS], double const priorCenter[3],
+                      double regularization);
+    static void ShiftTerms(double terms[MAGCAL_NB_MOMENTS], double const shift[3]);
+    static bool CholeskySolve(double matrix[MAGCAL_NB_PARAMS][MAGCAL_NB_PARAMS], double *vector);
+    static void EigenDecompose(double matrix[3][3], double eigenValues[3], double eigenVectors[3][3]);
+};
+
+#endif /* MAGCALIBRATOR_H_ */
@@ -33,16 +33,29 @@
 #include "NavCompass.h"
 #include "BoardConfig.h"
 #include "Globals.h"
+#include "ICM20948Driver.h"
+#include "LSM303AGRDriver.h"
 #include "LSM303DLHCDriver.h"
 #include "LSM303DLHDriver.h"
+#include "LSM6DS3LIS3MDLDriver.h"
 
-#include <cmath>
-#include <vector>
+#include <new>
+#include <string.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
 /***************************************************************************/
 
+static_assert(sizeof(LSM303DLHCDriver) <= NAVCOMPASS_DRIVER_STORAGE_SIZE, "NAVCOMPASS_DRIVER_STORAGE_SIZE too small");
+static_assert(sizeof(LSM303DLHDriver) <= NAVCOMPASS_DRIVER_STORAGE_SIZE, "NAVCOMPASS_DRIVER_STORAGE_SIZE too small");
+static_assert(sizeof(LSM303AGRDriver) <= NAVCOMPASS_DRIVER_STORAGE_SIZE, "NAVCOMPASS_DRIVER_STORAGE_SIZE too small");
+static_assert(sizeof(LSM6DS3LIS3MDLDriver) <= NAVCOMPASS_DRIVER_STORAGE_SIZE, "NAVCOMPASS_DRIVER_STORAGE_SIZE too small");
+static_assert(sizeof(ICM20948Driver) <= NAVCOMPASS_DRIVER_STORAGE_SIZE, "NAVCOMPASS_DRIVER_STORAGE_SIZE too small");
+
+// Width of the heading sectors used to check that the boat has turned a full circle during calibration
+#define NAVCOMPASS_CAL_SECTOR_DEG 30
+#define NAVCOMPASS_CAL_NB_SECTORS (360 / NAVCOMPASS_CAL_SECTOR_DEG)
+
 /***************************************************************************/
 /*                             Local types                                 */
 /***************************************************************************/
@@ -51,20 +64,28 @@
 /*                           Local prototypes                              */
 /***************************************************************************/
 
+template <class T> static NavCompassDriver *ConstructDriver(void *storage);
+
 /***************************************************************************/
 /*                           Static & Globals                              */
 /***************************************************************************/
 
+// Supported devices, in probing order. Devices sharing the same addresses are told apart by their driver's Init().
+static const NavCompassProbe_t probeTable[] = {
+    {{0x19, 0x00}, ConstructDriver<LSM303AGRDriver>},
+    {{0x19, 0x00}, ConstructDriver<LSM303DLHCDriver>},
+    {{0x18, 0x19}, ConstructDriver<LSM303DLHDriver>},
+    {{0x6b, 0x6a}, ConstructDriver<LSM6DS3LIS3MDLDriver>},
+    {{0x69, 0x68}, ConstructDriver<ICM20948Driver>},
+};
+
 /***************************************************************************/
 /*                              Functions                                  */
 /***************************************************************************/
 
-NavCompass::NavCompass() : headingIndex(0), navCompassDetected(false), navCompassDriver(nullptr)
+NavCompass::NavCompass() : navCompassDetected(false), calibrating(false), calibrationSectors(0), navCompassDriver(nullptr)
 {
-    for (int i = 0; i < HEADING_HISTORY_LENGTH; i++)
-    {
-        headingHistory[i] = 0.0f;
-    }
+    calibrationMutex = xSemaphoreCreateMutex();
 }
 
 NavCompass::~NavCompass()
@@ -75,119 +96,265 @@ bool NavCompass::Init()
 {
     navCompassDetected = false;
 
-    navCompassDriver = new LSM303DLHCDriver();
-    if (!navCompassDriver->Init())
+    for (uint32_t i = 0; i < sizeof(probeTable) / sizeof(probeTable[0]); i++)
+    {
+        if (ProbeDriver(&probeTable[i]))
+        {
+            navCompassDetected = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+  Construct a driver in the static driver storage and check if its device is present. The driver is only constructed
+  and initialized if one of the device's addresses acknowledges, so that absent devices cost a single I2C transfer.
+  @return true if the device has been detected, the driver is then kept in the storage
+*/
+bool NavCompass::ProbeDriver(NavCompassProbe_t const *probe)
+{
+    if (!IsI2CDevicePresent(probe->i2cAddress[0]) && !IsI2CDevicePresent(probe->i2cAddress[1]))
+    {
+        return false;
+    }
+
+    if (navCompassDriver != nullptr)
     {
-        delete navCompassDriver;
-        navCompassDriver = new LSM303DLHDriver();
+        navCompassDriver->~NavCompassDriver();
     }
 
-    if (!navCompassDriver->Init())
+    navCompassDriver = probe->ConstructDriver(driverStorage);
+    if (navCompassDriver->Init())
+    {
+        return true;
+    }
+
+    navCompassDriver->~NavCompassDriver();
+    navCompassDriver = nullptr;
+    return false;
+}
+
+/*
+  Check if a device acknowledges its I2C address
+*/
+bool NavCompass::IsI2CDevicePresent(uint8_t i2cAddress)
+{
+    if (i2cAddress == 0)
     {
-        delete navCompassDriver;
         return false;
     }
 
-    navCompassDetected = true;
-    return true;
+    return gI2CBus.IsDevicePresent(I2C_CLIENT_COMPASS, i2cAddress);
+}
+
+template <class T> static NavCompassDriver *ConstructDriver(void *storage)
+{
+    return new (storage) T();
 }
 
-string NavCompass::GetDeviceName()
+const char *NavCompass::GetDeviceName()
 {
     if (navCompassDetected)
     {
         return navCompassDriver->GetDeviceName();
     }
 
-    return string("");
+    return "";
 }
 
-float NavCompass::GetHeading()
+/*
+  Read all the samples acquired by the compass since the last call, low-pass filter acceleration at its full output
+  data rate, integrate angular rate if the device has a gyroscope, and update the filtered heading, attitude and rate of
+  turn with each magnetic field sample. Must be called periodically by the compass task, faster than the magnetometer
+  output data rate. This is the only function doing I2C transfers during normal operation.
+*/
+void NavCompass::Sample()
 {
-    vec accel;
-    vec mag;
-    vec from;
-    vec E;
-    vec N;
+    vec      mag;
+    uint32_t nbSamples;
 
-    switch (gConfiguration.eeprom.compassHdgVector)
+    if (!navCompassDetected)
     {
-    case COMPASS_HDG_VECTOR_X:
-        from = {1.0f, 0.0f, 0.0f};
-        break;
-    case COMPASS_HDG_VECTOR_Y:
-        from = {0.0f, 1.0f, 0.0f};
-        break;
-    case COMPASS_HDG_VECTOR_Z:
-        from = {0.0f, 0.0f, 1.0f};
-        break;
-    case COMPASS_HDG_VECTOR_MX:
-        from = {-1.0f, 0.0f, 0.0f};
-        break;
-    case COMPASS_HDG_VECTOR_MY:
-        from = {0.0f, -1.0f, 0.0f};
-        break;
-    case COMPASS_HDG_VECTOR_MZ:
-        from = {0.0f, 0.0f, -1.0f};
-        break;
+        return;
     }
 
-    // Get Acceleration and Magnetic data from LSM303
-    // Note that we don't care about units of both acceleration and magnetic field since we
-    // are only calculating angles.
-    navCompassDriver->GetAcceleration(&accel);
-    navCompassDriver->GetMagneticField(&mag);
+    nbSamples           = navCompassDriver->ReadSamples(accSamples, gyroSamples, NAVCOMPASS_MAX_ACC_SAMPLES);
+    uint32_t accTime_us = micros();
+    bool     hasGyro    = navCompassDriver->HasGyroscope();
+    if (gCompassCapture.IsActive())
+    {
+        if (!hasGyro)
+        {
+            memset(gyroSamples, 0, nbSamples * sizeof(vec));
+        }
+        gCompassCapture.AddAccSamples(accTime_us, accSamples, gyroSamples, nbSamples);
+    }
+    fusion.AddAccSamples(accTime_us, accSamples, hasGyro ? gyroSamples : nullptr, nbSamples);
 
-    // Substract calibration offsets from magnetic readings
-    mag.x -= gConfiguration.eeprom.xMagOffset;
-    mag.y -= gConfiguration.eeprom.yMagOffset;
-    mag.z -= gConfiguration.eeprom.zMagOffset;
+    // Heading needs a gravity vector and only changes with a new magnetic field sample
+    if ((fusion.GetNbAccSamples() == 0) || !navCompassDriver->IsMagneticFieldReady())
+    {
+        return;
+    }
 
-    // normalize
-    Normalize(&accel);
-    Normalize(&mag);
+    navCompassDriver->GetMagneticField(&mag);
+    uint32_t magTime_us = micros();
 
-    // D X M = E, cross acceleration vector Down with M (magnetic north + inclination) to produce "East"
-    CrossProduct(&mag, &accel, &E);
-    Normalize(&E);
-    // E X D = N, cross "East" with "Down" to produce "North" (parallel to the ground)
-    CrossProduct(&accel, &E, &N);
-    Normalize(&N);
+    if (calibrating)
+    {
+        xSemaphoreTake(calibrationMutex, portMAX_DELAY);
+        calibrator.AddSample(mag);
+        xSemaphoreGive(calibrationMutex);
+    }
 
-    // compute heading
-    float heading = atan2f(vector_dot(&E, &from), vector_dot(&N, &from)) * 180.0f / PI;
+    ConfigureFusion();
+    float rawHeading = fusion.AddMagSample(magTime_us, mag);
 
-    if (heading < 0)
-        heading += 360;
+    if (calibrating)
+    {
+        calibrationSectors |= 1 << ((uint32_t)(rawHeading / NAVCOMPASS_CAL_SECTOR_DEG) % NAVCOMPASS_CAL_NB_SECTORS);
+    }
 
-    headingHistory[headingIndex++] = heading;
-    if (headingIndex >= HEADING_HISTORY_LENGTH)
+    if (gCompassCapture.IsActive())
     {
-        headingIndex = 0;
+        gCompassCapture.AddMagSample(magTime_us, mag, fusion.GetHeading(), fusion.GetRoll(), fusion.GetPitch());
     }
+}
+
+/*
+  Get the last heading computed by Sample(). No I2C transfer is done, it can be called from any task.
+  @return Magnetic heading in degrees
+*/
+float NavCompass::GetHeading()
+{
+    return fusion.GetHeading();
+}
+
+/*
+  Get the last roll angle computed by Sample()
+  @return Roll in degrees, positive when heeling to starboard
+*/
+float NavCompass::GetRoll()
+{
+    return fusion.GetRoll();
+}
+
+/*
+  Get the last pitch angle computed by Sample()
+  @return Pitch in degrees, positive when bow is up
+*/
+float NavCompass::GetPitch()
+{
+    return fusion.GetPitch();
+}
+
+/*
+  Get the last rate of turn computed by Sample()
+  @return Rate of turn in degrees per minute, positive when turning to starboard
+*/
+float NavCompass::GetRateOfTurn()
+{
+    return fusion.GetRateOfTurn();
+}
+
+/*
+  Get the number of acceleration samples read since boot
+*/
+uint32_t NavCompass::GetNbAccSamples()
+{
+    return fusion.GetNbAccSamples();
+}
+
+/*
+  Get the number of magnetic field samples read since boot
+*/
+uint32_t NavCompass::GetNbMagSamples()
+{
+    return fusion.GetNbMagSamples();
+}
 
-    bool firstQ     = false;
-    bool lastQ      = false;
-    bool shiftAngle = false;
-    for (int i = 0; i < HEADING_HISTORY_LENGTH; i++)
+/*
+  Start collecting magnetic field samples for calibration. The boat must then turn at least one full circle.
+*/
+void NavCompass::StartCalibration()
+{
+    vec center = {gConfiguration.eeprom.xMagOffset, gConfiguration.eeprom.yMagOffset, gConfiguration.eeprom.zMagOffset};
+
+    xSemaphoreTake(calibrationMutex, portMAX_DELAY);
+    calibrator.Reset(center);
+    calibrationSectors = 0;
+    calibrating        = true;
+    xSemaphoreGive(calibrationMutex);
+}
+
+/*
+  Fit the calibration on the samples collected since StartCalibration. Collection goes on.
+  @param calibration Structure receiving the calibration
+  @param nbSamples Number of collected samples
+  @param nbSectors Number of 30° heading sectors covered by the samples
+  @return true if the fit succeeded
+*/
+bool NavCompass::GetCalibration(MagCalibration_t *calibration, uint32_t *nbSamples, uint32_t *nbSectors)
+{
+    bool fitted;
+
+    xSemaphoreTake(calibrationMutex, portMAX_DELAY);
+    fitted     = calibrator.Solve(calibration);
+    *nbSamples = calibrator.GetNbSamples();
+    *nbSectors = 0;
+    for (uint32_t i = 0; i < NAVCOMPASS_CAL_NB_SECTORS; i++)
     {
-        if (headingHistory[i] < 90.0)
-            firstQ = true;
-        if (headingHistory[i] > 270.0)
-            lastQ = true;
+        *nbSectors += (calibrationSectors >> i) & 0x01;
     }
-    shiftAngle = firstQ && lastQ;
+    xSemaphoreGive(calibrationMutex);
+
+    return fitted;
+}
+
+/*
+  Stop collecting calibration samples
+*/
+void NavCompass::StopCalibration()
+{
+    calibrating = false;
+}
+
+/*
+  Apply the compass configuration to the fusion before each magnetic field sample, so that changes made from the
+  console or the panel are taken into account on the next sample
+*/
+void NavCompass::ConfigureFusion()
+{
+    vec forward = {1.0f, 0.0f, 0.0f};
 
-    heading = 0.0f;
-    for (int i = 0; i < HEADING_HISTORY_LENGTH; i++)
+    switch (gConfiguration.eeprom.compassHdgVector)
     {
-        float value = headingHistory[i];
-        if (shiftAngle && (value > 270.0))
-            value -= 360.0;
-        heading += value;
+    case COMPASS_HDG_VECTOR_X:
+        forward = {1.0f, 0.0f, 0.0f};
+        break;
+    case COMPASS_HDG_VECTOR_Y:
+        forward = {0.0f, 1.0f, 0.0f};
+        break;
+    case COMPASS_HDG_VECTOR_Z:
+        forward = {0.0f, 0.0f, 1.0f};
+        break;
+    case COMPASS_HDG_VECTOR_MX:
+        forward = {-1.0f, 0.0f, 0.0f};
+        break;
+    case COMPASS_HDG_VECTOR_MY:
+        forward = {0.0f, -1.0f, 0.0f};
+        break;
+    case COMPASS_HDG_VECTOR_MZ:
+        forward = {0.0f, 0.0f, -1.0f};
+        break;
     }
 
-    return heading / HEADING_HISTORY_LENGTH;
+    fusion.SetForwardVector(forward);
+    fusion.SetCalibration({gConfiguration.eeprom.xMagOffset, gConfiguration.eeprom.yMagOffset, gConfiguration.eeprom.zMagOffset},
+                          gConfiguration.eeprom.magSoftIron);
+    fusion.SetHeadingFilter(gConfiguration.eeprom.headingFilter_ms / 1000.0f);
 }
 
 void NavCompass::GetMagneticField(float *magX, float *magY, float *magZ)
@@ -215,23 +382,3 @@ void NavCompass::GetAcceleration(float *accX, float *accY, float *accZ)
         *accZ = acc.z;
     }
 }
-
-void NavCompass::Normalize(vec *a)
-{
-    float mag = sqrt(vector_dot(a, a));
-    a->x /= mag;
-    a->y /= mag;
-    a->z /= mag;
-}
-
-void NavCompass::CrossProduct(vec *a, vec *b, vec *out)
-{
-    out->x = (a->y * b->z) - (a->z * b->y);
-    out->y = (a->z * b->x) - (a->x * b->z);
-    out->z = (a->x * b->y) - (a->y * b->x);
-}
-
-float NavCompass::vector_dot(vec *a, vec *b)
-{
-    return (a->x * b->x) + (a->y * b->y) + (a->z * b->z);
-}
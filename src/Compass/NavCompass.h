@@ -33,22 +33,33 @@
 /*                              Includes                                   */
 /***************************************************************************/
 
+#include "CompassFusion.h"
+#include "Configuration.h"
+#include "MagCalibrator.h"
 #include "NavCompassDriver.h"
 
+#include <Arduino.h>
 #include <stdint.h>
-#include <string>
 
 /***************************************************************************/
 /*                              Constants                                  */
 /***************************************************************************/
 
-#define HEADING_HISTORY_LENGTH 4
+// Maximum number of acceleration & angular rate samples read at once, depth of the LSM303 FIFO
+#define NAVCOMPASS_MAX_ACC_SAMPLES 32
+// Size of the static storage in which the detected compass driver is constructed
+#define NAVCOMPASS_DRIVER_STORAGE_SIZE 32
 
 /***************************************************************************/
 /*                                Types                                    */
 /***************************************************************************/
 
-using string = std::string;
+// Entry of the table of supported devices
+typedef struct
+{
+    uint8_t           i2cAddress[2];                     // I2C addresses at which the device may answer, 0 if unused
+    NavCompassDriver *(*ConstructDriver)(void *storage); // Construct the driver of the device in the given storage
+} NavCompassProbe_t;
 
 /***************************************************************************/
 /*                               Classes                                   */
@@ -60,21 +71,36 @@ class NavCompass
     NavCompass();
     virtual ~NavCompass();
 
-    bool   Init();
-    string GetDeviceName();
-    float  GetHeading();
-    void   GetMagneticField(float *magX, float *magY, float *magZ);
-    void   GetAcceleration(float *accX, float *accY, float *accZ);
+    bool        Init();
+    const char *GetDeviceName();
+    void        Sample();
+    float       GetHeading();
+    float       GetRoll();
+    float       GetPitch();
+    float       GetRateOfTurn();
+    uint32_t    GetNbAccSamples();
+    uint32_t    GetNbMagSamples();
+    void        StartCalibration();
+    bool        GetCalibration(MagCalibration_t *calibration, uint32_t *nbSamples, uint32_t *nbSectors);
+    void        StopCalibration();
+    void        GetMagneticField(float *magX, float *magY, float *magZ);
+    void        GetAcceleration(float *accX, float *accY, float *accZ);
 
   private:
-    float             headingHistory[HEADING_HISTORY_LENGTH];
-    uint32_t          headingIndex;
+    vec               accSamples[NAVCOMPASS_MAX_ACC_SAMPLES];
+    vec               gyroSamples[NAVCOMPASS_MAX_ACC_SAMPLES];
+    CompassFusion     fusion;
     bool              navCompassDetected;
+    MagCalibrator     calibrator;
+    volatile bool     calibrating;
+    uint32_t          calibrationSectors;
+    SemaphoreHandle_t calibrationMutex;
     NavCompassDriver *navCompassDriver;
+    alignas(8) uint8_t driverStorage[NAVCOMPASS_DRIVER_STORAGE_SIZE];
 
-    void  Normalize(vec *a);
-    void  CrossProduct(vec *a, vec *b, vec *out);
-    float vector_dot(vec *a, vec *b);
+    bool ProbeDriver(NavCompassProbe_t const *probe);
+    bool IsI2CDevicePresent(uint8_t i2cAddress);
+    void ConfigureFusion();
 };
 
 #endif /* NAVCOMPASS_H_ */
@@ -29,6 +29,7 @@
 /***************************************************************************/
 
 #include "NavCompassDriver.h"
+#include "Globals.h"
 
 /***************************************************************************/
 /*                              Constants                                  */
@@ -53,3 +54,58 @@
 NavCompassDriver::~NavCompassDriver()
 {
 }
+
+/*
+  Read all the acceleration and angular rate samples acquired since the last call, with as few I2C transactions as the
+  device allows. Devices without FIFO only return the last sample.
+  @param acc Array receiving the acceleration samples
+  @param gyro Array receiving the angular rate samples in deg/s, only written if HasGyroscope() returns true
+  @param maxSamples Size of the arrays
+  @return Number of samples read
+*/
+uint32_t NavCompassDriver::ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples)
+{
+    if (maxSamples == 0)
+    {
+        return 0;
+    }
+
+    GetAcceleration(acc);
+    return 1;
+}
+
+/*
+  Check if the device provides angular rate samples
+*/
+bool NavCompassDriver::HasGyroscope()
+{
+    return false;
+}
+
+/*
+  Check if a new magnetic field sample is available. Devices without data-ready status are always considered ready.
+  @return true if a new sample can be read
+*/
+bool NavCompassDriver::IsMagneticFieldReady()
+{
+    return true;
+}
+
+/*
+  Register access helpers shared by all drivers. Each call is a single transaction on the shared I2C bus, so that
+  display and PMU transfers may interleave between them.
+*/
+bool NavCompassDriver::I2CRead(uint8_t i2cAddress, uint8_t address, uint8_t *data)
+{
+    return gI2CBus.ReadRegister(I2C_CLIENT_COMPASS, i2cAddress, address, data);
+}
+
+bool NavCompassDriver::I2CBurstRead(uint8_t i2cAddress, uint8_t address, uint8_t *buffer, uint8_t length)
+{
+    return gI2CBus.BurstRead(I2C_CLIENT_COMPASS, i2cAddress, address, buffer, length);
+}
+
+bool NavCompassDriver::I2CWrite(uint8_t i2cAddress, uint8_t data, uint8_t address)
+{
+    return gI2CBus.WriteRegister(I2C_CLIENT_COMPASS, i2cAddress, address, data);
+}
@@ -31,12 +31,15 @@
 /*                              Includes                                   */
 /***************************************************************************/
 
-#include <string>
+#include <stdint.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
 /***************************************************************************/
 
+// Maximum length of a single I2C read, below the 128 bytes of the Wire library buffer
+#define NAVCOMPASS_I2C_MAX_BURST 120
+
 /***************************************************************************/
 /*                                Types                                    */
 /***************************************************************************/
@@ -46,8 +49,6 @@ struct vec
     float x, y, z;
 };
 
-using string = std::string;
-
 /***************************************************************************/
 /*                               Classes                                   */
 /***************************************************************************/
@@ -55,11 +56,19 @@ using string = std::string;
 class NavCompassDriver
 {
   public:
-    virtual ~NavCompassDriver()               = 0;
-    virtual bool   Init()                     = 0;
-    virtual string GetDeviceName()            = 0;
-    virtual void   GetMagneticField(vec *mag) = 0;
-    virtual void   GetAcceleration(vec *acc)  = 0;
+    virtual ~NavCompassDriver()                    = 0;
+    virtual bool        Init()                     = 0;
+    virtual const char *GetDeviceName()            = 0;
+    virtual void        GetMagneticField(vec *mag) = 0;
+    virtual void        GetAcceleration(vec *acc)  = 0;
+    virtual uint32_t    ReadSamples(vec *acc, vec *gyro, uint32_t maxSamples);
+    virtual bool        HasGyroscope();
+    virtual bool        IsMagneticFieldReady();
+
+  protected:
+    bool I2CRead(uint8_t i2cAddress, uint8_t address, uint8_t *data);
+    bool I2CBurstRead(uint8_t i2cAddress, uint8_t address, uint8_t *buffer, uint8_t length);
+    bool I2CWrite(uint8_t i2cAddress, uint8_t data, uint8_t address);
 };
 
 #endif /* NAVCOMPASSDRIVER_H_ */
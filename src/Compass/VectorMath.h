@@ -0,0 +1,171 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Inlined vector math kernel of the tilt compensated compass    *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef VECTORMATH_H_
+#define VECTORMATH_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NavCompassDriver.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define VECMATH_PI_F        3.14159265f
+#define VECMATH_RAD_TO_DEG  57.2957795f
+// Added to squared norms before inversion so that a null vector does not produce an infinity
+#define VECMATH_EPSILON     1e-20f
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+static inline float VecDot(vec const &a, vec const &b)
+{
+    return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+}
+
+static inline vec VecCross(vec const &a, vec const &b)
+{
+    return {(a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x)};
+}
+
+static inline vec VecScale(vec const &a, float k)
+{
+    return {a.x * k, a.y * k, a.z * k};
+}
+
+/*
+  Inverse square root from the IEEE-754 bit pattern followed by two Newton iterations. Relative error is below 5e-6
+  over the whole float range, without any division nor square root instruction.
+  @param x Strictly positive value
+*/
+static inline float FastInvSqrt(float x)
+{
+    uint32_t i;
+    float    y;
+
+    memcpy(&i, &x, sizeof(i));
+    i = 0x5f375a86 - (i >> 1);
+    memcpy(&y, &i, sizeof(y));
+    y = y * (1.5f - 0.5f * x * y * y);
+    y = y * (1.5f - 0.5f * x * y * y);
+
+    return y;
+}
+
+static inline vec VecNormalize(vec const &a)
+{
+    return VecScale(a, FastInvSqrt(VecDot(a, a) + VECMATH_EPSILON));
+}
+
+/*
+  Four quadrant arctangent using a 9th order polynomial on [0, 1] (Abramowitz & Stegun 4.4.49) and octant folding.
+  Absolute error is below 2e-5 rad. Conditional expressions are simple selects : there is no data dependent branch.
+  @return Angle in radians, within [-PI, PI]
+*/
+static inline float FastAtan2(float y, float x)
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float z  = fminf(ax, ay) / (fmaxf(ax, ay) + VECMATH_EPSILON);
+    float z2 = z * z;
+    float a  = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+
+    a = (ay > ax) ? (0.5f * VECMATH_PI_F - a) : a;
+    a = (x < 0.0f) ? (VECMATH_PI_F - a) : a;
+
+    return copysignf(a, y);
+}
+
+/*
+  Low-pass filter a block of vector samples, as read from a sensor FIFO
+  @param state Filter state, updated with each sample
+  @param samples Sample block
+  @param nbSamples Number of samples in the block
+  @param gain Filter gain applied to each sample
+*/
+static inline void VecFilterBlock(vec *state, vec const *samples, uint32_t nbSamples, float gain)
+{
+    float x = state->x;
+    float y = state->y;
+    float z = state->z;
+
+    for (uint32_t i = 0; i < nbSamples; i++)
+    {
+        x += gain * (samples[i].x - x);
+        y += gain * (samples[i].y - y);
+        z += gain * (samples[i].z - z);
+    }
+
+    *state = {x, y, z};
+}
+
+/*
+  First order low-pass filter of a heading. Its sine and cosine are filtered rather than the angle, so that the filter
+  does not swing through 180 degrees when the heading wraps between 359 and 0.
+  @param filteredSin Filter state, sine component
+  @param filteredCos Filter state, cosine component
+  @param hdgSin Sine of the new heading sample
+  @param hdgCos Cosine of the new heading sample
+  @param dt_s Time since the previous sample, in seconds. 0 resets the filter to the sample.
+  @param tau_s Time constant of the filter, in seconds. 0 disables the filter.
+  @return Filtered heading in degrees, within [0, 360[
+*/
+static inline float FilterHeadingVector(float *filteredSin, float *filteredCos, float hdgSin, float hdgCos, float dt_s, float tau_s)
+{
+    float gain = 1.0f;
+
+    if ((dt_s > 0.0f) && (tau_s > 0.0f))
+    {
+        gain = 1.0f - expf(-dt_s / tau_s);
+    }
+
+    *filteredSin += gain * (hdgSin - *filteredSin);
+    *filteredCos += gain * (hdgCos - *filteredCos);
+
+    float filtered_deg = FastAtan2(*filteredSin, *filteredCos) * VECMATH_RAD_TO_DEG;
+    if (filtered_deg < 0)
+    {
+        filtered_deg += 360.0f;
+    }
+
+    return filtered_deg;
+}
+
+#endif /* VECTORMATH_H_ */
@@ -35,14 +35,19 @@
 #include <CRC32.h>
 #include <EEPROM.h>
 #include <esp_bt.h>
+#include <stddef.h>
+#include <string.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
 /***************************************************************************/
 
-#define CONFIGURATION_EEPROM_SIZE 128
+#define CONFIGURATION_EEPROM_SIZE 256
 #define EEPROM_CONFIG_OFFSET      0
-#define CONFIG_MAGIC_NUMBER       0x4D544E4D
+#define CONFIG_MAGIC_NUMBER       0x4D544E32 // Must be changed each time the layout of EEPROMConfig_t changes
+// Configuration saved by firmwares without NMEA output settings : its fields are the first ones of EEPROMConfig_t
+#define CONFIG_V1_MAGIC_NUMBER 0x4D544E4D
+#define CONFIG_V1_SIZE         offsetof(EEPROMConfig_t, nmeaOutputs)
 
 /***************************************************************************/
 /*                             Local types                                 */
@@ -57,6 +62,9 @@ typedef struct
 } ConfigBlock_t;
 #pragma pack()
 
+static_assert(sizeof(ConfigBlock_t) <= CONFIGURATION_EEPROM_SIZE, "Configuration does not fit in EEPROM");
+static_assert(CONFIG_V1_SIZE == 88, "Fields of the previous configuration layout have been changed");
+
 /***************************************************************************/
 /*                           Local prototypes                              */
 /***************************************************************************/
@@ -71,10 +79,11 @@ typedef struct
 
 void Configuration::Init()
 {
+    eepromMutex = xSemaphoreCreateMutex();
     EEPROM.begin(CONFIGURATION_EEPROM_SIZE);
 }
 
-Configuration::Configuration() : configModified(false)
+Configuration::Configuration() : configModified(false), eepromMutex(nullptr)
 {
     // Set default configuration
     ram.navCompassAvailable = false;
@@ -94,6 +103,39 @@ Configuration::Configuration() : configModified(false)
     eeprom.rmbWorkaround        = false;
     eeprom.windRepeater         = true;
     eeprom.compassHdgVector     = COMPASS_HDG_VECTOR_X;
+    eeprom.nmeaOutputs          = 0;
+    for (int i = 0; i < NMEA_OUTPUT_NB; i++)
+    {
+        eeprom.nmeaOutputFilter[i]   = NMEA_FILTER_ALL;
+        eeprom.nmeaOutputRate_Bps[i] = 0;
+    }
+    eeprom.nmeaPeriod_ms[NMEA_OUT_MWV_R] = 500;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_MWV_T] = 500;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_DPT]   = 1000;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_MTW]   = 5000;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_VLW]   = 5000;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_VHW]   = 500;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_HDG]   = 100;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_XDR]   = 5000;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_XDR_A] = 200;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_ROT]   = 200;
+    eeprom.nmeaPeriod_ms[NMEA_OUT_HDT]   = 200;
+    eeprom.usbBaudrate                   = CONSOLE_BAUDRATE;
+    eeprom.lowLatency                    = false;
+    eeprom.powerSaving                   = false;
+    eeprom.headingFilter_ms              = 500;
+    for (int i = 0; i < 9; i++)
+    {
+        eeprom.magSoftIron[i] = (i % 4 == 0) ? 1.0f : 0.0f;
+    }
+    eeprom.magFitError_per  = 0;
+    eeprom.autoMagVariation = true;
+    // No shared default password : characters which cannot be mistaken for each other when read on the display
+    static const char passwordChars[] = "abcdefghjkmnpqrstuvwxyz23456789";
+    for (int i = 0; i < WIFI_PASSWORD_MIN_LENGTH; i++)
+    {
+        eeprom.wifiPassword[i] = passwordChars[esp_random() % (sizeof(passwordChars) - 1)];
+    }
 
     // Set Bluetooth power to maximum
     for (int i = 0; i < ESP_BLE_PWR_TYPE_NUM; i++)
@@ -109,6 +151,8 @@ Configuration::~Configuration()
 
 void Configuration::LoadFromEeprom()
 {
+    // Configuration is only loaded here : it is deployed when conversion starts, after RF listening has started, so
+    // that Bluetooth & WiFi start-up does not delay the reception of the first network cycles
     ConfigBlock_t configBlock = {0};
 
     EEPROM.get(0, configBlock);
@@ -119,12 +163,26 @@ void Configuration::LoadFromEeprom()
         if (CRC32::calculate(pConfig, sizeof(ConfigBlock_t) - sizeof(uint32_t)) == configBlock.checksum)
         {
             eeprom = configBlock.config;
-            DeployConfiguration(nullptr);
+        }
+    }
+    else if (configBlock.magicWord == CONFIG_V1_MAGIC_NUMBER)
+    {
+        // Migrate the configuration of previous firmwares : the fields added since keep their default value
+        uint32_t checksum;
+        memcpy(&checksum, pConfig + sizeof(uint32_t) + CONFIG_V1_SIZE, sizeof(checksum));
+        if (CRC32::calculate(pConfig, sizeof(uint32_t) + CONFIG_V1_SIZE) == checksum)
+        {
+            memcpy(&eeprom, pConfig + sizeof(uint32_t), CONFIG_V1_SIZE);
         }
     }
 }
 
 void Configuration::SaveToEeprom()
+{
+    SaveToEeprom(eeprom);
+}
+
+void Configuration::SaveToEeprom(EEPROMConfig_t const &config)
 {
     ConfigBlock_t eepromBlock = {0};
     ConfigBlock_t configBlock = {0};
@@ -132,10 +190,12 @@ void Configuration::SaveToEeprom()
     uint8_t *pEepromBlock = (uint8_t *)(&eepromBlock);
     uint8_t *pConfig      = (uint8_t *)(&configBlock);
 
+    xSemaphoreTake(eepromMutex, portMAX_DELAY);
+
     EEPROM.get(0, eepromBlock);
 
     configBlock.magicWord = CONFIG_MAGIC_NUMBER;
-    configBlock.config    = eeprom;
+    configBlock.config    = config;
 
     configBlock.checksum = CRC32::calculate(pConfig, sizeof(ConfigBlock_t) - sizeof(uint32_t));
 
@@ -148,9 +208,17 @@ void Configuration::SaveToEeprom()
             break;
         }
     }
+
+    xSemaphoreGive(eepromMutex);
 }
 
 void Configuration::SaveCalibration(MicronetCodec &micronetCodec)
+{
+    UpdateCalibration(micronetCodec);
+    SaveToEeprom();
+}
+
+void Configuration::UpdateCalibration(MicronetCodec &micronetCodec)
 {
     configModified = false;
 
@@ -163,8 +231,6 @@ void Configuration::SaveCalibration(MicronetCodec &micronetCodec)
     eeprom.magneticVariation_deg    = micronetCodec.navData.magneticVariation_deg;
     eeprom.windShift                = micronetCodec.navData.windShift_min;
     eeprom.timeZone_h               = micronetCodec.navData.timeZone_h;
-
-    SaveToEeprom();
 }
 
 void Configuration::LoadCalibration(MicronetCodec *micronetCodec)
@@ -185,29 +251,20 @@ void Configuration::DeployConfiguration(MicronetDevice *micronetDevice)
     switch (eeprom.nmeaLink)
     {
     case SERIAL_TYPE_USB:
-        if (ram.nmeaLink == &gBtSerial)
-        {
-            gBtSerial.end();
-        }
         ram.nmeaLink = &Serial;
         break;
     case SERIAL_TYPE_BT:
-        if (ram.nmeaLink != &gBtSerial)
-        {
-            gBtSerial.begin(String("MicroNav"));
-            ram.nmeaLink = &gBtSerial;
-        }
+        ram.nmeaLink = &gBtSerial;
         break;
     case SERIAL_TYPE_WIFI:
-        if (ram.nmeaLink == &gBtSerial)
-        {
-            gBtSerial.end();
-        }
-        // TODO : Implement WiFi serial link
-        ram.nmeaLink = &Serial;
+        ram.nmeaLink = gNmeaMultiplexer.GetTcpStream();
         break;
     }
 
+    // Start/stop Bluetooth & WiFi, enable NMEA outputs and change USB baudrate accordingly. This is done later by the NMEA
+    // task, which is the only one writing to these links.
+    gNmeaMultiplexer.RequestDeploy();
+
     if (micronetDevice != nullptr)
     {
         // Configure Micronet device
@@ -31,8 +31,10 @@
 /*                              Includes                                   */
 /***************************************************************************/
 
+#include "DeviationTable.h"
 #include "MicronetCodec.h"
 #include "MicronetDevice.h"
+#include "NmeaDefs.h"
 #include <Arduino.h>
 #include <stdint.h>
 
@@ -40,6 +42,9 @@
 /*                              Constants                                  */
 /***************************************************************************/
 
+#define WIFI_PASSWORD_MIN_LENGTH 8  // Shortest WPA2 passphrase
+#define WIFI_PASSWORD_SIZE       16 // Longest password + null terminator
+
 /***************************************************************************/
 /*                                Types                                    */
 /***************************************************************************/
@@ -102,6 +107,19 @@ typedef struct
     LinkId_t        speedSource;
     LinkId_t        compassSource;
     CompassHdgVec_t compassHdgVector;
+    uint8_t         nmeaOutputs;                        // Bit mask of NMEA outputs mirroring the NMEA link
+    uint32_t        nmeaOutputFilter[NMEA_OUTPUT_NB];   // Bit mask of NmeaId_t sentences sent on each output
+    uint16_t        nmeaOutputRate_Bps[NMEA_OUTPUT_NB]; // Maximum throughput of each output, 0 for unlimited
+    uint16_t        nmeaPeriod_ms[NMEA_OUT_NB];         // Minimum period of each encoded sentence, 0 to disable it
+    uint32_t        usbBaudrate;                        // Baudrate of USB serial link (console & NMEA)
+    uint8_t         lowLatency;                         // Emit HDG & MWV as soon as their data are received
+    uint8_t         powerSaving;                        // Light sleep between Micronet network cycles, only with USB NMEA link, external GNSS & compass, periods >= 1s
+    uint16_t        headingFilter_ms;                   // Time constant of the compass heading low-pass filter, 0 to disable it
+    float           magSoftIron[9];                     // Soft iron correction matrix of the compass, row major
+    float           magFitError_per;                    // RMS error of the compass calibration fit, 0 if never calibrated
+    int8_t          magDeviation[DEVIATION_NB_SECTORS]; // Learned compass deviation of each heading sector, in DEVIATION_EEPROM_STEP_DEG
+    uint8_t         autoMagVariation;                   // Magnetic variation computed from GNSS position with the World Magnetic Model
+    char            wifiPassword[WIFI_PASSWORD_SIZE];   // Password of the NMEA WiFi access point, random for each unit by default
 } EEPROMConfig_t;
 
 typedef struct
@@ -124,6 +142,8 @@ class Configuration
     void Init();
     void LoadFromEeprom();
     void SaveToEeprom();
+    void SaveToEeprom(EEPROMConfig_t const &config);
+    void UpdateCalibration(MicronetCodec &micronetCodec);
     void SaveCalibration(MicronetCodec &micronetCodec);
     void LoadCalibration(MicronetCodec *micronetCodec);
     void DeployConfiguration(MicronetDevice *micronetDevice);
@@ -136,7 +156,8 @@ class Configuration
     RAMConfig_t ram;
 
   private:
-    bool configModified;
+    bool              configModified;
+    SemaphoreHandle_t eepromMutex; // Serializes EEPROM writes of the different tasks
 };
 
 /***************************************************************************/
@@ -0,0 +1,843 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Event-driven tasks running the NMEA/Micronet conversion       *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "ConversionTasks.h"
+#include "BoardConfig.h"
+#include "Globals.h"
+
+#include <Arduino.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Event flags for task/controller communication
+#define CONVERSION_EVENT_STOP_REQUEST         0x00000001 // Stop of the conversion has been requested (ESC key)
+#define CONVERSION_EVENT_RX_STOPPED           0x00000002 // RX task has exited
+#define CONVERSION_EVENT_NMEA_STOPPED         0x00000004 // NMEA task has exited
+#define CONVERSION_EVENT_COMPASS_STOPPED      0x00000008 // Compass task has exited
+#define CONVERSION_EVENT_HOUSEKEEPING_STOPPED 0x00000010 // Housekeeping task has exited
+#define CONVERSION_EVENT_SLEEP_STOPPED        0x00000020 // Sleep task has exited
+#define CONVERSION_EVENT_ALL_STOPPED          0x0000003E // All tasks have exited
+#define CONVERSION_EVENT_PERIPHERALS_READY    0x00000040 // GNSS, compass & display have been initialized at boot
+
+// Notification bits of the NMEA task
+#define NMEA_NOTIFY_MICRONET_DATA 0x00000001 // Micronet data have been updated by RX task
+#define NMEA_NOTIFY_GNSS_DATA     0x00000002 // Characters have been received from GNSS
+#define NMEA_NOTIFY_STOP          0x00000004 // Conversion is stopping
+
+// Notification bits of the housekeeping task
+#define HOUSEKEEPING_EVENT_NETWORK_STATE 0x00000001 // Micronet device state has changed
+#define HOUSEKEEPING_EVENT_STOP          0x00000002 // Conversion is stopping
+#define HOUSEKEEPING_EVENT_CONFIGURATION 0x00000004 // Calibration or configuration has been changed from the network or the panel
+
+// Size of the chunks read from NMEA input streams before being decoded
+#define NMEA_INPUT_CHUNK_SIZE 128
+
+// Maximum sleep time of the RX task when no message arrives, only used to check for stop requests
+#define RX_TASK_TIMEOUT_MS 100
+// Maximum sleep time of NMEA & compass tasks while waiting for boot initialization of peripherals
+#define PERIPHERALS_WAIT_TIMEOUT_MS 100
+// Wake-up period of the NMEA task. GNSS link wakes the task on reception but Bluetooth and TCP
+// links have no receive callback and are polled at this rate. It is also the resolution of the
+// NMEA output scheduler.
+#define NMEA_TASK_PERIOD_MS 10
+// Compass sampling period, shorter than the 15Hz magnetometer output period. Accelerometer samples are kept in its FIFO.
+#define COMPASS_TASK_PERIOD_MS 40
+// Period of heading updates in navigation data
+#define COMPASS_PUBLISH_PERIOD_MS 100
+// Period at which the learned compass deviation is saved to EEPROM, if it changed
+#define COMPASS_DEVIATION_SAVE_PERIOD_MS 600000
+// Housekeeping job periods
+#define SYSTEM_INFO_PERIOD_MS    1000 // Battery & power status given to MicronetDevice
+#define DATA_VALIDITY_PERIOD_MS  500  // Validity of navigation data (timeouts are 3s and more)
+#define DEVICE_YIELD_PERIOD_MS   100  // Lost devices/networks, same as network expiry resolution
+#define NETWORK_STATUS_PERIOD_MS 1000 // Network status copy for the display, refreshed every second
+#define CURRENT_LOG_PERIOD_MS    1000 // Current consumption per device state, AXP192 values are filtered over ~1s
+// Maximum sleep time of the sleep task when no message arrives, only used to check for stop requests
+#define SLEEP_TASK_TIMEOUT_MS 100
+// Light sleep ends this time before the next network cycle. It leaves time to restart clocks and to re-arm the
+// RF_ACTIVE_POWER action scheduled by MicronetDevice 1ms before the cycle.
+#define LIGHT_SLEEP_WAKEUP_ADVANCE_US 3000
+// Light sleep is not entered for shorter periods
+#define LIGHT_SLEEP_MIN_DURATION_US 20000
+// Sentences scheduled faster than the Micronet network cycle forbid light sleep, which would delay them to the next cycle
+#define LIGHT_SLEEP_MIN_SENTENCE_PERIOD_MS 1000
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+typedef struct
+{
+    uint32_t period_ms;  // Execution period
+    uint32_t eventMask;  // Notification bits triggering an immediate execution
+    uint32_t lastRun_ms; // Time of last execution
+    void (*job)();       // Job function
+} HousekeepingJob_t;
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+static void HousekeepingSystemInfo();
+static void HousekeepingDataValidity();
+static void HousekeepingDeviceYield();
+static void HousekeepingNetworkStatus();
+static void HousekeepingCurrentLog();
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+// Pointer to the class instance. Used by static UART callback to pass data to the object instance.
+ConversionTasks *ConversionTasks::objectPtr;
+
+// Task names, in ConversionTaskId_t order
+static const char *taskNames[CONVERSION_TASK_NB] = {"RxTask", "NmeaTask", "CompassTask", "HousekeepingTask", "SleepTask"};
+
+// Housekeeping jobs, executed by the housekeeping task when their period elapses or on one of their events
+static HousekeepingJob_t housekeepingJobs[] = {{SYSTEM_INFO_PERIOD_MS, 0, 0, HousekeepingSystemInfo},
+                                               {DATA_VALIDITY_PERIOD_MS, 0, 0, HousekeepingDataValidity},
+                                               {DEVICE_YIELD_PERIOD_MS, 0, 0, HousekeepingDeviceYield},
+                                               {NETWORK_STATUS_PERIOD_MS, HOUSEKEEPING_EVENT_NETWORK_STATE, 0, HousekeepingNetworkStatus},
+                                               {CURRENT_LOG_PERIOD_MS, 0, 0, HousekeepingCurrentLog}};
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+ConversionTasks::ConversionTasks()
+    : rxTaskHandle(nullptr), nmeaTaskHandle(nullptr), compassTaskHandle(nullptr), housekeepingTaskHandle(nullptr), sleepTaskHandle(nullptr),
+      conversionEventGroup(nullptr), dataMutex(nullptr), running(false), firstFrameTime_us(0)
+{
+}
+
+ConversionTasks::~ConversionTasks()
+{
+}
+
+/*
+  Create synchronization objects. Must be called at boot, before any other method.
+*/
+void ConversionTasks::Init()
+{
+    conversionEventGroup = xEventGroupCreate();
+    dataMutex            = xSemaphoreCreateMutex();
+}
+
+/*
+  Create and start the conversion tasks. Must be called once configuration has been deployed.
+*/
+void ConversionTasks::Start()
+{
+    if (running)
+    {
+        return;
+    }
+
+    objectPtr = this;
+
+    xEventGroupClearBits(conversionEventGroup, CONVERSION_EVENT_STOP_REQUEST | CONVERSION_EVENT_ALL_STOPPED);
+    txMessageFifo.ResetFifo();
+
+    running = true;
+
+    xTaskCreatePinnedToCore(StaticRxTask, taskNames[CONVERSION_TASK_RX], RX_TASK_STACK_SIZE, (void *)this, RF_TASK_PRIORITY, &rxTaskHandle, RF_CORE);
+    xTaskCreatePinnedToCore(StaticNmeaTask, taskNames[CONVERSION_TASK_NMEA], NMEA_TASK_STACK_SIZE, (void *)this, NMEA_TASK_PRIORITY, &nmeaTaskHandle,
+                            APP_CORE);
+    xTaskCreatePinnedToCore(StaticHousekeepingTask, taskNames[CONVERSION_TASK_HOUSEKEEPING], HOUSEKEEPING_TASK_STACK_SIZE, (void *)this,
+                            HOUSEKEEPING_TASK_PRIORITY, &housekeepingTaskHandle, RF_CORE);
+    xTaskCreatePinnedToCore(StaticSleepTask, taskNames[CONVERSION_TASK_SLEEP], SLEEP_TASK_STACK_SIZE, (void *)this, SLEEP_TASK_PRIORITY,
+                            &sleepTaskHandle, RF_CORE);
+
+    // Compass may still be probed by the boot task : compass task exits by itself if there is none
+    xTaskCreatePinnedToCore(StaticCompassTask, taskNames[CONVERSION_TASK_COMPASS], COMPASS_TASK_STACK_SIZE, (void *)this, COMPASS_TASK_PRIORITY,
+                            &compassTaskHandle, APP_CORE);
+
+    // Wake-up RX task on incoming messages instead of polling. GNSS callback is registered by NMEA task once
+    // GNSS has been configured.
+    gRxMessageFifo.SetNotificationTask(rxTaskHandle);
+}
+
+/*
+  Stop all conversion tasks and wait for them to exit
+*/
+void ConversionTasks::Stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    gRxMessageFifo.SetNotificationTask(nullptr);
+    GNSS_SERIAL.onReceive(nullptr);
+
+    running = false;
+
+    // Wake-up tasks so that they see the stop request immediately
+    xTaskNotifyGive(rxTaskHandle);
+    xTaskNotify(nmeaTaskHandle, NMEA_NOTIFY_STOP, eSetBits);
+    xTaskNotify(housekeepingTaskHandle, HOUSEKEEPING_EVENT_STOP, eSetBits);
+    xTaskNotifyGive(compassTaskHandle);
+    xTaskNotifyGive(sleepTaskHandle);
+
+    xEventGroupWaitBits(conversionEventGroup, CONVERSION_EVENT_ALL_STOPPED, pdFALSE, pdTRUE, portMAX_DELAY);
+
+    vTaskDelete(rxTaskHandle);
+    vTaskDelete(nmeaTaskHandle);
+    vTaskDelete(compassTaskHandle);
+    vTaskDelete(housekeepingTaskHandle);
+    vTaskDelete(sleepTaskHandle);
+
+    rxTaskHandle           = nullptr;
+    nmeaTaskHandle         = nullptr;
+    compassTaskHandle      = nullptr;
+    housekeepingTaskHandle = nullptr;
+    sleepTaskHandle        = nullptr;
+}
+
+/*
+  Request the end of the conversion. The controlling task is expected to call Stop().
+*/
+void ConversionTasks::RequestStop()
+{
+    xEventGroupSetBits(conversionEventGroup, CONVERSION_EVENT_STOP_REQUEST);
+}
+
+/*
+  Wait for a stop request
+  @param timeout_ms Maximum waiting time in milliseconds
+  @return true if a stop has been requested
+*/
+bool ConversionTasks::WaitStopRequest(uint32_t timeout_ms)
+{
+    EventBits_t flags =
+        xEventGroupWaitBits(conversionEventGroup, CONVERSION_EVENT_STOP_REQUEST, pdTRUE, pdFALSE, timeout_ms / portTICK_PERIOD_MS);
+
+    return (flags & CONVERSION_EVENT_STOP_REQUEST) != 0;
+}
+
+/*
+  Signal that boot initialization of GNSS, compass and display is complete. NMEA and compass tasks wait for this
+  signal before accessing these peripherals, so that RF processing can start before them.
+*/
+void ConversionTasks::SetPeripheralsReady()
+{
+    xEventGroupSetBits(conversionEventGroup, CONVERSION_EVENT_PERIPHERALS_READY);
+}
+
+/*
+  Lock the data shared by conversion tasks (navigation data, configuration, deviation table) to modify them from
+  another task, e.g. the panel
+*/
+void ConversionTasks::LockData()
+{
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+}
+
+/*
+  Unlock the data locked by LockData()
+*/
+void ConversionTasks::UnlockData()
+{
+    xSemaphoreGive(dataMutex);
+}
+
+/*
+  Get reception time of the first Micronet frame processed since power-on
+  @return Time in microseconds since boot, 0 if no frame has been received yet
+*/
+uint32_t ConversionTasks::GetFirstFrameTime()
+{
+    return firstFrameTime_us;
+}
+
+/*
+  Get execution statistics of a conversion task
+  @param taskId Identifier of the task
+*/
+ExecutionProfile *ConversionTasks::GetTaskProfile(ConversionTaskId_t taskId)
+{
+    return &taskProfiles[taskId];
+}
+
+/*
+  Get the FreeRTOS name of a conversion task
+  @param taskId Identifier of the task
+*/
+const char *ConversionTasks::GetTaskName(ConversionTaskId_t taskId)
+{
+    return taskNames[taskId];
+}
+
+void ConversionTasks::StaticRxTask(void *callingObject)
+{
+    // Task entry points are static -> switch to non static processing method
+    ((ConversionTasks *)callingObject)->RxTask();
+}
+
+void ConversionTasks::StaticNmeaTask(void *callingObject)
+{
+    ((ConversionTasks *)callingObject)->NmeaTask();
+}
+
+void ConversionTasks::StaticCompassTask(void *callingObject)
+{
+    ((ConversionTasks *)callingObject)->CompassTask();
+}
+
+void ConversionTasks::StaticHousekeepingTask(void *callingObject)
+{
+    ((ConversionTasks *)callingObject)->HousekeepingTask();
+}
+
+void ConversionTasks::StaticSleepTask(void *callingObject)
+{
+    ((ConversionTasks *)callingObject)->SleepTask();
+}
+
+/*
+  Called by the UART driver when characters have been received from GNSS
+*/
+void ConversionTasks::StaticGnssReceiveCallback()
+{
+    TaskHandle_t taskHandle = objectPtr->nmeaTaskHandle;
+
+    if (taskHandle != nullptr)
+    {
+        xTaskNotify(taskHandle, NMEA_NOTIFY_GNSS_DATA, eSetBits);
+    }
+}
+
+/*
+  Wait for the end of the boot initialization of peripherals
+  @return true if peripherals are ready, false if the conversion has been stopped in the meantime
+*/
+bool ConversionTasks::WaitPeripheralsReady()
+{
+    while (running)
+    {
+        if (xEventGroupWaitBits(conversionEventGroup, CONVERSION_EVENT_PERIPHERALS_READY, pdFALSE, pdFALSE,
+                                PERIPHERALS_WAIT_TIMEOUT_MS / portTICK_PERIOD_MS) &
+            CONVERSION_EVENT_PERIPHERALS_READY)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+  Signal the end of a task to Stop(). The task is suspended and deleted by Stop() so that its handle remains valid
+  until all tasks have been notified.
+*/
+void ConversionTasks::ExitTask(EventBits_t stoppedFlag)
+{
+    xEventGroupSetBits(conversionEventGroup, stoppedFlag);
+    vTaskSuspend(NULL);
+}
+
+/*
+  Process Micronet messages received from RF. The task sleeps until the RX FIFO notifies it.
+*/
+void ConversionTasks::RxTask()
+{
+    MicronetMessage_t *rxMessage;
+    uint32_t           timeout_ms = RX_TASK_TIMEOUT_MS;
+
+    while (running)
+    {
+        // Wait for the FIFO to signal a new message
+        ulTaskNotifyTake(pdTRUE, timeout_ms / portTICK_PERIOD_MS);
+
+        // RF slot processing is time critical : run it at maximum CPU frequency
+        gPower.LockMaxFrequency();
+
+        while (running && ((rxMessage = gRxMessageFifo.Peek()) != nullptr))
+        {
+            uint32_t startTime_us = micros();
+
+            // Keep track of the first frame since power-on to measure boot time
+            if (firstFrameTime_us == 0)
+            {
+                firstFrameTime_us = rxMessage->startTime_us;
+            }
+
+            xSemaphoreTake(dataMutex, portMAX_DELAY);
+
+            DeviceState_t previousState = gMicronetDevice.GetDeviceInfo().state;
+
+            // Let MicronetDevice decode and process the message
+            gMicronetDevice.ProcessMessage(rxMessage, &txMessageFifo);
+            // Give any outgoing message from MicronetDevice to RF driver
+            gRfDriver.Transmit(&txMessageFifo);
+            // Transmit to Panel manager the latest version of navigation data
+            gPanelDriver.SetNavigationData(gMicronetCodec.navData);
+
+            // Check if Micronet's calibration data have been updated
+            if ((gMicronetCodec.navData.calibrationUpdated) || (gConfiguration.GetModifiedFlag()))
+            {
+                // Yes : let housekeeping task save new data to EEPROM and deploy the configuration, flash writes would
+                // stall RF processing
+                gMicronetCodec.navData.calibrationUpdated = false;
+                xTaskNotify(housekeepingTaskHandle, HOUSEKEEPING_EVENT_CONFIGURATION, eSetBits);
+            }
+
+            // Network status is only copied for the display when the device state changes or periodically
+            if (gMicronetDevice.GetDeviceInfo().state != previousState)
+            {
+                xTaskNotify(housekeepingTaskHandle, HOUSEKEEPING_EVENT_NETWORK_STATE, eSetBits);
+            }
+
+            xSemaphoreGive(dataMutex);
+
+            gRxMessageFifo.DeleteMessage();
+
+            // Let NMEA task, on the other core, check changes and emit corresponding NMEA sentences
+            xTaskNotify(nmeaTaskHandle, NMEA_NOTIFY_MICRONET_DATA, eSetBits);
+            // Let sleep task check if the network cycle has been updated
+            xTaskNotifyGive(sleepTaskHandle);
+
+            taskProfiles[CONVERSION_TASK_RX].Record(micros() - startTime_us);
+        }
+
+        // Coast missed network cycles, or switch the receiver on only when needed while searching for the network
+        xSemaphoreTake(dataMutex, portMAX_DELAY);
+        timeout_ms = gMicronetDevice.ScheduleRadio(&txMessageFifo);
+        gRfDriver.Transmit(&txMessageFifo);
+        xSemaphoreGive(dataMutex);
+
+        if (timeout_ms > RX_TASK_TIMEOUT_MS)
+        {
+            timeout_ms = RX_TASK_TIMEOUT_MS;
+        }
+
+        gPower.UnlockMaxFrequency();
+    }
+
+    ExitTask(CONVERSION_EVENT_RX_STOPPED);
+}
+
+/*
+  Decode incoming NMEA streams and emit NMEA sentences which are due. All NMEA I/O is done here, out of the data lock,
+  so that a blocking UART, Bluetooth or network write never delays RF processing.
+*/
+void ConversionTasks::NmeaTask()
+{
+    uint32_t notifications;
+
+    // GNSS UART is reconfigured by the boot task, wait for it before reading GNSS data
+    if (WaitPeripheralsReady())
+    {
+        GNSS_SERIAL.onReceive(StaticGnssReceiveCallback);
+    }
+
+    while (running)
+    {
+        // Sleep until Micronet or GNSS data arrives or the scheduler period elapses
+        notifications = 0;
+        xTaskNotifyWait(0, 0xffffffff, &notifications, NMEA_TASK_PERIOD_MS / portTICK_PERIOD_MS);
+        uint32_t startTime_us = micros();
+
+        // Decode & emit NMEA bursts at maximum CPU frequency
+        gPower.LockMaxFrequency();
+
+        // Apply NMEA output configuration changes requested by other tasks, between two flushes
+        gNmeaMultiplexer.ApplyDeploy();
+
+        // Transmit any incoming data from GNSS & NMEA_EXT links to DataBridge for decoding
+        DecodeNmeaStream(&GNSS_SERIAL, LINK_NMEA_GNSS);
+        DecodeNmeaStream(gConfiguration.ram.nmeaLink, LINK_NMEA_EXT);
+
+        xSemaphoreTake(dataMutex, portMAX_DELAY);
+        if (notifications & NMEA_NOTIFY_MICRONET_DATA)
+        {
+            // Micronet's data have been updated, let DataBridge check changes and emit corresponding NMEA sentences
+            gDataBridge.UpdateMicronetData();
+        }
+        else
+        {
+            // Let DataBridge emit the NMEA sentences which are due
+            gDataBridge.Yield();
+        }
+        xSemaphoreGive(dataMutex);
+
+        // Write queued sentences to NMEA outputs and let NMEA multiplexer accept/release network clients
+        gNmeaMultiplexer.Flush();
+        gNmeaMultiplexer.Yield();
+
+        gPower.UnlockMaxFrequency();
+
+        taskProfiles[CONVERSION_TASK_NMEA].Record(micros() - startTime_us);
+    }
+
+    ExitTask(CONVERSION_EVENT_NMEA_STOPPED);
+}
+
+/*
+  Read all available characters from an NMEA input stream and give them to DataBridge. Characters are read by chunks
+  out of the data lock which is only taken for decoding.
+  @param stream Input stream
+  @param sourceLink Link identifier of the stream
+*/
+void ConversionTasks::DecodeNmeaStream(Stream *stream, LinkId_t sourceLink)
+{
+    char     buffer[NMEA_INPUT_CHUNK_SIZE];
+    uint32_t length;
+
+    do
+    {
+        length = 0;
+        while ((length < NMEA_INPUT_CHUNK_SIZE) && (stream->available() > 0))
+        {
+            char c = stream->read();
+            // if NMEA_EXT share the same link than the console : check for ESC key
+            if ((sourceLink == LINK_NMEA_EXT) && ((void *)(&CONSOLE) == (void *)stream) && (c == 0x1b))
+            {
+                // ESC key pressed, request end of conversion
+                RequestStop();
+            }
+            buffer[length++] = c;
+        }
+
+        if (length > 0)
+        {
+            xSemaphoreTake(dataMutex, portMAX_DELAY);
+            for (uint32_t i = 0; i < length; i++)
+            {
+                gDataBridge.PushNmeaChar(buffer[i], sourceLink);
+            }
+            xSemaphoreGive(dataMutex);
+        }
+    } while (length == NMEA_INPUT_CHUNK_SIZE);
+}
+
+/*
+  Sample navigation compass at the output data rate of its sensors and periodically publish the filtered heading
+*/
+void ConversionTasks::CompassTask()
+{
+    // Only run magnetic heading task if navigation compass has been detected at boot
+    if (!WaitPeripheralsReady() || !gConfiguration.ram.navCompassAvailable)
+    {
+        ExitTask(CONVERSION_EVENT_COMPASS_STOPPED);
+    }
+
+    TickType_t lastWakeTime   = xTaskGetTickCount();
+    uint32_t   lastPublish_ms = millis();
+    uint32_t   lastSave_ms    = millis();
+
+    while (running)
+    {
+        uint32_t startTime_us = micros();
+
+        // I2C transfers are done outside of the data lock to not delay RF processing
+        gNavCompass.Sample();
+
+        if (millis() - lastPublish_ms >= COMPASS_PUBLISH_PERIOD_MS)
+        {
+            lastPublish_ms = millis();
+            xSemaphoreTake(dataMutex, portMAX_DELAY);
+            gDataBridge.UpdateCompassData(gNavCompass.GetHeading() + gMicronetCodec.navData.headingOffset_deg, gNavCompass.GetRoll(),
+                                          gNavCompass.GetPitch(), gNavCompass.GetRateOfTurn());
+            if (gCompassCapture.IsActive())
+            {
+                NavigationData *navData = &gMicronetCodec.navData;
+                gCompassCapture.AddNavData(micros(), navData->cog_deg.valid ? navData->cog_deg.value : NAN,
+                                           navData->sog_kt.valid ? navData->sog_kt.value : NAN, gDataBridge.GetMagneticVariation(),
+                                           navData->magHdg_deg.valid ? navData->magHdg_deg.value : NAN);
+            }
+            xSemaphoreGive(dataMutex);
+        }
+
+        if (millis() - lastSave_ms >= COMPASS_DEVIATION_SAVE_PERIOD_MS)
+        {
+            lastSave_ms = millis();
+            SaveDeviation();
+        }
+
+        taskProfiles[CONVERSION_TASK_COMPASS].Record(micros() - startTime_us);
+
+        vTaskDelayUntil(&lastWakeTime, COMPASS_TASK_PERIOD_MS / portTICK_PERIOD_MS);
+    }
+
+    // Deviation learned since the last periodic save would be lost : the table is reloaded from EEPROM at next start
+    SaveDeviation();
+
+    ExitTask(CONVERSION_EVENT_COMPASS_STOPPED);
+}
+
+/*
+  Save the learned compass deviation to EEPROM, if it changed. The table is copied under the data lock but committed
+  to flash outside of it.
+*/
+void ConversionTasks::SaveDeviation()
+{
+    EEPROMConfig_t config;
+    bool           modified;
+
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    DeviationTable *deviationTable = gDataBridge.GetDeviationTable();
+    modified                       = deviationTable->IsModified();
+    if (modified)
+    {
+        deviationTable->Store(gConfiguration.eeprom.magDeviation);
+        config = gConfiguration.eeprom;
+    }
+    xSemaphoreGive(dataMutex);
+
+    if (modified)
+    {
+        gConfiguration.SaveToEeprom(config);
+    }
+}
+
+/*
+  Run time related processing. Each job is only executed when its period elapses or on one of its events, the task
+  sleeps until the next job is due.
+*/
+void ConversionTasks::HousekeepingTask()
+{
+    uint32_t nbJobs = sizeof(housekeepingJobs) / sizeof(housekeepingJobs[0]);
+    uint32_t events = 0;
+    uint32_t now    = millis();
+
+    for (uint32_t i = 0; i < nbJobs; i++)
+    {
+        // Force execution of all jobs at start
+        housekeepingJobs[i].lastRun_ms = now - housekeepingJobs[i].period_ms;
+    }
+
+    while (running)
+    {
+        uint32_t nextRun_ms   = 0xffffffff;
+        uint32_t startTime_us = micros();
+
+        xSemaphoreTake(dataMutex, portMAX_DELAY);
+
+        now = millis();
+        for (uint32_t i = 0; i < nbJobs; i++)
+        {
+            HousekeepingJob_t *job     = &housekeepingJobs[i];
+            uint32_t           elapsed = now - job->lastRun_ms;
+
+            if ((elapsed >= job->period_ms) || (events & job->eventMask))
+            {
+                job->job();
+                job->lastRun_ms = now;
+                elapsed         = 0;
+            }
+            if ((job->period_ms - elapsed) < nextRun_ms)
+            {
+                nextRun_ms = job->period_ms - elapsed;
+            }
+        }
+
+        xSemaphoreGive(dataMutex);
+
+        if (events & HOUSEKEEPING_EVENT_CONFIGURATION)
+        {
+            SaveConfiguration();
+        }
+
+        taskProfiles[CONVERSION_TASK_HOUSEKEEPING].Record(micros() - startTime_us);
+
+        // Sleep until next due job or next event
+        events = 0;
+        xTaskNotifyWait(0, 0xffffffff, &events, nextRun_ms / portTICK_PERIOD_MS);
+    }
+
+    // Do not lose a configuration change received just before the stop
+    if (events & HOUSEKEEPING_EVENT_CONFIGURATION)
+    {
+        SaveConfiguration();
+    }
+
+    ExitTask(CONVERSION_EVENT_HOUSEKEEPING_STOPPED);
+}
+
+/*
+  Save calibration data received from the network and deploy the configuration. The configuration is copied under the
+  data lock but committed to flash outside of it, to not block the other tasks during the write.
+*/
+void ConversionTasks::SaveConfiguration()
+{
+    EEPROMConfig_t config;
+
+    xSemaphoreTake(dataMutex, portMAX_DELAY);
+    gConfiguration.UpdateCalibration(gMicronetCodec);
+    gConfiguration.DeployConfiguration(&gMicronetDevice);
+    config = gConfiguration.eeprom;
+    xSemaphoreGive(dataMutex);
+
+    gConfiguration.SaveToEeprom(config);
+}
+
+/*
+  Put the CPU in light sleep between the end of a Micronet network cycle and the start of the next one. The radio
+  is already put in low power by MicronetDevice during this period.
+*/
+void ConversionTasks::SleepTask()
+{
+    uint32_t lastSleepNetworkStart = 0;
+
+    while (running)
+    {
+        // Wait for the RX task to process a message
+        ulTaskNotifyTake(pdTRUE, SLEEP_TASK_TIMEOUT_MS / portTICK_PERIOD_MS);
+
+        if (!IsLightSleepAllowed())
+        {
+            continue;
+        }
+
+        uint32_t startTime_us = micros();
+
+        xSemaphoreTake(dataMutex, portMAX_DELAY);
+        DeviceInfo_t &deviceInfo   = gMicronetDevice.GetDeviceInfo();
+        bool          active       = (deviceInfo.state == DEVICE_STATE_ACTIVE);
+        uint32_t      networkStart = deviceInfo.networkMap.networkStart;
+        uint32_t      sleepStart   = gMicronetCodec.GetEndOfNetwork(&deviceInfo.networkMap);
+        uint32_t      sleepEnd     = gMicronetDevice.GetNextCycleStart() - LIGHT_SLEEP_WAKEUP_ADVANCE_US;
+        xSemaphoreGive(dataMutex);
+
+        taskProfiles[CONVERSION_TASK_SLEEP].Record(micros() - startTime_us);
+
+        // Sleep only once per network cycle : after an early wake-up, the rest of the UART data is received awake
+        if (!active || (networkStart == lastSleepNetworkStart))
+        {
+            continue;
+        }
+
+        // Wait for the end of the network cycle, remaining messages of the cycle are processed meanwhile by RX task
+        int32_t waitTime_us = sleepStart - micros();
+        if (waitTime_us > 0)
+        {
+            vTaskDelay(waitTime_us / (1000 * portTICK_PERIOD_MS) + 1);
+        }
+
+        int32_t sleepTime_us = sleepEnd - micros();
+        if (running && (sleepTime_us > LIGHT_SLEEP_MIN_DURATION_US))
+        {
+            lastSleepNetworkStart = networkStart;
+            gPower.LightSleep(sleepTime_us);
+            // Transmit timer was stopped during sleep
+            gRfDriver.RestartTransmitTimer();
+        }
+    }
+
+    ExitTask(CONVERSION_EVENT_SLEEP_STOPPED);
+}
+
+/*
+  Check if light sleep can be used with the current configuration. Bluetooth and WiFi do not support light sleep. The
+  internal GNSS sends its sentences at any time of the network cycle and the first characters of each burst would be
+  lost while its UART wakes-up. Both cores are stopped during most of the cycle : the compass task would overflow the
+  magnetometer FIFO and sentences scheduled faster than the cycle would be sent in one burst per cycle.
+  @return true if light sleep is allowed
+*/
+bool ConversionTasks::IsLightSleepAllowed()
+{
+    uint8_t radioOutputs = NMEA_OUTPUT_MASK(NMEA_OUTPUT_BT) | NMEA_OUTPUT_MASK(NMEA_OUTPUT_TCP) | NMEA_OUTPUT_MASK(NMEA_OUTPUT_UDP);
+
+    if (!gConfiguration.eeprom.powerSaving || (gConfiguration.eeprom.nmeaLink != SERIAL_TYPE_USB) ||
+        ((gConfiguration.eeprom.nmeaOutputs & radioOutputs) != 0) || (gConfiguration.eeprom.gnssSource == LINK_NMEA_GNSS) ||
+        (gConfiguration.eeprom.compassSource == LINK_COMPASS))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < NMEA_OUT_NB; i++)
+    {
+        uint16_t period_ms = gConfiguration.eeprom.nmeaPeriod_ms[i];
+        if ((period_ms != 0) && (period_ms < LIGHT_SLEEP_MIN_SENTENCE_PERIOD_MS))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+  Collect system information and give it to MicronetDevice class
+*/
+static void HousekeepingSystemInfo()
+{
+    SystemInfo_t systemInfo;
+    systemInfo.batteryCharging = gPower.GetStatus().batteryCharging;
+    systemInfo.powerConnected  = gPower.GetStatus().usbConnected;
+    systemInfo.batteryLevel    = gPower.GetStatus().batteryLevel_per;
+    systemInfo.batteryPresent  = gPower.GetStatus().batteryConnected;
+    gMicronetDevice.SetSystemInfo(systemInfo);
+}
+
+/*
+  Update validity of Micronet's navigation data
+*/
+static void HousekeepingDataValidity()
+{
+    gMicronetCodec.navData.UpdateValidity();
+}
+
+/*
+  Let MicronetDevice device process all its time related status
+*/
+static void HousekeepingDeviceYield()
+{
+    DeviceState_t previousState = gMicronetDevice.GetDeviceInfo().state;
+
+    gMicronetDevice.Yield();
+
+    // Network lost : update display without waiting for the next period
+    if (gMicronetDevice.GetDeviceInfo().state != previousState)
+    {
+        HousekeepingNetworkStatus();
+    }
+}
+
+/*
+  Give PanelDriver the latest network status
+*/
+static void HousekeepingNetworkStatus()
+{
+    gPanelDriver.SetNetworkStatus(gMicronetDevice.GetDeviceInfo());
+}
+
+/*
+  Log current consumption of the system in the current device state
+*/
+static void HousekeepingCurrentLog()
+{
+    gPower.LogStateCurrent(gMicronetDevice.GetDeviceInfo().state);
+}
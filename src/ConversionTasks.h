@@ -0,0 +1,119 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Event-driven tasks running the NMEA/Micronet conversion       *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef CONVERSIONTASKS_H_
+#define CONVERSIONTASKS_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "Configuration.h"
+#include "ExecutionProfile.h"
+#include "MicronetMessageFifo.h"
+
+#include <Arduino.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef enum
+{
+    CONVERSION_TASK_RX = 0,
+    CONVERSION_TASK_NMEA,
+    CONVERSION_TASK_COMPASS,
+    CONVERSION_TASK_HOUSEKEEPING,
+    CONVERSION_TASK_SLEEP,
+    CONVERSION_TASK_NB
+} ConversionTaskId_t;
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+class ConversionTasks
+{
+  public:
+    ConversionTasks();
+    virtual ~ConversionTasks();
+
+    void     Init();
+    void     Start();
+    void     Stop();
+    void     RequestStop();
+    bool     WaitStopRequest(uint32_t timeout_ms);
+    void     SetPeripheralsReady();
+    uint32_t GetFirstFrameTime();
+    void     LockData();
+    void     UnlockData();
+
+    ExecutionProfile  *GetTaskProfile(ConversionTaskId_t taskId);
+    static const char *GetTaskName(ConversionTaskId_t taskId);
+
+  private:
+    TaskHandle_t            rxTaskHandle;
+    TaskHandle_t            nmeaTaskHandle;
+    TaskHandle_t            compassTaskHandle;
+    TaskHandle_t            housekeepingTaskHandle;
+    TaskHandle_t            sleepTaskHandle;
+    EventGroupHandle_t      conversionEventGroup;
+    SemaphoreHandle_t       dataMutex;
+    volatile bool           running;
+    volatile uint32_t       firstFrameTime_us;
+    MicronetMessageFifo     txMessageFifo;
+    ExecutionProfile        taskProfiles[CONVERSION_TASK_NB];
+    static ConversionTasks *objectPtr;
+
+    static void StaticRxTask(void *callingObject);
+    static void StaticNmeaTask(void *callingObject);
+    static void StaticCompassTask(void *callingObject);
+    static void StaticHousekeepingTask(void *callingObject);
+    static void StaticSleepTask(void *callingObject);
+    static void StaticGnssReceiveCallback();
+    void        RxTask();
+    void        NmeaTask();
+    void        CompassTask();
+    void        HousekeepingTask();
+    void        SleepTask();
+    bool        IsLightSleepAllowed();
+    void        SaveConfiguration();
+    void        SaveDeviation();
+    void        DecodeNmeaStream(Stream *stream, LinkId_t sourceLink);
+    bool        WaitPeripheralsReady();
+    void        ExitTask(EventBits_t stoppedFlag);
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* CONVERSIONTASKS_H_ */
@@ -0,0 +1,122 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Execution count and duration statistics                       *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "ExecutionProfile.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+ExecutionProfile::ExecutionProfile()
+{
+    Reset();
+}
+
+ExecutionProfile::~ExecutionProfile()
+{
+}
+
+void ExecutionProfile::Reset()
+{
+    count        = 0;
+    max_us       = 0;
+    total_us     = 0;
+    resetTime_us = esp_timer_get_time();
+}
+
+// Record one execution. Can be called from ISR, it is located in IRAM.
+// @param duration_us Execution time in microseconds
+void IRAM_ATTR ExecutionProfile::Record(uint32_t duration_us)
+{
+    count++;
+    total_us += duration_us;
+    if (duration_us > max_us)
+    {
+        max_us = duration_us;
+    }
+}
+
+uint32_t ExecutionProfile::GetCount()
+{
+    return count;
+}
+
+uint32_t ExecutionProfile::GetMax()
+{
+    return max_us;
+}
+
+uint32_t ExecutionProfile::GetAverage()
+{
+    uint32_t localCount = count;
+
+    return (localCount == 0) ? 0 : (uint32_t)(total_us / localCount);
+}
+
+// Print execution rate, durations and CPU load since last reset
+void ExecutionProfile::Print(Stream *stream)
+{
+    uint64_t elapsed_us = esp_timer_get_time() - resetTime_us;
+    uint32_t localCount = count;
+    uint64_t localTotal = total_us;
+
+    if (elapsed_us == 0)
+    {
+        elapsed_us = 1;
+    }
+
+    stream->print(localCount);
+    stream->print(" runs (");
+    stream->print((uint32_t)((uint64_t)localCount * 1000000 / elapsed_us));
+    stream->print("/s), avg ");
+    stream->print(GetAverage());
+    stream->print("us, max ");
+    stream->print(max_us);
+    stream->print("us, load ");
+    stream->print((float)(localTotal * 100) / elapsed_us, 2);
+    stream->println("%");
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Execution count and duration statistics                       *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef EXECUTIONPROFILE_H_
+#define EXECUTIONPROFILE_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+class ExecutionProfile
+{
+  public:
+    ExecutionProfile();
+    virtual ~ExecutionProfile();
+
+    void     Reset();
+    void     Record(uint32_t duration_us);
+    uint32_t GetCount();
+    uint32_t GetMax();
+    uint32_t GetAverage();
+    void     Print(Stream *stream);
+
+  private:
+    volatile uint32_t count;
+    volatile uint32_t max_us;
+    volatile uint64_t total_us;
+    int64_t           resetTime_us; // 64-bit time base : statistics can cover hours without wrapping
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* EXECUTIONPROFILE_H_ */
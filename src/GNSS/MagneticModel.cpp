@@ -0,0 +1,364 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  World Magnetic Model evaluator                                *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "MagneticModel.h"
+
+#include <Arduino.h>
+#include <math.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Epoch of the coefficients. WMM2025 is valid from 2025.0 to 2030.0, secular variation is extrapolated after that
+// with a slowly growing error : the table must be replaced with the coefficients of the next model when published.
+// Both are generated by tools/wmm_table.py from the WMM.COF file of the model, never edited by hand.
+#define MAGMODEL_EPOCH 2025.0f
+// Reference radius of the model, in km
+#define MAGMODEL_REFERENCE_RADIUS_KM 6371.2f
+// WGS84 ellipsoid semi-major axis in km and first eccentricity squared
+#define WGS84_A_KM 6378.137f
+#define WGS84_E2   0.00669437999f
+// Variation is evaluated again when the position moved by more than this (~6 nautical miles in latitude)
+#define MAGMODEL_UPDATE_DISTANCE_DEG 0.1f
+// ... or when the date changed by more than this (~18 days)
+#define MAGMODEL_UPDATE_PERIOD_YEAR 0.05f
+// Minimum cosine of the geocentric latitude, declination is undefined at the geographic poles
+#define MAGMODEL_MIN_COS_LATITUDE 1e-6f
+
+#define MAGMODEL_DEG_TO_RAD (float)(M_PI / 180.0)
+
+/***************************************************************************/
+/*                                Macros                                   */
+/***************************************************************************/
+
+// Index of the degree n, order m term in triangular arrays starting at n = 0
+#define MAGMODEL_INDEX(n, m) ((((n) * ((n) + 1)) / 2) + (m))
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+// WMM2025 Schmidt semi-normalized coefficients, ordered by degree then order starting at n = 1, m = 0
+static const MagModelCoefficient_t wmmCoefficients[MAGMODEL_NB_TERMS - 1] = {
+    {-29351.8f,     0.0f,  12.0f,   0.0f}, //  1  0
+    { -1410.8f,  4545.4f,   9.7f, -21.5f}, //  1  1
+    { -2556.6f,     0.0f, -11.6f,   0.0f}, //  2  0
+    {  2951.1f, -3133.6f,  -5.2f, -27.7f}, //  2  1
+    {  1649.3f,  -815.1f,  -8.0f, -12.1f}, //  2  2
+    {  1361.0f,     0.0f,  -1.3f,   0.0f}, //  3  0
+    { -2404.1f,   -56.6f,  -4.2f,   4.0f}, //  3  1
+    {  1243.8f,   237.5f,   0.4f,  -0.3f}, //  3  2
+    {   453.6f,  -549.5f, -15.6f,  -4.1f}, //  3  3
+    {   895.0f,     0.0f,  -1.6f,   0.0f}, //  4  0
+    {   799.5f,   278.6f,  -2.4f,  -1.1f}, //  4  1
+    {    55.7f,  -133.9f,  -6.0f,   4.1f}, //  4  2
+    {  -281.1f,   212.0f,   5.6f,   1.6f}, //  4  3
+    {    12.1f,  -375.6f,  -7.0f,  -4.4f}, //  4  4
+    {  -233.2f,     0.0f,   0.6f,   0.0f}, //  5  0
+    {   368.9f,    45.4f,   1.4f,  -0.5f}, //  5  1
+    {   187.2f,   220.2f,   0.0f,   2.2f}, //  5  2
+    {  -138.7f,  -122.9f,   0.6f,   0.4f}, //  5  3
+    {  -142.0f,    43.0f,   2.2f,   1.7f}, //  5  4
+    {    20.9f,   106.1f,   0.9f,   1.9f}, //  5  5
+    {    64.4f,     0.0f,  -0.2f,   0.0f}, //  6  0
+    {    63.8f,   -18.4f,  -0.4f,   0.3f}, //  6  1
+    {    76.9f,    16.8f,   0.9f,  -1.6f}, //  6  2
+    {  -115.7f,    48.8f,   1.2f,  -0.4f}, //  6  3
+    {   -40.9f,   -59.8f,  -0.9f,   0.9f}, //  6  4
+    {    14.9f,    10.9f,   0.3f,   0.7f}, //  6  5
+    {   -60.7f,    72.7f,   0.9f,   0.9f}, //  6  6
+    {    79.5f,     0.0f,  -0.0f,   0.0f}, //  7  0
+    {   -77.0f,   -48.9f,  -0.1f,   0.6f}, //  7  1
+    {    -8.8f,   -14.4f,  -0.1f,   0.5f}, //  7  2
+    {    59.3f,    -1.0f,   0.5f,  -0.8f}, //  7  3
+    {    15.8f,    23.4f,  -0.1f,   0.0f}, //  7  4
+    {     2.5f,    -7.4f,  -0.8f,  -1.0f}, //  7  5
+    {   -11.1f,   -25.1f,  -0.8f,   0.6f}, //  7  6
+    {    14.2f,    -2.3f,   0.8f,  -0.2f}, //  7  7
+    {    23.2f,     0.0f,  -0.1f,   0.0f}, //  8  0
+    {    10.8f,     7.1f,   0.2f,  -0.2f}, //  8  1
+    {   -17.5f,   -12.6f,   0.0f,   0.5f}, //  8  2
+    {     2.0f,    11.4f,   0.5f,  -0.4f}, //  8  3
+    {   -21.7f,    -9.7f,  -0.1f,   0.4f}, //  8  4
+    {    16.9f,    12.7f,   0.3f,  -0.5f}, //  8  5
+    {    15.0f,     0.7f,   0.2f,  -0.6f}, //  8  6
+    {   -16.8f,    -5.2f,  -0.0f,   0.3f}, //  8  7
+    {     0.9f,     3.9f,   0.2f,   0.2f}, //  8  8
+    {     4.6f,     0.0f,  -0.0f,   0.0f}, //  9  0
+    {     7.8f,   -24.8f,  -0.1f,  -0.3f}, //  9  1
+    {     3.0f,    12.2f,   0.1f,   0.3f}, //  9  2
+    {    -0.2f,     8.3f,   0.3f,  -0.3f}, //  9  3
+    {    -2.5f,    -3.3f,  -0.3f,   0.3f}, //  9  4
+    {   -13.1f,    -5.2f,   0.0f,   0.2f}, //  9  5
+    {     2.4f,     7.2f,   0.3f,  -0.1f}, //  9  6
+    {     8.6f,    -0.6f,  -0.1f,  -0.2f}, //  9  7
+    {    -8.7f,     0.8f,   0.1f,   0.4f}, //  9  8
+    {   -12.9f,    10.0f,  -0.1f,   0.1f}, //  9  9
+    {    -1.3f,     0.0f,   0.1f,   0.0f}, // 10  0
+    {    -6.4f,     3.3f,   0.0f,   0.0f}, // 10  1
+    {     0.2f,     0.0f,   0.1f,  -0.0f}, // 10  2
+    {     2.0f,     2.4f,   0.1f,  -0.2f}, // 10  3
+    {    -1.0f,     5.3f,  -0.0f,   0.1f}, // 10  4
+    {    -0.6f,    -9.1f,  -0.3f,  -0.1f}, // 10  5
+    {    -0.9f,     0.4f,   0.0f,   0.1f}, // 10  6
+    {     1.5f,    -4.2f,  -0.1f,   0.0f}, // 10  7
+    {     0.9f,    -3.8f,  -0.1f,  -0.1f}, // 10  8
+    {    -2.7f,     0.9f,  -0.0f,   0.2f}, // 10  9
+    {    -3.9f,    -9.1f,  -0.0f,  -0.0f}, // 10 10
+    {     2.9f,     0.0f,   0.0f,   0.0f}, // 11  0
+    {    -1.5f,     0.0f,  -0.0f,  -0.0f}, // 11  1
+    {    -2.5f,     2.9f,   0.0f,   0.1f}, // 11  2
+    {     2.4f,    -0.6f,   0.0f,  -0.0f}, // 11  3
+    {    -0.6f,     0.2f,   0.0f,   0.1f}, // 11  4
+    {    -0.1f,     0.5f,  -0.1f,  -0.0f}, // 11  5
+    {    -0.6f,    -0.3f,   0.0f,  -0.0f}, // 11  6
+    {    -0.1f,    -1.2f,  -0.0f,   0.1f}, // 11  7
+    {     1.1f,    -1.7f,  -0.1f,  -0.0f}, // 11  8
+    {    -1.0f,    -2.9f,  -0.1f,   0.0f}, // 11  9
+    {    -0.2f,    -1.8f,  -0.1f,   0.0f}, // 11 10
+    {     2.6f,    -2.3f,  -0.1f,   0.0f}, // 11 11
+    {    -2.0f,     0.0f,   0.0f,   0.0f}, // 12  0
+    {    -0.2f,    -1.3f,   0.0f,  -0.0f}, // 12  1
+    {     0.3f,     0.7f,  -0.0f,   0.0f}, // 12  2
+    {     1.2f,     1.0f,  -0.0f,  -0.1f}, // 12  3
+    {    -1.3f,    -1.4f,  -0.0f,   0.1f}, // 12  4
+    {     0.6f,    -0.0f,  -0.0f,  -0.0f}, // 12  5
+    {     0.6f,     0.6f,   0.1f,  -0.0f}, // 12  6
+    {     0.5f,    -0.1f,  -0.0f,  -0.0f}, // 12  7
+    {    -0.1f,     0.8f,   0.0f,   0.0f}, // 12  8
+    {    -0.4f,     0.1f,   0.0f,  -0.0f}, // 12  9
+    {    -0.2f,    -1.0f,  -0.1f,  -0.0f}, // 12 10
+    {    -1.3f,     0.1f,  -0.0f,   0.0f}, // 12 11
+    {    -0.7f,     0.2f,  -0.1f,  -0.1f}, // 12 12
+};
+
+static const MagModelDefinition_t wmmModel = {MAGMODEL_EPOCH, wmmCoefficients};
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+MagneticModel::MagneticModel()
+    : valid(false), lastLatitude_deg(0.0f), lastLongitude_deg(0.0f), lastYear(0.0f), variation_deg(0.0f), evaluationTime_us(0)
+{
+}
+
+MagneticModel::~MagneticModel()
+{
+}
+
+/*
+  Update the magnetic variation for the given position and date. The model is only evaluated if they changed
+  significantly since the last evaluation.
+  @param latitude_deg Latitude, positive north
+  @param longitude_deg Longitude, positive east
+  @param year Date as a decimal year
+  @return true if the model has been evaluated
+*/
+bool MagneticModel::Update(float latitude_deg, float longitude_deg, float year)
+{
+    float deltaLongitude_deg = fabsf(longitude_deg - lastLongitude_deg);
+
+    if (deltaLongitude_deg > 180.0f)
+    {
+        deltaLongitude_deg = 360.0f - deltaLongitude_deg;
+    }
+
+    if (valid && (fabsf(latitude_deg - lastLatitude_deg) < MAGMODEL_UPDATE_DISTANCE_DEG) &&
+        (deltaLongitude_deg * cosf(latitude_deg * MAGMODEL_DEG_TO_RAD) < MAGMODEL_UPDATE_DISTANCE_DEG) &&
+        (fabsf(year - lastYear) < MAGMODEL_UPDATE_PERIOD_YEAR))
+    {
+        return false;
+    }
+
+    uint32_t start_us = micros();
+    variation_deg     = ComputeDeclination(latitude_deg, longitude_deg, year);
+    evaluationTime_us = micros() - start_us;
+
+    lastLatitude_deg  = latitude_deg;
+    lastLongitude_deg = longitude_deg;
+    lastYear          = year;
+    valid             = true;
+
+    return true;
+}
+
+/*
+  Get the magnetic variation computed by the last evaluation
+  @return Variation in degrees, positive east
+*/
+float MagneticModel::GetVariation()
+{
+    return variation_deg;
+}
+
+/*
+  Check if the model has been evaluated at least once
+*/
+bool MagneticModel::IsValid()
+{
+    return valid;
+}
+
+/*
+  Get the duration of the last evaluation of the model, in microseconds
+*/
+uint32_t MagneticModel::GetEvaluationTime()
+{
+    return evaluationTime_us;
+}
+
+/*
+  Evaluate the declination of the World Magnetic Model at sea level
+  @param latitude_deg Geodetic latitude, positive north
+  @param longitude_deg Longitude, positive east
+  @param year Date as a decimal year
+  @return Declination in degrees, positive east
+*/
+float MagneticModel::ComputeDeclination(float latitude_deg, float longitude_deg, float year)
+{
+    return ComputeDeclination(&wmmModel, latitude_deg, longitude_deg, year);
+}
+
+/*
+  Evaluate the declination of a spherical harmonic model at sea level. Single precision is enough for the 0.1°
+  resolution of NMEA sentences and it uses the hardware FPU of the ESP32.
+  @param model Coefficients of the model and their epoch
+  @param latitude_deg Geodetic latitude, positive north
+  @param longitude_deg Longitude, positive east
+  @param year Date as a decimal year
+  @return Declination in degrees, positive east
+*/
+float MagneticModel::ComputeDeclination(MagModelDefinition_t const *model, float latitude_deg, float longitude_deg, float year)
+{
+    float P[MAGMODEL_NB_TERMS];
+    float dP[MAGMODEL_NB_TERMS];
+    float cosM[MAGMODEL_MAX_DEGREE + 1];
+    float sinM[MAGMODEL_MAX_DEGREE + 1];
+    float dt_year   = year - model->epoch;
+    float latitude  = latitude_deg * MAGMODEL_DEG_TO_RAD;
+    float longitude = longitude_deg * MAGMODEL_DEG_TO_RAD;
+    float sinLat    = sinf(latitude);
+    float cosLat    = cosf(latitude);
+
+    // Geodetic to geocentric spherical coordinates at sea level
+    float rc = WGS84_A_KM / sqrtf(1.0f - WGS84_E2 * sinLat * sinLat);
+    float p  = rc * cosLat;
+    float z  = rc * (1.0f - WGS84_E2) * sinLat;
+    float r  = sqrtf(p * p + z * z);
+    float x  = z / r;
+    float c  = fmaxf(p / r, MAGMODEL_MIN_COS_LATITUDE);
+
+    // Schmidt semi-normalized associated Legendre functions of sin(geocentric latitude) and their derivatives with
+    // respect to latitude
+    P[0]  = 1.0f;
+    dP[0] = 0.0f;
+    for (int n = 1; n <= MAGMODEL_MAX_DEGREE; n++)
+    {
+        for (int m = 0; m < n; m++)
+        {
+            float k    = 1.0f / sqrtf((float)(n * n - m * m));
+            float pn1  = P[MAGMODEL_INDEX(n - 1, m)];
+            float dpn1 = dP[MAGMODEL_INDEX(n - 1, m)];
+            float pn2  = 0.0f;
+            float dpn2 = 0.0f;
+
+            if (m <= n - 2)
+            {
+                float k2 = sqrtf((float)((n - 1) * (n - 1) - m * m));
+                pn2      = k2 * P[MAGMODEL_INDEX(n - 2, m)];
+                dpn2     = k2 * dP[MAGMODEL_INDEX(n - 2, m)];
+            }
+            P[MAGMODEL_INDEX(n, m)]  = k * ((2 * n - 1) * x * pn1 - pn2);
+            dP[MAGMODEL_INDEX(n, m)] = k * ((2 * n - 1) * (c * pn1 + x * dpn1) - dpn2);
+        }
+
+        // Normalization of m = 0 and m > 0 terms differ by sqrt(2), which makes P11 a special case
+        float k    = (n == 1) ? 1.0f : sqrtf((2 * n - 1) / (2.0f * n));
+        float pnn  = P[MAGMODEL_INDEX(n - 1, n - 1)];
+        float dpnn = dP[MAGMODEL_INDEX(n - 1, n - 1)];
+
+        P[MAGMODEL_INDEX(n, n)]  = k * c * pnn;
+        dP[MAGMODEL_INDEX(n, n)] = k * (c * dpnn - x * pnn);
+    }
+
+    // cos(m * longitude) and sin(m * longitude) by recurrence
+    cosM[0] = 1.0f;
+    sinM[0] = 0.0f;
+    cosM[1] = cosf(longitude);
+    sinM[1] = sinf(longitude);
+    for (int m = 2; m <= MAGMODEL_MAX_DEGREE; m++)
+    {
+        cosM[m] = cosM[m - 1] * cosM[1] - sinM[m - 1] * sinM[1];
+        sinM[m] = sinM[m - 1] * cosM[1] + cosM[m - 1] * sinM[1];
+    }
+
+    // Field components in geocentric frame : north, east and down
+    float ratio     = MAGMODEL_REFERENCE_RADIUS_KM / r;
+    float ratioPow  = ratio * ratio;
+    float northComp = 0.0f;
+    float eastComp  = 0.0f;
+    float downComp  = 0.0f;
+
+    for (int n = 1; n <= MAGMODEL_MAX_DEGREE; n++)
+    {
+        ratioPow *= ratio;
+        for (int m = 0; m <= n; m++)
+        {
+            MagModelCoefficient_t const *coef = &model->coefficients[MAGMODEL_INDEX(n, m) - 1];
+
+            float g     = coef->g + coef->gDot * dt_year;
+            float h     = coef->h + coef->hDot * dt_year;
+            float gcHs  = g * cosM[m] + h * sinM[m];
+            int   index = MAGMODEL_INDEX(n, m);
+
+            northComp -= ratioPow * gcHs * dP[index];
+            eastComp += ratioPow * m * (g * sinM[m] - h * cosM[m]) * P[index];
+            downComp -= ratioPow * (n + 1) * gcHs * P[index];
+        }
+    }
+    eastComp /= c;
+
+    // Rotate north component from geocentric to geodetic frame. East component is the same in both frames.
+    float psi   = atan2f(z, p) - latitude;
+    float north = northComp * cosf(psi) - downComp * sinf(psi);
+
+    return atan2f(eastComp, north) / MAGMODEL_DEG_TO_RAD;
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  World Magnetic Model evaluator                                *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+
+#ifndef MAGNETICMODEL_H_
+#define MAGNETICMODEL_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Degree and order of the spherical harmonic expansion of the World Magnetic Model
+#define MAGMODEL_MAX_DEGREE 12
+// Number of terms of the expansion, including the unused n = 0 one
+#define MAGMODEL_NB_TERMS (((MAGMODEL_MAX_DEGREE + 1) * (MAGMODEL_MAX_DEGREE + 2)) / 2)
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef struct
+{
+    float g, h;       // Gauss coefficients at epoch, in nT
+    float gDot, hDot; // Secular variation, in nT/year
+} MagModelCoefficient_t;
+
+typedef struct
+{
+    float                        epoch;        // Decimal year of the coefficients
+    MagModelCoefficient_t const *coefficients; // MAGMODEL_NB_TERMS - 1 coefficients, by degree then order from n = 1, m = 0
+} MagModelDefinition_t;
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Magnetic variation computed with the World Magnetic Model at sea level. The model is only evaluated again when the
+  position or the date changed significantly since the last evaluation, which takes well under a millisecond.
+*/
+class MagneticModel
+{
+  public:
+    MagneticModel();
+    virtual ~MagneticModel();
+
+    bool     Update(float latitude_deg, float longitude_deg, float year);
+    float    GetVariation();
+    bool     IsValid();
+    uint32_t GetEvaluationTime();
+
+    static float ComputeDeclination(float latitude_deg, float longitude_deg, float year);
+    static float ComputeDeclination(MagModelDefinition_t const *model, float latitude_deg, float longitude_deg, float year);
+
+  private:
+    bool     valid;
+    float    lastLatitude_deg;
+    float    lastLongitude_deg;
+    float    lastYear;
+    float    variation_deg;
+    uint32_t evaluationTime_us;
+};
+
+#endif /* MAGNETICMODEL_H_ */
@@ -29,6 +29,7 @@
 /***************************************************************************/
 
 #include "Globals.h"
+#include "BoardConfig.h"
 
 /***************************************************************************/
 /*                              Constants                                  */
@@ -60,8 +61,12 @@ UbloxDriver         gM8nDriver;                       // GNSS Driver
 PanelManager        gPanelDriver;                     // Display driver
 BluetoothSerial     gBtSerial;                        // Bluetooth driver
 NmeaBridge          gDataBridge(&gMicronetCodec);     // NMEA Bridge
+NmeaMultiplexer     gNmeaMultiplexer;                 // NMEA output multiplexer
 MicronetDevice      gMicronetDevice(&gMicronetCodec); // Micronet Device
 Power               gPower;                           // Power Manager
+ConversionTasks     gConversionTasks;                 // NMEA/Micronet conversion tasks
+CompassCapture      gCompassCapture;                  // Compass raw data capture
+I2CBus              gI2CBus(&SHARED_I2C);             // I2C bus shared by PMU, display & compass
 
 /***************************************************************************/
 /*                              Functions                                  */
@@ -31,7 +31,10 @@
 /*                              Includes                                   */
 /***************************************************************************/
 
+#include "CompassCapture.h"
 #include "Configuration.h"
+#include "ConversionTasks.h"
+#include "I2CBus.h"
 #include "MenuManager.h"
 #include "Micronet/MicronetCodec.h"
 #include "Micronet/MicronetDevice.h"
@@ -39,6 +42,7 @@
 #include "NavCompass.h"
 #include "NavigationData.h"
 #include "NmeaBridge.h"
+#include "NmeaMultiplexer.h"
 #include "PanelManager.h"
 #include "Power.h"
 #include "RfDriver.h"
@@ -68,8 +72,12 @@ extern PanelManager        gPanelDriver;
 extern MicronetCodec       gMicronetCodec;
 extern BluetoothSerial     gBtSerial;
 extern NmeaBridge          gDataBridge;
+extern NmeaMultiplexer     gNmeaMultiplexer;
 extern MicronetDevice      gMicronetDevice;
 extern Power               gPower;
+extern ConversionTasks     gConversionTasks;
+extern CompassCapture      gCompassCapture;
+extern I2CBus              gI2CBus;
 
 /***************************************************************************/
 /*                              Prototypes                                 */
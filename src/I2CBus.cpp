@@ -0,0 +1,218 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Arbitration of the shared I2C bus                             *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "I2CBus.h"
+
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Polling period of bulk transfers waiting for register transfers to complete
+#define I2CBUS_BULK_YIELD_TICKS 1
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+I2CBus::I2CBus(TwoWire *wire) : wire(wire), nbUrgentWaiting(0), owner(I2C_CLIENT_NB), acquireTime_us(0), statsStartTime_us(0)
+{
+    busMutex = xSemaphoreCreateMutex();
+    memset(clientStats, 0, sizeof(clientStats));
+}
+
+I2CBus::~I2CBus()
+{
+}
+
+/*
+  Wait for the bus to be free and take it. Compass and PMU are served before display : the mutex inherits the
+  priority of waiting tasks, and display does not take the bus while a register transfer is waiting for it.
+  @param client Device which is going to be accessed
+  @return Wire object to be used until Release()
+*/
+TwoWire *I2CBus::Acquire(I2CClient_t client)
+{
+    uint32_t request_us = micros();
+
+    if (client == I2C_CLIENT_DISPLAY)
+    {
+        while (nbUrgentWaiting.load() > 0)
+        {
+            vTaskDelay(I2CBUS_BULK_YIELD_TICKS);
+        }
+        xSemaphoreTake(busMutex, portMAX_DELAY);
+    }
+    else
+    {
+        nbUrgentWaiting++;
+        xSemaphoreTake(busMutex, portMAX_DELAY);
+        nbUrgentWaiting--;
+    }
+
+    I2CClientStats_t *stats = &clientStats[client];
+
+    owner          = client;
+    acquireTime_us = micros();
+    if (acquireTime_us - request_us > stats->maxWait_us)
+    {
+        stats->maxWait_us = acquireTime_us - request_us;
+    }
+    stats->nbTransactions++;
+
+    return wire;
+}
+
+/*
+  Give the bus back after a transfer started with Acquire()
+*/
+void I2CBus::Release()
+{
+    clientStats[owner].busyTime_us += micros() - acquireTime_us;
+    owner = I2C_CLIENT_NB;
+    xSemaphoreGive(busMutex);
+}
+
+/*
+  Check if a device acknowledges its I2C address
+*/
+bool I2CBus::IsDevicePresent(I2CClient_t client, uint8_t i2cAddress)
+{
+    TwoWire *bus = Acquire(client);
+
+    bus->beginTransmission(i2cAddress);
+    bool present = (bus->endTransmission() == 0);
+
+    Release();
+    return present;
+}
+
+/*
+  Read a single register
+  @return true if the device acknowledged the transfer
+*/
+bool I2CBus::ReadRegister(I2CClient_t client, uint8_t i2cAddress, uint8_t address, uint8_t *data)
+{
+    TwoWire *bus = Acquire(client);
+    bool     ack = false;
+
+    bus->beginTransmission(i2cAddress);
+    bus->write(address);
+    if (bus->endTransmission() == 0)
+    {
+        bus->requestFrom(i2cAddress, (uint8_t)1);
+        *data = bus->read();
+        ack   = (bus->endTransmission() == 0);
+    }
+
+    Release();
+    return ack;
+}
+
+/*
+  Read consecutive registers in a single transfer. Register address auto-increment is device specific and must be
+  requested by the caller in the register address if needed.
+  @return true if the device acknowledged the transfer
+*/
+bool I2CBus::BurstRead(I2CClient_t client, uint8_t i2cAddress, uint8_t address, uint8_t *buffer, uint8_t length)
+{
+    TwoWire *bus = Acquire(client);
+    bool     ack = false;
+
+    bus->beginTransmission(i2cAddress);
+    bus->write(address);
+    if (bus->endTransmission() == 0)
+    {
+        bus->requestFrom(i2cAddress, (uint8_t)length);
+        bus->readBytes(buffer, bus->available());
+        ack = (bus->endTransmission() == 0);
+    }
+
+    Release();
+    return ack;
+}
+
+/*
+  Write a single register
+  @return true if the device acknowledged the transfer
+*/
+bool I2CBus::WriteRegister(I2CClient_t client, uint8_t i2cAddress, uint8_t address, uint8_t data)
+{
+    TwoWire *bus = Acquire(client);
+
+    bus->beginTransmission(i2cAddress);
+    bus->write(address);
+    bus->write(data);
+    bool ack = (bus->endTransmission() == 0);
+
+    Release();
+    return ack;
+}
+
+/*
+  Get bus usage of a client since the last call to ResetStats()
+*/
+void I2CBus::GetStats(I2CClient_t client, I2CClientStats_t *stats)
+{
+    xSemaphoreTake(busMutex, portMAX_DELAY);
+    *stats = clientStats[client];
+    xSemaphoreGive(busMutex);
+}
+
+/*
+  Get the time elapsed since the last call to ResetStats(), in microseconds. Bus utilization of a client is its busy
+  time divided by this time.
+*/
+uint32_t I2CBus::GetStatsTime()
+{
+    return micros() - statsStartTime_us;
+}
+
+void I2CBus::ResetStats()
+{
+    xSemaphoreTake(busMutex, portMAX_DELAY);
+    memset(clientStats, 0, sizeof(clientStats));
+    statsStartTime_us = micros();
+    xSemaphoreGive(busMutex);
+}
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Arbitration of the shared I2C bus                             *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+
+#ifndef I2CBUS_H_
+#define I2CBUS_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <atomic>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+// Devices sharing the bus. Compass and PMU do short register transfers, display does bulk transfers.
+typedef enum
+{
+    I2C_CLIENT_COMPASS = 0,
+    I2C_CLIENT_PMU,
+    I2C_CLIENT_DISPLAY,
+    I2C_CLIENT_NB
+} I2CClient_t;
+
+typedef struct
+{
+    uint32_t nbTransactions; // Number of bus accesses
+    uint32_t busyTime_us;    // Total time during which the client owned the bus
+    uint32_t maxWait_us;     // Longest time the client waited for the bus
+} I2CClientStats_t;
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Serialize accesses to an I2C bus used by several tasks. A client owns the bus between Acquire() and Release() and
+  must keep it for a single short transfer. Bulk transfers split their data in several accesses and give way to
+  compass and PMU whenever one of them is waiting, so that sensor sampling is at most delayed by one chunk whatever
+  the priority of the task pushing display frames.
+*/
+class I2CBus
+{
+  public:
+    I2CBus(TwoWire *wire);
+    virtual ~I2CBus();
+
+    TwoWire *Acquire(I2CClient_t client);
+    void     Release();
+    bool     IsDevicePresent(I2CClient_t client, uint8_t i2cAddress);
+    bool     ReadRegister(I2CClient_t client, uint8_t i2cAddress, uint8_t address, uint8_t *data);
+    bool     BurstRead(I2CClient_t client, uint8_t i2cAddress, uint8_t address, uint8_t *buffer, uint8_t length);
+    bool     WriteRegister(I2CClient_t client, uint8_t i2cAddress, uint8_t address, uint8_t data);
+    void     GetStats(I2CClient_t client, I2CClientStats_t *stats);
+    uint32_t GetStatsTime();
+    void     ResetStats();
+
+  private:
+    TwoWire              *wire;
+    SemaphoreHandle_t     busMutex;
+    std::atomic<uint32_t> nbUrgentWaiting;
+    I2CClient_t           owner;
+    uint32_t              acquireTime_us;
+    uint32_t              statsStartTime_us;
+    I2CClientStats_t      clientStats[I2C_CLIENT_NB];
+};
+
+#endif /* I2CBUS_H_ */
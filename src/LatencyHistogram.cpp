@@ -0,0 +1,165 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Latency statistics & histogram                                *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "LatencyHistogram.h"
+
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+// Upper limits of the histogram bins, the last bin collects everything above the last limit
+const uint32_t LatencyHistogram::binLimits_us[LATENCY_HISTOGRAM_NB_BINS - 1] = {500,   1000,   2000,   5000,   10000, 20000,
+                                                                                 50000, 100000, 200000, 500000, 1000000};
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+}
+
+void LatencyHistogram::Reset()
+{
+    memset(bins, 0, sizeof(bins));
+    count  = 0;
+    min_us = 0;
+    max_us = 0;
+    sum_us = 0;
+}
+
+void LatencyHistogram::Record(uint32_t latency_us)
+{
+    int bin;
+
+    for (bin = 0; bin < LATENCY_HISTOGRAM_NB_BINS - 1; bin++)
+    {
+        if (latency_us < binLimits_us[bin])
+        {
+            break;
+        }
+    }
+    bins[bin]++;
+
+    if ((count == 0) || (latency_us < min_us))
+    {
+        min_us = latency_us;
+    }
+    if (latency_us > max_us)
+    {
+        max_us = latency_us;
+    }
+    sum_us += latency_us;
+    count++;
+}
+
+uint32_t LatencyHistogram::GetCount()
+{
+    return count;
+}
+
+uint32_t LatencyHistogram::GetMin()
+{
+    return min_us;
+}
+
+uint32_t LatencyHistogram::GetMax()
+{
+    return max_us;
+}
+
+uint32_t LatencyHistogram::GetAverage()
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    return (uint32_t)(sum_us / count);
+}
+
+// Print statistics followed by the non-empty bins
+void LatencyHistogram::Print(Stream *stream)
+{
+    if (count == 0)
+    {
+        stream->println("-");
+        return;
+    }
+
+    stream->print(count);
+    stream->print(" samples, min ");
+    stream->print(min_us);
+    stream->print("us, avg ");
+    stream->print(GetAverage());
+    stream->print("us, max ");
+    stream->print(max_us);
+    stream->println("us");
+
+    for (int i = 0; i < LATENCY_HISTOGRAM_NB_BINS; i++)
+    {
+        if (bins[i] != 0)
+        {
+            stream->print("    ");
+            if (i < LATENCY_HISTOGRAM_NB_BINS - 1)
+            {
+                stream->print("<");
+                stream->print(binLimits_us[i]);
+            }
+            else
+            {
+                stream->print(">=");
+                stream->print(binLimits_us[LATENCY_HISTOGRAM_NB_BINS - 2]);
+            }
+            stream->print("us : ");
+            stream->println(bins[i]);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Latency statistics & histogram                                *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define LATENCY_HISTOGRAM_NB_BINS 12
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram();
+    virtual ~LatencyHistogram();
+
+    void     Reset();
+    void     Record(uint32_t latency_us);
+    uint32_t GetCount();
+    uint32_t GetMin();
+    uint32_t GetMax();
+    uint32_t GetAverage();
+    void     Print(Stream *stream);
+
+  private:
+    static const uint32_t binLimits_us[LATENCY_HISTOGRAM_NB_BINS - 1];
+    uint32_t              bins[LATENCY_HISTOGRAM_NB_BINS];
+    uint32_t              count;
+    uint32_t              min_us;
+    uint32_t              max_us;
+    uint64_t              sum_us;
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* LATENCYHISTOGRAM_H_ */
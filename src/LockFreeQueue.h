@@ -0,0 +1,170 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Single producer/single consumer lock-free queue               *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef LOCKFREEQUEUE_H_
+#define LOCKFREEQUEUE_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <atomic>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Fixed size FIFO allowing one producer and one consumer to exchange items
+  without any lock, even when running on different cores. Producer only
+  writes writeIndex and consumer only writes readIndex, memory ordering is
+  guaranteed by acquire/release semantics on those indexes.
+  SIZE must be a power of two.
+*/
+template <typename T, uint32_t SIZE> class LockFreeQueue
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "LockFreeQueue size must be a power of two");
+
+  public:
+    LockFreeQueue() : writeIndex(0), readIndex(0)
+    {
+    }
+
+    /*
+      Push an item in the queue (producer side only)
+      @param item Item to be copied into the queue
+      @return false if the queue is full
+    */
+    bool Push(T const &item)
+    {
+        uint32_t write = writeIndex.load(std::memory_order_relaxed);
+
+        if ((write - readIndex.load(std::memory_order_acquire)) >= SIZE)
+        {
+            return false;
+        }
+
+        store[write & (SIZE - 1)] = item;
+        writeIndex.store(write + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /*
+      Get a pointer to the next free item so that the producer can fill it in place.
+      Commit() must be called once the item is ready.
+      @return Pointer to the free item or nullptr if the queue is full
+    */
+    T *Reserve()
+    {
+        uint32_t write = writeIndex.load(std::memory_order_relaxed);
+
+        if ((write - readIndex.load(std::memory_order_acquire)) >= SIZE)
+        {
+            return nullptr;
+        }
+
+        return &store[write & (SIZE - 1)];
+    }
+
+    /*
+      Publish the item previously obtained with Reserve() (producer side only)
+    */
+    void Commit()
+    {
+        writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /*
+      Pop an item from the queue (consumer side only)
+      @param item Pointer where to copy the item
+      @return false if the queue is empty
+    */
+    bool Pop(T *item)
+    {
+        uint32_t read = readIndex.load(std::memory_order_relaxed);
+
+        if (read == writeIndex.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        *item = store[read & (SIZE - 1)];
+        readIndex.store(read + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /*
+      Get a pointer to the oldest item without removing it (consumer side only)
+      @return Pointer to the item or nullptr if the queue is empty
+    */
+    T *Peek()
+    {
+        uint32_t read = readIndex.load(std::memory_order_relaxed);
+
+        if (read == writeIndex.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return &store[read & (SIZE - 1)];
+    }
+
+    /*
+      Remove the item returned by Peek() (consumer side only)
+    */
+    void Release()
+    {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    uint32_t GetNbItems()
+    {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+  private:
+    T                     store[SIZE];
+    std::atomic<uint32_t> writeIndex;
+    std::atomic<uint32_t> readIndex;
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* LOCKFREEQUEUE_H_ */
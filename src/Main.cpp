@@ -31,9 +31,11 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <Wire.h>
+#include <esp_heap_caps.h>
 
 #include "BoardConfig.h"
 #include "Configuration.h"
+#include "ConversionTasks.h"
 #include "Globals.h"
 #include "MenuManager.h"
 #include "Micronet.h"
@@ -41,18 +43,50 @@
 #include "MicronetMessageFifo.h"
 #include "NavCompass.h"
 #include "PanelManager.h"
+#include "PanelResources.h"
 #include "Version.h"
 
 /***************************************************************************/
 /*                              Constants                                  */
 /***************************************************************************/
 
-#define MAX_SCANNED_NETWORKS 5
+#define MAX_SCANNED_NETWORKS    5
+#define CONSOLE_CHECK_PERIOD_MS 100
+#define CAPTURE_PRINT_PERIOD_MS 20
+#define MAX_PROFILED_TASKS      32
+#define GNSS_STARTUP_DELAY_MS   250
+#define CONSOLE_LINE_LENGTH     32
 
 /***************************************************************************/
 /*                             Local types                                 */
 /***************************************************************************/
 
+typedef struct
+{
+    const char *name;
+    uint32_t    size;
+} RamUsage_t;
+
+/***************************************************************************/
+/*                           Local variables                               */
+/***************************************************************************/
+
+static char const *nmeaOutputNames[NMEA_OUTPUT_NB] = {"USB", "BT", "TCP", "UDP"};
+
+// Statically allocated RAM per subsystem, evaluated at compile time. Panel includes the display frame buffer.
+static const RamUsage_t ramUsage[] = {
+    {"Radio", sizeof(RfDriver) + sizeof(MicronetMessageFifo)},
+    {"Micronet", sizeof(MicronetCodec) + sizeof(MicronetDevice)},
+    {"NMEA", sizeof(NmeaBridge) + sizeof(NmeaMultiplexer) + sizeof(UbloxDriver)},
+    {"Panel", sizeof(PanelManager) + (SCREEN_WIDTH * SCREEN_HEIGHT) / 8},
+    {"Compass", sizeof(NavCompass) + sizeof(CompassCapture)},
+    {"Power", sizeof(Power)},
+    {"Configuration", sizeof(Configuration)},
+    {"Conversion tasks", sizeof(ConversionTasks)},
+    {"Task stacks", RX_TASK_STACK_SIZE + NMEA_TASK_STACK_SIZE + COMPASS_TASK_STACK_SIZE + HOUSEKEEPING_TASK_STACK_SIZE +
+                        PANEL_TASK_STACK_SIZE + POWER_TASK_STACK_SIZE + SLEEP_TASK_STACK_SIZE},
+};
+
 /***************************************************************************/
 /*                           Local prototypes                              */
 /***************************************************************************/
@@ -62,18 +96,29 @@ void PrintInt(uint32_t data);
 void PrintRawMessage(MicronetMessage_t *message, uint32_t lastMasterRequest_us);
 void PrintNetworkMap(NetworkMap_t *networkMap);
 
+void BootTask(void *parameter);
 void ConversionLoop();
-void MenuDebug1();
-void MenuDebug2();
+void MenuProfiling();
+void MenuExecutionProfiles();
+void MenuLatencyStats();
+void MenuCompassCapture();
+void MenuNmeaOutputs();
+int  ReadConsoleLine(char *line, int maxLength);
+void PrintNmeaOutputSettings();
+bool ParseNmeaOutputCommand(char *line);
 
 /***************************************************************************/
 /*                               Globals                                   */
 /***************************************************************************/
 
-bool firstLoop;
+bool     firstLoop;
+uint32_t rfListeningTime_ms;
+uint32_t peripheralsReadyTime_ms;
 
 MenuEntry_t mainMenu[] = {
-    {"MicroNav", nullptr}, {"Start NMEA conversion", ConversionLoop}, {"Debug 1", MenuDebug1}, {"Debug 2", MenuDebug2}, {nullptr, nullptr}};
+    {"MicroNav", nullptr}, {"Start NMEA conversion", ConversionLoop}, {"Task & CPU profiling", MenuProfiling},
+    {"ISR & task loop profiles", MenuExecutionProfiles}, {"Latency statistics", MenuLatencyStats}, {"Compass data capture", MenuCompassCapture},
+    {"NMEA outputs", MenuNmeaOutputs}, {nullptr, nullptr}};
 
 /***************************************************************************/
 /*                              Functions                                  */
@@ -86,7 +131,7 @@ void setup()
     gConfiguration.LoadFromEeprom();
 
     // Init USB serial link
-    CONSOLE.begin(CONSOLE_BAUDRATE);
+    CONSOLE.begin(gConfiguration.eeprom.usbBaudrate);
 
     CONSOLE.print("MicroNav v");
     CONSOLE.print(SW_MAJOR_VERSION);
@@ -95,20 +140,16 @@ void setup()
     CONSOLE.print(".");
     CONSOLE.println(SW_PATCH_VERSION);
 
-    // Configure power supply
-    Wire.begin(PMU_I2C_SDA, PMU_I2C_SCL);
-    gPower.Init();
+    // GPIO interrupts must be served by RF core : reserve it before any other driver attaches an interrupt
+    gRfDriver.InstallIsrService();
 
-    // Init GNSS NMEA serial link
-    GNSS_SERIAL.begin(GNSS_BAUDRATE, SERIAL_8N1, GNSS_RX_PIN, GNSS_TX_PIN);
-
-    // Let time for serial drivers to set-up
-    delay(250);
-
-#if (GNSS_UBLOXM8N == 1)
-    CONSOLE.println("Configuring UBlox GNSS");
-    gM8nDriver.Start(NMEA_GGA_ENABLE | NMEA_VTG_ENABLE | NMEA_RMC_ENABLE);
-#endif
+    // Configure power supply. PMU powers the radio, it must be configured first.
+    SHARED_I2C.begin(PMU_I2C_SDA, PMU_I2C_SCL);
+    gPower.Init();
+    if (!gPower.InitFrequencyScaling())
+    {
+        CONSOLE.println("CPU frequency scaling not supported");
+    }
 
     // Setup main menu
     gMenuManager.SetMenu(mainMenu);
@@ -124,38 +165,23 @@ void setup()
             delay(1000);
         }
     }
-    CONSOLE.println("OK");
-
-    CONSOLE.print("Initializing navigation compass ... ");
-    if (!gNavCompass.Init())
-    {
-        CONSOLE.println("NOT DETECTED");
-        gConfiguration.ram.navCompassAvailable = false;
-    }
-    else
-    {
-        CONSOLE.print(gNavCompass.GetDeviceName().c_str());
-        CONSOLE.println(" Found");
-        gConfiguration.ram.navCompassAvailable = true;
-    }
-
-    CONSOLE.print("Initializing display ... ");
-    if (!gPanelDriver.Init())
-    {
-        CONSOLE.println("NOT DETECTED");
-        gConfiguration.ram.displayAvailable = false;
-    }
-    else
-    {
-        CONSOLE.println(" Found");
-        gConfiguration.ram.displayAvailable = true;
-    }
 
     gMicronetCodec.SetSwVersion(SW_MAJOR_VERSION, SW_MINOR_VERSION);
     gPanelDriver.SetNavigationData(gMicronetCodec.navData);
 
-    // Start listening
+    // Start listening as early as possible so that no network cycle is lost after a power-on
     gRfDriver.Start();
+    rfListeningTime_ms = millis();
+    CONSOLE.print("OK, listening at ");
+    CONSOLE.print(rfListeningTime_ms);
+    CONSOLE.println("ms");
+
+    // Init GNSS NMEA serial link
+    GNSS_SERIAL.begin(GNSS_BAUDRATE, SERIAL_8N1, GNSS_RX_PIN, GNSS_TX_PIN);
+
+    // Slow peripherals are initialized in background while conversion is already running
+    gConversionTasks.Init();
+    xTaskCreatePinnedToCore(BootTask, "BootTask", BOOT_TASK_STACK_SIZE, nullptr, BOOT_TASK_PRIORITY, nullptr, APP_CORE);
 
     // Display serial menu
     gMenuManager.PrintMenu();
@@ -307,18 +333,59 @@ void PrintNetworkMap(NetworkMap_t *networkMap)
     CONSOLE.println("");
 }
 
+/*
+  Initialize display, compass and GNSS in background. These peripherals are slow to set-up and not needed to
+  start RF processing.
+*/
+void BootTask(void *parameter)
+{
+    if (!gPanelDriver.Init())
+    {
+        CONSOLE.println("Display NOT DETECTED");
+        gConfiguration.ram.displayAvailable = false;
+    }
+    else
+    {
+        CONSOLE.println("Display Found");
+        gConfiguration.ram.displayAvailable = true;
+    }
+
+    if (!gNavCompass.Init())
+    {
+        CONSOLE.println("Navigation compass NOT DETECTED");
+        gConfiguration.ram.navCompassAvailable = false;
+    }
+    else
+    {
+        CONSOLE.print("Navigation compass ");
+        CONSOLE.print(gNavCompass.GetDeviceName());
+        CONSOLE.println(" Found");
+        gConfiguration.ram.navCompassAvailable = true;
+    }
+
+#if (GNSS_UBLOXM8N == 1)
+    // Let time for GNSS to start after power-on
+    delay(GNSS_STARTUP_DELAY_MS);
+    CONSOLE.println("Configuring UBlox GNSS");
+    gM8nDriver.Start(NMEA_GGA_ENABLE | NMEA_VTG_ENABLE | NMEA_RMC_ENABLE);
+#endif
+
+    peripheralsReadyTime_ms = millis();
+    gConversionTasks.SetPeripheralsReady();
+
+    vTaskDelete(nullptr);
+}
+
 void ConversionLoop()
 {
-    bool                exitNmeaLoop = false;
-    MicronetMessage_t  *rxMessage;
-    MicronetMessageFifo txMessageFifo;
-    uint32_t            lastHeadingTime = millis();
+    bool exitNmeaLoop = false;
 
     CONSOLE.println("Starting MicroNav...");
 
     // TODO : Move LoadCalibration & DeployConfiguration to Main.cpp
     // Load sensor calibration data into Micronet codec
     gConfiguration.LoadCalibration(&gMicronetCodec);
+    gDataBridge.GetDeviationTable()->Load(gConfiguration.eeprom.magDeviation);
 
     // Configure Micronet device according to board configuration
     gConfiguration.DeployConfiguration(&gMicronetDevice);
@@ -328,107 +395,489 @@ void ConversionLoop()
 
     gRxMessageFifo.ResetFifo();
 
+    // From now on, conversion is executed by event-driven tasks
+    gConversionTasks.Start();
+
     do
     {
-        // Collect system information and give it to MicronetDevice class
-        SystemInfo_t systemInfo;
-        systemInfo.batteryCharging = gPower.GetStatus().batteryCharging;
-        systemInfo.powerConnected = gPower.GetStatus().usbConnected;
-        systemInfo.batteryLevel = gPower.GetStatus().batteryLevel_per;
-        systemInfo.batteryPresent = gPower.GetStatus().batteryConnected;
-        gMicronetDevice.SetSystemInfo(systemInfo);
+        // Sleep until a stop request or the next console check. Compass capture is printed from here, at a lower
+        // priority than all conversion tasks.
+        if (gConversionTasks.WaitStopRequest(gCompassCapture.IsActive() ? CAPTURE_PRINT_PERIOD_MS : CONSOLE_CHECK_PERIOD_MS))
+        {
+            // ESC key pressed on the NMEA_EXT link shared with the console
+            CONSOLE.println("ESC key pressed, stopping conversion.");
+            exitNmeaLoop = true;
+        }
 
-        // Process any incoming Micronet message from RF
-        if ((rxMessage = gRxMessageFifo.Peek()) != nullptr)
+        // if console is not on the same link than NMEA_EXT : check for ESC key
+        if ((void *)(&CONSOLE) != (void *)(gConfiguration.ram.nmeaLink))
         {
-            // Let MicronetDevice decode and process the message
-            gMicronetDevice.ProcessMessage(rxMessage, &txMessageFifo);
-            // Give any outgoing message from MicronetDevice to RF driver
-            gRfDriver.Transmit(&txMessageFifo);
-            // If Micronet's data have been updated, let DataBridge check changes and emit corresponding NMEA sentences
-            gDataBridge.UpdateMicronetData();
-            // Transmit to Panel manager the latest version of navigation data
-            gPanelDriver.SetNavigationData(gMicronetCodec.navData);
-
-
-            // Check if Micronet's calibration data have been updated
-            if ((gMicronetCodec.navData.calibrationUpdated) || (gConfiguration.GetModifiedFlag()))
+            while (CONSOLE.available() > 0)
             {
-                // Yes : save new data to EEPROM and deploy the configuration
-                gMicronetCodec.navData.calibrationUpdated = false;
-                gConfiguration.SaveCalibration(gMicronetCodec);
-                gConfiguration.DeployConfiguration(&gMicronetDevice);
+                if (CONSOLE.read() == 0x1b)
+                {
+                    CONSOLE.println("ESC key pressed, stopping conversion.");
+                    exitNmeaLoop = true;
+                }
             }
+        }
 
-            gRxMessageFifo.DeleteMessage();
+        if (gCompassCapture.IsActive())
+        {
+            gCompassCapture.Print(&CONSOLE);
         }
+    } while (!exitNmeaLoop);
 
-        // Transmit any incoming data from GNSS link to DataBridge for decoding
-        while (GNSS_SERIAL.available() > 0)
+    gConversionTasks.Stop();
+
+    gRfDriver.DisableFrequencyTracking();
+}
+
+void MenuProfiling()
+{
+#if (configUSE_TRACE_FACILITY == 1)
+    TaskStatus_t taskStatus[MAX_PROFILED_TASKS];
+    uint32_t     totalRunTime = 0;
+    UBaseType_t  nbTasks      = uxTaskGetSystemState(taskStatus, MAX_PROFILED_TASKS, &totalRunTime);
+    const char  *stateNames[] = {"Run", "Ready", "Block", "Susp", "Del"};
+
+    // Run time counters are per core, so the sum of all tasks is 100% per core
+    CONSOLE.println("Task              Core Prio State  Stack free   CPU since boot");
+    for (UBaseType_t i = 0; i < nbTasks; i++)
+    {
+        TaskStatus_t *task = &taskStatus[i];
+        char          line[80];
+        int           core     = (task->xCoreID < portNUM_PROCESSORS) ? task->xCoreID : -1;
+        uint32_t      state    = (task->eCurrentState <= eDeleted) ? task->eCurrentState : eDeleted;
+        float         load_per = 0;
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+        if (totalRunTime > 0)
         {
-            gDataBridge.PushNmeaChar(GNSS_SERIAL.read(), LINK_NMEA_GNSS);
+            load_per = (100.0f * task->ulRunTimeCounter) / totalRunTime;
         }
+#endif
+        snprintf(line, sizeof(line), "%-17s %4d %4u %-6s %10u %13.2f%%", task->pcTaskName, core, (unsigned)task->uxCurrentPriority,
+                 stateNames[state], (unsigned)task->usStackHighWaterMark, load_per);
+        CONSOLE.println(line);
+    }
+#if (configGENERATE_RUN_TIME_STATS != 1)
+    CONSOLE.println("CPU usage not available : configGENERATE_RUN_TIME_STATS is disabled");
+#endif
+#else
+    CONSOLE.println("Task list not available : configUSE_TRACE_FACILITY is disabled");
+#endif
+
+    // Heap status
+    uint32_t freeHeap     = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    uint32_t largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    CONSOLE.print("Heap : ");
+    CONSOLE.print(freeHeap);
+    CONSOLE.print(" bytes free, ");
+    CONSOLE.print(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+    CONSOLE.print(" minimum, largest block ");
+    CONSOLE.print(largestBlock);
+    CONSOLE.print(", fragmentation ");
+    CONSOLE.print((freeHeap == 0) ? 0 : 100 - ((100 * largestBlock) / freeHeap));
+    CONSOLE.println("%");
+
+    // Boot timings
+    CONSOLE.print("Boot : RF listening at ");
+    CONSOLE.print(rfListeningTime_ms);
+    CONSOLE.print("ms, first frame at ");
+    CONSOLE.print(gConversionTasks.GetFirstFrameTime() / 1000);
+    CONSOLE.print("ms, peripherals ready at ");
+    CONSOLE.print(peripheralsReadyTime_ms);
+    CONSOLE.println("ms");
+
+    // Light sleep duty cycle, since previous call
+    SleepStats_t &sleepStats  = gPower.GetSleepStats();
+    uint64_t      elapsed_us  = esp_timer_get_time() - sleepStats.startTime_us;
+    float         asleep_per  = (elapsed_us == 0) ? 0 : (100.0f * sleepStats.sleepTime_us) / elapsed_us;
+    char          sleepLine[96];
+    snprintf(sleepLine, sizeof(sleepLine), "Light sleep : %u periods, %u early wake-ups, %.1f%% asleep, %.1f%% awake duty cycle",
+             (unsigned)sleepStats.nbSleeps, (unsigned)sleepStats.nbEarlyWakeups, asleep_per, 100.0f - asleep_per);
+    CONSOLE.println(sleepLine);
+    gPower.ResetSleepStats();
+
+    // Current consumption per device state, since previous call
+    const char *deviceStateNames[POWER_NB_LOGGED_STATES] = {"Search network", "Low power", "Active"};
+    for (uint32_t i = 0; i < POWER_NB_LOGGED_STATES; i++)
+    {
+        CurrentStats_t &current = gPower.GetStateCurrent(i);
+        char            line[64];
+        snprintf(line, sizeof(line), "Current in %-14s : %6.1fmA (%u samples)", deviceStateNames[i],
+                 (current.nbSamples == 0) ? 0.0f : current.totalCurrent_mA / current.nbSamples, (unsigned)current.nbSamples);
+        CONSOLE.println(line);
+    }
+    CONSOLE.print("CPU frequency : ");
+    CONSOLE.print(getCpuFrequencyMhz());
+    CONSOLE.println("MHz");
+    gPower.ResetStateCurrent();
 
-        // Transmit any incoming char from NMEA_EXT link to DataBridge for decoding
-        while (gConfiguration.ram.nmeaLink->available() > 0)
+    if (gConfiguration.ram.navCompassAvailable)
+    {
+        CONSOLE.print("Compass samples since boot : ");
+        CONSOLE.print(gNavCompass.GetNbAccSamples());
+        CONSOLE.print(" acceleration, ");
+        CONSOLE.print(gNavCompass.GetNbMagSamples());
+        CONSOLE.println(" magnetic field");
+    }
+
+    // I2C bus utilization per device, since previous call
+    const char *i2cClientNames[I2C_CLIENT_NB] = {"compass", "PMU", "display"};
+    uint32_t    i2cStatsTime_us               = gI2CBus.GetStatsTime();
+    for (uint32_t i = 0; i < I2C_CLIENT_NB; i++)
+    {
+        I2CClientStats_t stats;
+        char             line[80];
+        gI2CBus.GetStats((I2CClient_t)i, &stats);
+        snprintf(line, sizeof(line), "I2C %-7s : %5.1f%% busy, %u transfers, max wait %uus", i2cClientNames[i],
+                 (i2cStatsTime_us == 0) ? 0.0f : (100.0f * stats.busyTime_us) / i2cStatsTime_us, (unsigned)stats.nbTransactions,
+                 (unsigned)stats.maxWait_us);
+        CONSOLE.println(line);
+    }
+    gI2CBus.ResetStats();
+
+    MagneticModel *magneticModel = gDataBridge.GetMagneticModel();
+    if (magneticModel->IsValid())
+    {
+        char line[64];
+        snprintf(line, sizeof(line), "Magnetic variation (WMM) : %.1fdeg, evaluated in %uus", magneticModel->GetVariation(),
+                 (unsigned)magneticModel->GetEvaluationTime());
+        CONSOLE.println(line);
+    }
+
+    // Static RAM budget
+    uint32_t ramTotal = 0;
+    for (uint32_t i = 0; i < sizeof(ramUsage) / sizeof(ramUsage[0]); i++)
+    {
+        char line[48];
+        snprintf(line, sizeof(line), "%-17s %7u bytes", ramUsage[i].name, (unsigned)ramUsage[i].size);
+        CONSOLE.println(line);
+        ramTotal += ramUsage[i].size;
+    }
+    CONSOLE.print("Total static RAM : ");
+    CONSOLE.print(ramTotal);
+    CONSOLE.println(" bytes");
+}
+
+// Execution profiles of interrupts and conversion task loops, since previous call. Kept apart from MenuProfiling so
+// that they can be sampled over a known period without the system report.
+void MenuExecutionProfiles()
+{
+    CONSOLE.print("SX1276 DIO ISR : ");
+    gRfDriver.GetDioIsrProfile()->Print(&CONSOLE);
+    gRfDriver.GetDioIsrProfile()->Reset();
+    CONSOLE.print("TX timer ISR : ");
+    gRfDriver.GetTimerIsrProfile()->Print(&CONSOLE);
+    gRfDriver.GetTimerIsrProfile()->Reset();
+    for (uint32_t i = 0; i < CONVERSION_TASK_NB; i++)
+    {
+        ExecutionProfile *profile = gConversionTasks.GetTaskProfile((ConversionTaskId_t)i);
+        CONSOLE.print(ConversionTasks::GetTaskName((ConversionTaskId_t)i));
+        CONSOLE.print(" loop : ");
+        profile->Print(&CONSOLE);
+        profile->Reset();
+    }
+}
+
+void MenuLatencyStats()
+{
+    CONSOLE.print("RX FIFO dwell time : ");
+    gRxMessageFifo.GetDwellTimeHistogram()->Print(&CONSOLE);
+    gRxMessageFifo.GetDwellTimeHistogram()->Reset();
+
+    CONSOLE.println("Latency from RF frame reception to NMEA output write");
+    for (uint32_t i = 0; i < NMEA_OUT_NB; i++)
+    {
+        CONSOLE.print(NmeaBridge::GetSentenceName(i));
+        CONSOLE.print(" : ");
+        gNmeaMultiplexer.GetLatencyHistogram(i)->Print(&CONSOLE);
+    }
+    gNmeaMultiplexer.ResetLatencyStats();
+
+    CONSOLE.print("NMEA output queue overflows : ");
+    CONSOLE.println(gNmeaMultiplexer.GetQueueOverflows());
+
+    CycleTracker &cycleTracker = gMicronetDevice.GetCycleTracker();
+    CONSOLE.print("Network cycle : ");
+    CONSOLE.print(cycleTracker.GetPeriod(), 1);
+    CONSOLE.print("us, drift ");
+    CONSOLE.print(cycleTracker.GetDrift(), 1);
+    CONSOLE.print("ppm, jitter ");
+    CONSOLE.print(cycleTracker.GetJitter(), 1);
+    CONSOLE.print("us, ");
+    CONSOLE.println(cycleTracker.IsLocked() ? "locked" : "not locked");
+    CONSOLE.print("Network resyncs : ");
+    CONSOLE.print(cycleTracker.GetNbResyncs());
+    CONSOLE.print(", coasted cycles : ");
+    CONSOLE.println(gMicronetDevice.GetNbCoastedCycles());
+}
+
+void MenuCompassCapture()
+{
+    if ((peripheralsReadyTime_ms != 0) && !gConfiguration.ram.navCompassAvailable)
+    {
+        CONSOLE.println("Navigation compass not available");
+        return;
+    }
+
+    CONSOLE.println("Capturing compass data, press ESC to stop.");
+    gCompassCapture.Start();
+    gCompassCapture.PrintHeader(&CONSOLE);
+
+    ConversionLoop();
+
+    gCompassCapture.Stop();
+    gCompassCapture.Print(&CONSOLE);
+    CONSOLE.print("Dropped records : ");
+    CONSOLE.println(gCompassCapture.GetNbDropped());
+}
+
+void MenuNmeaOutputs()
+{
+    char           line[CONSOLE_LINE_LENGTH];
+    EEPROMConfig_t backup = gConfiguration.eeprom;
+
+    do
+    {
+        PrintNmeaOutputSettings();
+        CONSOLE.println("R <output> <B/s>             : Maximum throughput of an output, 0 for unlimited");
+        CONSOLE.println("F <output> <+|-><sentence|*> : Add or remove sentences sent on an output");
+        CONSOLE.println("P <sentence> <ms>            : Minimum period of an encoded sentence, 0 to disable it");
+        CONSOLE.println("W <password>                 : Password of the WiFi access point, 8 to 15 characters");
+        CONSOLE.println("Empty line to save, ESC to cancel");
+        CONSOLE.print("> ");
+
+        if (ReadConsoleLine(line, sizeof(line)) < 0)
         {
-            char c = gConfiguration.ram.nmeaLink->read();
-            // if NMEA_EXT share the same link than the console : check for ESC key
-            if (((void *)(&CONSOLE) == (void *)(gConfiguration.ram.nmeaLink)) && (c == 0x1b))
+            gConfiguration.eeprom = backup;
+            CONSOLE.println("Changes cancelled");
+            return;
+        }
+
+        if ((line[0] != 0) && !ParseNmeaOutputCommand(line))
+        {
+            CONSOLE.println("Invalid command");
+        }
+    } while (line[0] != 0);
+
+    gConfiguration.SaveToEeprom();
+    // Applied by the NMEA task at next conversion start
+    gNmeaMultiplexer.RequestDeploy();
+    CONSOLE.println("NMEA output settings saved");
+}
+
+// Reads a line from the console with echo. Returns its length or -1 if ESC has been pressed.
+int ReadConsoleLine(char *line, int maxLength)
+{
+    static bool lastWasCr = false;
+    int         length    = 0;
+
+    while (true)
+    {
+        if (CONSOLE.available() <= 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        char c = CONSOLE.read();
+        if ((c == '\n') && lastWasCr)
+        {
+            // LF of a CR/LF sequence
+            lastWasCr = false;
+            continue;
+        }
+        lastWasCr = (c == '\r');
+
+        if (c == 0x1b)
+        {
+            CONSOLE.println();
+            return -1;
+        }
+        else if ((c == '\r') || (c == '\n'))
+        {
+            line[length] = 0;
+            CONSOLE.println();
+            return length;
+        }
+        else if ((c == 0x08) || (c == 0x7f))
+        {
+            if (length > 0)
             {
-                // ESC key pressed, exit conversion loop and return to upper menu
-                CONSOLE.println("ESC key pressed, stopping conversion.");
-                exitNmeaLoop = true;
+                length--;
+                CONSOLE.print("\b \b");
             }
-            // Not ESC key : transmit to DataBridge
-            gDataBridge.PushNmeaChar(c, LINK_NMEA_EXT);
         }
+        else if ((c >= ' ') && (length < maxLength - 1))
+        {
+            line[length++] = c;
+            CONSOLE.print(c);
+        }
+    }
+}
 
-        // Only execute magnetic heading code if navigation compass is available
-        if (gConfiguration.ram.navCompassAvailable == true)
+void PrintNmeaOutputSettings()
+{
+    CONSOLE.print("Sentences :");
+    for (uint32_t id = 1; id < NMEA_ID_NB; id++)
+    {
+        CONSOLE.print(" ");
+        CONSOLE.print(NmeaBridge::GetSentenceIdName(id));
+    }
+    CONSOLE.println();
+
+    for (uint32_t i = 0; i < NMEA_OUTPUT_NB; i++)
+    {
+        CONSOLE.print(nmeaOutputNames[i]);
+        CONSOLE.print(" : ");
+        if (gConfiguration.eeprom.nmeaOutputRate_Bps[i] == 0)
+        {
+            CONSOLE.print("unlimited");
+        }
+        else
+        {
+            CONSOLE.print(gConfiguration.eeprom.nmeaOutputRate_Bps[i]);
+            CONSOLE.print("B/s");
+        }
+        CONSOLE.print(", sentences");
+        for (uint32_t id = 1; id < NMEA_ID_NB; id++)
         {
-            // Handle magnetic compass : only request new reading if previous is at least 100ms old
-            if ((millis() - lastHeadingTime) > 100)
+            if (gConfiguration.eeprom.nmeaOutputFilter[i] & NMEA_OUTPUT_MASK(id))
             {
-                lastHeadingTime = millis();
-                gDataBridge.UpdateCompassData(gNavCompass.GetHeading() + gMicronetCodec.navData.headingOffset_deg);
+                CONSOLE.print(" ");
+                CONSOLE.print(NmeaBridge::GetSentenceIdName(id));
             }
         }
+        CONSOLE.println();
+    }
 
-        // if console is not on the same link than NMEA_EXT : check for ESC key
-        if ((void *)(&CONSOLE) != (void *)(gConfiguration.ram.nmeaLink))
+    CONSOLE.print("Encoded sentence periods :");
+    for (uint32_t i = 0; i < NMEA_OUT_NB; i++)
+    {
+        CONSOLE.print(" ");
+        CONSOLE.print(NmeaBridge::GetSentenceName(i));
+        CONSOLE.print("=");
+        CONSOLE.print(gConfiguration.eeprom.nmeaPeriod_ms[i]);
+        CONSOLE.print("ms");
+    }
+    CONSOLE.println();
+
+    char ssid[NMEA_WIFI_SSID_SIZE];
+    gNmeaMultiplexer.GetWifiSsid(ssid, sizeof(ssid));
+    CONSOLE.print("WiFi access point : SSID ");
+    CONSOLE.print(ssid);
+    CONSOLE.print(", password ");
+    CONSOLE.println(gConfiguration.eeprom.wifiPassword);
+}
+
+bool ParseNmeaOutputCommand(char *line)
+{
+    char    *command    = strtok(line, " ");
+    char    *outputName = strtok(nullptr, " ");
+    char    *value      = strtok(nullptr, " ");
+    uint32_t output;
+
+    if ((command != nullptr) && (command[1] == 0) && (toupper(command[0]) == 'W') && (outputName != nullptr) && (value == nullptr))
+    {
+        // WiFi password : a running access point is restarted with it by the deployment
+        uint32_t length = strlen(outputName);
+        if ((length < WIFI_PASSWORD_MIN_LENGTH) || (length >= WIFI_PASSWORD_SIZE))
         {
-            while (CONSOLE.available() > 0)
+            return false;
+        }
+        strcpy(gConfiguration.eeprom.wifiPassword, outputName);
+        return true;
+    }
+
+    if ((command == nullptr) || (outputName == nullptr) || (value == nullptr) || (strtok(nullptr, " ") != nullptr))
+    {
+        return false;
+    }
+
+    if ((command[1] == 0) && (toupper(command[0]) == 'P'))
+    {
+        // Period of an encoded sentence : read directly by the bridge, no deployment needed
+        for (uint32_t sentence = 0; sentence < NMEA_OUT_NB; sentence++)
+        {
+            if (strcasecmp(outputName, NmeaBridge::GetSentenceName(sentence)) == 0)
             {
-                if (CONSOLE.read() == 0x1b)
+                char    *end;
+                uint32_t period_ms = strtoul(value, &end, 10);
+                if ((*end != 0) || (period_ms > UINT16_MAX))
                 {
-                    CONSOLE.println("ESC key pressed, stopping conversion.");
-                    exitNmeaLoop = true;
+                    return false;
                 }
+                gConfiguration.eeprom.nmeaPeriod_ms[sentence] = period_ms;
+                return true;
             }
         }
+        return false;
+    }
 
-        // Update validity of Micronet's navigation data
-        gMicronetCodec.navData.UpdateValidity();
-
-        // Let MicronetDevice device process all its time related status
-        gMicronetDevice.Yield();
-
-        // Give PanelDriver the latest network status
-        gPanelDriver.SetNetworkStatus(gMicronetDevice.GetDeviceInfo());
-
-        // Give hand to OS before next loop
-        yield();
+    for (output = 0; output < NMEA_OUTPUT_NB; output++)
+    {
+        if (strcasecmp(outputName, nmeaOutputNames[output]) == 0)
+        {
+            break;
+        }
+    }
+    if (output >= NMEA_OUTPUT_NB)
+    {
+        return false;
+    }
 
-    } while (!exitNmeaLoop);
+    if ((command[1] == 0) && (toupper(command[0]) == 'R'))
+    {
+        char    *end;
+        uint32_t rate_Bps = strtoul(value, &end, 10);
+        if ((*end != 0) || (rate_Bps > UINT16_MAX))
+        {
+            return false;
+        }
+        gConfiguration.eeprom.nmeaOutputRate_Bps[output] = rate_Bps;
+        return true;
+    }
+    else if ((command[1] == 0) && (toupper(command[0]) == 'F'))
+    {
+        uint32_t mask = 0;
 
-    gRfDriver.DisableFrequencyTracking();
-}
+        if ((value[0] != '+') && (value[0] != '-'))
+        {
+            return false;
+        }
+        if (strcmp(value + 1, "*") == 0)
+        {
+            mask = NMEA_FILTER_ALL;
+        }
+        else
+        {
+            for (uint32_t id = 1; id < NMEA_ID_NB; id++)
+            {
+                if (strcasecmp(value + 1, NmeaBridge::GetSentenceIdName(id)) == 0)
+                {
+                    mask = NMEA_OUTPUT_MASK(id);
+                    break;
+                }
+            }
+        }
+        if (mask == 0)
+        {
+            return false;
+        }
 
-void MenuDebug1()
-{
-}
+        if (value[0] == '+')
+        {
+            gConfiguration.eeprom.nmeaOutputFilter[output] |= mask;
+        }
+        else
+        {
+            gConfiguration.eeprom.nmeaOutputFilter[output] &= ~mask;
+        }
+        return true;
+    }
 
-void MenuDebug2()
-{
+    return false;
 }
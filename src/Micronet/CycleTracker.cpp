@@ -0,0 +1,201 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Filtered estimate of Micronet network cycle timing            *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "CycleTracker.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define CYCLE_PHASE_GAIN      0.25f  // Alpha : fraction of the phase error corrected at each measurement
+#define CYCLE_PERIOD_GAIN     0.05f  // Beta : fraction of the phase error per cycle applied to the period
+#define CYCLE_JITTER_GAIN     0.1f   // Filtering factor of the mean absolute phase error
+#define CYCLE_MAX_DRIFT_PPM   500.0f // Maximum clock drift between the master and us
+#define CYCLE_RESYNC_ERROR_US 2000   // Phase error beyond which the master is considered to have restarted its cycle
+#define CYCLE_MAX_GAP         10     // Number of cycles between two measurements beyond which tracking restarts
+#define CYCLE_LOCK_UPDATES    4      // Number of measurements before the estimate is considered reliable
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+/*
+  Class constructor
+  @param nominalPeriod_us Nominal period of the network cycle in microseconds
+*/
+CycleTracker::CycleTracker(uint32_t nominalPeriod_us) : nominalPeriod_us(nominalPeriod_us), nbResyncs(0)
+{
+    Reset();
+}
+
+/*
+  Class destructor
+*/
+CycleTracker::~CycleTracker()
+{
+}
+
+/*
+  Restart tracking from the nominal period
+*/
+void CycleTracker::Reset()
+{
+    lastStart_us = 0;
+    period_us    = nominalPeriod_us;
+    jitter_us    = 0;
+    nbUpdates    = 0;
+}
+
+/*
+  Update the estimate with a new measurement of the cycle start
+  @param cycleStart_us Start time of the cycle, i.e. of the MASTER REQUEST message
+*/
+void CycleTracker::Update(uint32_t cycleStart_us)
+{
+    if (nbUpdates == 0)
+    {
+        lastStart_us = cycleStart_us;
+        nbUpdates    = 1;
+        return;
+    }
+
+    // Number of cycles elapsed since the last measurement
+    uint32_t elapsed_us = cycleStart_us - lastStart_us;
+    uint32_t nbCycles   = (uint32_t)((elapsed_us + period_us / 2) / period_us);
+
+    if ((nbCycles == 0) || (nbCycles > CYCLE_MAX_GAP))
+    {
+        // Too far from the last measurement to be reliable
+        Reset();
+        Update(cycleStart_us);
+        return;
+    }
+
+    uint32_t predicted_us = lastStart_us + (uint32_t)lroundf(nbCycles * period_us);
+    int32_t  error_us     = (int32_t)(cycleStart_us - predicted_us);
+
+    if (abs(error_us) > CYCLE_RESYNC_ERROR_US)
+    {
+        // Master has restarted its cycle with a new phase : keep the period estimate but restart the phase
+        lastStart_us = cycleStart_us;
+        jitter_us    = 0;
+        nbUpdates    = 1;
+        nbResyncs++;
+        return;
+    }
+
+    lastStart_us = predicted_us + (int32_t)lroundf(CYCLE_PHASE_GAIN * error_us);
+    period_us += CYCLE_PERIOD_GAIN * error_us / nbCycles;
+    jitter_us += CYCLE_JITTER_GAIN * (abs(error_us) - jitter_us);
+
+    // Bound the period to a realistic clock drift
+    float maxDeviation_us = nominalPeriod_us * CYCLE_MAX_DRIFT_PPM / 1000000.0f;
+    if (period_us > nominalPeriod_us + maxDeviation_us)
+    {
+        period_us = nominalPeriod_us + maxDeviation_us;
+    }
+    else if (period_us < nominalPeriod_us - maxDeviation_us)
+    {
+        period_us = nominalPeriod_us - maxDeviation_us;
+    }
+
+    nbUpdates++;
+}
+
+/*
+  Tell if enough measurements have been made for the estimate to be reliable
+*/
+bool CycleTracker::IsLocked()
+{
+    return nbUpdates >= CYCLE_LOCK_UPDATES;
+}
+
+/*
+  Predict the first cycle start after a given time
+  @param time_us Time in microseconds
+  @return Predicted start time of the cycle in microseconds
+*/
+uint32_t CycleTracker::GetStartAfter(uint32_t time_us)
+{
+    uint32_t nbCycles = (uint32_t)((time_us - lastStart_us) / period_us) + 1;
+
+    return lastStart_us + (uint32_t)lroundf(nbCycles * period_us);
+}
+
+/*
+  Get the estimated cycle period measured with our clock
+  @return Period in microseconds
+*/
+float CycleTracker::GetPeriod()
+{
+    return period_us;
+}
+
+/*
+  Get the estimated clock drift of the master relative to us
+  @return Drift in ppm, positive when the master's cycle is longer than nominal in our time base
+*/
+float CycleTracker::GetDrift()
+{
+    return (period_us - nominalPeriod_us) * 1000000.0f / nominalPeriod_us;
+}
+
+/*
+  Get the mean absolute difference between predicted and measured cycle starts
+  @return Jitter in microseconds
+*/
+float CycleTracker::GetJitter()
+{
+    return jitter_us;
+}
+
+/*
+  Get the number of times the master has been found with a new phase
+*/
+uint32_t CycleTracker::GetNbResyncs()
+{
+    return nbResyncs;
+}
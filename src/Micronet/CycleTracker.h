@@ -0,0 +1,83 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Filtered estimate of Micronet network cycle timing            *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef CYCLETRACKER_H_
+#define CYCLETRACKER_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Tracks the period and the phase of the master's network cycle with an alpha-beta filter fed with the reception
+  times of MASTER REQUEST messages. Period is measured with our micros() clock, so that its difference with the
+  nominal period is the clock drift between the master and us. Missed cycles are handled by counting the number of
+  periods elapsed between two measurements.
+*/
+class CycleTracker
+{
+  public:
+    CycleTracker(uint32_t nominalPeriod_us);
+    virtual ~CycleTracker();
+
+    void     Reset();
+    void     Update(uint32_t cycleStart_us);
+    bool     IsLocked();
+    uint32_t GetStartAfter(uint32_t time_us);
+    float    GetPeriod();
+    float    GetDrift();
+    float    GetJitter();
+    uint32_t GetNbResyncs();
+
+  private:
+    uint32_t nominalPeriod_us;
+    uint32_t lastStart_us;
+    float    period_us;
+    float    jitter_us;
+    uint32_t nbUpdates;
+    uint32_t nbResyncs;
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* CYCLETRACKER_H_ */
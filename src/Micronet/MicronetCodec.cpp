@@ -56,11 +56,11 @@
 /*                              Functions                                  */
 /***************************************************************************/
 
-MicronetCodec::MicronetCodec() : swMajorVersion(0), swMinorVersion(0)
+MicronetCodec::MicronetCodec() : swMajorVersion(0), swMinorVersion(0), rxTime_us(0)
 {
 }
 
-MicronetCodec::MicronetCodec(uint8_t swMajorVersion, uint8_t swMinorVersion)
+MicronetCodec::MicronetCodec(uint8_t swMajorVersion, uint8_t swMinorVersion) : rxTime_us(0)
 {
     SetSwVersion(swMajorVersion, swMinorVersion);
 }
@@ -162,6 +162,9 @@ bool MicronetCodec::DecodeMessage(MicronetMessage_t *message)
 void MicronetCodec::DecodeSendDataMessage(MicronetMessage_t *message)
 {
     int fieldOffset = MICRONET_PAYLOAD_OFFSET;
+
+    // Time at which the last byte of the frame has been received, propagated to each decoded value
+    rxTime_us = message->endTime_us - GUARD_TIME_IN_US;
     while (fieldOffset < message->len)
     {
         fieldOffset = DecodeDataField(message, fieldOffset);
@@ -342,6 +345,7 @@ void MicronetCodec::UpdateMicronetData(uint8_t fieldId, int8_t value)
         navData.stp_degc.value     = (((float)value) / 2.0f) + navData.waterTemperatureOffset_degc;
         navData.stp_degc.valid     = true;
         navData.stp_degc.timeStamp = millis();
+        navData.stp_degc.rxTime_us = rxTime_us;
         break;
     }
 }
@@ -356,6 +360,7 @@ void MicronetCodec::UpdateMicronetData(uint8_t fieldId, int16_t value)
         navData.spd_kt.value     = (((float)value) / 100.0f) * navData.waterSpeedFactor_per;
         navData.spd_kt.valid     = true;
         navData.spd_kt.timeStamp = millis();
+        navData.spd_kt.rxTime_us = rxTime_us;
         break;
     case MICRONET_FIELD_ID_DPT:
         if (value < MAXIMUM_VALID_DEPTH_FT * 10)
@@ -363,6 +368,7 @@ void MicronetCodec::UpdateMicronetData(uint8_t fieldId, int16_t value)
             navData.dpt_m.value     = (((float)value) * 0.3048f / 10.0f) + navData.depthOffset_m;
             navData.dpt_m.valid     = true;
             navData.dpt_m.timeStamp = millis();
+            navData.dpt_m.rxTime_us = rxTime_us;
         }
         else
         {
@@ -373,6 +379,7 @@ void MicronetCodec::UpdateMicronetData(uint8_t fieldId, int16_t value)
         navData.aws_kt.value     = (((float)value) / 10.0f) * navData.windSpeedFactor_per;
         navData.aws_kt.valid     = true;
         navData.aws_kt.timeStamp = millis();
+        navData.aws_kt.rxTime_us = rxTime_us;
         break;
     case MICRONET_FIELD_ID_AWA:
         newValue = ((float)value) + navData.windDirectionOffset_deg;
@@ -383,6 +390,7 @@ void MicronetCodec::UpdateMicronetData(uint8_t fieldId, int16_t value)
         navData.awa_deg.value     = newValue;
         navData.awa_deg.valid     = true;
         navData.awa_deg.timeStamp = millis();
+        navData.awa_deg.rxTime_us = rxTime_us;
         break;
     case MICRONET_FIELD_ID_HDG:
         newValue = ((float)value) + navData.headingOffset_deg;
@@ -397,11 +405,13 @@ void MicronetCodec::UpdateMicronetData(uint8_t fieldId, int16_t value)
         navData.magHdg_deg.value     = newValue;
         navData.magHdg_deg.valid     = true;
         navData.magHdg_deg.timeStamp = millis();
+        navData.magHdg_deg.rxTime_us = rxTime_us;
         break;
     case MICRONET_FIELD_ID_VCC:
         navData.vcc_v.value     = ((float)value) / 10.0f;
         navData.vcc_v.valid     = true;
         navData.vcc_v.timeStamp = millis();
+        navData.vcc_v.rxTime_us = rxTime_us;
         break;
     }
 }
@@ -414,9 +424,11 @@ void MicronetCodec::UpdateMicronetData(uint8_t fieldId, int32_t value1, int32_t
         navData.trip_nm.value     = ((float)value1) / 100.0f;
         navData.trip_nm.valid     = true;
         navData.trip_nm.timeStamp = millis();
+        navData.trip_nm.rxTime_us = rxTime_us;
         navData.log_nm.value      = ((float)value2) / 10.0f;
         navData.log_nm.valid      = true;
         navData.log_nm.timeStamp  = millis();
+        navData.log_nm.rxTime_us  = rxTime_us;
         break;
     }
 }
@@ -435,10 +447,12 @@ void MicronetCodec::CalculateTrueWind()
             navData.tws_kt.value     = sqrtf(twLon * twLon + twLat * twLat);
             navData.tws_kt.valid     = true;
             navData.tws_kt.timeStamp = millis();
+            navData.tws_kt.rxTime_us = rxTime_us;
 
             navData.twa_deg.value     = atan2f(twLat, twLon) * 180.0f / M_PI;
             navData.twa_deg.valid     = true;
             navData.twa_deg.timeStamp = millis();
+            navData.twa_deg.rxTime_us = rxTime_us;
         }
     }
 }
@@ -1231,6 +1245,31 @@ uint32_t MicronetCodec::GetEndOfNetwork(NetworkMap_t *networkMap)
     return networkMap->networkEnd;
 }
 
+/*
+  Move all the times of a network map, e.g. to predict the map of a later network cycle
+  @param networkMap Network map to update
+  @param offset_us Time offset to add
+*/
+void MicronetCodec::ShiftNetworkMap(NetworkMap_t *networkMap, uint32_t offset_us)
+{
+    networkMap->networkStart += offset_us;
+    networkMap->networkEnd += offset_us;
+    networkMap->firstSlot += offset_us;
+    for (uint32_t i = 0; i < networkMap->nbSyncSlots; i++)
+    {
+        // Null start time means unallocated slot
+        if (networkMap->syncSlot[i].start_us != 0)
+        {
+            networkMap->syncSlot[i].start_us += offset_us;
+        }
+    }
+    networkMap->asyncSlot.start_us += offset_us;
+    for (uint32_t i = 0; i < networkMap->nbAckSlots; i++)
+    {
+        networkMap->ackSlot[i].start_us += offset_us;
+    }
+}
+
 uint8_t MicronetCodec::CalculateSignalStrength(MicronetMessage_t *message)
 {
     int16_t rssi = message->rssi;
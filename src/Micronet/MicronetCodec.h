@@ -121,6 +121,7 @@ class MicronetCodec
     uint32_t     GetStartOfNetwork(NetworkMap_t *networkMap);
     uint32_t     GetNextStartOfNetwork(NetworkMap_t *networkMap);
     uint32_t     GetEndOfNetwork(NetworkMap_t *networkMap);
+    void         ShiftNetworkMap(NetworkMap_t *networkMap, uint32_t offset_us);
     uint8_t      CalculateSignalStrength(MicronetMessage_t *message);
     float        CalculateSignalFloatStrength(MicronetMessage_t *message);
     uint8_t      GetDataMessageLength(uint32_t dataFields);
@@ -140,6 +141,7 @@ class MicronetCodec
     uint8_t      swMajorVersion;
     uint8_t      swMinorVersion;
     SystemInfo_t systemInfo;
+    uint32_t     rxTime_us;
 
     void    DecodeSendDataMessage(MicronetMessage_t *message);
     void    DecodeSendCommandMessage(MicronetMessage_t *message);
@@ -40,8 +40,32 @@
 #define DEVICE_LOST_TIME_MS 60000
 // If we don't receive a request from a network for this time, we consider the network lost
 #define NETWORK_LOST_TIME_MS 5000
+// Resolution of the expiration timing wheels
+#define DEVICE_EXPIRY_RESOLUTION_MS  1000
+#define NETWORK_EXPIRY_RESOLUTION_MS 100
 // Battery low level in percent
 #define BATTERY_LOW_LEVEL 20
+// Period of Micronet network cycles
+#define NETWORK_CYCLE_PERIOD_US 1000000
+// Network search strategy
+#define SEARCH_FULL_SCAN_TIME_MS  30000 // Continuous listening before switching to slow scan
+#define SEARCH_MAX_MISSES         30    // Missed predicted MASTER REQUESTs before falling back to full scan
+#define SEARCH_WINDOW_MARGIN_US   3000  // Listening margin around a predicted MASTER REQUEST
+#define SEARCH_DRIFT_PER_CYCLE_US 100   // Additional margin per elapsed cycle, covers 100ppm of clock drift
+#define SEARCH_MASTER_REQUEST_US  5000  // Upper bound of MASTER REQUEST duration
+#define SEARCH_SLOW_LISTEN_MS     1200  // Listening time of slow scan, longer than a network cycle
+#define SEARCH_SLOW_SLEEP_MS      2000  // Receiver off time of slow scan
+#define SEARCH_ACTION_DELAY_US    2000  // Delay of immediate RF actions, the transmit scheduler drops past actions
+#define SEARCH_NO_TIMEOUT         0xffffffff
+// Receiver start-up time before a network cycle, lets time for the PLL calibration loop to complete
+#define RF_WAKEUP_TIME_US 1000
+// Receiver start-up time from sleep when the cycle start is accurately predicted : oscillator, PLL lock and RX ramp-up
+#define RF_RX_STARTUP_US 500
+// Margin added to the wake-up advance in number of cycle start jitters
+#define RF_WAKEUP_JITTER_FACTOR 4
+// Network cycle coasting
+#define COAST_MAX_CYCLES  1    // Number of consecutive missed MASTER REQUESTs for which our slots are still used
+#define COAST_MARGIN_US   2000 // Delay after the predicted end of MASTER REQUEST before considering it missed
 
 /***************************************************************************/
 /*                             Local types                                 */
@@ -63,7 +87,10 @@
   Class constructor
 */
 MicronetDevice::MicronetDevice(MicronetCodec *micronetCodec)
-    : lastMasterSignalStrength(0), pingTimeStamp(0), nextAsyncSlot(0), batteryAlertSent(false)
+    : lastMasterSignalStrength(0), pingTimeStamp(0), nextAsyncSlot(0), batteryAlertSent(false),
+      deviceExpiry(DEVICE_EXPIRY_RESOLUTION_MS), networkExpiry(NETWORK_EXPIRY_RESOLUTION_MS), searchMode(SEARCH_MODE_CONTINUOUS),
+      searchModeStart_ms(0), searchMisses(0), lastMasterRequest_us(0), receiverOn(true), searchWindowScheduled(false), searchWindowEnd_us(0),
+      slowScanToggle_ms(0), cycleTracker(NETWORK_CYCLE_PERIOD_US), nextCycleStart_us(0), coastedCycles(0), nbCoastedCycles(0)
 {
     memset(&deviceInfo, 0, sizeof(deviceInfo));
     memset(&systemInfo, 0, sizeof(systemInfo));
@@ -93,6 +120,13 @@ void MicronetDevice::SetDeviceId(uint32_t deviceId)
 */
 void MicronetDevice::SetNetworkId(uint32_t networkId)
 {
+    // New network : search it with a full scan
+    if (networkId != deviceInfo.networkId)
+    {
+        SetSearchMode(SEARCH_MODE_CONTINUOUS);
+        cycleTracker.Reset();
+    }
+
     this->deviceInfo.networkId = networkId;
 }
 
@@ -140,78 +174,40 @@ void MicronetDevice::ProcessMessage(MicronetMessage_t *message, MicronetMessageF
             // Yes : update the list of detected devices in the network
             UpdateDevicesInRange(message);
 
+            // Our network is in range but its MASTER REQUEST has been missed : listen continuously until the next one
+            if ((deviceInfo.state == DEVICE_STATE_SEARCH_NETWORK) && (searchMode != SEARCH_MODE_CONTINUOUS) &&
+                (micronetCodec->GetMessageId(message) != MICRONET_MESSAGE_ID_MASTER_REQUEST))
+            {
+                SetSearchMode(SEARCH_MODE_CONTINUOUS);
+                SetReceiver(messageFifo, true, micros() + SEARCH_ACTION_DELAY_US);
+            }
+
             // Is this the MASTER REQUEST message from the master device ?
             if (micronetCodec->GetMessageId(message) == MICRONET_MESSAGE_ID_MASTER_REQUEST)
             {
                 // Yes : decode the network map from the message
+                bool     wasActive         = (deviceInfo.state == DEVICE_STATE_ACTIVE);
+                uint32_t scheduledStart_us = deviceInfo.networkMap.networkStart;
                 deviceInfo.state            = DEVICE_STATE_ACTIVE;
                 deviceInfo.lastMasterCommMs = millis();
                 micronetCodec->GetNetworkMap(message, &deviceInfo.networkMap);
-
-                // Schedule the low power mode of RF transmitter just at the end of the network cycle
-                txMessage.action       = MICRONET_ACTION_RF_LOW_POWER;
-                txMessage.startTime_us = micronetCodec->GetEndOfNetwork(&deviceInfo.networkMap);
-                txMessage.len          = 0;
-                messageFifo->Push(txMessage);
-
-                // Schedule exit of RF transmitter's low power mode 1ms before actual start of the next network cycle.
-                // It will let time for the PLL calibration loop to complete.
-                txMessage.action       = MICRONET_ACTION_RF_ACTIVE_POWER;
-                txMessage.startTime_us = micronetCodec->GetNextStartOfNetwork(&deviceInfo.networkMap) - 1000;
-                txMessage.len          = 0;
-                messageFifo->Push(txMessage);
+                cycleTracker.Update(deviceInfo.networkMap.networkStart);
 
                 // Calculate signal strength of the MASTER REQUEST message. This strength will be transmitted in our outgoing messages to allow master
                 // device to monitor the quality of the reception. It is used in the HEALTH page of Micronet displays.
                 lastMasterSignalStrength = micronetCodec->CalculateSignalStrength(message);
 
-                // Check for battery status and send an alarm message if it is low
-                CheckBatteryStatus(messageFifo);
-
-                // For each virtual slave device...
-                for (int i = 0; i < NUMBER_OF_VIRTUAL_DEVICES; i++)
+                // A MASTER REQUEST received after its cycle has been coasted has already been handled with the predicted map
+                bool alreadyScheduled = wasActive && (coastedCycles > 0) &&
+                                        (abs((int32_t)(deviceInfo.networkMap.networkStart - scheduledStart_us)) < NETWORK_CYCLE_PERIOD_US / 2);
+                coastedCycles = 0;
+                if (alreadyScheduled)
                 {
-                    // Find the synchronous slot of the virtual device
-                    txSlot = micronetCodec->GetSyncTransmissionSlot(&deviceInfo.networkMap, deviceInfo.deviceId + i);
-                    if (txSlot.start_us != 0)
-                    {
-                        // Slot found : encode device data message
-                        uint32_t payloadLength = micronetCodec->EncodeDataMessage(&txMessage, lastMasterSignalStrength, deviceInfo.networkId,
-                                                                                  deviceInfo.deviceId + i, deviceInfo.splitDataFields[i]);
-                        // Check that the sync slot is big enough for the encoded message
-                        if (txSlot.payloadBytes < payloadLength)
-                        {
-                            // Sync slot is too small : request slot resize
-                            SendResizeRequest(messageFifo, deviceInfo.deviceId + i, payloadLength);
-                        }
-                        else
-                        {
-                            // Sync slot is ok : transmit message
-                            txMessage.action       = MICRONET_ACTION_RF_TRANSMIT;
-                            txMessage.startTime_us = txSlot.start_us;
-                            messageFifo->Push(txMessage);
-                            // If we are here, it means we don't need the asynchronous slot. So we can use it to ping other devices to maintain a list
-                            // of devices in range. We only ping when handling the first virtual slave device to avoid pinging too often.
-                            if (i == NUMBER_OF_VIRTUAL_DEVICES - 1)
-                            {
-                                // Only the last virtual device will ping the network
-                                // SendNetworkPing function will ensure that we will not flood the network with ping requests by enforcing a minimum
-                                // delay wetween each ping
-                                SendNetworkPing(messageFifo);
-                            }
-                        }
-                    }
-                    else
-                    {
-                        // No synchronous slot available : request a slot
-                        SendSlotRequest(messageFifo, deviceInfo.deviceId + i, micronetCodec->GetDataMessageLength(deviceInfo.splitDataFields[i]));
-                    }
+                    nextCycleStart_us = cycleTracker.GetStartAfter(deviceInfo.networkMap.networkStart + NETWORK_CYCLE_PERIOD_US / 2);
                 }
-
-                // Decrease the Async slot availability counter at each network cycle
-                if (nextAsyncSlot > 0)
+                else
                 {
-                    nextAsyncSlot--;
+                    ScheduleNetworkCycle(messageFifo, false);
                 }
             }
             else
@@ -233,11 +229,6 @@ void MicronetDevice::ProcessMessage(MicronetMessage_t *message, MicronetMessageF
             }
         }
     }
-
-    // Remove inactive devices from network device list
-    RemoveLostDevices();
-    // Remove inactive networks from surrounding network list
-    RemoveLostNetworks();
 }
 
 // Distribute requested data fields to the virtual devices
@@ -332,6 +323,8 @@ void MicronetDevice::UpdateDevicesInRange(MicronetMessage_t *message)
         deviceInfo.devicesInRange[deviceInfo.nbDevicesInRange].localRadioLevel  = micronetCodec->CalculateSignalStrength(message);
         deviceInfo.devicesInRange[deviceInfo.nbDevicesInRange].remoteRadioLevel = micronetCodec->GetSignalStrength(message);
         deviceInfo.nbDevicesInRange++;
+        // Schedule its expiration. Timestamp refreshes don't touch the wheel, they are checked when the entry expires.
+        deviceExpiry.Schedule(deviceId, millis(), DEVICE_LOST_TIME_MS);
     }
 }
 
@@ -380,6 +373,10 @@ void MicronetDevice::UpdateNetworkScan(MicronetMessage_t *message)
             deviceInfo.networksInRange[deviceInfo.nbNetworksInRange].timeStamp = now;
             deviceInfo.networksInRange[deviceInfo.nbNetworksInRange].rssi      = message->rssi;
             deviceInfo.nbNetworksInRange++;
+            if (!networkExpiry.Schedule(networkId, now, NETWORK_LOST_TIME_MS))
+            {
+                RescheduleNetworks();
+            }
         }
         else
         {
@@ -400,58 +397,98 @@ void MicronetDevice::UpdateNetworkScan(MicronetMessage_t *message)
                 deviceInfo.networksInRange[minIndex].networkId = networkId;
                 deviceInfo.networksInRange[minIndex].timeStamp = now;
                 deviceInfo.networksInRange[minIndex].rssi      = message->rssi;
+                // The entry of the replaced network will be dropped when it expires
+                if (!networkExpiry.Schedule(networkId, now, NETWORK_LOST_TIME_MS))
+                {
+                    RescheduleNetworks();
+                }
             }
         }
     }
 }
 
 /*
-  Remove lost devices from network device list.
+  Remove lost devices from network device list. Only devices whose expiration is due are checked.
 */
 void MicronetDevice::RemoveLostDevices()
 {
     uint32_t now = millis();
+    uint32_t deviceId;
 
-    // Check every device of the list
-    for (int i = 0; i < deviceInfo.nbDevicesInRange; i++)
+    while (deviceExpiry.PopExpired(now, &deviceId))
     {
-        // Check last communication time of the device
-        if ((now - deviceInfo.devicesInRange[i].lastCommMs) > DEVICE_LOST_TIME_MS)
+        for (int i = 0; i < deviceInfo.nbDevicesInRange; i++)
         {
-            // No news for too long : remove the device
-            if (i < deviceInfo.nbDevicesInRange - 1)
+            if (deviceInfo.devicesInRange[i].deviceId == deviceId)
             {
-                memcpy(&deviceInfo.devicesInRange[i], &deviceInfo.devicesInRange[i + 1], sizeof(DeviceInfo_t) * deviceInfo.nbDevicesInRange - i - 1);
+                uint32_t silence_ms = now - deviceInfo.devicesInRange[i].lastCommMs;
+                if (silence_ms > DEVICE_LOST_TIME_MS)
+                {
+                    // No news for too long : remove the device
+                    memmove(&deviceInfo.devicesInRange[i], &deviceInfo.devicesInRange[i + 1],
+                            sizeof(ConnectionInfo_t) * (deviceInfo.nbDevicesInRange - i - 1));
+                    deviceInfo.nbDevicesInRange--;
+                }
+                else
+                {
+                    // Device communicated since scheduling : expire it relatively to its last communication
+                    deviceExpiry.Schedule(deviceId, now, DEVICE_LOST_TIME_MS - silence_ms);
+                }
+                break;
             }
-            deviceInfo.nbDevicesInRange--;
         }
     }
 }
 
 /*
-  Remove lost networks from surrounding network lists.
+  Remove lost networks from surrounding network lists. Only networks whose expiration is due are checked.
 */
 void MicronetDevice::RemoveLostNetworks()
 {
     uint32_t now = millis();
+    uint32_t networkId;
 
-    // Check every network of the list
-    for (int i = 0; i < deviceInfo.nbNetworksInRange; i++)
+    while (networkExpiry.PopExpired(now, &networkId))
     {
-        // Check last communication time of the network
-        if ((now - deviceInfo.networksInRange[i].timeStamp) > NETWORK_LOST_TIME_MS)
+        for (int i = 0; i < deviceInfo.nbNetworksInRange; i++)
         {
-            // No news for too long : remove the network
-            if (i < deviceInfo.nbNetworksInRange - 1)
+            if (deviceInfo.networksInRange[i].networkId == networkId)
             {
-                memcpy(&deviceInfo.networksInRange[i], &deviceInfo.networksInRange[i + 1],
-                       sizeof(DeviceInfo_t) * deviceInfo.nbNetworksInRange - i - 1);
+                uint32_t silence_ms = now - deviceInfo.networksInRange[i].timeStamp;
+                if (silence_ms > NETWORK_LOST_TIME_MS)
+                {
+                    // No news for too long : remove the network
+                    memmove(&deviceInfo.networksInRange[i], &deviceInfo.networksInRange[i + 1],
+                            sizeof(NetworkInfo_t) * (deviceInfo.nbNetworksInRange - i - 1));
+                    deviceInfo.nbNetworksInRange--;
+                }
+                else
+                {
+                    networkExpiry.Schedule(networkId, now, NETWORK_LOST_TIME_MS - silence_ms);
+                }
+                break;
             }
-            deviceInfo.nbNetworksInRange--;
         }
     }
 }
 
+/*
+  Rebuild network expiration wheel from the network list. Only needed if the wheel is filled with entries of
+  replaced networks.
+*/
+void MicronetDevice::RescheduleNetworks()
+{
+    uint32_t now = millis();
+
+    networkExpiry.Clear();
+    for (int i = 0; i < deviceInfo.nbNetworksInRange; i++)
+    {
+        uint32_t silence_ms = now - deviceInfo.networksInRange[i].timeStamp;
+        networkExpiry.Schedule(deviceInfo.networksInRange[i].networkId, now,
+                               (silence_ms < NETWORK_LOST_TIME_MS) ? NETWORK_LOST_TIME_MS - silence_ms : 0);
+    }
+}
+
 /*
     Check if the battery level and send a alert message if the level is low.
     @param messageFifo Pointer to the outgoing message FIFO
@@ -588,6 +625,140 @@ bool MicronetDevice::isAsyncSlotAvailable()
     return asyncSlotAvailable;
 }
 
+/*
+  Schedule the RF actions of the network cycle described by the current network map : receiver power modes and
+  transmissions in our slots.
+  @param messageFifo Pointer to the outgoing message queue
+  @param coasted true if the network map has been predicted because the MASTER REQUEST was missed. Only already
+  allocated sync slots are used then, the other requests are delayed until the master is received again.
+*/
+void MicronetDevice::ScheduleNetworkCycle(MicronetMessageFifo *messageFifo, bool coasted)
+{
+    TxSlotDesc_t      txSlot;
+    MicronetMessage_t txMessage;
+    uint32_t          now_us = micros();
+
+    nextCycleStart_us = cycleTracker.GetStartAfter(deviceInfo.networkMap.networkStart + NETWORK_CYCLE_PERIOD_US / 2);
+
+    // Schedule the low power mode of RF transmitter just at the end of the network cycle
+    txMessage.action       = MICRONET_ACTION_RF_LOW_POWER;
+    txMessage.startTime_us = micronetCodec->GetEndOfNetwork(&deviceInfo.networkMap);
+    txMessage.len          = 0;
+    messageFifo->Push(txMessage);
+
+    // Schedule exit of RF transmitter's low power mode just before the predicted start of the next network cycle
+    txMessage.action       = MICRONET_ACTION_RF_ACTIVE_POWER;
+    txMessage.startTime_us = nextCycleStart_us - GetWakeupAdvance();
+    txMessage.len          = 0;
+    messageFifo->Push(txMessage);
+
+    // Check for battery status and send an alarm message if it is low
+    if (!coasted)
+    {
+        CheckBatteryStatus(messageFifo);
+    }
+
+    // For each virtual slave device...
+    for (int i = 0; i < NUMBER_OF_VIRTUAL_DEVICES; i++)
+    {
+        // Find the synchronous slot of the virtual device
+        txSlot = micronetCodec->GetSyncTransmissionSlot(&deviceInfo.networkMap, deviceInfo.deviceId + i);
+        if (txSlot.start_us != 0)
+        {
+            // Slot found : encode device data message
+            uint32_t payloadLength = micronetCodec->EncodeDataMessage(&txMessage, lastMasterSignalStrength, deviceInfo.networkId,
+                                                                      deviceInfo.deviceId + i, deviceInfo.splitDataFields[i]);
+            // Check that the sync slot is big enough for the encoded message
+            if (txSlot.payloadBytes < payloadLength)
+            {
+                // Sync slot is too small : request slot resize
+                if (!coasted)
+                {
+                    SendResizeRequest(messageFifo, deviceInfo.deviceId + i, payloadLength);
+                }
+            }
+            else if (!coasted)
+            {
+                // Sync slot is ok : transmit message
+                txMessage.action       = MICRONET_ACTION_RF_TRANSMIT;
+                txMessage.startTime_us = txSlot.start_us;
+                messageFifo->Push(txMessage);
+                // If we are here, it means we don't need the asynchronous slot. So we can use it to ping other devices to maintain a list
+                // of devices in range. We only ping when handling the first virtual slave device to avoid pinging too often.
+                if (i == NUMBER_OF_VIRTUAL_DEVICES - 1)
+                {
+                    // Only the last virtual device will ping the network
+                    // SendNetworkPing function will ensure that we will not flood the network with ping requests by enforcing a minimum
+                    // delay wetween each ping
+                    SendNetworkPing(messageFifo);
+                }
+            }
+            else if ((int32_t)(txSlot.start_us - now_us) > SEARCH_ACTION_DELAY_US)
+            {
+                // Coasted cycle : only transmit in the slots which are not already passed
+                txMessage.action       = MICRONET_ACTION_RF_TRANSMIT;
+                txMessage.startTime_us = txSlot.start_us;
+                messageFifo->Push(txMessage);
+            }
+        }
+        else if (!coasted)
+        {
+            // No synchronous slot available : request a slot
+            SendSlotRequest(messageFifo, deviceInfo.deviceId + i, micronetCodec->GetDataMessageLength(deviceInfo.splitDataFields[i]));
+        }
+    }
+
+    // Decrease the Async slot availability counter at each network cycle
+    if (nextAsyncSlot > 0)
+    {
+        nextAsyncSlot--;
+    }
+}
+
+/*
+  Get the time between the receiver start-up and the predicted start of the next network cycle. Once the cycle timing
+  is tracked, it only covers the receiver start-up time and the uncertainty of the prediction.
+  @return Wake-up advance in microseconds
+*/
+uint32_t MicronetDevice::GetWakeupAdvance()
+{
+    if (!cycleTracker.IsLocked())
+    {
+        return RF_WAKEUP_TIME_US;
+    }
+
+    uint32_t advance_us = RF_RX_STARTUP_US + (uint32_t)(RF_WAKEUP_JITTER_FACTOR * cycleTracker.GetJitter());
+
+    return (advance_us < RF_WAKEUP_TIME_US) ? advance_us : RF_WAKEUP_TIME_US;
+}
+
+/*
+  Get the predicted start time of the next network cycle
+  @return Start time in microseconds
+*/
+uint32_t MicronetDevice::GetNextCycleStart()
+{
+    return nextCycleStart_us;
+}
+
+/*
+  Get the network cycle timing estimator
+  @return Reference to the cycle tracker
+*/
+CycleTracker &MicronetDevice::GetCycleTracker()
+{
+    return cycleTracker;
+}
+
+/*
+  Get the number of network cycles handled without their MASTER REQUEST
+  @return Number of coasted cycles since boot
+*/
+uint32_t MicronetDevice::GetNbCoastedCycles()
+{
+    return nbCoastedCycles;
+}
+
 /*
   Update device internal status (lists, timeouts, states, etc.)
 */
@@ -603,5 +774,177 @@ void MicronetDevice::Yield()
     {
         deviceInfo.state            = DEVICE_STATE_SEARCH_NETWORK;
         deviceInfo.nbDevicesInRange = 0;
+        deviceExpiry.Clear();
+        coastedCycles = 0;
+
+        // Master is likely still running with the same timing : only listen when its next MASTER REQUESTs are expected.
+        // Receiver has been left on by the last RF_ACTIVE_POWER action of the network cycle.
+        lastMasterRequest_us = deviceInfo.networkMap.networkStart;
+        receiverOn           = true;
+        SetSearchMode(SEARCH_MODE_PREDICTED);
+    }
+}
+
+/*
+  Schedule the RF actions which don't directly result from a received message : coasting of a missed network cycle
+  while attached to the network, receiver duty cycle while searching for it.
+  Must be called after each received message and before the returned timeout expires.
+  @param messageFifo Pointer to the outgoing message queue
+  @return Time in milliseconds before the next call is required
+*/
+uint32_t MicronetDevice::ScheduleRadio(MicronetMessageFifo *messageFifo)
+{
+    if (deviceInfo.state == DEVICE_STATE_ACTIVE)
+    {
+        return UpdateCoasting(messageFifo);
+    }
+
+    return UpdateSearch(messageFifo);
+}
+
+/*
+  Detect a missed MASTER REQUEST and keep on transmitting in our sync slots of the cycle, using the network map of
+  the previous cycle moved to the predicted cycle start. Only COAST_MAX_CYCLES consecutive cycles are coasted.
+  @param messageFifo Pointer to the outgoing message queue
+  @return Time in milliseconds before the next call is required
+*/
+uint32_t MicronetDevice::UpdateCoasting(MicronetMessageFifo *messageFifo)
+{
+    uint32_t now_us = micros();
+
+    if (coastedCycles >= COAST_MAX_CYCLES)
+    {
+        return SEARCH_NO_TIMEOUT;
+    }
+
+    // MASTER REQUEST of the next cycle should have been received by this time
+    uint32_t deadline_us  = nextCycleStart_us + (deviceInfo.networkMap.firstSlot - deviceInfo.networkMap.networkStart) + COAST_MARGIN_US;
+    int32_t  remaining_us = deadline_us - now_us;
+    if (remaining_us > 0)
+    {
+        return remaining_us / 1000 + 1;
+    }
+
+    micronetCodec->ShiftNetworkMap(&deviceInfo.networkMap, nextCycleStart_us - deviceInfo.networkMap.networkStart);
+    ScheduleNetworkCycle(messageFifo, true);
+    coastedCycles++;
+    nbCoastedCycles++;
+
+    return SEARCH_NO_TIMEOUT;
+}
+
+/*
+  Drive the receiver duty cycle while searching for the network. The receiver listens continuously until a first
+  frame is received. After a network loss, it only listens around the MASTER REQUESTs predicted from the last network
+  cycle, then falls back to a full scan after too many misses. Without any frame for a long time, the receiver is
+  periodically switched off, each listening window being longer than a network cycle.
+  @param messageFifo Pointer to the outgoing message queue, receiving RF power actions
+  @return Time in milliseconds before the next call is required
+*/
+uint32_t MicronetDevice::UpdateSearch(MicronetMessageFifo *messageFifo)
+{
+    uint32_t now_us = micros();
+    uint32_t now_ms = millis();
+
+    if (deviceInfo.state != DEVICE_STATE_SEARCH_NETWORK)
+    {
+        return SEARCH_NO_TIMEOUT;
+    }
+
+    if (searchMode == SEARCH_MODE_PREDICTED)
+    {
+        if (searchWindowScheduled && ((int32_t)(now_us - searchWindowEnd_us) >= 0))
+        {
+            // MASTER REQUEST has not been received in the listening window
+            searchWindowScheduled = false;
+            SetReceiver(messageFifo, false, now_us + SEARCH_ACTION_DELAY_US);
+            if (++searchMisses >= SEARCH_MAX_MISSES)
+            {
+                SetSearchMode(SEARCH_MODE_CONTINUOUS);
+            }
+        }
+        else if (!searchWindowScheduled)
+        {
+            if (receiverOn)
+            {
+                SetReceiver(messageFifo, false, now_us + SEARCH_ACTION_DELAY_US);
+            }
+
+            // Next MASTER REQUEST far enough to schedule the receiver start-up. Cycle period is the one tracked while attached,
+            // margin grows with the elapsed cycles to cover the residual drift.
+            float    period_us = cycleTracker.GetPeriod();
+            uint32_t nbCycles  = (uint32_t)((now_us - lastMasterRequest_us) / period_us) + 1;
+            uint32_t margin_us, windowStart_us;
+            do
+            {
+                margin_us      = SEARCH_WINDOW_MARGIN_US + nbCycles * SEARCH_DRIFT_PER_CYCLE_US;
+                windowStart_us = lastMasterRequest_us + (uint32_t)(nbCycles * period_us) - margin_us - RF_WAKEUP_TIME_US;
+                nbCycles++;
+            } while ((int32_t)(windowStart_us - now_us) < 2 * SEARCH_ACTION_DELAY_US);
+
+            SetReceiver(messageFifo, true, windowStart_us);
+            searchWindowEnd_us    = windowStart_us + RF_WAKEUP_TIME_US + 2 * margin_us + SEARCH_MASTER_REQUEST_US;
+            searchWindowScheduled = true;
+        }
+
+        if (searchMode == SEARCH_MODE_PREDICTED)
+        {
+            return (searchWindowEnd_us - now_us) / 1000 + 1;
+        }
+    }
+
+    if (searchMode == SEARCH_MODE_CONTINUOUS)
+    {
+        if (!receiverOn)
+        {
+            SetReceiver(messageFifo, true, now_us + SEARCH_ACTION_DELAY_US);
+        }
+        if (now_ms - searchModeStart_ms < SEARCH_FULL_SCAN_TIME_MS)
+        {
+            return SEARCH_FULL_SCAN_TIME_MS - (now_ms - searchModeStart_ms);
+        }
+        SetSearchMode(SEARCH_MODE_SLOW_SCAN);
     }
+
+    // Slow scan : alternate listening and receiver off periods
+    uint32_t period_ms = receiverOn ? SEARCH_SLOW_LISTEN_MS : SEARCH_SLOW_SLEEP_MS;
+    if (now_ms - slowScanToggle_ms >= period_ms)
+    {
+        SetReceiver(messageFifo, !receiverOn, now_us + SEARCH_ACTION_DELAY_US);
+        slowScanToggle_ms = now_ms;
+        period_ms         = receiverOn ? SEARCH_SLOW_LISTEN_MS : SEARCH_SLOW_SLEEP_MS;
+    }
+
+    return period_ms - (now_ms - slowScanToggle_ms);
+}
+
+/*
+  Change the network search strategy
+  @param mode New search mode
+*/
+void MicronetDevice::SetSearchMode(SearchMode_t mode)
+{
+    searchMode            = mode;
+    searchModeStart_ms    = millis();
+    searchMisses          = 0;
+    searchWindowScheduled = false;
+    slowScanToggle_ms     = searchModeStart_ms;
+}
+
+/*
+  Schedule a change of the receiver power mode
+  @param messageFifo Pointer to the outgoing message queue
+  @param on true to start the receiver, false to put it in low power
+  @param time_us Time of the change
+*/
+void MicronetDevice::SetReceiver(MicronetMessageFifo *messageFifo, bool on, uint32_t time_us)
+{
+    MicronetMessage_t txMessage;
+
+    txMessage.action       = on ? MICRONET_ACTION_RF_ACTIVE_POWER : MICRONET_ACTION_RF_LOW_POWER;
+    txMessage.startTime_us = time_us;
+    txMessage.len          = 0;
+    messageFifo->Push(txMessage);
+
+    receiverOn = on;
 }
\ No newline at end of file
@@ -31,9 +31,11 @@
 /*                              Includes                                   */
 /***************************************************************************/
 
+#include "CycleTracker.h"
 #include "Micronet.h"
 #include "MicronetCodec.h"
 #include "MicronetMessageFifo.h"
+#include "TimingWheel.h"
 #include <Arduino.h>
 
 /***************************************************************************/
@@ -54,6 +56,13 @@ typedef enum
     DEVICE_STATE_ACTIVE
 } DeviceState_t;
 
+typedef enum
+{
+    SEARCH_MODE_CONTINUOUS = 0, // Receiver always on
+    SEARCH_MODE_PREDICTED,      // Receiver on around predicted MASTER REQUESTs of the lost network
+    SEARCH_MODE_SLOW_SCAN       // Receiver periodically on for more than a network cycle
+} SearchMode_t;
+
 typedef struct
 {
     uint32_t deviceId;
@@ -102,6 +111,10 @@ class MicronetDevice
     DeviceInfo_t &GetDeviceInfo();
     void          SetSystemInfo(SystemInfo_t &systemInfo);
     void          Yield();
+    uint32_t      ScheduleRadio(MicronetMessageFifo *messageFifo);
+    uint32_t      GetNextCycleStart();
+    CycleTracker &GetCycleTracker();
+    uint32_t      GetNbCoastedCycles();
 
   private:
     MicronetCodec *micronetCodec;
@@ -111,19 +124,40 @@ class MicronetDevice
     uint32_t       pingTimeStamp;
     uint32_t       nextAsyncSlot;
     bool           batteryAlertSent;
-
-    void    SplitDataFields();
-    uint8_t GetShortestDevice();
-    void    UpdateDevicesInRange(MicronetMessage_t *message);
-    void    UpdateNetworkScan(MicronetMessage_t *message);
-    void    RemoveLostDevices();
-    void    RemoveLostNetworks();
-    void    CheckBatteryStatus(MicronetMessageFifo *messageFifo);
-    bool    SendNetworkPing(MicronetMessageFifo *messageFifo);
-    bool    SendResizeRequest(MicronetMessageFifo *messageFifo, uint32_t deviceId, uint8_t newSize);
-    bool    SendSlotRequest(MicronetMessageFifo *messageFifo, uint32_t deviceId, uint8_t slotSize);
-    bool    SendAlert(MicronetMessageFifo *messageFifo, uint32_t deviceId, uint32_t alertId);
-    bool    isAsyncSlotAvailable();
+    TimingWheel    deviceExpiry;
+    TimingWheel    networkExpiry;
+    SearchMode_t   searchMode;
+    uint32_t       searchModeStart_ms;
+    uint32_t       searchMisses;
+    uint32_t       lastMasterRequest_us;
+    bool           receiverOn;
+    bool           searchWindowScheduled;
+    uint32_t       searchWindowEnd_us;
+    uint32_t       slowScanToggle_ms;
+    CycleTracker   cycleTracker;
+    uint32_t       nextCycleStart_us;
+    uint32_t       coastedCycles;
+    uint32_t       nbCoastedCycles;
+
+    void     SplitDataFields();
+    uint8_t  GetShortestDevice();
+    void     UpdateDevicesInRange(MicronetMessage_t *message);
+    void     UpdateNetworkScan(MicronetMessage_t *message);
+    void     RemoveLostDevices();
+    void     RemoveLostNetworks();
+    void     RescheduleNetworks();
+    void     CheckBatteryStatus(MicronetMessageFifo *messageFifo);
+    bool     SendNetworkPing(MicronetMessageFifo *messageFifo);
+    bool     SendResizeRequest(MicronetMessageFifo *messageFifo, uint32_t deviceId, uint8_t newSize);
+    bool     SendSlotRequest(MicronetMessageFifo *messageFifo, uint32_t deviceId, uint8_t slotSize);
+    bool     SendAlert(MicronetMessageFifo *messageFifo, uint32_t deviceId, uint32_t alertId);
+    bool     isAsyncSlotAvailable();
+    void     ScheduleNetworkCycle(MicronetMessageFifo *messageFifo, bool coasted);
+    uint32_t GetWakeupAdvance();
+    uint32_t UpdateCoasting(MicronetMessageFifo *messageFifo);
+    uint32_t UpdateSearch(MicronetMessageFifo *messageFifo);
+    void     SetSearchMode(SearchMode_t mode);
+    void     SetReceiver(MicronetMessageFifo *messageFifo, bool on, uint32_t time_us);
 };
 
 #endif /* MICRONETDEVICE_H_ */
@@ -50,10 +50,11 @@
 /*                              Functions                                  */
 /***************************************************************************/
 
-MicronetMessageFifo::MicronetMessageFifo() : fifoMutex(portMUX_INITIALIZER_UNLOCKED)
+MicronetMessageFifo::MicronetMessageFifo() : fifoMutex(portMUX_INITIALIZER_UNLOCKED), notificationTask(nullptr)
 {
     // Reset packet store
     memset(store, 0, sizeof(store));
+    memset(pushTime_us, 0, sizeof(pushTime_us));
     writeIndex = 0;
     readIndex  = 0;
     nbMessages = 0;
@@ -78,6 +79,7 @@ bool MicronetMessageFifo::Push(MicronetMessage_t const &message)
         store[writeIndex].startTime_us = message.startTime_us;
         store[writeIndex].endTime_us   = message.endTime_us;
         memcpy(store[writeIndex].data, message.data, message.len);
+        pushTime_us[writeIndex] = micros();
         writeIndex++;
         nbMessages++;
         if (writeIndex >= MESSAGE_STORE_SIZE)
@@ -92,6 +94,8 @@ bool MicronetMessageFifo::Push(MicronetMessage_t const &message)
     }
 
     portEXIT_CRITICAL(&fifoMutex);
+
+    NotifyTask();
     return true;
 }
 
@@ -107,6 +111,7 @@ bool MicronetMessageFifo::PushIsr(MicronetMessage_t const &message)
         store[writeIndex].startTime_us = message.startTime_us;
         store[writeIndex].endTime_us   = message.endTime_us;
         memcpy(store[writeIndex].data, message.data, message.len);
+        pushTime_us[writeIndex] = micros();
         writeIndex++;
         nbMessages++;
         if (writeIndex >= MESSAGE_STORE_SIZE)
@@ -119,11 +124,14 @@ bool MicronetMessageFifo::PushIsr(MicronetMessage_t const &message)
         return false;
     }
 
+    NotifyTask();
     return true;
 }
 
 bool MicronetMessageFifo::Pop(MicronetMessage_t *message)
 {
+    uint32_t pushTime;
+
     // Disable interrupts to avoid race conditions
     portENTER_CRITICAL(&fifoMutex);
 
@@ -132,6 +140,7 @@ bool MicronetMessageFifo::Pop(MicronetMessage_t *message)
     {
         // Yes : Copy message
         memcpy(message, &(store[readIndex]), sizeof(MicronetMessage_t));
+        pushTime = pushTime_us[readIndex];
         // Remove message from the store
         readIndex++;
         if (readIndex >= MESSAGE_STORE_SIZE)
@@ -147,6 +156,8 @@ bool MicronetMessageFifo::Pop(MicronetMessage_t *message)
     }
 
     portEXIT_CRITICAL(&fifoMutex);
+
+    dwellTime.Record(micros() - pushTime);
     return true;
 }
 
@@ -190,6 +201,9 @@ MicronetMessage_t *MicronetMessageFifo::Peek()
 
 void MicronetMessageFifo::DeleteMessage()
 {
+    bool     deleted = false;
+    uint32_t pushTime;
+
     // FIXME : use FreeRTOS spinlocks for multicore protection
     portENTER_CRITICAL(&fifoMutex);
 
@@ -197,6 +211,8 @@ void MicronetMessageFifo::DeleteMessage()
     if (nbMessages > 0)
     {
         // Yes : delete the next one
+        pushTime = pushTime_us[readIndex];
+        deleted  = true;
         nbMessages--;
         readIndex++;
         if (readIndex >= MESSAGE_STORE_SIZE)
@@ -206,6 +222,12 @@ void MicronetMessageFifo::DeleteMessage()
     }
 
     portEXIT_CRITICAL(&fifoMutex);
+
+    if (deleted)
+    {
+        // Time spent by the message in the store, including its processing
+        dwellTime.Record(micros() - pushTime);
+    }
 }
 
 void MicronetMessageFifo::ResetFifo()
@@ -220,3 +242,40 @@ int MicronetMessageFifo::GetNbMessages()
 {
     return nbMessages;
 }
+
+LatencyHistogram *MicronetMessageFifo::GetDwellTimeHistogram()
+{
+    return &dwellTime;
+}
+
+/*
+  Register the task to be notified each time a message is pushed into the FIFO.
+  @param taskHandle Handle of the task to wake-up, nullptr to disable notifications
+*/
+void MicronetMessageFifo::SetNotificationTask(TaskHandle_t taskHandle)
+{
+    notificationTask = taskHandle;
+}
+
+/*
+  Wake-up the registered task, if any. Push() is called from both task and ISR
+  contexts, so the right FreeRTOS primitive is selected at runtime.
+*/
+void MicronetMessageFifo::NotifyTask()
+{
+    TaskHandle_t taskHandle = notificationTask;
+
+    if (taskHandle != nullptr)
+    {
+        if (xPortInIsrContext())
+        {
+            BaseType_t scheduleChange = pdFALSE;
+            vTaskNotifyGiveFromISR(taskHandle, &scheduleChange);
+            portYIELD_FROM_ISR(scheduleChange);
+        }
+        else
+        {
+            xTaskNotifyGive(taskHandle);
+        }
+    }
+}
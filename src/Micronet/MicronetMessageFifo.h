@@ -31,6 +31,7 @@
 /*                              Includes                                   */
 /***************************************************************************/
 
+#include "LatencyHistogram.h"
 #include "Micronet.h"
 #include <Arduino.h>
 #include <stdint.h>
@@ -59,13 +60,20 @@ class MicronetMessageFifo
     void               DeleteMessage();
     void               ResetFifo();
     int                GetNbMessages();
+    LatencyHistogram  *GetDwellTimeHistogram();
+    void               SetNotificationTask(TaskHandle_t taskHandle);
 
   private:
     volatile int      writeIndex;
     volatile int      readIndex;
     volatile int      nbMessages;
     MicronetMessage_t store[MESSAGE_STORE_SIZE];
+    uint32_t          pushTime_us[MESSAGE_STORE_SIZE];
     portMUX_TYPE      fifoMutex;
+    LatencyHistogram  dwellTime;
+    TaskHandle_t      notificationTask;
+
+    void NotifyTask();
 };
 
 /***************************************************************************/
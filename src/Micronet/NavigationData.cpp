@@ -84,6 +84,9 @@ NavigationData::NavigationData()
     waypoint.valid      = false;
     vmgwp_kt.valid      = false;
     magHdg_deg.valid    = false;
+    roll_deg.valid      = false;
+    pitch_deg.valid     = false;
+    rot_degpmin.valid   = false;
 
     calibrationUpdated          = false;
     waterSpeedFactor_per        = 0.0f;
@@ -149,4 +152,10 @@ void NavigationData::UpdateValidity()
         vmgwp_kt.valid = false;
     if (currentTime - magHdg_deg.timeStamp > VALIDITY_TIME_FAST_MS)
         magHdg_deg.valid = false;
+    if (currentTime - roll_deg.timeStamp > VALIDITY_TIME_FAST_MS)
+        roll_deg.valid = false;
+    if (currentTime - pitch_deg.timeStamp > VALIDITY_TIME_FAST_MS)
+        pitch_deg.valid = false;
+    if (currentTime - rot_degpmin.timeStamp > VALIDITY_TIME_FAST_MS)
+        rot_degpmin.valid = false;
 }
@@ -48,6 +48,7 @@ typedef struct
     bool     valid;
     float    value;
     uint32_t timeStamp;
+    uint32_t rxTime_us; // micros() at the end of the RF frame which carried the value, used for latency tracing
 } FloatValue_t;
 
 typedef struct
@@ -110,7 +111,10 @@ class NavigationData
     WaypointName_t waypoint;
     FloatValue_t   vmgwp_kt;
 
-    FloatValue_t magHdg_deg; // Magnetic heading (includes heading offset but not magnetic variation or deviation)
+    FloatValue_t magHdg_deg;  // Magnetic heading (includes heading offset but not magnetic variation or deviation)
+    FloatValue_t roll_deg;    // Heel, positive to starboard
+    FloatValue_t pitch_deg;   // Pitch, positive bow up
+    FloatValue_t rot_degpmin; // Rate of turn, positive to starboard
 
     bool   calibrationUpdated;
     float  waterSpeedFactor_per;
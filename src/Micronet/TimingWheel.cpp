@@ -0,0 +1,194 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Timing wheel used to track expiration of timed entries        *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "TimingWheel.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+/*
+  Class constructor
+  @param resolution_ms Duration of one slot in milliseconds
+*/
+TimingWheel::TimingWheel(uint32_t resolution_ms) : resolution_ms(resolution_ms)
+{
+    Clear();
+}
+
+/*
+  Class destructor
+*/
+TimingWheel::~TimingWheel()
+{
+}
+
+/*
+  Remove all entries from the wheel
+*/
+void TimingWheel::Clear()
+{
+    for (int i = 0; i < TIMING_WHEEL_NB_SLOTS; i++)
+    {
+        slots[i] = -1;
+    }
+
+    // Chain all nodes in the free list
+    for (int i = 0; i < TIMING_WHEEL_MAX_NODES - 1; i++)
+    {
+        nodes[i].next = i + 1;
+    }
+    nodes[TIMING_WHEEL_MAX_NODES - 1].next = -1;
+
+    freeList     = 0;
+    nbNodes      = 0;
+    cursor       = 0;
+    wheelTime_ms = 0;
+}
+
+/*
+  Schedule the expiration of an entry
+  @param key Identifier of the entry, returned by PopExpired() when the entry expires
+  @param now_ms Current time in milliseconds
+  @param delay_ms Delay before expiration in milliseconds
+  @return false if the wheel is full
+*/
+bool TimingWheel::Schedule(uint32_t key, uint32_t now_ms, uint32_t delay_ms)
+{
+    if (freeList < 0)
+    {
+        return false;
+    }
+
+    // Empty wheel : restart time from now, no need to visit slots elapsed while idle
+    if (nbNodes == 0)
+    {
+        wheelTime_ms = now_ms;
+    }
+
+    int16_t index    = freeList;
+    freeList         = nodes[index].next;
+    nodes[index].key = key;
+    // An entry expires once its delay has fully elapsed
+    nodes[index].expiry_ms = now_ms + delay_ms + 1;
+    nbNodes++;
+
+    Insert(index);
+
+    return true;
+}
+
+/*
+  Get the next expired entry. Must be called until it returns false to process all expired entries.
+  @param now_ms Current time in milliseconds
+  @param key Pointer where to store the key of the expired entry
+  @return true if an expired entry has been found
+*/
+bool TimingWheel::PopExpired(uint32_t now_ms, uint32_t *key)
+{
+    if (nbNodes == 0)
+    {
+        wheelTime_ms = now_ms;
+        return false;
+    }
+
+    // Visit each slot whose time range has fully elapsed
+    while ((int32_t)(now_ms - (wheelTime_ms + resolution_ms)) >= 0)
+    {
+        int16_t index;
+
+        while ((index = slots[cursor]) >= 0)
+        {
+            slots[cursor] = nodes[index].next;
+
+            if ((int32_t)(nodes[index].expiry_ms - (wheelTime_ms + resolution_ms)) < 0)
+            {
+                // Entry has expired : release its node
+                *key              = nodes[index].key;
+                nodes[index].next = freeList;
+                freeList          = index;
+                nbNodes--;
+                return true;
+            }
+
+            // Entry was beyond horizon : move it to its actual slot
+            Insert(index);
+        }
+
+        cursor = (cursor + 1) % TIMING_WHEEL_NB_SLOTS;
+        wheelTime_ms += resolution_ms;
+    }
+
+    return false;
+}
+
+/*
+  Get the number of scheduled entries
+*/
+uint32_t TimingWheel::GetNbEntries()
+{
+    return nbNodes;
+}
+
+/*
+  Link a node into the slot of its expiration time
+  @param index Index of the node
+*/
+void TimingWheel::Insert(int16_t index)
+{
+    int32_t  delta_ms = (int32_t)(nodes[index].expiry_ms - wheelTime_ms);
+    uint32_t ticks    = (delta_ms < 0) ? 0 : delta_ms / resolution_ms;
+
+    if (ticks >= TIMING_WHEEL_NB_SLOTS)
+    {
+        ticks = TIMING_WHEEL_NB_SLOTS - 1;
+    }
+
+    uint32_t slot     = (cursor + ticks) % TIMING_WHEEL_NB_SLOTS;
+    nodes[index].next = slots[slot];
+    slots[slot]       = index;
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Timing wheel used to track expiration of timed entries        *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef TIMINGWHEEL_H_
+#define TIMINGWHEEL_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define TIMING_WHEEL_NB_SLOTS  64 // Number of slots of the wheel. Horizon is NB_SLOTS x resolution.
+#define TIMING_WHEEL_MAX_NODES 48 // Maximum number of entries scheduled at the same time
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef struct
+{
+    uint32_t key;
+    uint32_t expiry_ms;
+    int16_t  next;
+} WheelNode_t;
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  Entries are identified by a 32-bit key and hashed into the slot of their expiration time. Time only advances when
+  PopExpired() is called and each call only visits the slots elapsed since the previous one, so that the cost of
+  expiration processing is proportional to the number of entries reaching their deadline, not to the number of
+  scheduled entries. Entries beyond the horizon are parked in the last slot and rescheduled when it is reached.
+*/
+class TimingWheel
+{
+  public:
+    TimingWheel(uint32_t resolution_ms);
+    virtual ~TimingWheel();
+
+    void     Clear();
+    bool     Schedule(uint32_t key, uint32_t now_ms, uint32_t delay_ms);
+    bool     PopExpired(uint32_t now_ms, uint32_t *key);
+    uint32_t GetNbEntries();
+
+  private:
+    WheelNode_t nodes[TIMING_WHEEL_MAX_NODES];
+    int16_t     slots[TIMING_WHEEL_NB_SLOTS];
+    int16_t     freeList;
+    uint32_t    nbNodes;
+    uint32_t    resolution_ms;
+    uint32_t    cursor;
+    uint32_t    wheelTime_ms;
+
+    void Insert(int16_t index);
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* TIMINGWHEEL_H_ */
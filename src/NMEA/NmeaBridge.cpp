@@ -31,6 +31,7 @@
 #include "NmeaBridge.h"
 #include "BoardConfig.h"
 #include "Globals.h"
+#include "NmeaParser.h"
 
 #include <Arduino.h>
 #include <string.h>
@@ -39,6 +40,9 @@
 /*                              Constants                                  */
 /***************************************************************************/
 
+// Maximum age of the GNSS course used to learn compass deviation
+#define DEVIATION_MAX_COG_AGE_MS 2000
+
 const uint8_t NmeaBridge::asciiTable[128] = {
     ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',  ' ', ' ', ' ', ' ', ' ',  ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
     ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', '\"', ' ', ' ', '%', '&', '\'', ' ', ' ', ' ', '+', ' ', '-', '.', '/', '0', '1', '2', '3',
@@ -46,6 +50,10 @@ const uint8_t NmeaBridge::asciiTable[128] = {
     'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V',  'W', 'X', 'Y', 'Z', ' ',  ' ', ' ', ' ', ' ', ' ', 'A', '(', 'C', ')', 'E', 'F', 'G',
     'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',  'Q', 'R', 'S', 'T', 'U',  'V', 'W', 'X', 'Y', 'Z', ' ', ' ', ' ', ' ', ' '};
 
+char const *NmeaBridge::sentenceNames[NMEA_OUT_NB] = {"MWV(R)", "MWV(T)", "DPT", "MTW", "VLW", "VHW", "HDG", "XDR", "XDR(A)", "ROT", "HDT"};
+char const *NmeaBridge::sentenceIdNames[NMEA_ID_NB] = {"???", "RMB", "RMC", "GGA", "VTG", "MWV", "DPT", "VHW", "HDG", "VWR",
+                                                       "VWT", "MWD", "HDT", "ZDA", "GLL", "MTW", "VLW", "XDR", "ROT"};
+
 /***************************************************************************/
 /*                                Macros                                   */
 /***************************************************************************/
@@ -72,7 +80,14 @@ NmeaBridge::NmeaBridge(MicronetCodec *micronetCodec)
     nmeaExtBuffer[0]   = 0;
     nmeaGnssWriteIndex = 0;
     nmeaGnssBuffer[0]  = 0;
-    memset(&nmeaTimeStamps, 0, sizeof(nmeaTimeStamps));
+    memset(lastEmissionTime, 0, sizeof(lastEmissionTime));
+    // Spread initial emission times so that sentences with the same period do not fall in the same slot
+    for (int i = 0; i < NMEA_OUT_NB; i++)
+    {
+        nextEmissionTime[i] = i * NMEA_SCHEDULER_SLOT_MS;
+    }
+    lastSlotTime   = 0;
+    schedulerIndex = 0;
     this->micronetCodec = micronetCodec;
 }
 
@@ -128,9 +143,10 @@ void NmeaBridge::PushNmeaChar(char c, LinkId_t sourceLink)
                     if (sourceLink == gConfiguration.eeprom.gnssSource)
                     {
                         DecodeRMCSentence(nmeaBuffer);
+                        UpdateMagneticVariation();
                         if (sourceLink != LINK_NMEA_EXT)
                         {
-                            gConfiguration.ram.nmeaLink->println(nmeaBuffer);
+                            gNmeaMultiplexer.WriteSentence(sId, nmeaBuffer);
                         }
                     }
                     break;
@@ -138,9 +154,10 @@ void NmeaBridge::PushNmeaChar(char c, LinkId_t sourceLink)
                     if (sourceLink == gConfiguration.eeprom.gnssSource)
                     {
                         DecodeGGASentence(nmeaBuffer);
+                        UpdateMagneticVariation();
                         if (sourceLink != LINK_NMEA_EXT)
                         {
-                            gConfiguration.ram.nmeaLink->println(nmeaBuffer);
+                            gNmeaMultiplexer.WriteSentence(sId, nmeaBuffer);
                         }
                     }
                     break;
@@ -150,7 +167,7 @@ void NmeaBridge::PushNmeaChar(char c, LinkId_t sourceLink)
                         DecodeVTGSentence(nmeaBuffer);
                         if (sourceLink != LINK_NMEA_EXT)
                         {
-                            gConfiguration.ram.nmeaLink->println(nmeaBuffer);
+                            gNmeaMultiplexer.WriteSentence(sId, nmeaBuffer);
                         }
                     }
                     break;
@@ -178,6 +195,64 @@ void NmeaBridge::PushNmeaChar(char c, LinkId_t sourceLink)
                         DecodeHDGSentence(nmeaBuffer);
                     }
                     break;
+                case NMEA_ID_VWR:
+                    if (sourceLink == gConfiguration.eeprom.windSource)
+                    {
+                        DecodeVWRSentence(nmeaBuffer);
+                    }
+                    break;
+                case NMEA_ID_VWT:
+                    if (sourceLink == gConfiguration.eeprom.windSource)
+                    {
+                        DecodeVWTSentence(nmeaBuffer);
+                    }
+                    break;
+                case NMEA_ID_MWD:
+                    if (sourceLink == gConfiguration.eeprom.windSource)
+                    {
+                        DecodeMWDSentence(nmeaBuffer);
+                    }
+                    break;
+                case NMEA_ID_HDT:
+                    if (sourceLink == gConfiguration.eeprom.compassSource)
+                    {
+                        DecodeHDTSentence(nmeaBuffer);
+                    }
+                    break;
+                case NMEA_ID_ZDA:
+                    if (sourceLink == gConfiguration.eeprom.gnssSource)
+                    {
+                        DecodeZDASentence(nmeaBuffer);
+                        UpdateMagneticVariation();
+                        if (sourceLink != LINK_NMEA_EXT)
+                        {
+                            gNmeaMultiplexer.WriteSentence(sId, nmeaBuffer);
+                        }
+                    }
+                    break;
+                case NMEA_ID_GLL:
+                    if (sourceLink == gConfiguration.eeprom.gnssSource)
+                    {
+                        DecodeGLLSentence(nmeaBuffer);
+                        UpdateMagneticVariation();
+                        if (sourceLink != LINK_NMEA_EXT)
+                        {
+                            gNmeaMultiplexer.WriteSentence(sId, nmeaBuffer);
+                        }
+                    }
+                    break;
+                case NMEA_ID_MTW:
+                    if (sourceLink == gConfiguration.eeprom.speedSource)
+                    {
+                        DecodeMTWSentence(nmeaBuffer);
+                    }
+                    break;
+                case NMEA_ID_VLW:
+                    if (sourceLink == gConfiguration.eeprom.speedSource)
+                    {
+                        DecodeVLWSentence(nmeaBuffer);
+                    }
+                    break;
                 default:
                     break;
                 }
@@ -202,31 +277,78 @@ void NmeaBridge::PushNmeaChar(char c, LinkId_t sourceLink)
     }
 }
 
-void NmeaBridge::UpdateCompassData(float heading_deg)
+void NmeaBridge::UpdateCompassData(float heading_deg, float roll_deg, float pitch_deg, float rot_degpmin)
 {
+    // Attitude and rate of turn are only provided by the navigation compass, whatever the heading source
+    micronetCodec->navData.roll_deg.value        = roll_deg;
+    micronetCodec->navData.roll_deg.valid        = true;
+    micronetCodec->navData.roll_deg.timeStamp    = millis();
+    micronetCodec->navData.roll_deg.rxTime_us    = micros();
+    micronetCodec->navData.pitch_deg.value       = pitch_deg;
+    micronetCodec->navData.pitch_deg.valid       = true;
+    micronetCodec->navData.pitch_deg.timeStamp   = millis();
+    micronetCodec->navData.pitch_deg.rxTime_us   = micros();
+    micronetCodec->navData.rot_degpmin.value     = rot_degpmin;
+    micronetCodec->navData.rot_degpmin.valid     = true;
+    micronetCodec->navData.rot_degpmin.timeStamp = millis();
+    micronetCodec->navData.rot_degpmin.rxTime_us = micros();
+
     if (gConfiguration.eeprom.compassSource == LINK_COMPASS)
     {
         if (heading_deg < 0.0f)
             heading_deg += 360.0f;
         if (heading_deg >= 360.0f)
             heading_deg -= 360.0f;
+
+        // Learn deviation from the magnetic course over ground, then correct heading with it
+        FloatValue_t *cog = &micronetCodec->navData.cog_deg;
+        FloatValue_t *sog = &micronetCodec->navData.sog_kt;
+        if (cog->valid && sog->valid && (millis() - cog->timeStamp < DEVIATION_MAX_COG_AGE_MS))
+        {
+            deviationTable.Learn(heading_deg, cog->value - GetMagneticVariation(), sog->value, rot_degpmin);
+        }
+        heading_deg += deviationTable.GetDeviation(heading_deg);
+        if (heading_deg < 0.0f)
+            heading_deg += 360.0f;
+        if (heading_deg >= 360.0f)
+            heading_deg -= 360.0f;
+
         micronetCodec->navData.magHdg_deg.value     = heading_deg;
         micronetCodec->navData.magHdg_deg.valid     = true;
         micronetCodec->navData.magHdg_deg.timeStamp = millis();
-        EncodeHDG();
+        micronetCodec->navData.magHdg_deg.rxTime_us = micros();
+        if (gConfiguration.eeprom.lowLatency && (gConfiguration.eeprom.nmeaPeriod_ms[NMEA_OUT_HDG] != 0))
+        {
+            EncodeHDG();
+        }
+        if (gConfiguration.eeprom.lowLatency && (gConfiguration.eeprom.nmeaPeriod_ms[NMEA_OUT_HDT] != 0))
+        {
+            EncodeHDT();
+        }
     }
 }
 
+// Called each time Micronet data may have been updated by a received frame
 void NmeaBridge::UpdateMicronetData()
 {
-    EncodeMWV_R();
-    EncodeMWV_T();
-    EncodeDPT();
-    EncodeMTW();
-    EncodeVLW();
-    EncodeVHW();
-    EncodeHDG();
-    EncodeXDR();
+    if (gConfiguration.eeprom.lowLatency)
+    {
+        // Heading & wind are sent right away, bypassing the scheduler
+        if (gConfiguration.eeprom.compassSource == LINK_MICRONET)
+        {
+            EncodeImmediate(NMEA_OUT_HDG);
+            EncodeImmediate(NMEA_OUT_HDT);
+        }
+        EncodeImmediate(NMEA_OUT_MWV_R);
+        EncodeImmediate(NMEA_OUT_MWV_T);
+    }
+
+    RunScheduler();
+}
+
+void NmeaBridge::Yield()
+{
+    RunScheduler();
 }
 
 bool NmeaBridge::IsSentenceValid(char *nmeaBuffer)
@@ -295,6 +417,38 @@ NmeaId_t NmeaBridge::SentenceId(char *nmeaBuffer)
         // HDG sentence
         nmeaSentence = NMEA_ID_HDG;
         break;
+    case 0x565752:
+        // VWR sentence
+        nmeaSentence = NMEA_ID_VWR;
+        break;
+    case 0x565754:
+        // VWT sentence
+        nmeaSentence = NMEA_ID_VWT;
+        break;
+    case 0x4D5744:
+        // MWD sentence
+        nmeaSentence = NMEA_ID_MWD;
+        break;
+    case 0x484454:
+        // HDT sentence
+        nmeaSentence = NMEA_ID_HDT;
+        break;
+    case 0x5A4441:
+        // ZDA sentence
+        nmeaSentence = NMEA_ID_ZDA;
+        break;
+    case 0x474C4C:
+        // GLL sentence
+        nmeaSentence = NMEA_ID_GLL;
+        break;
+    case 0x4D5457:
+        // MTW sentence
+        nmeaSentence = NMEA_ID_MTW;
+        break;
+    case 0x564C57:
+        // VLW sentence
+        nmeaSentence = NMEA_ID_VLW;
+        break;
     }
 
     return nmeaSentence;
@@ -700,7 +854,7 @@ void NmeaBridge::DecodeVHWSentence(char *sentence)
     sentence++;
     if (!hasMagHeading && hasTrueHeading)
     {
-        value = trueHeading - micronetCodec->navData.magneticVariation_deg;
+        value = trueHeading - GetMagneticVariation();
         hasMagHeading = true;
     }
     if ((sentence[0] == 'M') && hasMagHeading)
@@ -744,6 +898,282 @@ void NmeaBridge::DecodeHDGSentence(char *sentence)
     micronetCodec->navData.magHdg_deg.timeStamp = millis();
 }
 
+void NmeaBridge::DecodeVWRSentence(char *sentence)
+{
+    float value;
+    float awa = -9999.0;
+    float aws;
+
+    sentence += 7;
+
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        awa = value;
+    }
+    if ((sentence = strchr(sentence, ',')) == nullptr)
+        return;
+    sentence++;
+    if (awa > -9000.0)
+    {
+        // VWR gives the angle from 0 to 180 degrees, L/R indicating the side
+        if (sentence[0] == 'L')
+            awa = -awa;
+        else if (sentence[0] != 'R')
+            return;
+        micronetCodec->navData.awa_deg.value     = awa;
+        micronetCodec->navData.awa_deg.valid     = true;
+        micronetCodec->navData.awa_deg.timeStamp = millis();
+    }
+    if ((sentence = strchr(sentence, ',')) == nullptr)
+        return;
+    sentence++;
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        aws = value;
+    }
+    else
+    {
+        // No speed in knots, try with m/s
+        for (int i = 0; i < 2; i++)
+        {
+            if ((sentence = strchr(sentence, ',')) == nullptr)
+                return;
+            sentence++;
+        }
+        if (sscanf(sentence, "%f", &value) != 1)
+            return;
+        aws = value * 1.943844;
+    }
+
+    micronetCodec->navData.aws_kt.value     = aws;
+    micronetCodec->navData.aws_kt.valid     = true;
+    micronetCodec->navData.aws_kt.timeStamp = millis();
+    micronetCodec->CalculateTrueWind();
+}
+
+void NmeaBridge::DecodeVWTSentence(char *sentence)
+{
+    float value;
+    float twa = -9999.0;
+    float tws;
+
+    sentence += 7;
+
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        twa = value;
+    }
+    if ((sentence = strchr(sentence, ',')) == nullptr)
+        return;
+    sentence++;
+    if (twa > -9000.0)
+    {
+        // VWT gives the angle from 0 to 180 degrees, L/R indicating the side
+        if (sentence[0] == 'L')
+            twa = -twa;
+        else if (sentence[0] != 'R')
+            return;
+        micronetCodec->navData.twa_deg.value     = twa;
+        micronetCodec->navData.twa_deg.valid     = true;
+        micronetCodec->navData.twa_deg.timeStamp = millis();
+    }
+    if ((sentence = strchr(sentence, ',')) == nullptr)
+        return;
+    sentence++;
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        tws = value;
+    }
+    else
+    {
+        // No speed in knots, try with m/s
+        for (int i = 0; i < 2; i++)
+        {
+            if ((sentence = strchr(sentence, ',')) == nullptr)
+                return;
+            sentence++;
+        }
+        if (sscanf(sentence, "%f", &value) != 1)
+            return;
+        tws = value * 1.943844;
+    }
+
+    micronetCodec->navData.tws_kt.value     = tws;
+    micronetCodec->navData.tws_kt.valid     = true;
+    micronetCodec->navData.tws_kt.timeStamp = millis();
+}
+
+void NmeaBridge::DecodeMWDSentence(char *sentence)
+{
+    float value;
+    float twd       = -9999.0;
+    bool  hasMagDir = false;
+
+    sentence += 7;
+
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        // True direction, converted to magnetic
+        twd = value - GetMagneticVariation();
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if ((sentence = strchr(sentence, ',')) == nullptr)
+            return;
+        sentence++;
+    }
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        twd       = value;
+        hasMagDir = true;
+    }
+    if ((sentence = strchr(sentence, ',')) == nullptr)
+        return;
+    sentence++;
+    if (hasMagDir && (sentence[0] != 'M'))
+        return;
+
+    // Wind direction is relative to north, TWA can only be derived with a valid heading
+    if ((twd > -9000.0) && micronetCodec->navData.magHdg_deg.valid)
+    {
+        float twa = twd - micronetCodec->navData.magHdg_deg.value;
+        if (twa > 180.0f)
+            twa -= 360.0f;
+        if (twa < -180.0f)
+            twa += 360.0f;
+        micronetCodec->navData.twa_deg.value     = twa;
+        micronetCodec->navData.twa_deg.valid     = true;
+        micronetCodec->navData.twa_deg.timeStamp = millis();
+    }
+
+    if ((sentence = strchr(sentence, ',')) == nullptr)
+        return;
+    sentence++;
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        micronetCodec->navData.tws_kt.value     = value;
+        micronetCodec->navData.tws_kt.valid     = true;
+        micronetCodec->navData.tws_kt.timeStamp = millis();
+    }
+}
+
+void NmeaBridge::DecodeHDTSentence(char *sentence)
+{
+    float value;
+
+    sentence += 7;
+
+    if (sscanf(sentence, "%f", &value) != 1)
+        return;
+    value -= GetMagneticVariation();
+    if (value < 0)
+        value += 360.0f;
+    if (value >= 360.0)
+        value -= 360.0f;
+    micronetCodec->navData.magHdg_deg.value     = value;
+    micronetCodec->navData.magHdg_deg.valid     = true;
+    micronetCodec->navData.magHdg_deg.timeStamp = millis();
+}
+
+void NmeaBridge::DecodeZDASentence(char *sentence)
+{
+    sentence += 7;
+
+    if (sentence[0] != ',')
+    {
+        micronetCodec->navData.time.hour      = (sentence[0] - '0') * 10 + (sentence[1] - '0');
+        micronetCodec->navData.time.minute    = (sentence[2] - '0') * 10 + (sentence[3] - '0');
+        micronetCodec->navData.time.valid     = true;
+        micronetCodec->navData.time.timeStamp = millis();
+    }
+    if ((sentence = strchr(sentence, ',')) == nullptr)
+        return;
+    sentence++;
+
+    int day, month, year;
+    if (sscanf(sentence, "%d,%d,%d", &day, &month, &year) == 3)
+    {
+        micronetCodec->navData.date.day       = day;
+        micronetCodec->navData.date.month     = month;
+        micronetCodec->navData.date.year      = year % 100;
+        micronetCodec->navData.date.valid     = true;
+        micronetCodec->navData.date.timeStamp = millis();
+    }
+}
+
+void NmeaBridge::DecodeGLLSentence(char *sentence)
+{
+    NmeaGLL_t gll;
+
+    if (!NmeaParser::ParseGLL(sentence, &gll))
+        return;
+
+    if (gll.latitudeValid)
+    {
+        micronetCodec->navData.latitude_deg.value     = gll.latitude_deg;
+        micronetCodec->navData.latitude_deg.valid     = true;
+        micronetCodec->navData.latitude_deg.timeStamp = millis();
+    }
+    if (gll.longitudeValid)
+    {
+        micronetCodec->navData.longitude_deg.value     = gll.longitude_deg;
+        micronetCodec->navData.longitude_deg.valid     = true;
+        micronetCodec->navData.longitude_deg.timeStamp = millis();
+    }
+    if (gll.timeValid)
+    {
+        micronetCodec->navData.time.hour      = gll.hour;
+        micronetCodec->navData.time.minute    = gll.minute;
+        micronetCodec->navData.time.valid     = true;
+        micronetCodec->navData.time.timeStamp = millis();
+    }
+}
+
+void NmeaBridge::DecodeMTWSentence(char *sentence)
+{
+    float value;
+
+    sentence += 7;
+
+    if (sscanf(sentence, "%f", &value) != 1)
+        return;
+    if ((sentence = strchr(sentence, ',')) == nullptr)
+        return;
+    sentence++;
+    if (sentence[0] == 'C')
+    {
+        micronetCodec->navData.stp_degc.value     = value;
+        micronetCodec->navData.stp_degc.valid     = true;
+        micronetCodec->navData.stp_degc.timeStamp = millis();
+    }
+}
+
+void NmeaBridge::DecodeVLWSentence(char *sentence)
+{
+    float value;
+
+    sentence += 7;
+
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        micronetCodec->navData.log_nm.value     = value;
+        micronetCodec->navData.log_nm.valid     = true;
+        micronetCodec->navData.log_nm.timeStamp = millis();
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if ((sentence = strchr(sentence, ',')) == nullptr)
+            return;
+        sentence++;
+    }
+    if (sscanf(sentence, "%f", &value) == 1)
+    {
+        micronetCodec->navData.trip_nm.value     = value;
+        micronetCodec->navData.trip_nm.valid     = true;
+        micronetCodec->navData.trip_nm.timeStamp = millis();
+    }
+}
+
 int16_t NmeaBridge::NibbleValue(char c)
 {
     if ((c >= '0') && (c <= '9'))
@@ -762,14 +1192,45 @@ int16_t NmeaBridge::NibbleValue(char c)
     return -1;
 }
 
-void NmeaBridge::EncodeMWV_R()
+// Compute magnetic variation from GNSS position and date with the World Magnetic Model. The model is only evaluated
+// again when the boat moved significantly, so that this can be called on each received position.
+void NmeaBridge::UpdateMagneticVariation()
+{
+    NavigationData *navData = &micronetCodec->navData;
+
+    if (!gConfiguration.eeprom.autoMagVariation)
+    {
+        return;
+    }
+
+    if (navData->latitude_deg.valid && navData->longitude_deg.valid && navData->date.valid)
+    {
+        float year = 2000.0f + navData->date.year + (navData->date.month - 1) / 12.0f + (navData->date.day - 1) / 365.0f;
+        magneticModel.Update(navData->latitude_deg.value, navData->longitude_deg.value, year);
+    }
+}
+
+// Get the magnetic variation to be used for true/magnetic conversions. The model output is kept apart from the manual
+// variation of the calibration, which is the one saved to EEPROM.
+// @return Magnetic variation in degrees, positive east
+float NmeaBridge::GetMagneticVariation()
+{
+    if (gConfiguration.eeprom.autoMagVariation && magneticModel.IsValid())
+    {
+        return magneticModel.GetVariation();
+    }
+
+    return micronetCodec->navData.magneticVariation_deg;
+}
+
+bool NmeaBridge::EncodeMWV_R()
 {
     if (gConfiguration.eeprom.windSource == LINK_MICRONET)
     {
         bool update;
 
-        update = (micronetCodec->navData.awa_deg.timeStamp > nmeaTimeStamps.vwr + NMEA_SENTENCE_MIN_PERIOD_MS);
-        update = update && (micronetCodec->navData.aws_kt.timeStamp > nmeaTimeStamps.vwr + NMEA_SENTENCE_MIN_PERIOD_MS);
+        update = (micronetCodec->navData.awa_deg.timeStamp > lastEmissionTime[NMEA_OUT_MWV_R]);
+        update = update && (micronetCodec->navData.aws_kt.timeStamp > lastEmissionTime[NMEA_OUT_MWV_R]);
         update = update && (micronetCodec->navData.awa_deg.valid && micronetCodec->navData.aws_kt.valid);
 
         if (update)
@@ -780,20 +1241,23 @@ void NmeaBridge::EncodeMWV_R()
                 absAwa += 360.0f;
             sprintf(sentence, "$INMWV,%.1f,R,%.1f,N,A", absAwa, micronetCodec->navData.aws_kt.value);
             AddNmeaChecksum(sentence);
-            nmeaTimeStamps.vwr = millis();
-            gConfiguration.ram.nmeaLink->println(sentence);
+            lastEmissionTime[NMEA_OUT_MWV_R] = millis();
+            gNmeaMultiplexer.WriteSentence(NMEA_ID_MWV, sentence, NMEA_OUT_MWV_R, micronetCodec->navData.awa_deg.rxTime_us);
+            return true;
         }
     }
+
+    return false;
 }
 
-void NmeaBridge::EncodeMWV_T()
+bool NmeaBridge::EncodeMWV_T()
 {
     if (gConfiguration.eeprom.windSource == LINK_MICRONET)
     {
         bool update;
 
-        update = (micronetCodec->navData.twa_deg.timeStamp > nmeaTimeStamps.vwt + NMEA_SENTENCE_MIN_PERIOD_MS);
-        update = update && (micronetCodec->navData.tws_kt.timeStamp > nmeaTimeStamps.vwt + NMEA_SENTENCE_MIN_PERIOD_MS);
+        update = (micronetCodec->navData.twa_deg.timeStamp > lastEmissionTime[NMEA_OUT_MWV_T]);
+        update = update && (micronetCodec->navData.tws_kt.timeStamp > lastEmissionTime[NMEA_OUT_MWV_T]);
         update = update && (micronetCodec->navData.twa_deg.valid && micronetCodec->navData.tws_kt.valid);
 
         if (update)
@@ -804,19 +1268,22 @@ void NmeaBridge::EncodeMWV_T()
                 absTwa += 360.0f;
             sprintf(sentence, "$INMWV,%.1f,T,%.1f,N,A", absTwa, micronetCodec->navData.tws_kt.value);
             AddNmeaChecksum(sentence);
-            nmeaTimeStamps.vwt = millis();
-            gConfiguration.ram.nmeaLink->println(sentence);
+            lastEmissionTime[NMEA_OUT_MWV_T] = millis();
+            gNmeaMultiplexer.WriteSentence(NMEA_ID_MWV, sentence, NMEA_OUT_MWV_T, micronetCodec->navData.twa_deg.rxTime_us);
+            return true;
         }
     }
+
+    return false;
 }
 
-void NmeaBridge::EncodeDPT()
+bool NmeaBridge::EncodeDPT()
 {
     if (gConfiguration.eeprom.depthSource == LINK_MICRONET)
     {
         bool update;
 
-        update = (micronetCodec->navData.dpt_m.timeStamp > nmeaTimeStamps.dpt + NMEA_SENTENCE_MIN_PERIOD_MS);
+        update = (micronetCodec->navData.dpt_m.timeStamp > lastEmissionTime[NMEA_OUT_DPT]);
         update = update && micronetCodec->navData.dpt_m.valid;
 
         if (update)
@@ -824,19 +1291,22 @@ void NmeaBridge::EncodeDPT()
             char sentence[NMEA_SENTENCE_MAX_LENGTH];
             sprintf(sentence, "$INDPT,%.1f,%.1f,", micronetCodec->navData.dpt_m.value, micronetCodec->navData.depthOffset_m);
             AddNmeaChecksum(sentence);
-            nmeaTimeStamps.dpt = millis();
-            gConfiguration.ram.nmeaLink->println(sentence);
+            lastEmissionTime[NMEA_OUT_DPT] = millis();
+            gNmeaMultiplexer.WriteSentence(NMEA_ID_DPT, sentence, NMEA_OUT_DPT, micronetCodec->navData.dpt_m.rxTime_us);
+            return true;
         }
     }
+
+    return false;
 }
 
-void NmeaBridge::EncodeMTW()
+bool NmeaBridge::EncodeMTW()
 {
     if (gConfiguration.eeprom.speedSource == LINK_MICRONET)
     {
         bool update;
 
-        update = (micronetCodec->navData.stp_degc.timeStamp > (nmeaTimeStamps.mtw + NMEA_SENTENCE_MIN_PERIOD_MS));
+        update = (micronetCodec->navData.stp_degc.timeStamp > lastEmissionTime[NMEA_OUT_MTW]);
         update = update && micronetCodec->navData.stp_degc.valid;
 
         if (update)
@@ -844,20 +1314,23 @@ void NmeaBridge::EncodeMTW()
             char sentence[NMEA_SENTENCE_MAX_LENGTH];
             sprintf(sentence, "$INMTW,%.1f,C", micronetCodec->navData.stp_degc.value);
             AddNmeaChecksum(sentence);
-            nmeaTimeStamps.mtw = millis();
-            gConfiguration.ram.nmeaLink->println(sentence);
+            lastEmissionTime[NMEA_OUT_MTW] = millis();
+            gNmeaMultiplexer.WriteSentence(NMEA_ID_MTW, sentence, NMEA_OUT_MTW, micronetCodec->navData.stp_degc.rxTime_us);
+            return true;
         }
     }
+
+    return false;
 }
 
-void NmeaBridge::EncodeVLW()
+bool NmeaBridge::EncodeVLW()
 {
     if (gConfiguration.eeprom.speedSource == LINK_MICRONET)
     {
         bool update;
 
-        update = (micronetCodec->navData.log_nm.timeStamp > nmeaTimeStamps.vlw + NMEA_SENTENCE_MIN_PERIOD_MS);
-        update = update && (micronetCodec->navData.trip_nm.timeStamp > nmeaTimeStamps.vlw + NMEA_SENTENCE_MIN_PERIOD_MS);
+        update = (micronetCodec->navData.log_nm.timeStamp > lastEmissionTime[NMEA_OUT_VLW]);
+        update = update && (micronetCodec->navData.trip_nm.timeStamp > lastEmissionTime[NMEA_OUT_VLW]);
         update = update && (micronetCodec->navData.log_nm.valid && micronetCodec->navData.trip_nm.valid);
 
         if (update)
@@ -865,25 +1338,28 @@ void NmeaBridge::EncodeVLW()
             char sentence[NMEA_SENTENCE_MAX_LENGTH];
             sprintf(sentence, "$INVLW,%.1f,N,%.1f,N,,N,,N", micronetCodec->navData.log_nm.value, micronetCodec->navData.trip_nm.value);
             AddNmeaChecksum(sentence);
-            nmeaTimeStamps.vlw = millis();
-            gConfiguration.ram.nmeaLink->println(sentence);
+            lastEmissionTime[NMEA_OUT_VLW] = millis();
+            gNmeaMultiplexer.WriteSentence(NMEA_ID_VLW, sentence, NMEA_OUT_VLW, micronetCodec->navData.log_nm.rxTime_us);
+            return true;
         }
     }
+
+    return false;
 }
 
-void NmeaBridge::EncodeVHW()
+bool NmeaBridge::EncodeVHW()
 {
     if (gConfiguration.eeprom.speedSource == LINK_MICRONET)
     {
         bool update =
-            (micronetCodec->navData.spd_kt.timeStamp > nmeaTimeStamps.vhw + NMEA_SENTENCE_MIN_PERIOD_MS) && (micronetCodec->navData.spd_kt.valid);
+            (micronetCodec->navData.spd_kt.timeStamp > lastEmissionTime[NMEA_OUT_VHW]) && (micronetCodec->navData.spd_kt.valid);
 
         if (update)
         {
             char sentence[NMEA_SENTENCE_MAX_LENGTH];
             if ((micronetCodec->navData.magHdg_deg.valid) && (micronetCodec->navData.spd_kt.valid))
             {
-                float trueHeading = micronetCodec->navData.magHdg_deg.value + micronetCodec->navData.magneticVariation_deg;
+                float trueHeading = micronetCodec->navData.magHdg_deg.value + GetMagneticVariation();
                 if (trueHeading < 0.0f)
                 {
                     trueHeading += 360.0f;
@@ -900,37 +1376,45 @@ void NmeaBridge::EncodeVHW()
                 sprintf(sentence, "$INVHW,,T,,M,%.1f,N,,K", micronetCodec->navData.spd_kt.value);
             }
             AddNmeaChecksum(sentence);
-            nmeaTimeStamps.vhw = millis();
-            gConfiguration.ram.nmeaLink->println(sentence);
+            lastEmissionTime[NMEA_OUT_VHW] = millis();
+            gNmeaMultiplexer.WriteSentence(NMEA_ID_VHW, sentence, NMEA_OUT_VHW, micronetCodec->navData.spd_kt.rxTime_us);
+            return true;
         }
     }
+
+    return false;
 }
 
-void NmeaBridge::EncodeHDG()
+bool NmeaBridge::EncodeHDG()
 {
     if ((gConfiguration.eeprom.compassSource == LINK_MICRONET) || (gConfiguration.eeprom.compassSource == LINK_COMPASS))
     {
         bool update;
 
-        update = (micronetCodec->navData.magHdg_deg.timeStamp > nmeaTimeStamps.hdg + NMEA_SENTENCE_MIN_PERIOD_MS);
+        update = (micronetCodec->navData.magHdg_deg.timeStamp > lastEmissionTime[NMEA_OUT_HDG]);
         update = update && micronetCodec->navData.magHdg_deg.valid;
 
         if (update)
         {
-            char sentence[NMEA_SENTENCE_MAX_LENGTH];
-            sprintf(sentence, "$INHDG,%.1f,0,E,%.1f,%c", micronetCodec->navData.magHdg_deg.value, fabsf(micronetCodec->navData.magneticVariation_deg),
-                    (micronetCodec->navData.magneticVariation_deg < 0.0f) ? 'W' : 'E');
+            char  sentence[NMEA_SENTENCE_MAX_LENGTH];
+            float variation_deg = GetMagneticVariation();
+            sprintf(sentence, "$INHDG,%.1f,0,E,%.1f,%c", micronetCodec->navData.magHdg_deg.value, fabsf(variation_deg),
+                    (variation_deg < 0.0f) ? 'W' : 'E');
             AddNmeaChecksum(sentence);
-            nmeaTimeStamps.hdg = millis();
-            gConfiguration.ram.nmeaLink->println(sentence);
+            lastEmissionTime[NMEA_OUT_HDG] = millis();
+            gNmeaMultiplexer.WriteSentence(NMEA_ID_HDG, sentence, NMEA_OUT_HDG, micronetCodec->navData.magHdg_deg.rxTime_us);
+            return true;
         }
     }
+
+    return false;
 }
-void NmeaBridge::EncodeXDR()
+
+bool NmeaBridge::EncodeXDR()
 {
     bool update;
 
-    update = (micronetCodec->navData.vcc_v.timeStamp > nmeaTimeStamps.vcc + NMEA_SENTENCE_MIN_PERIOD_MS);
+    update = (micronetCodec->navData.vcc_v.timeStamp > lastEmissionTime[NMEA_OUT_XDR]);
     update = update && micronetCodec->navData.vcc_v.valid;
 
     if (update)
@@ -938,9 +1422,194 @@ void NmeaBridge::EncodeXDR()
         char sentence[NMEA_SENTENCE_MAX_LENGTH];
         sprintf(sentence, "$INXDR,U,%.1f,V,TACKTICK", micronetCodec->navData.vcc_v.value);
         AddNmeaChecksum(sentence);
-        nmeaTimeStamps.vcc = millis();
-        gConfiguration.ram.nmeaLink->println(sentence);
+        lastEmissionTime[NMEA_OUT_XDR] = millis();
+        gNmeaMultiplexer.WriteSentence(NMEA_ID_XDR, sentence, NMEA_OUT_XDR, micronetCodec->navData.vcc_v.rxTime_us);
+        return true;
+    }
+
+    return false;
+}
+
+bool NmeaBridge::EncodeXDR_A()
+{
+    bool update;
+
+    update = (micronetCodec->navData.roll_deg.timeStamp > lastEmissionTime[NMEA_OUT_XDR_A]);
+    update = update && micronetCodec->navData.roll_deg.valid && micronetCodec->navData.pitch_deg.valid;
+
+    if (update)
+    {
+        char sentence[NMEA_SENTENCE_MAX_LENGTH];
+        sprintf(sentence, "$INXDR,A,%.1f,D,PTCH,A,%.1f,D,ROLL", micronetCodec->navData.pitch_deg.value, micronetCodec->navData.roll_deg.value);
+        AddNmeaChecksum(sentence);
+        lastEmissionTime[NMEA_OUT_XDR_A] = millis();
+        gNmeaMultiplexer.WriteSentence(NMEA_ID_XDR, sentence, NMEA_OUT_XDR_A, micronetCodec->navData.roll_deg.rxTime_us);
+        return true;
+    }
+
+    return false;
+}
+
+bool NmeaBridge::EncodeROT()
+{
+    bool update;
+
+    update = (micronetCodec->navData.rot_degpmin.timeStamp > lastEmissionTime[NMEA_OUT_ROT]);
+    update = update && micronetCodec->navData.rot_degpmin.valid;
+
+    if (update)
+    {
+        char sentence[NMEA_SENTENCE_MAX_LENGTH];
+        sprintf(sentence, "$INROT,%.1f,A", micronetCodec->navData.rot_degpmin.value);
+        AddNmeaChecksum(sentence);
+        lastEmissionTime[NMEA_OUT_ROT] = millis();
+        gNmeaMultiplexer.WriteSentence(NMEA_ID_ROT, sentence, NMEA_OUT_ROT, micronetCodec->navData.rot_degpmin.rxTime_us);
+        return true;
+    }
+
+    return false;
+}
+
+bool NmeaBridge::EncodeHDT()
+{
+    if ((gConfiguration.eeprom.compassSource == LINK_MICRONET) || (gConfiguration.eeprom.compassSource == LINK_COMPASS))
+    {
+        bool update;
+
+        update = (micronetCodec->navData.magHdg_deg.timeStamp > lastEmissionTime[NMEA_OUT_HDT]);
+        update = update && micronetCodec->navData.magHdg_deg.valid;
+        // True heading is only meaningful once the variation is known
+        update = update && (!gConfiguration.eeprom.autoMagVariation || magneticModel.IsValid());
+
+        if (update)
+        {
+            char  sentence[NMEA_SENTENCE_MAX_LENGTH];
+            float trueHeading = micronetCodec->navData.magHdg_deg.value + GetMagneticVariation();
+            if (trueHeading < 0.0f)
+            {
+                trueHeading += 360.0f;
+            }
+            if (trueHeading >= 360.0f)
+            {
+                trueHeading -= 360.0f;
+            }
+            sprintf(sentence, "$INHDT,%.1f,T", trueHeading);
+            AddNmeaChecksum(sentence);
+            lastEmissionTime[NMEA_OUT_HDT] = millis();
+            gNmeaMultiplexer.WriteSentence(NMEA_ID_HDT, sentence, NMEA_OUT_HDT, micronetCodec->navData.magHdg_deg.rxTime_us);
+            return true;
+        }
     }
+
+    return false;
+}
+
+// Output scheduler : emit at most one sentence per slot, choosing in round robin among the sentences whose period has
+// elapsed and which have fresh data. This spreads the sentences over time instead of sending them all at once after each
+// Micronet cycle.
+void NmeaBridge::RunScheduler()
+{
+    uint32_t now = millis();
+
+    if ((now - lastSlotTime) < NMEA_SCHEDULER_SLOT_MS)
+    {
+        return;
+    }
+
+    for (uint32_t n = 0; n < NMEA_OUT_NB; n++)
+    {
+        uint32_t sentence = (schedulerIndex + n) % NMEA_OUT_NB;
+        uint16_t period   = gConfiguration.eeprom.nmeaPeriod_ms[sentence];
+
+        if ((period == 0) || ((int32_t)(now - nextEmissionTime[sentence]) < 0))
+        {
+            continue;
+        }
+
+        if (EncodeSentence(sentence))
+        {
+            // Keep the phase of the sentence unless it is late by more than one period
+            nextEmissionTime[sentence] += period;
+            if ((int32_t)(now - nextEmissionTime[sentence]) >= 0)
+            {
+                nextEmissionTime[sentence] = now + period;
+            }
+            lastSlotTime   = now;
+            schedulerIndex = sentence + 1;
+            return;
+        }
+    }
+}
+
+// Emit a sentence without waiting for its scheduler slot
+void NmeaBridge::EncodeImmediate(uint32_t sentence)
+{
+    if (gConfiguration.eeprom.nmeaPeriod_ms[sentence] != 0)
+    {
+        EncodeSentence(sentence);
+    }
+}
+
+DeviationTable *NmeaBridge::GetDeviationTable()
+{
+    return &deviationTable;
+}
+
+MagneticModel *NmeaBridge::GetMagneticModel()
+{
+    return &magneticModel;
+}
+
+char const *NmeaBridge::GetSentenceName(uint32_t sentence)
+{
+    if (sentence < NMEA_OUT_NB)
+    {
+        return sentenceNames[sentence];
+    }
+
+    return "---";
+}
+
+// Get the name of a sentence identifier, as used in output filters
+char const *NmeaBridge::GetSentenceIdName(uint32_t sentenceId)
+{
+    if (sentenceId < NMEA_ID_NB)
+    {
+        return sentenceIdNames[sentenceId];
+    }
+
+    return "---";
+}
+
+bool NmeaBridge::EncodeSentence(uint32_t sentence)
+{
+    switch (sentence)
+    {
+    case NMEA_OUT_MWV_R:
+        return EncodeMWV_R();
+    case NMEA_OUT_MWV_T:
+        return EncodeMWV_T();
+    case NMEA_OUT_DPT:
+        return EncodeDPT();
+    case NMEA_OUT_MTW:
+        return EncodeMTW();
+    case NMEA_OUT_VLW:
+        return EncodeVLW();
+    case NMEA_OUT_VHW:
+        return EncodeVHW();
+    case NMEA_OUT_HDG:
+        return EncodeHDG();
+    case NMEA_OUT_XDR:
+        return EncodeXDR();
+    case NMEA_OUT_XDR_A:
+        return EncodeXDR_A();
+    case NMEA_OUT_ROT:
+        return EncodeROT();
+    case NMEA_OUT_HDT:
+        return EncodeHDT();
+    }
+
+    return false;
 }
 
 uint8_t NmeaBridge::AddNmeaChecksum(char *sentence)
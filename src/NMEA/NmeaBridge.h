@@ -32,8 +32,11 @@
 /***************************************************************************/
 
 #include "Configuration.h"
+#include "DeviationTable.h"
+#include "MagneticModel.h"
 #include "MicronetCodec.h"
 #include "NavigationData.h"
+#include "NmeaDefs.h"
 
 #include <stdint.h>
 
@@ -41,39 +44,17 @@
 /*                              Constants                                  */
 /***************************************************************************/
 
-#define NMEA_SENTENCE_MAX_LENGTH   128
 #define NMEA_SENTENCE_HISTORY_SIZE 24
+// Minimum time between two sentences emitted by the output scheduler
+#define NMEA_SCHEDULER_SLOT_MS 10
 
 /***************************************************************************/
 /*                                Types                                    */
 /***************************************************************************/
 
-typedef enum
-{
-    NMEA_ID_UNKNOWN,
-    NMEA_ID_RMB,
-    NMEA_ID_RMC,
-    NMEA_ID_GGA,
-    NMEA_ID_VTG,
-    NMEA_ID_MWV,
-    NMEA_ID_DPT,
-    NMEA_ID_VHW,
-    NMEA_ID_HDG
-} NmeaId_t;
-
-typedef struct
-{
-    uint32_t vwr;
-    uint32_t vwt;
-    uint32_t dpt;
-    uint32_t mtw;
-    uint32_t vlw;
-    uint32_t vhw;
-    uint32_t hdg;
-    uint32_t vcc;
-} NmeaTimeStamps_t;
-
-#define NMEA_SENTENCE_MIN_PERIOD_MS 500
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
 
 class NmeaBridge
 {
@@ -82,16 +63,30 @@ class NmeaBridge
     virtual ~NmeaBridge();
 
     void PushNmeaChar(char c, LinkId_t sourceLink);
-    void UpdateCompassData(float heading_deg);
+    void UpdateCompassData(float heading_deg, float roll_deg, float pitch_deg, float rot_degpmin);
     void UpdateMicronetData();
+    void Yield();
+
+    DeviationTable    *GetDeviationTable();
+    MagneticModel     *GetMagneticModel();
+    float              GetMagneticVariation();
+    static char const *GetSentenceName(uint32_t sentence);
+    static char const *GetSentenceIdName(uint32_t sentenceId);
 
   private:
     static const uint8_t asciiTable[128];
+    static char const   *sentenceNames[NMEA_OUT_NB];
+    static char const   *sentenceIdNames[NMEA_ID_NB];
     char                 nmeaExtBuffer[NMEA_SENTENCE_MAX_LENGTH];
     char                 nmeaGnssBuffer[NMEA_SENTENCE_MAX_LENGTH];
     int                  nmeaExtWriteIndex;
     int                  nmeaGnssWriteIndex;
-    NmeaTimeStamps_t     nmeaTimeStamps;
+    uint32_t             lastEmissionTime[NMEA_OUT_NB];
+    uint32_t             nextEmissionTime[NMEA_OUT_NB];
+    uint32_t             lastSlotTime;
+    uint32_t             schedulerIndex;
+    DeviationTable       deviationTable;
+    MagneticModel        magneticModel;
     MicronetCodec *      micronetCodec;
 
     bool     IsSentenceValid(char *nmeaBuffer);
@@ -104,16 +99,31 @@ class NmeaBridge
     void     DecodeDPTSentence(char *sentence);
     void     DecodeVHWSentence(char *sentence);
     void     DecodeHDGSentence(char *sentence);
+    void     DecodeVWRSentence(char *sentence);
+    void     DecodeVWTSentence(char *sentence);
+    void     DecodeMWDSentence(char *sentence);
+    void     DecodeHDTSentence(char *sentence);
+    void     DecodeZDASentence(char *sentence);
+    void     DecodeGLLSentence(char *sentence);
+    void     DecodeMTWSentence(char *sentence);
+    void     DecodeVLWSentence(char *sentence);
     int16_t  NibbleValue(char c);
-
-    void EncodeMWV_R();
-    void EncodeMWV_T();
-    void EncodeDPT();
-    void EncodeMTW();
-    void EncodeVLW();
-    void EncodeVHW();
-    void EncodeHDG();
-    void EncodeXDR();
+    void     UpdateMagneticVariation();
+
+    void RunScheduler();
+    void EncodeImmediate(uint32_t sentence);
+    bool EncodeSentence(uint32_t sentence);
+    bool EncodeMWV_R();
+    bool EncodeMWV_T();
+    bool EncodeDPT();
+    bool EncodeMTW();
+    bool EncodeVLW();
+    bool EncodeVHW();
+    bool EncodeHDG();
+    bool EncodeXDR();
+    bool EncodeXDR_A();
+    bool EncodeROT();
+    bool EncodeHDT();
 
     uint8_t AddNmeaChecksum(char *sentence);
 };
@@ -0,0 +1,96 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  NMEA identifiers shared by configuration and NMEA modules     *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef NMEADEFS_H_
+#define NMEADEFS_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define NMEA_SENTENCE_MAX_LENGTH 128
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef enum
+{
+    NMEA_ID_UNKNOWN,
+    NMEA_ID_RMB,
+    NMEA_ID_RMC,
+    NMEA_ID_GGA,
+    NMEA_ID_VTG,
+    NMEA_ID_MWV,
+    NMEA_ID_DPT,
+    NMEA_ID_VHW,
+    NMEA_ID_HDG,
+    NMEA_ID_VWR,
+    NMEA_ID_VWT,
+    NMEA_ID_MWD,
+    NMEA_ID_HDT,
+    NMEA_ID_ZDA,
+    NMEA_ID_GLL,
+    NMEA_ID_MTW,
+    NMEA_ID_VLW,
+    NMEA_ID_XDR,
+    NMEA_ID_ROT,
+    NMEA_ID_NB
+} NmeaId_t;
+
+typedef enum
+{
+    NMEA_OUTPUT_USB = 0,
+    NMEA_OUTPUT_BT,
+    NMEA_OUTPUT_TCP,
+    NMEA_OUTPUT_UDP,
+    NMEA_OUTPUT_NB
+} NmeaOutputId_t;
+
+typedef enum
+{
+    NMEA_OUT_MWV_R = 0,
+    NMEA_OUT_MWV_T,
+    NMEA_OUT_DPT,
+    NMEA_OUT_MTW,
+    NMEA_OUT_VLW,
+    NMEA_OUT_VHW,
+    NMEA_OUT_HDG,
+    NMEA_OUT_XDR,
+    NMEA_OUT_XDR_A,
+    NMEA_OUT_ROT,
+    NMEA_OUT_HDT,
+    NMEA_OUT_NB
+} NmeaOutSentence_t;
+
+#endif /* NMEADEFS_H_ */
@@ -0,0 +1,232 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  NMEA output multiplexer                                       *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NmeaMultiplexer.h"
+#include "BoardConfig.h"
+#include "Globals.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+NmeaMultiplexer::NmeaMultiplexer() : tcpServer(NMEA_TCP_PORT), btStarted(false), wifiStarted(false), deployRequested(false)
+{
+    memset(wifiPassword, 0, sizeof(wifiPassword));
+    SetStream(NMEA_OUTPUT_USB, &Serial);
+    SetStream(NMEA_OUTPUT_BT, &gBtSerial);
+    SetStream(NMEA_OUTPUT_TCP, &tcpServer);
+    SetStream(NMEA_OUTPUT_UDP, &udp);
+}
+
+NmeaMultiplexer::~NmeaMultiplexer()
+{
+}
+
+// Request the deployment of the current configuration. Can be called from any task : the configuration is only applied
+// by ApplyDeploy(), from the task which writes to the outputs.
+void NmeaMultiplexer::RequestDeploy()
+{
+    deployRequested = true;
+}
+
+// Apply the pending deployment request, if any. Must be called from the task calling Flush(), between two flushes, so
+// that Bluetooth, sockets and the USB baudrate are never changed while a sentence is being written to them.
+void NmeaMultiplexer::ApplyDeploy()
+{
+    if (deployRequested.exchange(false))
+    {
+        Deploy();
+    }
+}
+
+// Enable outputs according to the current configuration : the NMEA link is always enabled, the other outputs mirror it if
+// selected in nmeaOutputs. Bluetooth and WiFi are started only when at least one of their outputs is enabled.
+void NmeaMultiplexer::Deploy()
+{
+    uint32_t activeOutputs = gConfiguration.eeprom.nmeaOutputs;
+
+    switch (gConfiguration.eeprom.nmeaLink)
+    {
+    case SERIAL_TYPE_USB:
+        activeOutputs |= NMEA_OUTPUT_MASK(NMEA_OUTPUT_USB);
+        break;
+    case SERIAL_TYPE_BT:
+        activeOutputs |= NMEA_OUTPUT_MASK(NMEA_OUTPUT_BT);
+        break;
+    case SERIAL_TYPE_WIFI:
+        activeOutputs |= NMEA_OUTPUT_MASK(NMEA_OUTPUT_TCP);
+        break;
+    }
+
+    if (activeOutputs & NMEA_OUTPUT_MASK(NMEA_OUTPUT_BT))
+    {
+        StartBluetooth();
+    }
+    else
+    {
+        StopBluetooth();
+    }
+
+    if (activeOutputs & (NMEA_OUTPUT_MASK(NMEA_OUTPUT_TCP) | NMEA_OUTPUT_MASK(NMEA_OUTPUT_UDP)))
+    {
+        if (strcmp(wifiPassword, gConfiguration.eeprom.wifiPassword) != 0)
+        {
+            // Password has been changed : restart the access point with the new one
+            StopWifi();
+        }
+        StartWifi();
+    }
+    else
+    {
+        StopWifi();
+    }
+
+    for (int i = 0; i < NMEA_OUTPUT_NB; i++)
+    {
+        ConfigureOutput((NmeaOutputId_t)i, (activeOutputs & NMEA_OUTPUT_MASK(i)) != 0, gConfiguration.eeprom.nmeaOutputFilter[i],
+                        gConfiguration.eeprom.nmeaOutputRate_Bps[i]);
+    }
+
+    // Apply USB baudrate change, only if the serial port has already been started
+    if ((Serial.baudRate() != 0) && (Serial.baudRate() != gConfiguration.eeprom.usbBaudrate))
+    {
+        Serial.flush();
+        Serial.updateBaudRate(gConfiguration.eeprom.usbBaudrate);
+    }
+}
+
+void NmeaMultiplexer::Yield()
+{
+    if (wifiStarted)
+    {
+        tcpServer.Yield();
+    }
+}
+
+Stream *NmeaMultiplexer::GetTcpStream()
+{
+    return &tcpServer;
+}
+
+int NmeaMultiplexer::GetNbTcpClients()
+{
+    return tcpServer.GetNbClients();
+}
+
+// Get the SSID of the NMEA WiFi access point, derived from the device ID so that each unit has its own
+// @param ssid Buffer receiving the null terminated SSID
+// @param size Size of the buffer, NMEA_WIFI_SSID_SIZE is enough
+void NmeaMultiplexer::GetWifiSsid(char *ssid, uint32_t size)
+{
+    // Lower bits of the device ID are always 0
+    snprintf(ssid, size, NMEA_WIFI_SSID, (unsigned)((gConfiguration.eeprom.deviceId >> 3) & 0xffff));
+}
+
+void NmeaMultiplexer::StartBluetooth()
+{
+    if (!btStarted)
+    {
+        gBtSerial.begin(String(NMEA_BT_NAME));
+        btStarted = true;
+    }
+}
+
+void NmeaMultiplexer::StopBluetooth()
+{
+    if (btStarted)
+    {
+        gBtSerial.end();
+        btStarted = false;
+    }
+}
+
+void NmeaMultiplexer::StartWifi()
+{
+    if (!wifiStarted)
+    {
+        char ssid[NMEA_WIFI_SSID_SIZE];
+        GetWifiSsid(ssid, sizeof(ssid));
+        WiFi.mode(WIFI_AP);
+        strcpy(wifiPassword, gConfiguration.eeprom.wifiPassword);
+        WiFi.softAP(ssid, wifiPassword);
+        broadcastIp = WiFi.softAPBroadcastIP();
+        tcpServer.Begin();
+        udp.begin(NMEA_UDP_PORT);
+        wifiStarted = true;
+    }
+}
+
+void NmeaMultiplexer::StopWifi()
+{
+    if (wifiStarted)
+    {
+        tcpServer.End();
+        udp.stop();
+        WiFi.softAPdisconnect(true);
+        WiFi.mode(WIFI_OFF);
+        wifiStarted = false;
+    }
+}
+
+// Write a sentence to an output, as one datagram per sentence for UDP
+void NmeaMultiplexer::WriteOutput(NmeaOutputId_t outputId, const uint8_t *buffer, uint32_t length)
+{
+    if (outputId == NMEA_OUTPUT_UDP)
+    {
+        udp.beginPacket(broadcastIp, NMEA_UDP_PORT);
+        udp.write(buffer, length);
+        udp.endPacket();
+    }
+    else
+    {
+        NmeaOutputQueue::WriteOutput(outputId, buffer, length);
+    }
+}
@@ -0,0 +1,100 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  NMEA output multiplexer                                       *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef NMEAMULTIPLEXER_H_
+#define NMEAMULTIPLEXER_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "Configuration.h"
+#include "NmeaOutputQueue.h"
+#include "NmeaTcpServer.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <atomic>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define NMEA_WIFI_SSID      "MicroNav-%04X" // Suffixed with the device ID to tell units apart
+#define NMEA_WIFI_SSID_SIZE 16
+#define NMEA_TCP_PORT       10110
+#define NMEA_UDP_PORT       10110
+#define NMEA_BT_NAME        "MicroNav"
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+// NMEA output queue writing to USB, Bluetooth, TCP and UDP, which are started according to the configuration
+class NmeaMultiplexer : public NmeaOutputQueue
+{
+  public:
+    NmeaMultiplexer();
+    virtual ~NmeaMultiplexer();
+
+    void    RequestDeploy();
+    void    ApplyDeploy();
+    void    Yield();
+    Stream *GetTcpStream();
+    int     GetNbTcpClients();
+    void    GetWifiSsid(char *ssid, uint32_t size);
+
+  protected:
+    void WriteOutput(NmeaOutputId_t outputId, const uint8_t *buffer, uint32_t length) override;
+
+  private:
+    NmeaTcpServer tcpServer;
+    WiFiUDP       udp;
+    IPAddress     broadcastIp;
+    bool          btStarted;
+    bool          wifiStarted;
+    char          wifiPassword[WIFI_PASSWORD_SIZE]; // Password of the running access point
+
+    std::atomic<bool> deployRequested;
+
+    void Deploy();
+    void StartBluetooth();
+    void StopBluetooth();
+    void StartWifi();
+    void StopWifi();
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* NMEAMULTIPLEXER_H_ */
@@ -0,0 +1,219 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Filtered and rate limited NMEA output queue                   *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NmeaOutputQueue.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Maximum amount of credit accumulated by a rate limited output, in ms of its nominal throughput
+#define NMEA_OUTPUT_MAX_BURST_MS 1000
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+NmeaOutputQueue::NmeaOutputQueue() : queueOverflows(0)
+{
+    memset(outputs, 0, sizeof(outputs));
+}
+
+NmeaOutputQueue::~NmeaOutputQueue()
+{
+}
+
+// Set the stream sentences of an output are written to
+// @param outputId Output
+// @param stream Stream of the output
+void NmeaOutputQueue::SetStream(NmeaOutputId_t outputId, Stream *stream)
+{
+    outputs[outputId].stream = stream;
+}
+
+// Enable or disable an output and set its filter and throughput. Must be called from the task calling Flush().
+// @param outputId Output
+// @param enabled true to write sentences to the output
+// @param sentenceFilter Bit mask of NmeaId_t sentences sent on the output
+// @param maxRate_Bps Maximum throughput of the output, 0 for unlimited
+void NmeaOutputQueue::ConfigureOutput(NmeaOutputId_t outputId, bool enabled, uint32_t sentenceFilter, uint16_t maxRate_Bps)
+{
+    NmeaOutput_t *output = &outputs[outputId];
+
+    output->enabled        = enabled;
+    output->sentenceFilter = sentenceFilter;
+    output->maxRate_Bps    = maxRate_Bps;
+    output->credit_mB      = maxRate_Bps * NMEA_OUTPUT_MAX_BURST_MS;
+    output->lastRefillTime = millis();
+}
+
+// Queue one sentence for all enabled outputs. The sentence is terminated once and the same buffer will be written to each
+// output by Flush(). Writing to Bluetooth or network stacks can block, so it is never done by the encoding task itself.
+// Callers must be serialized (they are, by the conversion data lock) as the queue has a single producer side.
+// @param sentenceId Identifier of the sentence, used for output filtering
+// @param sentence Null terminated NMEA sentence without line termination
+// @param outSentence Encoded sentence whose latency is recorded once written, NMEA_OUT_NB if not measured
+// @param rxTime_us Reception time of the RF frame carrying the data of the sentence
+void NmeaOutputQueue::WriteSentence(NmeaId_t sentenceId, const char *sentence, NmeaOutSentence_t outSentence, uint32_t rxTime_us)
+{
+    uint32_t length = strlen(sentence);
+
+    if (length > NMEA_SENTENCE_MAX_LENGTH)
+    {
+        return;
+    }
+
+    NmeaQueuedSentence_t *entry = sentenceQueue.Reserve();
+    if (entry == nullptr)
+    {
+        queueOverflows++;
+        return;
+    }
+
+    memcpy(entry->data, sentence, length);
+    entry->data[length++] = '\r';
+    entry->data[length++] = '\n';
+    entry->length         = length;
+    entry->sentenceId     = sentenceId;
+    entry->outSentence    = outSentence;
+    entry->rxTime_us      = rxTime_us;
+
+    sentenceQueue.Commit();
+}
+
+// Write all queued sentences to the enabled outputs. Must always be called from the same task. Latency of encoded
+// sentences is recorded once their last byte has been written, so that it includes queuing and output writes.
+void NmeaOutputQueue::Flush()
+{
+    NmeaQueuedSentence_t *entry;
+
+    while ((entry = sentenceQueue.Peek()) != nullptr)
+    {
+        bool written = false;
+
+        for (int i = 0; i < NMEA_OUTPUT_NB; i++)
+        {
+            NmeaOutput_t *output = &outputs[i];
+
+            if (output->enabled && (output->sentenceFilter & NMEA_FILTER(entry->sentenceId)))
+            {
+                if (ConsumeCredit(output, entry->length))
+                {
+                    WriteOutput((NmeaOutputId_t)i, entry->data, entry->length);
+                    written = true;
+                }
+            }
+        }
+
+        if (written && (entry->outSentence < NMEA_OUT_NB))
+        {
+            latency[entry->outSentence].Record(micros() - entry->rxTime_us);
+        }
+
+        sentenceQueue.Release();
+    }
+}
+
+uint32_t NmeaOutputQueue::GetDroppedSentences(NmeaOutputId_t outputId)
+{
+    return outputs[outputId].droppedSentences;
+}
+
+uint32_t NmeaOutputQueue::GetQueueOverflows()
+{
+    return queueOverflows;
+}
+
+LatencyHistogram *NmeaOutputQueue::GetLatencyHistogram(uint32_t sentence)
+{
+    return &latency[sentence];
+}
+
+void NmeaOutputQueue::ResetLatencyStats()
+{
+    for (int i = 0; i < NMEA_OUT_NB; i++)
+    {
+        latency[i].Reset();
+    }
+}
+
+// Write a sentence to the stream of an output
+void NmeaOutputQueue::WriteOutput(NmeaOutputId_t outputId, const uint8_t *buffer, uint32_t length)
+{
+    outputs[outputId].stream->write(buffer, length);
+}
+
+// Token bucket rate limiter : credit is expressed in milli-bytes to keep integer precision at low rates
+// @return true if the output has enough credit to send length bytes
+bool NmeaOutputQueue::ConsumeCredit(NmeaOutput_t *output, uint32_t length)
+{
+    if (output->maxRate_Bps == 0)
+    {
+        return true;
+    }
+
+    uint32_t now     = millis();
+    uint32_t elapsed = now - output->lastRefillTime;
+    if (elapsed > NMEA_OUTPUT_MAX_BURST_MS)
+    {
+        elapsed = NMEA_OUTPUT_MAX_BURST_MS;
+    }
+    output->lastRefillTime = now;
+    output->credit_mB += elapsed * output->maxRate_Bps;
+    if (output->credit_mB > output->maxRate_Bps * NMEA_OUTPUT_MAX_BURST_MS)
+    {
+        output->credit_mB = output->maxRate_Bps * NMEA_OUTPUT_MAX_BURST_MS;
+    }
+
+    if (output->credit_mB < length * 1000)
+    {
+        output->droppedSentences++;
+        return false;
+    }
+
+    output->credit_mB -= length * 1000;
+    return true;
+}
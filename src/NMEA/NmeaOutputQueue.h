@@ -0,0 +1,115 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Filtered and rate limited NMEA output queue                   *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef NMEAOUTPUTQUEUE_H_
+#define NMEAOUTPUTQUEUE_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "LatencyHistogram.h"
+#include "LockFreeQueue.h"
+#include "NmeaDefs.h"
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define NMEA_OUTPUT_QUEUE_SIZE 16 // Number of sentences waiting to be written, must be a power of two
+
+#define NMEA_FILTER_ALL      0xffffffff
+#define NMEA_FILTER(id)      (1 << (id))
+#define NMEA_OUTPUT_MASK(id) (1 << (id))
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef struct
+{
+    Stream  *stream;
+    bool     enabled;
+    uint32_t sentenceFilter;
+    uint16_t maxRate_Bps;
+    uint32_t credit_mB;
+    uint32_t lastRefillTime;
+    uint32_t droppedSentences;
+} NmeaOutput_t;
+
+typedef struct
+{
+    NmeaId_t          sentenceId;
+    NmeaOutSentence_t outSentence; // Encoded sentence whose latency is measured, NMEA_OUT_NB for forwarded ones
+    uint32_t          rxTime_us;   // Reception time of the data of the sentence
+    uint8_t           length;
+    uint8_t           data[NMEA_SENTENCE_MAX_LENGTH + 2];
+} NmeaQueuedSentence_t;
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+// Queue of NMEA sentences written to several outputs, each with its own sentence filter and throughput limit. Sentences
+// are queued by the encoding task and written by another one, so that a blocking output never delays encoding.
+class NmeaOutputQueue
+{
+  public:
+    NmeaOutputQueue();
+    virtual ~NmeaOutputQueue();
+
+    void              SetStream(NmeaOutputId_t outputId, Stream *stream);
+    void              ConfigureOutput(NmeaOutputId_t outputId, bool enabled, uint32_t sentenceFilter, uint16_t maxRate_Bps);
+    void              WriteSentence(NmeaId_t sentenceId, const char *sentence, NmeaOutSentence_t outSentence = NMEA_OUT_NB,
+                                    uint32_t rxTime_us = 0);
+    void              Flush();
+    uint32_t          GetDroppedSentences(NmeaOutputId_t outputId);
+    uint32_t          GetQueueOverflows();
+    LatencyHistogram *GetLatencyHistogram(uint32_t sentence);
+    void              ResetLatencyStats();
+
+  protected:
+    virtual void WriteOutput(NmeaOutputId_t outputId, const uint8_t *buffer, uint32_t length);
+
+  private:
+    NmeaOutput_t     outputs[NMEA_OUTPUT_NB];
+    uint32_t         queueOverflows;
+    LatencyHistogram latency[NMEA_OUT_NB];
+
+    LockFreeQueue<NmeaQueuedSentence_t, NMEA_OUTPUT_QUEUE_SIZE> sentenceQueue;
+
+    bool ConsumeCredit(NmeaOutput_t *output, uint32_t length);
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* NMEAOUTPUTQUEUE_H_ */
@@ -0,0 +1,170 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Hardware independent parsing of NMEA sentence fields          *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NmeaParser.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Index of the status field of GLL sentence, the address field being field 0
+#define NMEA_GLL_STATUS_FIELD 6
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+/*
+  Skip NMEA fields
+  @param field Start of a field
+  @param nbFields Number of fields to skip
+  @return Start of the field nbFields after the given one, nullptr if the sentence is shorter
+*/
+char const *NmeaParser::SkipFields(char const *field, uint32_t nbFields)
+{
+    for (uint32_t i = 0; (i < nbFields) && (field != nullptr); i++)
+    {
+        if ((field = strchr(field, ',')) != nullptr)
+        {
+            field++;
+        }
+    }
+
+    return field;
+}
+
+/*
+  Parse a latitude and its hemisphere, as "ddmm.mm,N"
+  @param field Start of the latitude field
+  @param latitude_deg Latitude in degrees, positive north
+  @return true if the latitude field is not empty
+*/
+bool NmeaParser::ParseLatitude(char const *field, float *latitude_deg)
+{
+    float mins;
+
+    if ((field == nullptr) || (field[0] == ',') || (sscanf(field + 2, "%f", &mins) != 1))
+    {
+        return false;
+    }
+
+    char const *hemisphere = SkipFields(field, 1);
+    if (hemisphere == nullptr)
+    {
+        return false;
+    }
+
+    *latitude_deg = (field[0] - '0') * 10 + (field[1] - '0') + mins / 60.0f;
+    if (hemisphere[0] == 'S')
+    {
+        *latitude_deg = -*latitude_deg;
+    }
+
+    return true;
+}
+
+/*
+  Parse a longitude and its hemisphere, as "dddmm.mm,E"
+  @param field Start of the longitude field
+  @param longitude_deg Longitude in degrees, positive east
+  @return true if the longitude field is not empty
+*/
+bool NmeaParser::ParseLongitude(char const *field, float *longitude_deg)
+{
+    float mins;
+
+    if ((field == nullptr) || (field[0] == ',') || (sscanf(field + 3, "%f", &mins) != 1))
+    {
+        return false;
+    }
+
+    char const *hemisphere = SkipFields(field, 1);
+    if (hemisphere == nullptr)
+    {
+        return false;
+    }
+
+    *longitude_deg = (field[0] - '0') * 100 + (field[1] - '0') * 10 + (field[2] - '0') + mins / 60.0f;
+    if (hemisphere[0] == 'W')
+    {
+        *longitude_deg = -*longitude_deg;
+    }
+
+    return true;
+}
+
+/*
+  Parse a GLL sentence : "$--GLL,ddmm.mm,N,dddmm.mm,E,hhmmss.ss,A[,m]*hh"
+  @param sentence Complete sentence, starting with '$'
+  @param gll Decoded fields, with a validity flag for each of them
+  @return true if the status of the sentence is valid ('A')
+*/
+bool NmeaParser::ParseGLL(char const *sentence, NmeaGLL_t *gll)
+{
+    memset(gll, 0, sizeof(NmeaGLL_t));
+
+    // Only accept the position if the status field is 'A'
+    char const *status = SkipFields(sentence, NMEA_GLL_STATUS_FIELD);
+    if ((status == nullptr) || (status[0] != 'A'))
+    {
+        return false;
+    }
+
+    char const *field   = SkipFields(sentence, 1);
+    gll->latitudeValid  = ParseLatitude(field, &gll->latitude_deg);
+    field               = SkipFields(field, 2);
+    gll->longitudeValid = ParseLongitude(field, &gll->longitude_deg);
+    field               = SkipFields(field, 2);
+
+    if ((field != nullptr) && (field[0] != ',') && (field[0] != '*'))
+    {
+        gll->hour      = (field[0] - '0') * 10 + (field[1] - '0');
+        gll->minute    = (field[2] - '0') * 10 + (field[3] - '0');
+        gll->timeValid = true;
+    }
+
+    return true;
+}
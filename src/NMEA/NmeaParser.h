@@ -0,0 +1,75 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Hardware independent parsing of NMEA sentence fields          *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef NMEAPARSER_H_
+#define NMEAPARSER_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef struct
+{
+    bool    latitudeValid;
+    float   latitude_deg;
+    bool    longitudeValid;
+    float   longitude_deg;
+    bool    timeValid;
+    uint8_t hour;
+    uint8_t minute;
+} NmeaGLL_t;
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+// NMEA field parsing without any dependency on navigation data or on the Arduino framework, so that it can be tested on
+// the host
+class NmeaParser
+{
+  public:
+    static char const *SkipFields(char const *field, uint32_t nbFields);
+    static bool        ParseLatitude(char const *field, float *latitude_deg);
+    static bool        ParseLongitude(char const *field, float *longitude_deg);
+    static bool        ParseGLL(char const *sentence, NmeaGLL_t *gll);
+};
+
+/***************************************************************************/
+/*                              Prototypes                                 */
+/***************************************************************************/
+
+#endif /* NMEAPARSER_H_ */
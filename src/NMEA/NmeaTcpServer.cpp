@@ -0,0 +1,196 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  TCP server used as NMEA link over WiFi                        *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NmeaTcpServer.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+NmeaTcpServer::NmeaTcpServer(uint16_t port) : server(port, NMEA_TCP_MAX_CLIENTS), started(false)
+{
+}
+
+NmeaTcpServer::~NmeaTcpServer()
+{
+}
+
+void NmeaTcpServer::Begin()
+{
+    if (!started)
+    {
+        server.begin();
+        server.setNoDelay(true);
+        started = true;
+    }
+}
+
+void NmeaTcpServer::End()
+{
+    if (started)
+    {
+        for (int i = 0; i < NMEA_TCP_MAX_CLIENTS; i++)
+        {
+            clients[i].stop();
+        }
+        server.end();
+        started = false;
+    }
+}
+
+// Accept incoming connections and release disconnected clients
+void NmeaTcpServer::Yield()
+{
+    if (!started)
+    {
+        return;
+    }
+
+    for (int i = 0; i < NMEA_TCP_MAX_CLIENTS; i++)
+    {
+        if (clients[i] && !clients[i].connected())
+        {
+            clients[i].stop();
+        }
+    }
+
+    while (server.hasClient())
+    {
+        WiFiClient newClient = server.available();
+        int        i;
+
+        for (i = 0; i < NMEA_TCP_MAX_CLIENTS; i++)
+        {
+            if (!clients[i])
+            {
+                newClient.setNoDelay(true);
+                clients[i] = newClient;
+                break;
+            }
+        }
+
+        if (i >= NMEA_TCP_MAX_CLIENTS)
+        {
+            // No room left : refuse the connection
+            newClient.stop();
+        }
+    }
+}
+
+int NmeaTcpServer::GetNbClients()
+{
+    int nbClients = 0;
+
+    for (int i = 0; i < NMEA_TCP_MAX_CLIENTS; i++)
+    {
+        if (clients[i])
+        {
+            nbClients++;
+        }
+    }
+
+    return nbClients;
+}
+
+int NmeaTcpServer::available()
+{
+    int nbBytes = 0;
+
+    for (int i = 0; i < NMEA_TCP_MAX_CLIENTS; i++)
+    {
+        if (clients[i])
+        {
+            nbBytes += clients[i].available();
+        }
+    }
+
+    return nbBytes;
+}
+
+int NmeaTcpServer::read()
+{
+    for (int i = 0; i < NMEA_TCP_MAX_CLIENTS; i++)
+    {
+        if (clients[i] && (clients[i].available() > 0))
+        {
+            return clients[i].read();
+        }
+    }
+
+    return -1;
+}
+
+int NmeaTcpServer::peek()
+{
+    for (int i = 0; i < NMEA_TCP_MAX_CLIENTS; i++)
+    {
+        if (clients[i] && (clients[i].available() > 0))
+        {
+            return clients[i].peek();
+        }
+    }
+
+    return -1;
+}
+
+size_t NmeaTcpServer::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t NmeaTcpServer::write(const uint8_t *buffer, size_t size)
+{
+    for (int i = 0; i < NMEA_TCP_MAX_CLIENTS; i++)
+    {
+        if (clients[i])
+        {
+            clients[i].write(buffer, size);
+        }
+    }
+
+    return size;
+}
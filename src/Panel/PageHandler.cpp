@@ -52,9 +52,9 @@
 /*                           Static & Globals                              */
 /***************************************************************************/
 
-Adafruit_SSD1306 *PageHandler::display;
-DeviceInfo_t      PageHandler::deviceInfo;
-NavigationData    PageHandler::navData;
+PanelDisplay  *PageHandler::display;
+DeviceInfo_t   PageHandler::deviceInfo;
+NavigationData PageHandler::navData;
 
 /***************************************************************************/
 /*                              Functions                                  */
@@ -68,7 +68,7 @@ PageHandler::~PageHandler()
 {
 }
 
-void PageHandler::SetDisplay(Adafruit_SSD1306 *display)
+void PageHandler::SetDisplay(PanelDisplay *display)
 {
     PageHandler::display = display;
 }
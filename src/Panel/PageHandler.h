@@ -32,6 +32,7 @@
 /***************************************************************************/
 
 #include "MicronetDevice.h"
+#include "PanelDisplay.h"
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
@@ -68,7 +69,7 @@ class PageHandler
     PageHandler();
     virtual ~PageHandler() = 0;
 
-    static void           SetDisplay(Adafruit_SSD1306 *display);
+    static void           SetDisplay(PanelDisplay *display);
     virtual bool          Draw(bool force, bool flushDisplay = true) = 0;
     virtual PageAction_t  OnButtonPressed(ButtonId_t buttonId, bool longPress);
     static void           SetNetworkStatus(DeviceInfo_t &deviceInfo);
@@ -76,8 +77,8 @@ class PageHandler
     static NavigationData navData;
 
   protected:
-    static Adafruit_SSD1306 *display;
-    static DeviceInfo_t      deviceInfo;
+    static PanelDisplay *display;
+    static DeviceInfo_t  deviceInfo;
 
     void PrintCentered(int32_t yPos, String const &text);
     void PrintCentered(int32_t xPos, int32_t yPos, String const &text);
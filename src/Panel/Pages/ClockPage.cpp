@@ -182,7 +182,7 @@ bool ClockPage::Draw(bool force, bool flushDisplay)
         display->setTextColor(SSD1306_WHITE);
         display->setTextSize(1);
         display->setFont(&FreeSansBold18pt);
-        display->getTextBounds(String(timeStr), 0, 0, &xTime, &yTime, &wTime, &hTime);
+        display->getTextBounds(timeStr, 0, 0, &xTime, &yTime, &wTime, &hTime);
         display->setFont(&FreeSansBold9pt);
         display->getTextBounds(dateStr, 0, 0, &xDate, &yDate, &wDate, &hDate);
 
@@ -175,6 +175,10 @@ PageAction_t CommandPage::OnButtonPressed(ButtonId_t buttonId, bool longPress)
             case 1:
                 subPage = &attachPage;
                 break;
+            case 2:
+                compassCalibPage.Start();
+                subPage = &compassCalibPage;
+                break;
             }
             action = PAGE_ACTION_REFRESH;
         }
@@ -32,6 +32,7 @@
 /***************************************************************************/
 
 #include "AttachPage.h"
+#include "CompassCalibPage.h"
 #include "PageHandler.h"
 
 /***************************************************************************/
@@ -60,7 +61,8 @@ class CommandPage : public PageHandler
     bool          selectionMode;
     uint32_t      selectionPosition;
 
-    AttachPage attachPage;
+    AttachPage       attachPage;
+    CompassCalibPage compassCalibPage;
 };
 
 #endif
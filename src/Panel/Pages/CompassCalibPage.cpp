@@ -0,0 +1,228 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Handler of the Compass calibration page                       *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "CompassCalibPage.h"
+#include "Globals.h"
+#include "PanelResources.h"
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+#include <Arduino.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Number of 30° heading sectors to cover before the calibration can be saved
+#define CALIBRATION_MIN_SECTORS 12
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+CompassCalibPage::CompassCalibPage() : menuSelection(0), calibrationValid(false), nbSamples(0), nbSectors(0)
+{
+    memset(&calibration, 0, sizeof(calibration));
+}
+
+CompassCalibPage::~CompassCalibPage()
+{
+}
+
+/*
+    Start a new calibration when entering the page
+*/
+void CompassCalibPage::Start()
+{
+    menuSelection    = 0;
+    calibrationValid = false;
+    nbSamples        = 0;
+    nbSectors        = 0;
+
+    if (gConfiguration.ram.navCompassAvailable)
+    {
+        gNavCompass.StartCalibration();
+    }
+}
+
+/*
+    Draw the page on display
+    @param force Force redraw, even if the content did not change
+*/
+bool CompassCalibPage::Draw(bool force, bool flushDisplay)
+{
+    char lineStr[22];
+
+    // Refine the fit with the samples collected since last draw
+    if (gConfiguration.ram.navCompassAvailable)
+    {
+        calibrationValid = gNavCompass.GetCalibration(&calibration, &nbSamples, &nbSectors);
+    }
+
+    if (display != nullptr)
+    {
+        display->clearDisplay();
+
+        display->setTextSize(1);
+        display->setFont(nullptr);
+        display->setTextColor(SSD1306_WHITE);
+
+        if (gConfiguration.ram.navCompassAvailable)
+        {
+            PrintCentered(0 * 8, "Turn a full circle");
+
+            PrintLeft(2 * 8, "Samples");
+            snprintf(lineStr, sizeof(lineStr), "%u", (unsigned)nbSamples);
+            PrintRight(2 * 8, lineStr);
+
+            PrintLeft(3 * 8, "Sectors");
+            snprintf(lineStr, sizeof(lineStr), "%u/%u", (unsigned)nbSectors, CALIBRATION_MIN_SECTORS);
+            PrintRight(3 * 8, lineStr);
+
+            PrintLeft(4 * 8, "Fit error");
+            if (calibrationValid)
+            {
+                snprintf(lineStr, sizeof(lineStr), "%.1f%%", calibration.fitError_per);
+                PrintRight(4 * 8, lineStr);
+            }
+            else
+            {
+                PrintRight(4 * 8, "---");
+            }
+
+            display->fillRect(SCREEN_WIDTH - 6 * 6, 6 * 8 + (menuSelection * 8), 6 * 6, 8, SSD1306_WHITE);
+            display->setTextColor((menuSelection == 0) ? SSD1306_BLACK : SSD1306_WHITE);
+            PrintRight(6 * 8, (calibrationValid && (nbSectors >= CALIBRATION_MIN_SECTORS)) ? "Save" : "----");
+            display->setTextColor((menuSelection == 1) ? SSD1306_BLACK : SSD1306_WHITE);
+            PrintRight(7 * 8, "Exit");
+        }
+        else
+        {
+            PrintCentered(0 * 8, "No compass detected");
+            display->fillRect(SCREEN_WIDTH - 6 * 4, 7 * 8, 6 * 4, 8, SSD1306_WHITE);
+            display->setTextColor(SSD1306_BLACK);
+            PrintRight(7 * 8, "Exit");
+        }
+        display->setTextColor(SSD1306_WHITE);
+
+        if (flushDisplay)
+        {
+            display->display();
+        }
+    }
+
+    return true;
+}
+
+/*
+  Function called by PanelManager when the button is pressed
+  @param longPress true if a long press was detected
+  @return Action to be executed by PanelManager
+*/
+PageAction_t CompassCalibPage::OnButtonPressed(ButtonId_t buttonId, bool longPress)
+{
+    PageAction_t action = PAGE_ACTION_NONE;
+
+    // Long press has not effect on this page
+    if (!longPress)
+    {
+        if (buttonId == BUTTON_ID_0)
+        {
+            if ((menuSelection == 0) && gConfiguration.ram.navCompassAvailable)
+            {
+                // "Save" menu : only available once the boat has turned a full circle
+                if (calibrationValid && (nbSectors >= CALIBRATION_MIN_SECTORS))
+                {
+                    SaveCalibration();
+                    gNavCompass.StopCalibration();
+                    action = PAGE_ACTION_EXIT_PAGE;
+                }
+            }
+            else
+            {
+                // "Exit" menu : keep previous calibration
+                gNavCompass.StopCalibration();
+                action = PAGE_ACTION_EXIT_PAGE;
+            }
+        }
+        else
+        {
+            // Button 1 : cycle through menu items
+            menuSelection = (menuSelection + 1) & 0x01;
+            action        = PAGE_ACTION_REFRESH;
+        }
+    }
+
+    return action;
+}
+
+/*
+  Store the fitted calibration in the configuration and save it to EEPROM
+*/
+void CompassCalibPage::SaveCalibration()
+{
+    EEPROMConfig_t config;
+
+    // Configuration and deviation table are shared with conversion tasks
+    gConversionTasks.LockData();
+    gConfiguration.eeprom.xMagOffset = calibration.offset.x;
+    gConfiguration.eeprom.yMagOffset = calibration.offset.y;
+    gConfiguration.eeprom.zMagOffset = calibration.offset.z;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            gConfiguration.eeprom.magSoftIron[i * 3 + j] = calibration.softIron[i][j];
+        }
+    }
+    gConfiguration.eeprom.magFitError_per = calibration.fitError_per;
+
+    // Deviation learned with the previous calibration is meaningless now
+    DeviationTable *deviationTable = gDataBridge.GetDeviationTable();
+    deviationTable->Reset();
+    deviationTable->Store(gConfiguration.eeprom.magDeviation);
+    config = gConfiguration.eeprom;
+    gConversionTasks.UnlockData();
+
+    gConfiguration.SaveToEeprom(config);
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Handler of the Compass calibration page                       *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef COMPASSCALIBPAGE_H_
+#define COMPASSCALIBPAGE_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "MagCalibrator.h"
+#include "PageHandler.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+class CompassCalibPage : public PageHandler
+{
+  public:
+    CompassCalibPage();
+    virtual ~CompassCalibPage();
+
+    void         Start();
+    bool         Draw(bool force, bool flushDisplay = true);
+    PageAction_t OnButtonPressed(ButtonId_t buttonId, bool longPress);
+
+  private:
+    uint32_t         menuSelection;
+    bool             calibrationValid;
+    uint32_t         nbSamples;
+    uint32_t         nbSectors;
+    MagCalibration_t calibration;
+
+    void SaveCalibration();
+};
+
+#endif
@@ -29,6 +29,7 @@
 /***************************************************************************/
 
 #include "ConfigPage1.h"
+#include "BoardConfig.h"
 #include "Globals.h"
 #include "MicronetDevice.h"
 #include "PanelResources.h"
@@ -42,9 +43,13 @@
 /***************************************************************************/
 
 // @brief Number of configuration items on this page
-#define NUMBER_OF_CONFIG_ITEMS 4
+#define NUMBER_OF_CONFIG_ITEMS 8
 // @brief Horizontal position of configuration values on display
 #define SELECTION_X_POSITION 72
+// @brief Number of NMEA mirror combinations (any combination of USB, Bluetooth & WiFi)
+#define NUMBER_OF_MIRROR_CONFIGS 8
+// @brief Number of selectable USB baudrates
+#define NUMBER_OF_USB_BAUDRATES 5
 
 /***************************************************************************/
 /*                             Local types                                 */
@@ -58,12 +63,18 @@
 /*                           Static & Globals                              */
 /***************************************************************************/
 
+// @brief Selectable USB baudrates
+static const uint32_t usbBaudrates[NUMBER_OF_USB_BAUDRATES] = {4800, 9600, 38400, 115200, 230400};
+// @brief Strings of selectable USB baudrates
+static char const *usbBaudrateStrings[NUMBER_OF_USB_BAUDRATES] = {"4800", "9600", "38400", "115200", "230400"};
+
 /***************************************************************************/
 /*                              Functions                                  */
 /***************************************************************************/
 
 ConfigPage1::ConfigPage1()
-    : editMode(false), editPosition(0), configFreqSel(0), configNmeaSel(0), configRmbWorkaround(false), configWindRepeater(false)
+    : editMode(false), editPosition(0), configFreqSel(0), configNmeaSel(0), configRmbWorkaround(false), configWindRepeater(false), configMirrorSel(0), configBaudSel(0),
+      configLowLatency(false), configPowerSaving(false)
 {
 }
 
@@ -85,6 +96,10 @@ bool ConfigPage1::Draw(bool force, bool flushDisplay)
         configNmeaSel       = (uint32_t)gConfiguration.eeprom.nmeaLink;
         configRmbWorkaround = gConfiguration.eeprom.rmbWorkaround;
         configWindRepeater  = gConfiguration.eeprom.windRepeater;
+        configMirrorSel     = MirrorOutputsToSel(gConfiguration.eeprom.nmeaOutputs);
+        configBaudSel       = BaudrateToSel(gConfiguration.eeprom.usbBaudrate);
+        configLowLatency    = gConfiguration.eeprom.lowLatency;
+        configPowerSaving   = gConfiguration.eeprom.powerSaving;
     }
 
     if (display != nullptr)
@@ -100,6 +115,10 @@ bool ConfigPage1::Draw(bool force, bool flushDisplay)
         display->println("NMEA link");
         display->println("RMB bugfix");
         display->println("Wind Repeat");
+        display->println("NMEA mirror");
+        display->println("USB baud");
+        display->println("Low latency");
+        display->println("Power save");
 
         // Config values
         for (int i = 0; i < NUMBER_OF_CONFIG_ITEMS; i++)
@@ -114,7 +133,7 @@ bool ConfigPage1::Draw(bool force, bool flushDisplay)
             {
                 display->setTextColor(SSD1306_WHITE);
             }
-            display->getTextBounds(String(ConfigString(i)), 0, 0, &xStr, &yStr, &wStr, &hStr);
+            display->getTextBounds(ConfigString(i), 0, 0, &xStr, &yStr, &wStr, &hStr);
             display->setCursor(SCREEN_WIDTH - wStr, i * 8);
             display->print(ConfigString(i));
         }
@@ -197,6 +216,14 @@ char const *ConfigPage1::ConfigString(uint32_t index)
         return ConfigRmbWorkaroundString();
     case 3:
         return ConfigWindRepeaterString();
+    case 4:
+        return ConfigMirrorString();
+    case 5:
+        return ConfigBaudString();
+    case 6:
+        return ConfigLowLatencyString();
+    case 7:
+        return ConfigPowerSavingString();
     }
 
     return "---";
@@ -227,7 +254,7 @@ char const *ConfigPage1::ConfigNmeaString()
         return "USB";
     case 1:
         return "Bluetooth";
-    case 3:
+    case 2:
         return "WiFi";
     }
 
@@ -256,6 +283,70 @@ char const *ConfigPage1::ConfigWindRepeaterString()
     return "No";
 }
 
+// Return the string of a the NMEA mirror configuration item
+// @return String naming the outputs mirroring the NMEA link
+char const *ConfigPage1::ConfigMirrorString()
+{
+    switch (configMirrorSel)
+    {
+    case 0:
+        return "None";
+    case 1:
+        return "USB";
+    case 2:
+        return "BT";
+    case 3:
+        return "USB+BT";
+    case 4:
+        return "WiFi";
+    case 5:
+        return "USB+WiFi";
+    case 6:
+        return "BT+WiFi";
+    case 7:
+        return "All";
+    }
+
+    return "---";
+}
+
+// Return the string of a the USB baudrate configuration item
+// @return String naming the value of the USB baudrate
+char const *ConfigPage1::ConfigBaudString()
+{
+    if (configBaudSel < NUMBER_OF_USB_BAUDRATES)
+    {
+        return usbBaudrateStrings[configBaudSel];
+    }
+
+    return "---";
+}
+
+// Return the string of a the Low Latency configuration item
+// @return String naming the value of Low Latency
+char const *ConfigPage1::ConfigLowLatencyString()
+{
+    if (configLowLatency)
+    {
+        return "Yes";
+    }
+    return "No";
+}
+
+// Return the string of a the Power Saving configuration item. Light sleep is only entered when NMEA is on USB without
+// radio outputs and GNSS is not the internal one : GNSS UART cannot wake-up the CPU without losing characters. The
+// onboard compass must not be the heading source and no sentence may have a period below 1s : both would be frozen
+// during most of the network cycle.
+// @return String naming the value of Power Saving
+char const *ConfigPage1::ConfigPowerSavingString()
+{
+    if (configPowerSaving)
+    {
+        return "Yes";
+    }
+    return "No";
+}
+
 // @brief Cycle the value of a given configuration item
 // @param index Configuration item
 void ConfigPage1::ConfigCycle(uint32_t index)
@@ -274,6 +365,18 @@ void ConfigPage1::ConfigCycle(uint32_t index)
     case 3:
         ConfigWindRepeaterCycle();
         break;
+    case 4:
+        ConfigMirrorCycle();
+        break;
+    case 5:
+        ConfigBaudCycle();
+        break;
+    case 6:
+        ConfigLowLatencyCycle();
+        break;
+    case 7:
+        ConfigPowerSavingCycle();
+        break;
     }
 }
 
@@ -286,7 +389,7 @@ void ConfigPage1::ConfigFreqCycle()
 // @brief Cycle the value of the NMEA Link configuration item
 void ConfigPage1::ConfigNmeaCycle()
 {
-    configNmeaSel = (configNmeaSel + 1) % 2;
+    configNmeaSel = (configNmeaSel + 1) % 3;
 }
 
 // @brief Cycle the value of the RMB Workaround configuration item
@@ -301,15 +404,112 @@ void ConfigPage1::ConfigWindRepeaterCycle()
     configWindRepeater = !configWindRepeater;
 }
 
+// @brief Cycle the value of the NMEA mirror configuration item
+void ConfigPage1::ConfigMirrorCycle()
+{
+    configMirrorSel = (configMirrorSel + 1) % NUMBER_OF_MIRROR_CONFIGS;
+}
+
+// @brief Cycle the value of the USB baudrate configuration item
+void ConfigPage1::ConfigBaudCycle()
+{
+    configBaudSel = (configBaudSel + 1) % NUMBER_OF_USB_BAUDRATES;
+}
+
+// @brief Cycle the value of the Low Latency configuration item
+void ConfigPage1::ConfigLowLatencyCycle()
+{
+    configLowLatency = !configLowLatency;
+}
+
+// @brief Cycle the value of the Power Saving configuration item
+void ConfigPage1::ConfigPowerSavingCycle()
+{
+    configPowerSaving = !configPowerSaving;
+}
+
+// @brief Convert a baudrate into a USB baudrate selection
+// @param baudrate Baudrate
+// @return Selection index, default baudrate if not found
+uint32_t ConfigPage1::BaudrateToSel(uint32_t baudrate)
+{
+    for (uint32_t i = 0; i < NUMBER_OF_USB_BAUDRATES; i++)
+    {
+        if (usbBaudrates[i] == baudrate)
+        {
+            return i;
+        }
+    }
+
+    return BaudrateToSel(CONSOLE_BAUDRATE);
+}
+
+// @brief Convert a NMEA mirror selection into a NMEA output mask
+// @param mirrorSel Selection index : bit 0 is USB, bit 1 is Bluetooth & bit 2 is WiFi (TCP & UDP)
+// @return NMEA output mask
+uint8_t ConfigPage1::MirrorSelToOutputs(uint32_t mirrorSel)
+{
+    uint8_t outputs = 0;
+
+    if (mirrorSel & 0x01)
+    {
+        outputs |= NMEA_OUTPUT_MASK(NMEA_OUTPUT_USB);
+    }
+    if (mirrorSel & 0x02)
+    {
+        outputs |= NMEA_OUTPUT_MASK(NMEA_OUTPUT_BT);
+    }
+    if (mirrorSel & 0x04)
+    {
+        outputs |= NMEA_OUTPUT_MASK(NMEA_OUTPUT_TCP) | NMEA_OUTPUT_MASK(NMEA_OUTPUT_UDP);
+    }
+
+    return outputs;
+}
+
+// @brief Convert a NMEA output mask into a NMEA mirror selection
+// @param outputs NMEA output mask
+// @return Selection index
+uint32_t ConfigPage1::MirrorOutputsToSel(uint8_t outputs)
+{
+    uint32_t mirrorSel = 0;
+
+    if (outputs & NMEA_OUTPUT_MASK(NMEA_OUTPUT_USB))
+    {
+        mirrorSel |= 0x01;
+    }
+    if (outputs & NMEA_OUTPUT_MASK(NMEA_OUTPUT_BT))
+    {
+        mirrorSel |= 0x02;
+    }
+    if (outputs & (NMEA_OUTPUT_MASK(NMEA_OUTPUT_TCP) | NMEA_OUTPUT_MASK(NMEA_OUTPUT_UDP)))
+    {
+        mirrorSel |= 0x04;
+    }
+
+    return mirrorSel;
+}
+
 // @brief Deploy the local configuration to the overall system and save it to
 // EEPROM
 void ConfigPage1::DeployConfiguration()
 {
+    EEPROMConfig_t config;
+
+    // Configuration and Micronet device are shared with conversion tasks
+    gConversionTasks.LockData();
     gConfiguration.eeprom.freqSystem    = (FreqSystem_t)configFreqSel;
     gConfiguration.eeprom.nmeaLink      = (SerialType_t)configNmeaSel;
     gConfiguration.eeprom.rmbWorkaround = configRmbWorkaround;
     gConfiguration.eeprom.windRepeater  = configWindRepeater;
+    gConfiguration.eeprom.nmeaOutputs   = MirrorSelToOutputs(configMirrorSel);
+    gConfiguration.eeprom.usbBaudrate   = usbBaudrates[configBaudSel];
+    gConfiguration.eeprom.lowLatency    = configLowLatency;
+    gConfiguration.eeprom.powerSaving   = configPowerSaving;
 
     gConfiguration.DeployConfiguration(&gMicronetDevice);
-    gConfiguration.SaveToEeprom();
+    config = gConfiguration.eeprom;
+    gConversionTasks.UnlockData();
+
+    gConfiguration.SaveToEeprom(config);
 }
@@ -64,6 +64,10 @@ class ConfigPage1 : public PageHandler
     uint32_t configNmeaSel;
     bool     configRmbWorkaround;
     bool     configWindRepeater;
+    uint32_t configMirrorSel;
+    uint32_t configBaudSel;
+    bool     configLowLatency;
+    bool     configPowerSaving;
 
     void DeployConfiguration();
 
@@ -72,12 +76,24 @@ class ConfigPage1 : public PageHandler
     char const *ConfigNmeaString();
     char const *ConfigRmbWorkaroundString();
     char const *ConfigWindRepeaterString();
+    char const *ConfigMirrorString();
+    char const *ConfigBaudString();
+    char const *ConfigLowLatencyString();
+    char const *ConfigPowerSavingString();
 
     void ConfigCycle(uint32_t index);
     void ConfigFreqCycle();
     void ConfigNmeaCycle();
     void ConfigRmbWorkaroundCycle();
     void ConfigWindRepeaterCycle();
+    void ConfigMirrorCycle();
+    void ConfigBaudCycle();
+    void ConfigLowLatencyCycle();
+    void ConfigPowerSavingCycle();
+
+    uint8_t  MirrorSelToOutputs(uint32_t mirrorSel);
+    uint32_t MirrorOutputsToSel(uint8_t outputs);
+    uint32_t BaudrateToSel(uint32_t baudrate);
 };
 
 #endif
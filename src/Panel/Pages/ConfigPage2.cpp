@@ -42,9 +42,11 @@
 /***************************************************************************/
 
 // @brief Number of configuration items on this page
-#define NUMBER_OF_CONFIG_ITEMS 5
+#define NUMBER_OF_CONFIG_ITEMS 7
 // @brief Horizontal position of configuration values on display
 #define SELECTION_X_POSITION 72
+// @brief Number of selectable heading filter time constants
+#define NUMBER_OF_HEADING_FILTERS 6
 
 /***************************************************************************/
 /*                             Local types                                 */
@@ -58,12 +60,18 @@
 /*                           Static & Globals                              */
 /***************************************************************************/
 
+// @brief Selectable time constants of the compass heading filter
+static const uint16_t headingFilters_ms[NUMBER_OF_HEADING_FILTERS] = {0, 200, 500, 1000, 2000, 5000};
+// @brief Names of the selectable heading filter time constants
+static char const *headingFilterStrings[NUMBER_OF_HEADING_FILTERS] = {"Off", "0.2s", "0.5s", "1s", "2s", "5s"};
+
 /***************************************************************************/
 /*                              Functions                                  */
 /***************************************************************************/
 
 ConfigPage2::ConfigPage2()
-    : editMode(false), editPosition(0), configCompassSel(0), configGnssSel(0), configWindSel(0), configDepthSel(0), configSpeedSel(0)
+    : editMode(false), editPosition(0), configCompassSel(0), configGnssSel(0), configWindSel(0), configDepthSel(0), configSpeedSel(0),
+      configHeadingFilterSel(0), configMagVariationSel(0)
 {
 }
 
@@ -138,6 +146,9 @@ bool ConfigPage2::Draw(bool force, bool flushDisplay)
             configSpeedSel = 1;
             break;
         }
+
+        configHeadingFilterSel = HeadingFilterToSel(gConfiguration.eeprom.headingFilter_ms);
+        configMagVariationSel  = gConfiguration.eeprom.autoMagVariation ? 1 : 0;
     }
 
     if (display != nullptr)
@@ -154,6 +165,8 @@ bool ConfigPage2::Draw(bool force, bool flushDisplay)
         display->println("Wind");
         display->println("Depth");
         display->println("Speed");
+        display->println("Hdg filter");
+        display->println("Mag var");
 
         // Config values
         for (int i = 0; i < NUMBER_OF_CONFIG_ITEMS; i++)
@@ -168,7 +181,7 @@ bool ConfigPage2::Draw(bool force, bool flushDisplay)
             {
                 display->setTextColor(SSD1306_WHITE);
             }
-            display->getTextBounds(String(ConfigString(i)), 0, 0, &xStr, &yStr, &wStr, &hStr);
+            display->getTextBounds(ConfigString(i), 0, 0, &xStr, &yStr, &wStr, &hStr);
             display->setCursor(SCREEN_WIDTH - wStr, i * 8);
             display->print(ConfigString(i));
         }
@@ -253,6 +266,10 @@ char const *ConfigPage2::ConfigString(uint32_t index)
         return ConfigDepthString();
     case 4:
         return ConfigSpeedString();
+    case 5:
+        return ConfigHeadingFilterString();
+    case 6:
+        return ConfigMagVariationString();
     }
 
     return "---";
@@ -335,6 +352,33 @@ char const *ConfigPage2::ConfigSpeedString()
     return "---";
 }
 
+// Return the string of a the heading filter configuration item
+// @return String naming the time constant of the heading filter
+char const *ConfigPage2::ConfigHeadingFilterString()
+{
+    if (configHeadingFilterSel < NUMBER_OF_HEADING_FILTERS)
+    {
+        return headingFilterStrings[configHeadingFilterSel];
+    }
+
+    return "---";
+}
+
+// Return the string of a the magnetic variation configuration item
+// @return String naming the source of the magnetic variation
+char const *ConfigPage2::ConfigMagVariationString()
+{
+    switch (configMagVariationSel)
+    {
+    case 0:
+        return "Manual";
+    case 1:
+        return "WMM";
+    }
+
+    return "---";
+}
+
 // @brief Cycle the value of a given configuration item
 // @param index Configuration item
 void ConfigPage2::ConfigCycle(uint32_t index)
@@ -356,6 +400,12 @@ void ConfigPage2::ConfigCycle(uint32_t index)
     case 4:
         ConfigSpeedCycle();
         break;
+    case 5:
+        ConfigHeadingFilterCycle();
+        break;
+    case 6:
+        ConfigMagVariationCycle();
+        break;
     }
 }
 
@@ -389,18 +439,55 @@ void ConfigPage2::ConfigSpeedCycle()
     configSpeedSel = (configSpeedSel + 1) % 2;
 }
 
+// @brief Cycle the value of the heading filter configuration item
+void ConfigPage2::ConfigHeadingFilterCycle()
+{
+    configHeadingFilterSel = (configHeadingFilterSel + 1) % NUMBER_OF_HEADING_FILTERS;
+}
+
+// @brief Cycle the value of the magnetic variation configuration item
+void ConfigPage2::ConfigMagVariationCycle()
+{
+    configMagVariationSel = (configMagVariationSel + 1) % 2;
+}
+
+// @brief Convert a heading filter time constant into a selection
+// @param headingFilter_ms Time constant in milliseconds
+// @return Selection index, closest longer time constant if not found
+uint32_t ConfigPage2::HeadingFilterToSel(uint16_t headingFilter_ms)
+{
+    for (uint32_t i = 0; i < NUMBER_OF_HEADING_FILTERS; i++)
+    {
+        if (headingFilters_ms[i] >= headingFilter_ms)
+        {
+            return i;
+        }
+    }
+
+    return NUMBER_OF_HEADING_FILTERS - 1;
+}
+
 // @brief Deploy the local configuration to the overall system and save it to
 // EEPROM
 void ConfigPage2::DeployConfiguration()
 {
+    EEPROMConfig_t config;
+
+    // Configuration and Micronet device are shared with conversion tasks
+    gConversionTasks.LockData();
     DeployCompass();
     DeployGnss();
     DeployWind();
     DeployDepth();
     DeploySpeed();
+    gConfiguration.eeprom.headingFilter_ms = headingFilters_ms[configHeadingFilterSel];
+    gConfiguration.eeprom.autoMagVariation = (configMagVariationSel != 0);
 
     gConfiguration.DeployConfiguration(&gMicronetDevice);
-    gConfiguration.SaveToEeprom();
+    config = gConfiguration.eeprom;
+    gConversionTasks.UnlockData();
+
+    gConfiguration.SaveToEeprom(config);
 }
 
 // @brief Deploy compass configuration to the overall system
@@ -65,6 +65,8 @@ class ConfigPage2 : public PageHandler
     uint32_t configWindSel;
     uint32_t configDepthSel;
     uint32_t configSpeedSel;
+    uint32_t configHeadingFilterSel;
+    uint32_t configMagVariationSel;
 
     void DeployConfiguration();
     void DeployCompass();
@@ -79,6 +81,8 @@ class ConfigPage2 : public PageHandler
     char const *ConfigWindString();
     char const *ConfigDepthString();
     char const *ConfigSpeedString();
+    char const *ConfigHeadingFilterString();
+    char const *ConfigMagVariationString();
 
     void ConfigCycle(uint32_t index);
     void ConfigCompassCycle();
@@ -86,6 +90,10 @@ class ConfigPage2 : public PageHandler
     void ConfigWindCycle();
     void ConfigDepthCycle();
     void ConfigSpeedCycle();
+    void ConfigHeadingFilterCycle();
+    void ConfigMagVariationCycle();
+
+    uint32_t HeadingFilterToSel(uint16_t headingFilter_ms);
 };
 
 #endif
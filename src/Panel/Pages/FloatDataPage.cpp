@@ -34,6 +34,7 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include <Arduino.h>
+#include <string.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
@@ -61,6 +62,8 @@ FloatDataPage::FloatDataPage() : prevValue1(0), prevValue2(0), prevValue1Valid(f
 {
     this->value1 = nullptr;
     this->value2 = nullptr;
+    unit1        = "";
+    unit2        = "";
     fracDigit1   = false;
     fracDigit2   = false;
 }
@@ -69,17 +72,17 @@ FloatDataPage::~FloatDataPage()
 {
 }
 
-void FloatDataPage::SetData(FloatValue_t *value, std::string unit, bool fracDigit)
+void FloatDataPage::SetData(FloatValue_t *value, char const *unit, bool fracDigit)
 {
     this->value1     = value;
     this->unit1      = unit;
     this->fracDigit1 = fracDigit1;
     this->value2     = nullptr;
-    this->unit2      = std::string("");
+    this->unit2      = "";
     this->fracDigit2 = fracDigit2;
 }
 
-void FloatDataPage::SetData(FloatValue_t *value1, std::string unit1, bool fracDigit1, FloatValue_t *value2, std::string unit2, bool fracDigit2)
+void FloatDataPage::SetData(FloatValue_t *value1, char const *unit1, bool fracDigit1, FloatValue_t *value2, char const *unit2, bool fracDigit2)
 {
     this->value1 = value1;
     this->unit1  = unit1;
@@ -139,7 +142,7 @@ bool FloatDataPage::Draw(bool force, bool flushDisplay)
             {
                 snprintf(lineStr1V, sizeof(lineStr1V), "--");
             }
-            display->getTextBounds(String(lineStr1V), 0, 0, &xS1, &yS1, &wS1, &hS1);
+            display->getTextBounds(lineStr1V, 0, 0, &xS1, &yS1, &wS1, &hS1);
 
             if (fracDigit1)
             {
@@ -152,14 +155,14 @@ bool FloatDataPage::Draw(bool force, bool flushDisplay)
                 {
                     snprintf(lineStr1F, sizeof(lineStr1F), ".-");
                 }
-                display->getTextBounds(String(lineStr1F), 0, 0, &xS2, &yS2, &wS2, &hS2);
+                display->getTextBounds(lineStr1F, 0, 0, &xS2, &yS2, &wS2, &hS2);
             }
             else
             {
                 wS2 = 0;
             }
 
-            if (unit1.compare("o") == 0)
+            if (strcmp(unit1, "o") == 0)
             {
                 display->setFont(&FreeSansBold9pt);
                 unitVShift = -8;
@@ -169,7 +172,7 @@ bool FloatDataPage::Draw(bool force, bool flushDisplay)
                 display->setFont(&FreeSansBold12pt);
                 unitVShift = 0;
             }
-            display->getTextBounds(String(unit1.c_str()), 0, 0, &xS3, &yS3, &wS3, &hS3);
+            display->getTextBounds(unit1, 0, 0, &xS3, &yS3, &wS3, &hS3);
             int16_t xShift = (SCREEN_WIDTH - (wS1 + wS2 + wS3 + 8)) / 2;
 
             display->setFont(&FreeSansBold18pt);
@@ -183,12 +186,12 @@ bool FloatDataPage::Draw(bool force, bool flushDisplay)
                 display->print(lineStr1F);
             }
 
-            if (unit1.compare("o") == 0)
+            if (strcmp(unit1, "o") == 0)
             {
                 display->setFont(&FreeSansBold9pt);
             }
             display->setCursor(xShift + wS1 + 3 + wS2 + 5, 24 + unitVShift);
-            display->print(unit1.c_str());
+            display->print(unit1);
         }
 
         if (value2 != nullptr)
@@ -202,7 +205,7 @@ bool FloatDataPage::Draw(bool force, bool flushDisplay)
             {
                 snprintf(lineStr2V, sizeof(lineStr2V), "--");
             }
-            display->getTextBounds(String(lineStr2V), 0, 0, &xS1, &yS1, &wS1, &hS1);
+            display->getTextBounds(lineStr2V, 0, 0, &xS1, &yS1, &wS1, &hS1);
 
             if (fracDigit2)
             {
@@ -215,14 +218,14 @@ bool FloatDataPage::Draw(bool force, bool flushDisplay)
                 {
                     snprintf(lineStr2F, sizeof(lineStr2F), ".-");
                 }
-                display->getTextBounds(String(lineStr2F), 0, 0, &xS2, &yS2, &wS2, &hS2);
+                display->getTextBounds(lineStr2F, 0, 0, &xS2, &yS2, &wS2, &hS2);
             }
             else
             {
                 wS2 = 0;
             }
 
-            if (unit2.compare("o") == 0)
+            if (strcmp(unit2, "o") == 0)
             {
                 display->setFont(&FreeSansBold9pt);
                 unitVShift = -8;
@@ -232,7 +235,7 @@ bool FloatDataPage::Draw(bool force, bool flushDisplay)
                 display->setFont(&FreeSansBold12pt);
                 unitVShift = 0;
             }
-            display->getTextBounds(String(unit2.c_str()), 0, 0, &xS3, &yS3, &wS3, &hS3);
+            display->getTextBounds(unit2, 0, 0, &xS3, &yS3, &wS3, &hS3);
             int16_t xShift = (SCREEN_WIDTH - (wS1 + wS2 + wS3 + 8)) / 2;
 
             display->setFont(&FreeSansBold18pt);
@@ -246,12 +249,12 @@ bool FloatDataPage::Draw(bool force, bool flushDisplay)
                 display->print(lineStr2F);
             }
 
-            if (unit2.compare("o") == 0)
+            if (strcmp(unit2, "o") == 0)
             {
                 display->setFont(&FreeSansBold9pt);
             }
             display->setCursor(xShift + wS1 + 3 + wS2 + 5, 24 + 28 + unitVShift);
-            display->print(unit2.c_str());
+            display->print(unit2);
         }
 
         if (flushDisplay)
@@ -53,14 +53,14 @@ class FloatDataPage : public PageHandler
     virtual ~FloatDataPage();
 
     bool Draw(bool force, bool flushDisplay = true);
-    void SetData(FloatValue_t *value, std::string unit, bool fracDigit);
-    void SetData(FloatValue_t *value1, std::string unit1, bool fracDigit1, FloatValue_t *value2, std::string unit2, bool fracDigit2);
+    void SetData(FloatValue_t *value, char const *unit, bool fracDigit);
+    void SetData(FloatValue_t *value1, char const *unit1, bool fracDigit1, FloatValue_t *value2, char const *unit2, bool fracDigit2);
 
   private:
     FloatValue_t *value1;
     FloatValue_t *value2;
-    std::string unit1;
-    std::string unit2;
+    char const *unit1;
+    char const *unit2;
     bool fracDigit1;
     bool fracDigit2;
     int32_t prevValue1, prevValue2;
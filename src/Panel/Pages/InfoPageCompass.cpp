@@ -83,7 +83,7 @@ bool InfoPageCompass::Draw(bool force, bool flushDisplay)
     PrintLeft(0, "NavCompass");
     if (gConfiguration.ram.navCompassAvailable != 0)
     {
-        PrintRight(0, "LSM303");
+        PrintRight(0, gNavCompass.GetDeviceName());
     }
     else
     {
@@ -105,6 +105,18 @@ bool InfoPageCompass::Draw(bool force, bool flushDisplay)
     snprintf(lineStr, sizeof(lineStr), "%.1f%", gConfiguration.eeprom.zMagOffset);
     PrintRight(24, lineStr);
 
+    // Residual error of last ellipsoid fit
+    PrintLeft(32, "Fit error");
+    if (gConfiguration.eeprom.magFitError_per > 0)
+    {
+        snprintf(lineStr, sizeof(lineStr), "%.1f%%", gConfiguration.eeprom.magFitError_per);
+        PrintRight(32, lineStr);
+    }
+    else
+    {
+        PrintRight(32, "---");
+    }
+
     if (flushDisplay)
     {
         display->display();
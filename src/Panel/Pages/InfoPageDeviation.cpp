@@ -0,0 +1,148 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Handler of the compass deviation info page                    *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "InfoPageDeviation.h"
+#include "DeviationTable.h"
+#include "Globals.h"
+#include "PanelResources.h"
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+#include <Arduino.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Width of the bar of each sector, in pixels
+#define DEVIATION_BAR_WIDTH (SCREEN_WIDTH / DEVIATION_NB_SECTORS)
+// Vertical position of the zero deviation axis and half height of the graph, in pixels
+#define DEVIATION_GRAPH_AXIS   38
+#define DEVIATION_GRAPH_HEIGHT 24
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+InfoPageDeviation::InfoPageDeviation()
+{
+}
+
+InfoPageDeviation::~InfoPageDeviation()
+{
+}
+
+/*
+  Draw the page on display : a bar graph of the deviation of each heading sector, from 0° on the left to 345° on the
+  right. Sectors without any sample are drawn as a dot on the axis.
+  @param force Force redraw, even if the content did not change
+*/
+bool InfoPageDeviation::Draw(bool force, bool flushDisplay)
+{
+    char            lineStr[22];
+    DeviationTable *table  = gDataBridge.GetDeviationTable();
+    float           maxDev = 0.0f;
+
+    display->clearDisplay();
+
+    display->setTextSize(1);
+    display->setFont(nullptr);
+    display->setTextColor(SSD1306_WHITE);
+
+    for (uint32_t i = 0; i < DEVIATION_NB_SECTORS; i++)
+    {
+        float   deviation = table->GetSectorDeviation(i);
+        int16_t x         = i * DEVIATION_BAR_WIDTH;
+
+        if (fabsf(deviation) > fabsf(maxDev))
+        {
+            maxDev = deviation;
+        }
+
+        if (table->GetSectorSamples(i) == 0)
+        {
+            display->drawPixel(x + DEVIATION_BAR_WIDTH / 2, DEVIATION_GRAPH_AXIS, SSD1306_WHITE);
+            continue;
+        }
+
+        // One pixel per degree, clipped to the graph height
+        int16_t height = (int16_t)lroundf(fmaxf(-DEVIATION_GRAPH_HEIGHT, fminf(DEVIATION_GRAPH_HEIGHT, deviation)));
+        if (height >= 0)
+        {
+            display->fillRect(x, DEVIATION_GRAPH_AXIS - height, DEVIATION_BAR_WIDTH - 1, height + 1, SSD1306_WHITE);
+        }
+        else
+        {
+            display->fillRect(x, DEVIATION_GRAPH_AXIS, DEVIATION_BAR_WIDTH - 1, 1 - height, SSD1306_WHITE);
+        }
+    }
+
+    PrintLeft(0, "Deviation");
+    snprintf(lineStr, sizeof(lineStr), "max %+.1f", maxDev);
+    PrintRight(0, lineStr);
+
+    if (flushDisplay)
+    {
+        display->display();
+    }
+
+    return true;
+}
+
+// @brief Function called by PanelManager when the button is pressed
+// @param longPress true if a long press was detected
+// @return Action to be executed by PanelManager
+PageAction_t InfoPageDeviation::OnButtonPressed(ButtonId_t buttonId, bool longPress)
+{
+    PageAction_t action = PAGE_ACTION_NONE;
+
+    if ((buttonId == BUTTON_ID_1) && !longPress)
+    {
+        action = PAGE_ACTION_EXIT_PAGE;
+    }
+    else if ((buttonId == BUTTON_ID_0) && !longPress)
+    {
+        action = PAGE_ACTION_EXIT_TOPIC;
+    }
+
+    return action;
+}
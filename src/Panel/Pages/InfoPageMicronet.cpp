@@ -124,6 +124,13 @@ bool InfoPageMicronet::Draw(bool force, bool flushDisplay)
     snprintf(lineStr, sizeof(lineStr), "%d", deviceInfo.nbNetworksInRange);
     PrintRight(32, lineStr);
 
+    // NMEA WiFi access point
+    gNmeaMultiplexer.GetWifiSsid(lineStr, sizeof(lineStr));
+    PrintLeft(40, "WiFi");
+    PrintRight(40, lineStr);
+    PrintLeft(48, "Password");
+    PrintRight(48, gConfiguration.eeprom.wifiPassword);
+
     if (flushDisplay)
     {
         display->display();
@@ -90,7 +90,7 @@ bool LogoPage::Draw(bool force, bool flushDisplay)
         display->setTextSize(1);
         display->setFont(nullptr);
         snprintf(versionStr, sizeof(versionStr), "v%d.%d.%d", swMajorVersion, swMinorVersion, swPatchVersion);
-        display->getTextBounds(String(versionStr), 0, 0, &xVersion, &yVersion, &wVersion, &hVersion);
+        display->getTextBounds(versionStr, 0, 0, &xVersion, &yVersion, &wVersion, &hVersion);
         display->setCursor(SCREEN_WIDTH - wVersion, LOGO_HEIGHT - yVersion + 2);
         display->print(versionStr);
         if (flushDisplay)
@@ -116,7 +116,7 @@ bool NetworkPage::Draw(bool force, bool flushDisplay)
             display->setTextColor(SSD1306_WHITE);
             display->setTextSize(1);
             display->setFont(&FreeSansBold9pt);
-            display->getTextBounds(String(noNetStr), 0, 0, &xStr, &yStr, &wStr, &hStr);
+            display->getTextBounds(noNetStr, 0, 0, &xStr, &yStr, &wStr, &hStr);
             display->setCursor((SCREEN_WIDTH - wStr) / 2, (SCREEN_HEIGHT - 8 - yStr) / 2 - 8);
             display->println(noNetStr);
         }
@@ -0,0 +1,120 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Driver for SSD1306 display on the shared I2C bus              *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "PanelDisplay.h"
+#include "Globals.h"
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// Number of frame buffer bytes sent in each bus access, ~0.8ms at 400kHz
+#define PANEL_DISPLAY_CHUNK_SIZE 32
+// Control byte announcing display RAM data
+#define SSD1306_DATA_STREAM 0x40
+
+/***************************************************************************/
+/*                             Local types                                 */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Local prototypes                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                           Static & Globals                              */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+PanelDisplay::PanelDisplay(uint8_t width, uint8_t height, TwoWire *wire, int8_t resetPin) : Adafruit_SSD1306(width, height, wire, resetPin)
+{
+}
+
+PanelDisplay::~PanelDisplay()
+{
+}
+
+/*
+  Allocate frame buffer and initialize display controller
+  @return true if initialization is successful
+*/
+bool PanelDisplay::begin(uint8_t switchVcc, uint8_t i2cAddress)
+{
+    gI2CBus.Acquire(I2C_CLIENT_DISPLAY);
+    bool success = Adafruit_SSD1306::begin(switchVcc, i2cAddress);
+    gI2CBus.Release();
+
+    return success;
+}
+
+/*
+  Push the frame buffer to display RAM. Display controller auto-increments its RAM address, so that the frame can be
+  sent in several transfers and the bus released between them.
+*/
+void PanelDisplay::display()
+{
+    uint8_t  windowCommands[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0, (uint8_t)(WIDTH - 1)};
+    uint32_t frameSize        = WIDTH * ((HEIGHT + 7) / 8);
+    TwoWire *bus;
+
+    bus = gI2CBus.Acquire(I2C_CLIENT_DISPLAY);
+    bus->setClock(wireClk);
+    ssd1306_commandList(windowCommands, sizeof(windowCommands));
+    bus->setClock(restoreClk);
+    gI2CBus.Release();
+
+    for (uint32_t offset = 0; offset < frameSize; offset += PANEL_DISPLAY_CHUNK_SIZE)
+    {
+        uint32_t length = (frameSize - offset < PANEL_DISPLAY_CHUNK_SIZE) ? frameSize - offset : PANEL_DISPLAY_CHUNK_SIZE;
+
+        bus = gI2CBus.Acquire(I2C_CLIENT_DISPLAY);
+        bus->setClock(wireClk);
+        bus->beginTransmission(i2caddr);
+        bus->write(SSD1306_DATA_STREAM);
+        bus->write(buffer + offset, length);
+        bus->endTransmission();
+        bus->setClock(restoreClk);
+        gI2CBus.Release();
+    }
+}
+
+/*
+  Enable/disable display dimming
+*/
+void PanelDisplay::dim(bool dim)
+{
+    gI2CBus.Acquire(I2C_CLIENT_DISPLAY);
+    Adafruit_SSD1306::dim(dim);
+    gI2CBus.Release();
+}
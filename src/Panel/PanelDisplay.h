@@ -0,0 +1,67 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Driver for SSD1306 display on the shared I2C bus              *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+
+#ifndef PANELDISPLAY_H_
+#define PANELDISPLAY_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <Adafruit_SSD1306.h>
+#include <Wire.h>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+/*
+  SSD1306 driver sharing its I2C bus through gI2CBus. Frame buffer is pushed in small chunks, each one being a
+  separate bus access, so that compass and PMU transfers are not delayed by a full frame transfer.
+*/
+class PanelDisplay : public Adafruit_SSD1306
+{
+  public:
+    PanelDisplay(uint8_t width, uint8_t height, TwoWire *wire, int8_t resetPin);
+    virtual ~PanelDisplay();
+
+    bool begin(uint8_t switchVcc, uint8_t i2cAddress);
+    void display();
+    void dim(bool dim);
+};
+
+#endif /* PANELDISPLAY_H_ */
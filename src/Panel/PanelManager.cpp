@@ -30,6 +30,7 @@
 
 #include "PanelManager.h"
 #include "BoardConfig.h"
+#include "PanelDisplay.h"
 #include "PanelResources.h"
 #include "Version.h"
 
@@ -70,8 +71,8 @@
 /*                           Static & Globals                              */
 /***************************************************************************/
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
-PanelManager    *PanelManager::objectPtr;
+PanelDisplay  display(SCREEN_WIDTH, SCREEN_HEIGHT, &SHARED_I2C, OLED_RESET);
+PanelManager *PanelManager::objectPtr;
 
 /***************************************************************************/
 /*                              Functions                                  */
@@ -81,8 +82,8 @@ PanelManager    *PanelManager::objectPtr;
   Constructor of the PanelManager class instance
 */
 PanelManager::PanelManager()
-    : displayAvailable(false), topicIndex(0), statusTopic("Status"), infoTopic("Info"), configTopic("Config"), commandTopic("Command"),
-      currentTopic(nullptr)
+    : displayAvailable(false), topicIndex(0), nbTopics(0), statusTopic("Status"), infoTopic("Info"), configTopic("Config"), commandTopic("Command"),
+      currentTopic(nullptr), commandMutex(portMUX_INITIALIZER_UNLOCKED), buttonMutex(portMUX_INITIALIZER_UNLOCKED)
 {
     memset(&networkStatus, 0, sizeof(networkStatus));
 }
@@ -111,35 +112,34 @@ bool PanelManager::Init()
 
         topicIndex = 0;
 
-        commandMutex      = portMUX_INITIALIZER_UNLOCKED;
-        buttonMutex       = portMUX_INITIALIZER_UNLOCKED;
         commandEventGroup = xEventGroupCreate();
-        xTaskCreate(CommandProcessingTask, "DioTask", 16384, (void *)this, 5, &commandTaskHandle);
+        xTaskCreatePinnedToCore(CommandProcessingTask, "DioTask", PANEL_TASK_STACK_SIZE, (void *)this, PANEL_TASK_PRIORITY, &commandTaskHandle, APP_CORE);
     }
 
-    depthPage.SetData(&PageHandler::navData.dpt_m, std::string("m"), true, &PageHandler::navData.stp_degc, std::string("c"), true);
-    speedPage.SetData(&PageHandler::navData.spd_kt, std::string("kt"), true, &PageHandler::navData.vcc_v, std::string("v"), true);
-    trueWindPage.SetData(&PageHandler::navData.tws_kt, std::string("kt"), true, &PageHandler::navData.twa_deg, std::string("o"), false);
+    depthPage.SetData(&PageHandler::navData.dpt_m, "m", true, &PageHandler::navData.stp_degc, "c", true);
+    speedPage.SetData(&PageHandler::navData.spd_kt, "kt", true, &PageHandler::navData.vcc_v, "v", true);
+    trueWindPage.SetData(&PageHandler::navData.tws_kt, "kt", true, &PageHandler::navData.twa_deg, "o", false);
 
     statusTopic.AddPage(&clockPage, "Data: Time, Date");
     statusTopic.AddPage(&depthPage, "Data: DPT, STP");
     statusTopic.AddPage(&speedPage, "Data: SPD, VCC");
     statusTopic.AddPage(&trueWindPage, "Data: TWS, TWA");
-    topicList.push_back(&statusTopic);
+    topicList[nbTopics++] = &statusTopic;
 
     infoTopic.AddPage(&networkPage, "Info: RF quality");
     infoTopic.AddPage(&infoPagePower, "Info: Battery");
     infoTopic.AddPage(&infoPageMicronet, "Info: Micronet");
     infoTopic.AddPage(&infoPageSensors, "Info: Sensors");
     infoTopic.AddPage(&infoPageCompass, "Info: Compass");
-    topicList.push_back(&infoTopic);
+    infoTopic.AddPage(&infoPageDeviation, "Info: Deviation");
+    topicList[nbTopics++] = &infoTopic;
 
     configTopic.AddPage(&configPage1, "Config: General");
     configTopic.AddPage(&configPage2, "Config: Links");
-    topicList.push_back(&configTopic);
+    topicList[nbTopics++] = &configTopic;
 
     commandTopic.AddPage(&commandPage, "Commands");
-    topicList.push_back(&commandTopic);
+    topicList[nbTopics++] = &commandTopic;
 
     currentTopic = &statusTopic;
     topicIndex   = 0;
@@ -182,7 +182,7 @@ void PanelManager::DrawPageISR()
 void PanelManager::NextTopic()
 {
     portENTER_CRITICAL(&commandMutex);
-    this->topicIndex = (topicIndex + 1) < topicList.size() ? topicIndex + 1 : 0;
+    this->topicIndex = (topicIndex + 1) < nbTopics ? topicIndex + 1 : 0;
     portEXIT_CRITICAL(&commandMutex);
 }
 
@@ -192,7 +192,7 @@ void PanelManager::NextTopic()
 void PanelManager::NextTopicISR()
 {
     portENTER_CRITICAL_ISR(&commandMutex);
-    this->topicIndex = (topicIndex + 1) < topicList.size() ? topicIndex + 1 : 0;
+    this->topicIndex = (topicIndex + 1) < nbTopics ? topicIndex + 1 : 0;
     portEXIT_CRITICAL_ISR(&commandMutex);
 }
 
@@ -352,7 +352,7 @@ void PanelManager::CommandCallback()
         {
             lastPageUpdate = now;
             portENTER_CRITICAL(&commandMutex);
-            currentTopic = topicList.at(topicIndex);
+            currentTopic = topicList[topicIndex];
             portEXIT_CRITICAL(&commandMutex);
 
             currentTopic->Draw(commandFlags & (COMMAND_EVENT_NEW_PAGE | COMMAND_EVENT_REFRESH));
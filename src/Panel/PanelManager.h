@@ -37,6 +37,7 @@
 #include "ConfigPage2.h"
 #include "FloatDataPage.h"
 #include "InfoPageCompass.h"
+#include "InfoPageDeviation.h"
 #include "InfoPageMicronet.h"
 #include "InfoPagePower.h"
 #include "InfoPageSensors.h"
@@ -48,12 +49,13 @@
 #include "TopicHandler.h"
 
 #include <Arduino.h>
-#include <vector>
 
 /***************************************************************************/
 /*                              Constants                                  */
 /***************************************************************************/
 
+#define PANEL_MAX_TOPICS 4
+
 /***************************************************************************/
 /*                                Types                                    */
 /***************************************************************************/
@@ -78,28 +80,30 @@ class PanelManager
     void LowPower(bool enable);
 
   private:
-    bool                        displayAvailable;
-    uint32_t                    topicIndex;
-    TopicHandler               *currentTopic;
-    std::vector<TopicHandler *> topicList;
-    TopicHandler                statusTopic;
-    TopicHandler                infoTopic;
-    TopicHandler                configTopic;
-    TopicHandler                commandTopic;
-
-    LogoPage         logoPage;
-    ClockPage        clockPage;
-    NetworkPage      networkPage;
-    InfoPageMicronet infoPageMicronet;
-    InfoPageSensors  infoPageSensors;
-    InfoPagePower    infoPagePower;
-    InfoPageCompass  infoPageCompass;
-    ConfigPage1      configPage1;
-    ConfigPage2      configPage2;
-    CommandPage      commandPage;
-    FloatDataPage    depthPage;
-    FloatDataPage    speedPage;
-    FloatDataPage    trueWindPage;
+    bool          displayAvailable;
+    uint32_t      topicIndex;
+    TopicHandler *currentTopic;
+    TopicHandler *topicList[PANEL_MAX_TOPICS];
+    uint32_t      nbTopics;
+    TopicHandler  statusTopic;
+    TopicHandler  infoTopic;
+    TopicHandler  configTopic;
+    TopicHandler  commandTopic;
+
+    LogoPage          logoPage;
+    ClockPage         clockPage;
+    NetworkPage       networkPage;
+    InfoPageMicronet  infoPageMicronet;
+    InfoPageSensors   infoPageSensors;
+    InfoPagePower     infoPagePower;
+    InfoPageCompass   infoPageCompass;
+    InfoPageDeviation infoPageDeviation;
+    ConfigPage1       configPage1;
+    ConfigPage2       configPage2;
+    CommandPage       commandPage;
+    FloatDataPage     depthPage;
+    FloatDataPage     speedPage;
+    FloatDataPage     trueWindPage;
 
     NavigationData    *navData;
     DeviceInfo_t       networkStatus;
@@ -58,10 +58,11 @@
 /*
     Class constructor
 */
-TopicHandler::TopicHandler(std::string topicName)
+TopicHandler::TopicHandler(char const *topicName)
 {
     this->topicName = topicName;
     pageIndex       = 0;
+    nbPages         = 0;
 }
 
 /*
@@ -77,13 +78,11 @@ TopicHandler::~TopicHandler()
 */
 bool TopicHandler::Draw(bool force, bool flushDisplay)
 {
-    int  listSize = pageList.size();
-    int  i;
     bool drawed = false;
 
-    if (listSize > pageIndex)
+    if (nbPages > pageIndex)
     {
-        drawed = pageList.at(pageIndex).handler->Draw(force, false);
+        drawed = pageList[pageIndex].handler->Draw(force, false);
     }
 
     if (drawed)
@@ -91,7 +90,7 @@ bool TopicHandler::Draw(bool force, bool flushDisplay)
         display->setTextSize(1);
         display->setFont(nullptr);
         display->setTextColor(SSD1306_WHITE);
-        PrintLeft(56, pageList.at(pageIndex).name.c_str());
+        PrintLeft(56, pageList[pageIndex].name);
         DrawBatteryStatus(SCREEN_WIDTH - 22, 56, lroundf(gPower.GetStatus().batteryLevel_per));
         if (flushDisplay)
         {
@@ -102,29 +101,39 @@ bool TopicHandler::Draw(bool force, bool flushDisplay)
     return drawed;
 }
 
-void TopicHandler::AddPage(PageHandler *pageHandler, std::string name)
+/*
+    Add a page to the topic
+    @param pageHandler Page to be added
+    @param name Name of the page, must remain allocated
+    @return false if the topic is full
+*/
+bool TopicHandler::AddPage(PageHandler *pageHandler, char const *name)
 {
-    PageRef_t pageRef;
+    if (nbPages >= TOPIC_MAX_PAGES)
+    {
+        return false;
+    }
 
-    pageRef.name    = name;
-    pageRef.handler = pageHandler;
+    pageList[nbPages].name    = name;
+    pageList[nbPages].handler = pageHandler;
+    nbPages++;
 
-    pageList.push_back(pageRef);
+    return true;
 }
 
 PageAction_t TopicHandler::OnButtonPressed(ButtonId_t buttonId, bool longPress)
 {
     PageAction_t action = PAGE_ACTION_EXIT_TOPIC;
 
-    if (pageList.size() >= pageIndex)
+    if (nbPages > pageIndex)
     {
-        action = pageList.at(pageIndex).handler->OnButtonPressed(buttonId, longPress);
+        action = pageList[pageIndex].handler->OnButtonPressed(buttonId, longPress);
     }
 
     if (action == PAGE_ACTION_EXIT_PAGE)
     {
         pageIndex = (pageIndex + 1);
-        if (pageIndex >= pageList.size())
+        if (pageIndex >= nbPages)
         {
             pageIndex = 0;
         }
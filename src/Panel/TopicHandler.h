@@ -34,13 +34,14 @@
 #include "MicronetDevice.h"
 #include "PageHandler.h"
 
-#include <vector>
-#include <string>
+#include <stdint.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
 /***************************************************************************/
 
+#define TOPIC_MAX_PAGES 8
+
 /***************************************************************************/
 /*                                Types                                    */
 /***************************************************************************/
@@ -48,7 +49,7 @@
 typedef struct
 {
     PageHandler *handler;
-    std::string name;
+    char const  *name;
 } PageRef_t;
 
 /***************************************************************************/
@@ -58,16 +59,17 @@ typedef struct
 class TopicHandler : public PageHandler
 {
     public:
-        TopicHandler(std::string topicName);
+        TopicHandler(char const *topicName);
         virtual ~TopicHandler();
-        void AddPage(PageHandler *pageHandler, std::string pageName);
+        bool AddPage(PageHandler *pageHandler, char const *pageName);
         virtual bool Draw(bool force, bool flushDisplay = true);
         virtual PageAction_t OnButtonPressed(ButtonId_t buttonId, bool longPress);
 
     protected:
-        std::string topicName;
+        char const *topicName;
         uint32_t pageIndex;
-        std::vector<PageRef_t> pageList;
+        uint32_t nbPages;
+        PageRef_t pageList[TOPIC_MAX_PAGES];
 
         void DrawBatteryStatus(uint32_t x, uint32_t y, uint32_t level);
 };
@@ -34,6 +34,8 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <driver/uart.h>
+#include <esp_sleep.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
@@ -55,6 +57,13 @@
 #define BATTERY_LEVEL_FILTERING_FACTOR 0.99f
 #define TEMPERATURE_FILTERING_FACTOR   0.98f
 
+// CPU frequencies used by dynamic frequency scaling
+#define CPU_MAX_FREQUENCY_MHZ 240
+#define CPU_MIN_FREQUENCY_MHZ 80
+
+// Number of characters to be received by the console UART to wake-up from light sleep
+#define CONSOLE_UART_WAKEUP_THRESHOLD 3
+
 // Estimated internal resistance of battery.
 #define BATTERY_INTERNAL_RESISTANCE_OHM 0.150f
 
@@ -81,8 +90,11 @@ const int32_t Power::voltageTable[VOLTAGE_TABLE_ENTRIES] = {3000, 3650, 3700, 37
 /***************************************************************************/
 
 // Class constructor
-Power::Power() : buttonCallback(nullptr), firstBatteryQuery(true)
+Power::Power() : buttonCallback(nullptr), firstBatteryQuery(true), maxFrequencyLock(nullptr)
 {
+    // Sleep statistics start at boot
+    memset(&sleepStats, 0, sizeof(sleepStats));
+    memset(stateCurrent, 0, sizeof(stateCurrent));
 }
 
 // Class destructor
@@ -92,8 +104,11 @@ Power::~Power()
 
 bool Power::Init()
 {
-    if (!AXPDriver.begin(Wire, AXP192_SLAVE_ADDRESS, PMU_I2C_SDA, PMU_I2C_SCL))
+    gI2CBus.Acquire(I2C_CLIENT_PMU);
+
+    if (!AXPDriver.begin(SHARED_I2C, AXP192_SLAVE_ADDRESS, PMU_I2C_SDA, PMU_I2C_SCL))
     {
+        gI2CBus.Release();
         return false;
     }
 
@@ -133,14 +148,18 @@ bool Power::Init()
     // Set the timing after one minute, the isWdtExpireIrq will be triggered in the loop interrupt function
     AXPDriver.setTimerout(1);
 
+    gI2CBus.Release();
+
     UpdateStatus();
 
     powerEventGroup = xEventGroupCreate();
-    xTaskCreate(StaticProcessingTask, "PowerTask", 16384, (void *)this, 6, &powerTaskHandle);
+    xTaskCreatePinnedToCore(StaticProcessingTask, "PowerTask", POWER_TASK_STACK_SIZE, (void *)this, POWER_TASK_PRIORITY, &powerTaskHandle, APP_CORE);
 
+    gI2CBus.Acquire(I2C_CLIENT_PMU);
     AXPDriver.disableIRQ(XPOWERS_AXP192_ALL_IRQ);
     AXPDriver.clearIrqStatus();
     AXPDriver.enableIRQ(XPOWERS_AXP192_PKEY_SHORT_IRQ | XPOWERS_AXP192_PKEY_LONG_IRQ);
+    gI2CBus.Release();
     pinMode(PMU_IRQ, INPUT);
     attachInterrupt(PMU_IRQ, StaticIrqCallback, FALLING);
 
@@ -162,6 +181,145 @@ PowerStatus_t &Power::GetStatus()
     return powerStatus;
 }
 
+/*
+  Put the CPU in light sleep. Both cores are stopped and peripheral clocks are gated. Wake-up occurs at the end of the
+  requested duration or on activity of the console UART. The characters which woke up the CPU are lost. GNSS UART
+  cannot wake-up the CPU and the start of its bursts would be lost too : light sleep must not be used when the
+  internal GNSS is the position source.
+  @param duration_us Sleep duration in microseconds
+  @return true if the CPU slept for the whole duration, false if it was woken up by UART activity
+*/
+bool Power::LightSleep(uint32_t duration_us)
+{
+    esp_sleep_enable_timer_wakeup(duration_us);
+    uart_set_wakeup_threshold(UART_NUM_0, CONSOLE_UART_WAKEUP_THRESHOLD);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+
+    uint64_t startTime_us = esp_timer_get_time();
+    esp_light_sleep_start();
+    uint64_t sleepTime_us = esp_timer_get_time() - startTime_us;
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+
+    bool timerWakeup = (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER);
+
+    sleepStats.nbSleeps++;
+    sleepStats.sleepTime_us += sleepTime_us;
+    if (!timerWakeup)
+    {
+        sleepStats.nbEarlyWakeups++;
+    }
+
+    // PMU IRQ line stays low until its status is cleared : check that no falling edge has been missed during sleep
+    if (digitalRead(PMU_IRQ) == LOW)
+    {
+        xEventGroupSetBits(powerEventGroup, POWER_EVENT_IRQ);
+    }
+
+    return timerWakeup;
+}
+
+/*
+  Enable dynamic frequency scaling : CPU runs at minimum frequency unless a task holds the maximum frequency lock.
+  Requires power management support (CONFIG_PM_ENABLE) in the ESP-IDF build.
+  @return true if frequency scaling is enabled
+*/
+bool Power::InitFrequencyScaling()
+{
+    esp_pm_config_esp32_t pmConfig;
+
+    pmConfig.max_freq_mhz       = CPU_MAX_FREQUENCY_MHZ;
+    pmConfig.min_freq_mhz       = CPU_MIN_FREQUENCY_MHZ;
+    pmConfig.light_sleep_enable = false;
+
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "MaxFrequency", &maxFrequencyLock) != ESP_OK)
+    {
+        maxFrequencyLock = nullptr;
+        return false;
+    }
+
+    if (esp_pm_configure(&pmConfig) != ESP_OK)
+    {
+        esp_pm_lock_delete(maxFrequencyLock);
+        maxFrequencyLock = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+  Hold the CPU at maximum frequency until the matching call to UnlockMaxFrequency(). Calls can be nested.
+*/
+void Power::LockMaxFrequency()
+{
+    if (maxFrequencyLock != nullptr)
+    {
+        esp_pm_lock_acquire(maxFrequencyLock);
+    }
+}
+
+/*
+  Release the maximum frequency lock taken with LockMaxFrequency()
+*/
+void Power::UnlockMaxFrequency()
+{
+    if (maxFrequencyLock != nullptr)
+    {
+        esp_pm_lock_release(maxFrequencyLock);
+    }
+}
+
+/*
+  Add a sample of the current consumption of the system to the statistics of a device state. Consumption is estimated
+  from AXP192 measurements as USB input current minus battery charge current.
+  @param state Device state, from 0 to POWER_NB_LOGGED_STATES - 1
+*/
+void Power::LogStateCurrent(uint32_t state)
+{
+    if (state < POWER_NB_LOGGED_STATES)
+    {
+        stateCurrent[state].nbSamples++;
+        stateCurrent[state].totalCurrent_mA += powerStatus.usbCurrent_mA - powerStatus.batteryCurrent_mA;
+    }
+}
+
+/*
+  Get current consumption statistics of a device state since last call to ResetStateCurrent()
+  @param state Device state, from 0 to POWER_NB_LOGGED_STATES - 1
+*/
+CurrentStats_t &Power::GetStateCurrent(uint32_t state)
+{
+    return stateCurrent[state < POWER_NB_LOGGED_STATES ? state : 0];
+}
+
+/*
+  Reset current consumption statistics of all device states
+*/
+void Power::ResetStateCurrent()
+{
+    memset(stateCurrent, 0, sizeof(stateCurrent));
+}
+
+/*
+  Get light sleep statistics since last call to ResetSleepStats()
+*/
+SleepStats_t &Power::GetSleepStats()
+{
+    return sleepStats;
+}
+
+/*
+  Reset light sleep statistics and start a new measurement period
+*/
+void Power::ResetSleepStats()
+{
+    sleepStats.nbSleeps       = 0;
+    sleepStats.nbEarlyWakeups = 0;
+    sleepStats.sleepTime_us   = 0;
+    sleepStats.startTime_us   = esp_timer_get_time();
+}
+
 /*
   Static entry point of the command processing task
   @param callingObject Pointer to the calling PanelManager instance
@@ -185,21 +343,25 @@ void Power::ProcessingTask()
         }
         if (commandFlags & POWER_EVENT_IRQ)
         {
+            gI2CBus.Acquire(I2C_CLIENT_PMU);
             AXPDriver.getIrqStatus();
+            bool shortPress = AXPDriver.isPekeyShortPressIrq();
+            bool longPress  = AXPDriver.isPekeyLongPressIrq();
+            AXPDriver.clearIrqStatus();
+            gI2CBus.Release();
 
+            // Callbacks are called once the bus has been released since they may access the display
             if (buttonCallback != nullptr)
             {
-                if (AXPDriver.isPekeyShortPressIrq())
+                if (shortPress)
                 {
                     buttonCallback(false);
                 }
-                if (AXPDriver.isPekeyLongPressIrq())
+                if (longPress)
                 {
                     buttonCallback(true);
                 }
             }
-
-            AXPDriver.clearIrqStatus();
         }
 
         UpdateStatus();
@@ -214,14 +376,32 @@ void IRAM_ATTR Power::StaticIrqCallback()
     portYIELD_FROM_ISR(scheduleChange);
 }
 
+/*
+  Read one value from the PMU, owning the I2C bus for this single read. The bus is released between values : PMU is an
+  urgent client, holding the bus for the whole set of registers would delay compass sampling by as many transfers.
+  @param getter XPowersLib member function reading the value
+  @return Value returned by the getter
+*/
+template <typename Getter> auto Power::ReadPmu(Getter getter) -> decltype((AXPDriver.*getter)())
+{
+    gI2CBus.Acquire(I2C_CLIENT_PMU);
+    auto value = (AXPDriver.*getter)();
+    gI2CBus.Release();
+
+    return value;
+}
+
 void Power::UpdateStatus()
 {
-    float batVoltage_V  = AXPDriver.getBattVoltage() / 1000.0f;
-    float batCurrent_mA = AXPDriver.getBatteryChargeCurrent() - AXPDriver.getBattDischargeCurrent();
+    float batVoltage_V  = ReadPmu(&XPowersPMU::getBattVoltage) / 1000.0f;
+    float batCurrent_mA = ReadPmu(&XPowersPMU::getBatteryChargeCurrent) - ReadPmu(&XPowersPMU::getBattDischargeCurrent);
+    float usbVoltage_V  = ReadPmu(&XPowersPMU::getVbusVoltage) / 1000.0f;
+    float usbCurrent_mA = ReadPmu(&XPowersPMU::getVbusCurrent);
+    float temperature_C = ReadPmu(&XPowersPMU::getTemperature);
 
-    powerStatus.batteryConnected = AXPDriver.isBatteryConnect();
-    powerStatus.batteryCharging  = AXPDriver.isCharging();
-    powerStatus.usbConnected     = AXPDriver.isVbusIn();
+    powerStatus.batteryConnected = ReadPmu(&XPowersPMU::isBatteryConnect);
+    powerStatus.batteryCharging  = ReadPmu(&XPowersPMU::isCharging);
+    powerStatus.usbConnected     = ReadPmu(&XPowersPMU::isVbusIn);
 
     if (firstBatteryQuery)
     {
@@ -229,21 +409,20 @@ void Power::UpdateStatus()
         powerStatus.batteryVoltage_V  = batVoltage_V;
         powerStatus.batteryCurrent_mA = batCurrent_mA;
         powerStatus.batteryLevel_per  = GetBatteryLevel(batVoltage_V, batCurrent_mA);
-        powerStatus.usbVoltage_V      = AXPDriver.getVbusVoltage();
-        powerStatus.usbCurrent_mA     = AXPDriver.getVbusCurrent();
-        powerStatus.temperature_C     = AXPDriver.getTemperature();
+        powerStatus.usbVoltage_V      = usbVoltage_V;
+        powerStatus.usbCurrent_mA     = usbCurrent_mA;
+        powerStatus.temperature_C     = temperature_C;
     }
     else
     {
         powerStatus.batteryVoltage_V = (VOLTAGE_FILTERING_FACTOR * powerStatus.batteryVoltage_V) + ((1.0f - VOLTAGE_FILTERING_FACTOR) * batVoltage_V);
         powerStatus.batteryCurrent_mA =
             (CURRENT_FILTERING_FACTOR * powerStatus.batteryCurrent_mA) + ((1.0f - CURRENT_FILTERING_FACTOR) * batCurrent_mA);
-        powerStatus.usbVoltage_V =
-            (VOLTAGE_FILTERING_FACTOR * powerStatus.usbVoltage_V) + ((1.0f - VOLTAGE_FILTERING_FACTOR) * AXPDriver.getVbusVoltage() / 1000.0f);
+        powerStatus.usbVoltage_V = (VOLTAGE_FILTERING_FACTOR * powerStatus.usbVoltage_V) + ((1.0f - VOLTAGE_FILTERING_FACTOR) * usbVoltage_V);
         powerStatus.usbCurrent_mA =
-            (CURRENT_FILTERING_FACTOR * powerStatus.usbCurrent_mA) + ((1.0f - CURRENT_FILTERING_FACTOR) * AXPDriver.getVbusCurrent());
+            (CURRENT_FILTERING_FACTOR * powerStatus.usbCurrent_mA) + ((1.0f - CURRENT_FILTERING_FACTOR) * usbCurrent_mA);
         powerStatus.temperature_C =
-            (TEMPERATURE_FILTERING_FACTOR * powerStatus.temperature_C) + ((1.0f - TEMPERATURE_FILTERING_FACTOR) * AXPDriver.getTemperature());
+            (TEMPERATURE_FILTERING_FACTOR * powerStatus.temperature_C) + ((1.0f - TEMPERATURE_FILTERING_FACTOR) * temperature_C);
         powerStatus.batteryLevel_per =
             BATTERY_LEVEL_FILTERING_FACTOR * powerStatus.batteryLevel_per +
             (1.0f - BATTERY_LEVEL_FILTERING_FACTOR) * GetBatteryLevel(powerStatus.batteryVoltage_V, powerStatus.batteryCurrent_mA);
@@ -252,12 +431,14 @@ void Power::UpdateStatus()
 
 void Power::CommandShutdown()
 {
+    gI2CBus.Acquire(I2C_CLIENT_PMU);
     AXPDriver.shutdown();
+    gI2CBus.Release();
 }
 
 uint16_t Power::GetBatteryLevel(float voltage_V, float current_mA)
 {
-    if (!AXPDriver.isBatteryConnect())
+    if (!powerStatus.batteryConnected)
     {
         return -1;
     }
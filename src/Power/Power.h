@@ -36,12 +36,14 @@
 
 #include "XPowersLib.h"
 #include <Arduino.h>
+#include <esp_pm.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
 /***************************************************************************/
 
-#define VOLTAGE_TABLE_ENTRIES 11
+#define VOLTAGE_TABLE_ENTRIES  11
+#define POWER_NB_LOGGED_STATES 3 // Number of device states with current consumption statistics
 
 /***************************************************************************/
 /*                                Types                                    */
@@ -60,6 +62,20 @@ typedef struct
     float temperature_C;
 } PowerStatus_t;
 
+typedef struct
+{
+    uint32_t nbSleeps;       // Number of light sleep periods
+    uint32_t nbEarlyWakeups; // Number of light sleep periods interrupted by UART activity
+    uint64_t sleepTime_us;   // Cumulated light sleep time
+    uint64_t startTime_us;   // Beginning of the measurement period
+} SleepStats_t;
+
+typedef struct
+{
+    uint32_t nbSamples;       // Number of current samples
+    float    totalCurrent_mA; // Sum of current samples
+} CurrentStats_t;
+
 typedef void (*ButtonCallback_t)(bool);
 
 /***************************************************************************/
@@ -72,19 +88,31 @@ class Power
     Power();
     virtual ~Power();
 
-    bool           Init();
-    void           Shutdown();
-    PowerStatus_t &GetStatus();
-    void           RegisterButtonCallback(ButtonCallback_t callback);
+    bool            Init();
+    void            Shutdown();
+    PowerStatus_t  &GetStatus();
+    void            RegisterButtonCallback(ButtonCallback_t callback);
+    bool            LightSleep(uint32_t duration_us);
+    SleepStats_t   &GetSleepStats();
+    void            ResetSleepStats();
+    bool            InitFrequencyScaling();
+    void            LockMaxFrequency();
+    void            UnlockMaxFrequency();
+    void            LogStateCurrent(uint32_t state);
+    CurrentStats_t &GetStateCurrent(uint32_t state);
+    void            ResetStateCurrent();
 
   private:
-    XPowersPMU         AXPDriver;
-    PowerStatus_t      powerStatus;
-    TaskHandle_t       powerTaskHandle;
-    EventGroupHandle_t powerEventGroup;
-    static Power      *objectPtr;
-    ButtonCallback_t   buttonCallback;
-    bool               firstBatteryQuery;
+    XPowersPMU           AXPDriver;
+    PowerStatus_t        powerStatus;
+    TaskHandle_t         powerTaskHandle;
+    EventGroupHandle_t   powerEventGroup;
+    static Power        *objectPtr;
+    ButtonCallback_t     buttonCallback;
+    bool                 firstBatteryQuery;
+    SleepStats_t         sleepStats;
+    esp_pm_lock_handle_t maxFrequencyLock;
+    CurrentStats_t       stateCurrent[POWER_NB_LOGGED_STATES];
     const static int32_t voltageTable[VOLTAGE_TABLE_ENTRIES];
 
     static void StaticProcessingTask(void *callingObject);
@@ -93,6 +121,8 @@ class Power
     void        UpdateStatus();
     void        CommandShutdown();
     uint16_t    GetBatteryLevel(float voltage_V, float current_mA);
+
+    template <typename Getter> auto ReadPmu(Getter getter) -> decltype((AXPDriver.*getter)());
 };
 
 /***************************************************************************/
@@ -35,6 +35,7 @@
 #include "SX1276MnetDriver.h"
 
 #include <Arduino.h>
+#include <driver/gpio.h>
 
 /***************************************************************************/
 /*                              Constants                                  */
@@ -42,6 +43,9 @@
 
 #define TX_DELAY_COMPENSATION 90
 
+// Stack size of the short-lived task used to run code on RF core
+#define RF_CORE_TASK_STACK_SIZE 4096
+
 /***************************************************************************/
 /*                             Local types                                 */
 /***************************************************************************/
@@ -60,7 +64,8 @@ RfDriver *RfDriver::rfDriver;
 /*                              Functions                                  */
 /***************************************************************************/
 
-RfDriver::RfDriver() : messageFifo(nullptr), nextTransmitIndex(-1), messageBytesSent(0), freqTrackingNID(0), txTimer(nullptr)
+RfDriver::RfDriver() : messageFifo(nullptr), nextTransmitIndex(-1), messageBytesSent(0), freqTrackingNID(0), txTimer(nullptr),
+      rfCoreJob(nullptr), rfCoreJobCaller(nullptr)
 {
     timerMux = portMUX_INITIALIZER_UNLOCKED;
     memset((void *)transmitList, 0, sizeof(transmitList));
@@ -70,20 +75,28 @@ RfDriver::~RfDriver()
 {
 }
 
+/*
+  All GPIO interrupts share a single CPU interrupt which is allocated on the core installing the GPIO ISR service.
+  This function must be called before any other attachInterrupt() so that SX1276 DIO interrupts are served by RF core.
+*/
+void RfDriver::InstallIsrService()
+{
+    RunOnRfCore(&RfDriver::InstallGpioIsrService);
+}
+
 bool RfDriver::Init(MicronetMessageFifo *messageFifo)
 {
     this->messageFifo = messageFifo;
     rfDriver          = this;
 
-    txTimer = timerBegin(0, getApbFrequency() / 1000000, true);
-    timerAlarmDisable(txTimer);
-    timerAttachInterrupt(txTimer, TimerHandler, true);
-
     if (!sx1276Driver.Init(RF_SCK_PIN, RF_MOSI_PIN, RF_MISO_PIN, RF_CS0_PIN, RF_DIO0_PIN, RF_DIO1_PIN, RF_RST_PIN, messageFifo))
     {
         return false;
     }
 
+    // Timer and DIO interrupts are allocated on RF core so that they are not delayed by display, compass or NMEA activity
+    RunOnRfCore(&RfDriver::AttachInterrupts);
+
     if (gConfiguration.eeprom.freqSystem == RF_FREQ_SYSTEM_868)
     {
         sx1276Driver.SetFrequency(MICRONET_RF_CENTER_FREQUENCY_868MHZ);
@@ -97,6 +110,42 @@ bool RfDriver::Init(MicronetMessageFifo *messageFifo)
     return true;
 }
 
+/*
+  Execute a member function from a temporary task pinned on RF core and wait for its completion
+  @param job Member function to execute
+*/
+void RfDriver::RunOnRfCore(void (RfDriver::*job)())
+{
+    rfCoreJob       = job;
+    rfCoreJobCaller = xTaskGetCurrentTaskHandle();
+    xTaskCreatePinnedToCore(StaticRfCoreTask, "RfCoreTask", RF_CORE_TASK_STACK_SIZE, (void *)this, RF_TASK_PRIORITY, nullptr, RF_CORE);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+void RfDriver::StaticRfCoreTask(void *callingObject)
+{
+    RfDriver *driver = (RfDriver *)callingObject;
+
+    (driver->*(driver->rfCoreJob))();
+    xTaskNotifyGive(driver->rfCoreJobCaller);
+    vTaskDelete(NULL);
+}
+
+void RfDriver::InstallGpioIsrService()
+{
+    // Arduino's attachInterrupt() accepts an already installed service
+    gpio_install_isr_service(0);
+}
+
+void RfDriver::AttachInterrupts()
+{
+    txTimer = timerBegin(0, getApbFrequency() / 1000000, true);
+    timerAlarmDisable(txTimer);
+    timerAttachInterrupt(txTimer, TimerHandler, true);
+
+    sx1276Driver.AttachInterrupts();
+}
+
 void RfDriver::Start()
 {
     sx1276Driver.StartRx();
@@ -160,6 +209,17 @@ void RfDriver::Transmit(MicronetMessage_t *message)
     taskEXIT_CRITICAL(&timerMux);
 }
 
+/*
+  Re-arm the transmit timer after a light sleep. The hardware timer does not count during sleep while transmit times
+  are based on micros() which does.
+*/
+void RfDriver::RestartTransmitTimer()
+{
+    taskENTER_CRITICAL(&timerMux);
+    ScheduleTransmit();
+    taskEXIT_CRITICAL(&timerMux);
+}
+
 void RfDriver::ScheduleTransmit()
 {
     int32_t  transmitIndex = -1;
@@ -257,7 +317,26 @@ int RfDriver::GetFreeTransmitSlot()
 
 void IRAM_ATTR RfDriver::TimerHandler()
 {
+    uint32_t startTime_us = micros();
+
     rfDriver->TransmitCallback();
+    rfDriver->timerIsrProfile.Record(micros() - startTime_us);
+}
+
+/*
+  Get execution statistics of the transmit timer interrupt
+*/
+ExecutionProfile *RfDriver::GetTimerIsrProfile()
+{
+    return &timerIsrProfile;
+}
+
+/*
+  Get execution statistics of SX1276 DIO interrupts
+*/
+ExecutionProfile *RfDriver::GetDioIsrProfile()
+{
+    return sx1276Driver.GetIsrProfile();
 }
 
 void RfDriver::TransmitCallback()
@@ -74,15 +74,20 @@ class RfDriver
     RfDriver();
     virtual ~RfDriver();
 
+    void InstallIsrService();
     bool Init(MicronetMessageFifo *messageFifo);
     void Start();
     void SetFrequency(float frequency_MHz);
     void SetBandwidth(RfBandwidth_t bandwidth);
     void Transmit(MicronetMessageFifo *txMessageFifo);
     void Transmit(MicronetMessage_t *message);
+    void RestartTransmitTimer();
     void EnableFrequencyTracking(uint32_t networkId);
     void DisableFrequencyTracking();
 
+    ExecutionProfile *GetTimerIsrProfile();
+    ExecutionProfile *GetDioIsrProfile();
+
   private:
     SX1276MnetDriver     sx1276Driver;
     MicronetMessageFifo *messageFifo;
@@ -92,6 +97,9 @@ class RfDriver
     uint32_t             freqTrackingNID;
     hw_timer_t          *txTimer;
     portMUX_TYPE         timerMux;
+    ExecutionProfile     timerIsrProfile;
+    void (RfDriver::*rfCoreJob)();
+    TaskHandle_t         rfCoreJobCaller;
 
     static const uint8_t preambleAndSync[MICRONET_RF_PREAMBLE_LENGTH];
 
@@ -99,7 +107,11 @@ class RfDriver
     int32_t GetNextTransmitIndex();
     int32_t GetFreeTransmitSlot();
     void    TransmitCallback();
+    void    RunOnRfCore(void (RfDriver::*job)());
+    void    InstallGpioIsrService();
+    void    AttachInterrupts();
 
+    static void      StaticRfCoreTask(void *callingObject);
     static void      TimerHandler();
     static RfDriver *rfDriver;
 };
@@ -145,11 +145,16 @@ bool SX1276MnetDriver::Init(uint32_t sckPin, uint32_t mosiPin, uint32_t miso_Pin
     // Set base configuration for Micronet configuration
     SetBaseConfiguration();
 
-    // Attach callback to DIO1 pin
+    return true;
+}
+
+/*
+  Attach DIO0 & DIO1 callbacks. Interrupts are allocated on the core calling this function.
+*/
+void SX1276MnetDriver::AttachInterrupts()
+{
     attachInterrupt(digitalPinToInterrupt(dio0Pin), Dio0Isr, RISING);
     attachInterrupt(digitalPinToInterrupt(dio1Pin), Dio1Isr, RISING);
-
-    return true;
 }
 
 /*
@@ -470,14 +475,26 @@ void SX1276MnetDriver::TransmitFromIsr(MicronetMessage_t &message)
 
 void IRAM_ATTR SX1276MnetDriver::Dio0Isr()
 {
+    uint32_t startTime_us = micros();
+
     driverObject->IsrProcessing(ISR_EVENT_DIO0);
+    driverObject->isrProfile.Record(micros() - startTime_us);
 }
 
 void IRAM_ATTR SX1276MnetDriver::Dio1Isr()
 {
-    BaseType_t scheduleChange = pdFALSE;
+    uint32_t startTime_us = micros();
 
     driverObject->IsrProcessing(ISR_EVENT_DIO1);
+    driverObject->isrProfile.Record(micros() - startTime_us);
+}
+
+/*
+  Get execution statistics of DIO interrupts
+*/
+ExecutionProfile *SX1276MnetDriver::GetIsrProfile()
+{
+    return &isrProfile;
 }
 
 void SX1276MnetDriver::IsrProcessing(uint32_t flags)
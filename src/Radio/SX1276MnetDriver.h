@@ -33,6 +33,7 @@
 /*                              Includes                                   */
 /***************************************************************************/
 
+#include "ExecutionProfile.h"
 #include "Micronet.h"
 #include "MicronetMessageFifo.h"
 
@@ -69,6 +70,7 @@ class SX1276MnetDriver
 
     bool Init(uint32_t sckPin, uint32_t mosiPin, uint32_t miso_Pin, uint32_t csPin, uint32_t dio0Pin, uint32_t dio1Pin, uint32_t rstPin,
               MicronetMessageFifo *messageFifo);
+    void AttachInterrupts();
     void SetFrequency(float frequency);
     void SetBandwidth(float bandwidth);
     void StartTx(void);
@@ -76,6 +78,8 @@ class SX1276MnetDriver
     void GoToIdle(void);
     void TransmitFromIsr(MicronetMessage_t &message);
 
+    ExecutionProfile *GetIsrProfile();
+
   private:
     SPISettings          spiSettings;
     uint32_t             sckPin, mosiPin, miso_Pin, csPin, dio0Pin, dio1Pin, rstPin;
@@ -84,6 +88,7 @@ class SX1276MnetDriver
     MicronetMessage_t    mnetTxMsg;
     uint32_t             msgDataOffset;
     MicronetMessageFifo *messageFifo;
+    ExecutionProfile     isrProfile;
 
     uint8_t SpiReadRegister(uint8_t addr);
     void    SpiBurstReadRegister(uint8_t addr, uint8_t *data, uint16_t length);
@@ -0,0 +1,126 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Minimal Arduino API for native host tests                     *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                               Classes                                   */
+/***************************************************************************/
+
+// Only what the modules built in [env:native] need from the Arduino core
+class Print
+{
+  public:
+    virtual ~Print()
+    {
+    }
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size-- > 0)
+        {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+
+    size_t print(const char *str)
+    {
+        return write((const uint8_t *)str, strlen(str));
+    }
+
+    size_t print(unsigned long value)
+    {
+        char str[24];
+        snprintf(str, sizeof(str), "%lu", value);
+        return print(str);
+    }
+
+    size_t print(unsigned int value)
+    {
+        return print((unsigned long)value);
+    }
+
+    size_t println(const char *str)
+    {
+        return print(str) + print("\r\n");
+    }
+
+    size_t println(unsigned long value)
+    {
+        return print(value) + print("\r\n");
+    }
+
+    size_t println(unsigned int value)
+    {
+        return println((unsigned long)value);
+    }
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read()      = 0;
+    virtual int peek()      = 0;
+};
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+// Time only advances when tests change it, so that time dependent behaviors are reproducible
+inline uint64_t &NativeTime_us()
+{
+    static uint64_t time_us = 0;
+    return time_us;
+}
+
+inline uint32_t micros()
+{
+    return (uint32_t)NativeTime_us();
+}
+
+inline uint32_t millis()
+{
+    return (uint32_t)(NativeTime_us() / 1000);
+}
+
+#endif /* ARDUINO_H_ */
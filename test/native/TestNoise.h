@@ -0,0 +1,75 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Reproducible noise for host tests                             *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+#ifndef TESTNOISE_H_
+#define TESTNOISE_H_
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include <math.h>
+#include <stdint.h>
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+// State of the linear congruential generator shared by all noise functions, so that a test only seeds it once
+inline uint32_t &TestNoiseState()
+{
+    static uint32_t state = 0;
+    return state;
+}
+
+inline void SeedNoise(uint32_t seed)
+{
+    TestNoiseState() = seed;
+}
+
+// Reproducible uniform noise in [-1, 1]
+inline float UniformNoise()
+{
+    uint32_t &state = TestNoiseState();
+
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) / 8388608.0f - 1.0f;
+}
+
+// Reproducible gaussian noise of unit standard deviation (LCG + Box-Muller)
+inline float GaussianNoise()
+{
+    uint32_t &state = TestNoiseState();
+
+    state    = state * 1664525u + 1013904223u;
+    float u1 = ((state >> 8) + 1.0f) / 16777217.0f;
+    state    = state * 1664525u + 1013904223u;
+    float u2 = (state >> 8) / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * 3.14159265f * u2);
+}
+
+#endif /* TESTNOISE_H_ */
@@ -0,0 +1,208 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Host tests of the compass heading and attitude fusion         *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "CompassFusion.h"
+
+#include <math.h>
+#include <unity.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define ACC_PERIOD_US 20000 // Accelerometer output rate, one sample per FIFO read
+#define MAG_DIVIDER   3     // One magnetic field sample every three acceleration samples
+#define DEG_TO_RAD    (VECMATH_PI_F / 180.0f)
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+static CompassFusion *fusion;
+static uint32_t       time_us;
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+// Rotate a vector around the forward (X) axis of the sensor
+static vec RotateX(vec const &v, float angle_deg)
+{
+    float s = sinf(angle_deg * DEG_TO_RAD);
+    float c = cosf(angle_deg * DEG_TO_RAD);
+
+    return {v.x, c * v.y - s * v.z, s * v.y + c * v.z};
+}
+
+// Earth field seen by a level sensor whose X axis points to the heading, Z up : 20µT horizontal, 40µT down
+static vec EarthField(float heading_deg)
+{
+    return {0.2f * cosf(heading_deg * DEG_TO_RAD), 0.2f * sinf(heading_deg * DEG_TO_RAD), -0.4f};
+}
+
+// Feed one acceleration sample and, every MAG_DIVIDER samples, one magnetic field sample
+static void Step(uint32_t step, vec const &acc, vec const *gyro, vec const &mag)
+{
+    time_us += ACC_PERIOD_US;
+    fusion->AddAccSamples(time_us, &acc, gyro, 1);
+    if ((step % MAG_DIVIDER) == 0)
+    {
+        fusion->AddMagSample(time_us, mag);
+    }
+}
+
+// Signed difference between two headings, within [-180, 180[
+static float HeadingDiff(float a_deg, float b_deg)
+{
+    return fmodf(a_deg - b_deg + 540.0f, 360.0f) - 180.0f;
+}
+
+/***************************************************************************/
+/*                                Tests                                    */
+/***************************************************************************/
+
+void setUp()
+{
+    fusion  = new CompassFusion();
+    time_us = 0;
+    fusion->SetForwardVector({1.0f, 0.0f, 0.0f});
+}
+
+void tearDown()
+{
+    delete fusion;
+}
+
+static void test_no_heading_without_gravity()
+{
+    fusion->AddMagSample(time_us, EarthField(90.0f));
+    TEST_ASSERT_EQUAL_UINT32(0, fusion->GetNbMagSamples());
+
+    fusion->AddAccSamples(time_us, nullptr, nullptr, 0);
+    fusion->AddMagSample(time_us, EarthField(90.0f));
+    TEST_ASSERT_EQUAL_UINT32(0, fusion->GetNbMagSamples());
+}
+
+static void test_level_heading()
+{
+    vec const up = {0.0f, 0.0f, 1.0f};
+
+    for (float heading_deg = 0.0f; heading_deg < 360.0f; heading_deg += 22.5f)
+    {
+        for (uint32_t i = 0; i < MAG_DIVIDER; i++)
+        {
+            Step(i, up, nullptr, EarthField(heading_deg));
+        }
+        // Unfiltered heading follows the field at once
+        TEST_ASSERT_LESS_THAN_FLOAT(0.01f, fabsf(HeadingDiff(fusion->GetHeading(), heading_deg)));
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, fusion->GetRoll());
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, fusion->GetPitch());
+    }
+}
+
+static void test_tilt_compensation()
+{
+    // Sensor heeled 20° to starboard : in its frame, up and the earth field lean to port (Y)
+    vec const up  = RotateX({0.0f, 0.0f, 1.0f}, -20.0f);
+    vec const mag = RotateX(EarthField(60.0f), -20.0f);
+
+    for (uint32_t i = 0; i < 50; i++)
+    {
+        Step(i, up, nullptr, mag);
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(0.05f, fabsf(HeadingDiff(fusion->GetHeading(), 60.0f)));
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 20.0f, fusion->GetRoll());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, fusion->GetPitch());
+}
+
+static void test_calibration()
+{
+    vec const   up          = {0.0f, 0.0f, 1.0f};
+    vec const   hardIron    = {0.3f, -0.1f, 0.05f};
+    float const softIron[9] = {0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+    // Field measured with hard iron offsets and an X gain of 2, corrected by the calibration
+    fusion->SetCalibration(hardIron, softIron);
+    for (float heading_deg = 10.0f; heading_deg < 360.0f; heading_deg += 45.0f)
+    {
+        vec field = EarthField(heading_deg);
+        vec mag   = {2.0f * field.x + hardIron.x, field.y + hardIron.y, field.z + hardIron.z};
+
+        for (uint32_t i = 0; i < MAG_DIVIDER; i++)
+        {
+            Step(i, up, nullptr, mag);
+        }
+        TEST_ASSERT_LESS_THAN_FLOAT(0.01f, fabsf(HeadingDiff(fusion->GetHeading(), heading_deg)));
+    }
+}
+
+static void test_gyro_propagation()
+{
+    float const rate_degps    = 30.0f;
+    vec const   up            = {0.0f, 0.0f, 1.0f};
+    vec const   gyro          = {0.0f, 0.0f, -rate_degps}; // Turning to starboard is a clockwise rotation around up
+    float       heading_deg   = 0.0f;
+    float       noGyroHdg_deg = 0.0f;
+    uint32_t    step;
+
+    // Slow heading filter : without gyroscope, the filtered vector lags a steady turn by atan(rate x time constant)
+    CompassFusion noGyro;
+    noGyro.SetForwardVector({1.0f, 0.0f, 0.0f});
+    noGyro.SetHeadingFilter(2.0f);
+    fusion->SetHeadingFilter(2.0f);
+
+    for (step = 0; step < 500; step++)
+    {
+        heading_deg = fmodf(heading_deg + rate_degps * ACC_PERIOD_US / 1000000.0f, 360.0f);
+        Step(step, up, &gyro, EarthField(heading_deg));
+        noGyro.AddAccSamples(time_us, &up, nullptr, 1);
+        if ((step % MAG_DIVIDER) == 0)
+        {
+            noGyro.AddMagSample(time_us, EarthField(heading_deg));
+            noGyroHdg_deg = noGyro.GetHeading();
+            TEST_ASSERT_LESS_THAN_FLOAT(1.0f, fabsf(HeadingDiff(fusion->GetHeading(), heading_deg)));
+        }
+    }
+
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, atanf(rate_degps * DEG_TO_RAD * 2.0f) / DEG_TO_RAD, HeadingDiff(heading_deg, noGyroHdg_deg));
+    TEST_ASSERT_FLOAT_WITHIN(0.02f * rate_degps * 60.0f, rate_degps * 60.0f, fusion->GetRateOfTurn());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_heading_without_gravity);
+    RUN_TEST(test_level_heading);
+    RUN_TEST(test_tilt_compensation);
+    RUN_TEST(test_calibration);
+    RUN_TEST(test_gyro_propagation);
+    return UNITY_END();
+}
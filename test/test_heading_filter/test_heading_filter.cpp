@@ -0,0 +1,184 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Host tests of the compass heading filter                      *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "TestNoise.h"
+#include "VectorMath.h"
+
+#include <math.h>
+#include <unity.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define SAMPLE_PERIOD_S  (1.0f / 15.0f) // Magnetometer output rate
+#define FILTER_TAU_S     1.0f
+#define DEG_TO_RAD       (VECMATH_PI_F / 180.0f)
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+static float filteredSin;
+static float filteredCos;
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+static float Filter(float heading_deg, float dt_s, float tau_s)
+{
+    return FilterHeadingVector(&filteredSin, &filteredCos, sinf(heading_deg * DEG_TO_RAD), cosf(heading_deg * DEG_TO_RAD), dt_s, tau_s);
+}
+
+// Signed difference between two headings, within [-180, 180[
+static float HeadingDiff(float a_deg, float b_deg)
+{
+    return fmodf(a_deg - b_deg + 540.0f, 360.0f) - 180.0f;
+}
+
+/***************************************************************************/
+/*                                Tests                                    */
+/***************************************************************************/
+
+void setUp()
+{
+    filteredSin = 0.0f;
+    filteredCos = 1.0f;
+    SeedNoise(12345);
+}
+
+void tearDown()
+{
+}
+
+static void test_first_sample_and_disabled_filter()
+{
+    // First sample (dt = 0) initializes the filter, whatever its previous state
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 123.0f, Filter(123.0f, 0.0f, FILTER_TAU_S));
+    // A null time constant disables the filter
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 250.0f, Filter(250.0f, SAMPLE_PERIOD_S, 0.0f));
+}
+
+static void test_step_lag()
+{
+    float heading_deg = Filter(0.0f, 0.0f, FILTER_TAU_S);
+    float time_s      = 0.0f;
+
+    // 90 degrees step : the vector reaches 1 - 1/e of the step after one time constant, i.e. atan2(0.632, 0.368)
+    while (time_s < FILTER_TAU_S - SAMPLE_PERIOD_S / 2)
+    {
+        heading_deg = Filter(90.0f, SAMPLE_PERIOD_S, FILTER_TAU_S);
+        time_s += SAMPLE_PERIOD_S;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 59.8f, heading_deg);
+
+    // Settled after five time constants
+    while (time_s < 5 * FILTER_TAU_S)
+    {
+        heading_deg = Filter(90.0f, SAMPLE_PERIOD_S, FILTER_TAU_S);
+        time_s += SAMPLE_PERIOD_S;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 90.0f, heading_deg);
+}
+
+static void test_turn_lag()
+{
+    float const rate_degps  = 10.0f;
+    float       input_deg   = 0.0f;
+    float       heading_deg = Filter(input_deg, 0.0f, FILTER_TAU_S);
+
+    // Steady turn : the filtered heading lags the input by rate x time constant
+    for (uint32_t i = 0; i < 15 * 10; i++)
+    {
+        input_deg   = fmodf(input_deg + rate_degps * SAMPLE_PERIOD_S, 360.0f);
+        heading_deg = Filter(input_deg, SAMPLE_PERIOD_S, FILTER_TAU_S);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, rate_degps * FILTER_TAU_S, HeadingDiff(input_deg, heading_deg));
+}
+
+static void test_noise_reduction()
+{
+    float const noise_deg = 5.0f;
+    double      sum2      = 0.0;
+    uint32_t    nbSamples = 0;
+
+    Filter(45.0f, 0.0f, FILTER_TAU_S);
+    for (uint32_t i = 0; i < 15 * 200; i++)
+    {
+        float heading_deg = Filter(45.0f + noise_deg * GaussianNoise(), SAMPLE_PERIOD_S, FILTER_TAU_S);
+        if (i >= 15 * 5)
+        {
+            float error = HeadingDiff(heading_deg, 45.0f);
+            sum2 += error * error;
+            nbSamples++;
+        }
+    }
+
+    // First order filter : output deviation is sqrt(g / (2 - g)) of the input one, 0.18 at 15Hz with a 1s time constant
+    float rms_deg = sqrt(sum2 / nbSamples);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.25f * noise_deg, rms_deg);
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.12f * noise_deg, rms_deg);
+}
+
+static void test_north_wrap()
+{
+    float heading_deg = Filter(350.0f, 0.0f, FILTER_TAU_S);
+
+    // Noisy heading around north : the filter must stay close to north, never swing to south
+    for (uint32_t i = 0; i < 15 * 20; i++)
+    {
+        float input_deg = fmodf(360.0f + 3.0f * GaussianNoise(), 360.0f);
+        heading_deg     = Filter(input_deg, SAMPLE_PERIOD_S, FILTER_TAU_S);
+        TEST_ASSERT_TRUE((heading_deg >= 0.0f) && (heading_deg < 360.0f));
+        TEST_ASSERT_LESS_THAN_FLOAT(12.0f, fabsf(HeadingDiff(heading_deg, 0.0f)));
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT(2.0f, fabsf(HeadingDiff(heading_deg, 0.0f)));
+
+    // Step across north takes the short way
+    Filter(350.0f, 0.0f, FILTER_TAU_S);
+    for (uint32_t i = 0; i < 15 * 5; i++)
+    {
+        heading_deg = Filter(10.0f, SAMPLE_PERIOD_S, FILTER_TAU_S);
+        TEST_ASSERT_TRUE((heading_deg >= 349.0f) || (heading_deg <= 11.0f));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 10.0f, heading_deg);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_and_disabled_filter);
+    RUN_TEST(test_step_lag);
+    RUN_TEST(test_turn_lag);
+    RUN_TEST(test_noise_reduction);
+    RUN_TEST(test_north_wrap);
+    return UNITY_END();
+}
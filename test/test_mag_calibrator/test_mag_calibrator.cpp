@@ -0,0 +1,269 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Host tests of the magnetometer calibration fit                *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "MagCalibrator.h"
+#include "TestNoise.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define FIELD_G        0.5f  // Earth magnetic field strength
+#define INCLINATION_RD 0.94f // About 54 degrees : 0.295G horizontal, 0.404G vertical
+#define NOISE_G        0.002f
+#define PI_F           3.14159265f
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+// Distortion applied to the synthetic samples : raw = softIron.field + offset
+static vec const   trueOffset         = {0.10f, -0.05f, 0.20f};
+static float const trueSoftIron[3][3] = {{1.05f, 0.03f, -0.02f}, {0.03f, 0.95f, 0.01f}, {-0.02f, 0.01f, 1.00f}};
+
+static MagCalibrator calibrator;
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+static vec Distort(vec const &field, float const softIron[3][3])
+{
+    vec raw;
+
+    raw.x = softIron[0][0] * field.x + softIron[0][1] * field.y + softIron[0][2] * field.z + trueOffset.x + NOISE_G * UniformNoise();
+    raw.y = softIron[1][0] * field.x + softIron[1][1] * field.y + softIron[1][2] * field.z + trueOffset.y + NOISE_G * UniformNoise();
+    raw.z = softIron[2][0] * field.x + softIron[2][1] * field.y + softIron[2][2] * field.z + trueOffset.z + NOISE_G * UniformNoise();
+
+    return raw;
+}
+
+// Field seen by the sensor for all orientations, as when the compass is turned by hand
+static vec SphereSample(uint32_t i, uint32_t nbSamples)
+{
+    // Fibonacci sphere : evenly spread directions
+    float z   = 1.0f - (2.0f * i + 1.0f) / nbSamples;
+    float r   = sqrtf(1.0f - z * z);
+    float phi = i * 2.39996323f;
+
+    return Distort({FIELD_G * r * cosf(phi), FIELD_G * r * sinf(phi), FIELD_G * z}, trueSoftIron);
+}
+
+// Field seen by the sensor when the boat turns on flat water, with a small heel
+static vec TurnSample(uint32_t i, uint32_t nbSamples)
+{
+    static float const identity[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    float              heading        = 2 * PI_F * i / nbSamples;
+    float              heel           = 0.02f * UniformNoise();
+    float              h              = FIELD_G * cosf(INCLINATION_RD);
+    float              v              = FIELD_G * sinf(INCLINATION_RD);
+    vec                field          = {h * cosf(heading), -h * sinf(heading), v};
+
+    // Heel rotates the field around the X axis
+    return Distort({field.x, field.y * cosf(heel) - field.z * sinf(heel), field.y * sinf(heel) + field.z * cosf(heel)}, identity);
+}
+
+static float OffsetError(MagCalibration_t const &calibration, vec const &expected)
+{
+    float dx = calibration.offset.x - expected.x;
+    float dy = calibration.offset.y - expected.y;
+    float dz = calibration.offset.z - expected.z;
+
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+// RMS relative deviation of the corrected field magnitude from the fitted field strength
+static float CorrectedSpread(MagCalibration_t const &calibration)
+{
+    double sum2 = 0;
+
+    for (uint32_t i = 0; i < 500; i++)
+    {
+        vec   raw   = SphereSample(i, 500);
+        float u[3]  = {raw.x - calibration.offset.x, raw.y - calibration.offset.y, raw.z - calibration.offset.z};
+        float norm2 = 0;
+        for (int r = 0; r < 3; r++)
+        {
+            float c = calibration.softIron[r][0] * u[0] + calibration.softIron[r][1] * u[1] + calibration.softIron[r][2] * u[2];
+            norm2 += c * c;
+        }
+        float error = sqrtf(norm2) / calibration.fieldStrength - 1.0f;
+        sum2 += error * error;
+    }
+
+    return sqrt(sum2 / 500);
+}
+
+/***************************************************************************/
+/*                                Tests                                    */
+/***************************************************************************/
+
+void setUp()
+{
+    SeedNoise(12345);
+    calibrator.Reset({0.0f, 0.0f, 0.0f});
+}
+
+void tearDown()
+{
+}
+
+static void test_not_enough_samples()
+{
+    MagCalibration_t calibration;
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        calibrator.AddSample(SphereSample(i, 10));
+    }
+    TEST_ASSERT_FALSE(calibrator.Solve(&calibration));
+}
+
+static void test_hard_and_soft_iron()
+{
+    MagCalibration_t calibration;
+
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        calibrator.AddSample(SphereSample(i, 1000));
+    }
+    TEST_ASSERT_TRUE(calibrator.Solve(&calibration));
+
+    TEST_ASSERT_LESS_THAN_FLOAT(0.002f, OffsetError(calibration, trueOffset));
+    TEST_ASSERT_FLOAT_WITHIN(0.02f * FIELD_G, FIELD_G, calibration.fieldStrength);
+    // Soft iron correction turns the ellipsoid back into a sphere, down to the noise level
+    TEST_ASSERT_LESS_THAN_FLOAT(0.005f, CorrectedSpread(calibration));
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0f, calibration.fitError_per);
+}
+
+static void test_convergence()
+{
+    MagCalibration_t calibration;
+    float            error[3];
+    uint32_t         nbSamples[3] = {60, 250, 2000};
+    uint32_t         added        = 0;
+
+    // Samples arrive in a random order of orientations : the fit refines as they accumulate
+    for (uint32_t step = 0; step < 3; step++)
+    {
+        for (; added < nbSamples[step]; added++)
+        {
+            calibrator.AddSample(SphereSample((added * 7919) % 2000, 2000));
+        }
+        TEST_ASSERT_TRUE(calibrator.Solve(&calibration));
+        error[step] = OffsetError(calibration, trueOffset);
+
+        char message[64];
+        snprintf(message, sizeof(message), "%u samples : offset error %.5fG", nbSamples[step], error[step]);
+        TEST_MESSAGE(message);
+    }
+
+    TEST_ASSERT_LESS_THAN_FLOAT(0.01f, error[0]);
+    TEST_ASSERT_LESS_THAN_FLOAT(error[0], error[2]);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.001f, error[2]);
+}
+
+static void test_solve_time()
+{
+    MagCalibration_t calibration;
+    uint32_t const   nbSolves = 1000;
+
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        calibrator.AddSample(SphereSample(i, 1000));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < nbSolves; i++)
+    {
+        TEST_ASSERT_TRUE(calibrator.Solve(&calibration));
+    }
+    double solve_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / nbSolves;
+
+    char message[64];
+    snprintf(message, sizeof(message), "Solve : %.1fus on host", solve_us);
+    TEST_MESSAGE(message);
+    // Independent of the number of samples, only a few thousand double operations
+    TEST_ASSERT_LESS_THAN_FLOAT(1000.0f, solve_us);
+}
+
+static void test_planar_turn_keeps_vertical_offset()
+{
+    MagCalibration_t calibration;
+    // Previous calibration, done with all orientations : horizontal offset has drifted since
+    vec const previous = {trueOffset.x - 0.03f, trueOffset.y + 0.02f, trueOffset.z};
+
+    calibrator.Reset(previous);
+    for (uint32_t i = 0; i < 720; i++)
+    {
+        calibrator.AddSample(TurnSample(i, 720));
+    }
+    TEST_ASSERT_TRUE(calibrator.Solve(&calibration));
+
+    // Horizontal offset comes from the turn, vertical offset and field strength are kept from the previous calibration
+    TEST_ASSERT_FLOAT_WITHIN(0.003f, trueOffset.x, calibration.offset.x);
+    TEST_ASSERT_FLOAT_WITHIN(0.003f, trueOffset.y, calibration.offset.y);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, trueOffset.z, calibration.offset.z);
+    TEST_ASSERT_FLOAT_WITHIN(0.03f * FIELD_G, FIELD_G, calibration.fieldStrength);
+}
+
+static void test_planar_turn_without_previous_calibration()
+{
+    MagCalibration_t calibration;
+
+    // Without previous calibration, the vertical offset cannot be observed : it must stay at its initial value and not
+    // be moved to the plane of the samples
+    for (uint32_t i = 0; i < 720; i++)
+    {
+        calibrator.AddSample(TurnSample(i, 720));
+    }
+    TEST_ASSERT_TRUE(calibrator.Solve(&calibration));
+
+    TEST_ASSERT_FLOAT_WITHIN(0.003f, trueOffset.x, calibration.offset.x);
+    TEST_ASSERT_FLOAT_WITHIN(0.003f, trueOffset.y, calibration.offset.y);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.0f, calibration.offset.z);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_not_enough_samples);
+    RUN_TEST(test_hard_and_soft_iron);
+    RUN_TEST(test_convergence);
+    RUN_TEST(test_solve_time);
+    RUN_TEST(test_planar_turn_keeps_vertical_offset);
+    RUN_TEST(test_planar_turn_without_previous_calibration);
+    return UNITY_END();
+}
@@ -0,0 +1,224 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Host tests of the World Magnetic Model declination            *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "MagneticModel.h"
+
+#include <math.h>
+#include <unity.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+// NMEA sentences give the variation with a 0.1° resolution
+#define DECLINATION_TOLERANCE_DEG 0.05f
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+typedef struct
+{
+    float year;
+    float latitude_deg;
+    float longitude_deg;
+    float declination_deg;
+} DeclinationTestValue_t;
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+// WMM2020 coefficients, the model whose official test values are reproduced below
+static const MagModelCoefficient_t wmm2020Coefficients[MAGMODEL_NB_TERMS - 1] = {
+    {-29404.5f,     0.0f,   6.7f,   0.0f}, //  1  0
+    { -1450.7f,  4652.9f,   7.7f, -25.1f}, //  1  1
+    { -2500.0f,     0.0f, -11.5f,   0.0f}, //  2  0
+    {  2982.0f, -2991.6f,  -7.1f, -30.2f}, //  2  1
+    {  1676.8f,  -734.8f,  -2.2f, -23.9f}, //  2  2
+    {  1363.9f,     0.0f,   2.8f,   0.0f}, //  3  0
+    { -2381.0f,   -82.2f,  -6.2f,   5.7f}, //  3  1
+    {  1236.2f,   241.8f,   3.4f,  -1.0f}, //  3  2
+    {   525.7f,  -542.9f, -12.2f,   1.1f}, //  3  3
+    {   903.1f,     0.0f,  -1.1f,   0.0f}, //  4  0
+    {   809.4f,   282.0f,  -1.6f,   0.2f}, //  4  1
+    {    86.2f,  -158.4f,  -6.0f,   6.9f}, //  4  2
+    {  -309.4f,   199.8f,   5.4f,   3.7f}, //  4  3
+    {    47.9f,  -350.1f,  -5.5f,  -5.6f}, //  4  4
+    {  -234.4f,     0.0f,  -0.3f,   0.0f}, //  5  0
+    {   363.1f,    47.7f,   0.6f,   0.1f}, //  5  1
+    {   187.8f,   208.4f,  -0.7f,   2.5f}, //  5  2
+    {  -140.7f,  -121.3f,   0.1f,  -0.9f}, //  5  3
+    {  -151.2f,    32.2f,   1.2f,   3.0f}, //  5  4
+    {    13.7f,    99.1f,   1.0f,   0.5f}, //  5  5
+    {    65.9f,     0.0f,  -0.6f,   0.0f}, //  6  0
+    {    65.6f,   -19.1f,  -0.4f,   0.1f}, //  6  1
+    {    73.0f,    25.0f,   0.5f,  -1.8f}, //  6  2
+    {  -121.5f,    52.7f,   1.4f,  -1.4f}, //  6  3
+    {   -36.2f,   -64.4f,  -1.4f,   0.9f}, //  6  4
+    {    13.5f,     9.0f,  -0.0f,   0.1f}, //  6  5
+    {   -64.7f,    68.1f,   0.8f,   1.0f}, //  6  6
+    {    80.6f,     0.0f,  -0.1f,   0.0f}, //  7  0
+    {   -76.8f,   -51.4f,  -0.3f,   0.5f}, //  7  1
+    {    -8.3f,   -16.8f,  -0.1f,   0.6f}, //  7  2
+    {    56.5f,     2.3f,   0.7f,  -0.7f}, //  7  3
+    {    15.8f,    23.5f,   0.2f,  -0.2f}, //  7  4
+    {     6.4f,    -2.2f,  -0.5f,  -1.2f}, //  7  5
+    {    -7.2f,   -27.2f,  -0.8f,   0.2f}, //  7  6
+    {     9.8f,    -1.9f,   1.0f,   0.3f}, //  7  7
+    {    23.6f,     0.0f,  -0.1f,   0.0f}, //  8  0
+    {     9.8f,     8.4f,   0.1f,  -0.3f}, //  8  1
+    {   -17.5f,   -15.3f,  -0.1f,   0.7f}, //  8  2
+    {    -0.4f,    12.8f,   0.5f,  -0.2f}, //  8  3
+    {   -21.1f,   -11.8f,  -0.1f,   0.5f}, //  8  4
+    {    15.3f,    14.9f,   0.4f,  -0.3f}, //  8  5
+    {    13.7f,     3.6f,   0.5f,  -0.5f}, //  8  6
+    {   -16.5f,    -6.9f,   0.0f,   0.4f}, //  8  7
+    {    -0.3f,     2.8f,   0.4f,   0.1f}, //  8  8
+    {     5.0f,     0.0f,  -0.1f,   0.0f}, //  9  0
+    {     8.2f,   -23.3f,  -0.2f,  -0.3f}, //  9  1
+    {     2.9f,    11.1f,  -0.0f,   0.2f}, //  9  2
+    {    -1.4f,     9.8f,   0.4f,  -0.4f}, //  9  3
+    {    -1.1f,    -5.1f,  -0.3f,   0.4f}, //  9  4
+    {   -13.3f,    -6.2f,  -0.0f,   0.1f}, //  9  5
+    {     1.1f,     7.8f,   0.3f,  -0.0f}, //  9  6
+    {     8.9f,     0.4f,  -0.0f,  -0.2f}, //  9  7
+    {    -9.3f,    -1.5f,  -0.0f,   0.5f}, //  9  8
+    {   -11.9f,     9.7f,  -0.4f,   0.2f}, //  9  9
+    {    -1.9f,     0.0f,   0.0f,   0.0f}, // 10  0
+    {    -6.2f,     3.4f,  -0.0f,  -0.0f}, // 10  1
+    {    -0.1f,    -0.2f,  -0.0f,   0.1f}, // 10  2
+    {     1.7f,     3.5f,   0.2f,  -0.3f}, // 10  3
+    {    -0.9f,     4.8f,  -0.1f,   0.1f}, // 10  4
+    {     0.6f,    -8.6f,  -0.2f,  -0.2f}, // 10  5
+    {    -0.9f,    -0.1f,  -0.0f,   0.1f}, // 10  6
+    {     1.9f,    -4.2f,  -0.1f,  -0.0f}, // 10  7
+    {     1.4f,    -3.4f,  -0.2f,  -0.1f}, // 10  8
+    {    -2.4f,    -0.1f,  -0.1f,   0.2f}, // 10  9
+    {    -3.9f,    -8.8f,  -0.0f,  -0.0f}, // 10 10
+    {     3.0f,     0.0f,  -0.0f,   0.0f}, // 11  0
+    {    -1.4f,    -0.0f,  -0.1f,  -0.0f}, // 11  1
+    {    -2.5f,     2.6f,  -0.0f,   0.1f}, // 11  2
+    {     2.4f,    -0.5f,   0.0f,   0.0f}, // 11  3
+    {    -0.9f,    -0.4f,  -0.0f,   0.2f}, // 11  4
+    {     0.3f,     0.6f,  -0.1f,  -0.0f}, // 11  5
+    {    -0.7f,    -0.2f,   0.0f,   0.0f}, // 11  6
+    {    -0.1f,    -1.7f,  -0.0f,   0.1f}, // 11  7
+    {     1.4f,    -1.6f,  -0.1f,  -0.0f}, // 11  8
+    {    -0.6f,    -3.0f,  -0.1f,  -0.1f}, // 11  9
+    {     0.2f,    -2.0f,  -0.1f,   0.0f}, // 11 10
+    {     3.1f,    -2.6f,  -0.1f,  -0.0f}, // 11 11
+    {    -2.0f,     0.0f,   0.0f,   0.0f}, // 12  0
+    {    -0.1f,    -1.2f,  -0.0f,  -0.0f}, // 12  1
+    {     0.5f,     0.5f,  -0.0f,   0.0f}, // 12  2
+    {     1.3f,     1.3f,   0.0f,  -0.1f}, // 12  3
+    {    -1.2f,    -1.8f,  -0.0f,   0.1f}, // 12  4
+    {     0.7f,     0.1f,  -0.0f,  -0.0f}, // 12  5
+    {     0.3f,     0.7f,   0.0f,   0.0f}, // 12  6
+    {     0.5f,    -0.1f,  -0.0f,  -0.0f}, // 12  7
+    {    -0.2f,     0.6f,   0.0f,   0.1f}, // 12  8
+    {    -0.5f,     0.2f,  -0.0f,  -0.0f}, // 12  9
+    {     0.1f,    -0.9f,  -0.0f,  -0.0f}, // 12 10
+    {    -1.1f,    -0.0f,  -0.0f,   0.0f}, // 12 11
+    {    -0.3f,     0.5f,  -0.1f,  -0.1f}, // 12 12
+};
+
+static const MagModelDefinition_t wmm2020Model = {2020.0f, wmm2020Coefficients};
+
+// Sea level points of the test values published with WMM2020 (WMM2020_TEST_VALUES)
+static const DeclinationTestValue_t wmm2020TestValues[] = {
+    {2020.0f, 80.0f, 0.0f, -1.28f},   {2020.0f, 0.0f, 120.0f, 0.16f},   {2020.0f, -80.0f, 240.0f, 69.36f},
+    {2022.5f, 80.0f, 0.0f, -0.00f},   {2022.5f, 0.0f, 120.0f, -0.06f},  {2022.5f, -80.0f, 240.0f, 69.13f},
+};
+
+// Built-in WMM2025 model at the points of the WMM2020 test values, evaluated in double precision from tools/WMM2025.COF
+// by tools/wmm_table.py. They check the single precision evaluation of the shipped table, not the COF file itself :
+// tools/wmm_table.py --test-values does it with the official test value file.
+static const DeclinationTestValue_t wmm2025ReferenceValues[] = {
+    {2025.0f, 80.0f, 0.0f, 1.28f},    {2025.0f, 0.0f, 120.0f, -0.16f},  {2025.0f, -80.0f, 240.0f, 68.78f},
+    {2027.5f, 80.0f, 0.0f, 2.59f},    {2027.5f, 0.0f, 120.0f, -0.24f},  {2027.5f, -80.0f, 240.0f, 68.49f},
+    {2025.0f, 48.4f, -4.5f, -0.265f}, {2025.0f, 37.8f, -122.4f, 12.99f}, {2027.5f, -33.9f, 151.2f, 12.85f},
+};
+
+/***************************************************************************/
+/*                                Tests                                    */
+/***************************************************************************/
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_wmm2020_test_values()
+{
+    for (uint32_t i = 0; i < sizeof(wmm2020TestValues) / sizeof(wmm2020TestValues[0]); i++)
+    {
+        DeclinationTestValue_t const *value = &wmm2020TestValues[i];
+        TEST_ASSERT_FLOAT_WITHIN(DECLINATION_TOLERANCE_DEG, value->declination_deg,
+                                 MagneticModel::ComputeDeclination(&wmm2020Model, value->latitude_deg, value->longitude_deg, value->year));
+    }
+}
+
+static void test_wmm2025_reference_values()
+{
+    for (uint32_t i = 0; i < sizeof(wmm2025ReferenceValues) / sizeof(wmm2025ReferenceValues[0]); i++)
+    {
+        DeclinationTestValue_t const *value = &wmm2025ReferenceValues[i];
+        TEST_ASSERT_FLOAT_WITHIN(DECLINATION_TOLERANCE_DEG, value->declination_deg,
+                                 MagneticModel::ComputeDeclination(value->latitude_deg, value->longitude_deg, value->year));
+    }
+}
+
+static void test_poles_and_range()
+{
+    // Declination is undefined at the geographic poles : the evaluation must stay finite and within [-180, 180]
+    for (float latitude_deg = -90.0f; latitude_deg <= 90.0f; latitude_deg += 7.5f)
+    {
+        for (float longitude_deg = -180.0f; longitude_deg <= 180.0f; longitude_deg += 15.0f)
+        {
+            float declination_deg = MagneticModel::ComputeDeclination(latitude_deg, longitude_deg, 2026.0f);
+            TEST_ASSERT_FALSE(isnan(declination_deg));
+            TEST_ASSERT_TRUE((declination_deg >= -180.0f) && (declination_deg <= 180.0f));
+        }
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_wmm2020_test_values);
+    RUN_TEST(test_wmm2025_reference_values);
+    RUN_TEST(test_poles_and_range);
+    return UNITY_END();
+}
@@ -0,0 +1,271 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Host tests of NMEA output filtering and rate limiting         *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NmeaOutputQueue.h"
+
+#include <string.h>
+#include <unity.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define MWV_SENTENCE "$INMWV,45.0,R,12.3,N,A*1A"          // 27 bytes once terminated
+#define DPT_SENTENCE "$INDPT,8.5,0.0,*44"                 // 20 bytes once terminated
+#define GGA_SENTENCE "$GPGGA,123519,4807.038,N,01131.000" // Forwarded sentence
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+// Stream keeping everything written to it, as the output of a serial link or of a TCP client would receive it
+class CaptureStream : public Stream
+{
+  public:
+    char     data[2048];
+    uint32_t length;
+    uint32_t nbWrites;
+
+    void Clear()
+    {
+        memset(data, 0, sizeof(data));
+        length   = 0;
+        nbWrites = 0;
+    }
+
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        // Only the beginning of the output is kept, the rest is just counted
+        if (length + size < sizeof(data))
+        {
+            memcpy(data + length, buffer, size);
+        }
+        length += size;
+        nbWrites++;
+        return size;
+    }
+
+    int available() override
+    {
+        return 0;
+    }
+
+    int read() override
+    {
+        return -1;
+    }
+
+    int peek() override
+    {
+        return -1;
+    }
+};
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+static CaptureStream    usbStream;
+static CaptureStream    btStream;
+static NmeaOutputQueue *outputQueue;
+
+/***************************************************************************/
+/*                                Tests                                    */
+/***************************************************************************/
+
+void setUp()
+{
+    NativeTime_us() = 10000000;
+    usbStream.Clear();
+    btStream.Clear();
+    outputQueue = new NmeaOutputQueue();
+    outputQueue->SetStream(NMEA_OUTPUT_USB, &usbStream);
+    outputQueue->SetStream(NMEA_OUTPUT_BT, &btStream);
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_USB, true, NMEA_FILTER_ALL, 0);
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_BT, false, NMEA_FILTER_ALL, 0);
+}
+
+void tearDown()
+{
+    delete outputQueue;
+}
+
+static void test_sentences_are_terminated_and_written_once()
+{
+    outputQueue->WriteSentence(NMEA_ID_MWV, MWV_SENTENCE);
+    outputQueue->WriteSentence(NMEA_ID_DPT, DPT_SENTENCE);
+    TEST_ASSERT_EQUAL_UINT32(0, usbStream.length);
+
+    outputQueue->Flush();
+    TEST_ASSERT_EQUAL_STRING(MWV_SENTENCE "\r\n" DPT_SENTENCE "\r\n", usbStream.data);
+    TEST_ASSERT_EQUAL_UINT32(2, usbStream.nbWrites);
+    // Disabled output receives nothing
+    TEST_ASSERT_EQUAL_UINT32(0, btStream.length);
+
+    // Queue is empty once flushed
+    outputQueue->Flush();
+    TEST_ASSERT_EQUAL_UINT32(2, usbStream.nbWrites);
+}
+
+static void test_sentence_filter()
+{
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_BT, true, NMEA_FILTER(NMEA_ID_MWV), 0);
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_USB, true, NMEA_FILTER_ALL & ~NMEA_FILTER(NMEA_ID_MWV), 0);
+
+    outputQueue->WriteSentence(NMEA_ID_MWV, MWV_SENTENCE);
+    outputQueue->WriteSentence(NMEA_ID_DPT, DPT_SENTENCE);
+    outputQueue->WriteSentence(NMEA_ID_GGA, GGA_SENTENCE);
+    outputQueue->Flush();
+
+    TEST_ASSERT_EQUAL_STRING(MWV_SENTENCE "\r\n", btStream.data);
+    TEST_ASSERT_EQUAL_STRING(DPT_SENTENCE "\r\n" GGA_SENTENCE "\r\n", usbStream.data);
+    // Filtered sentences are not rate limiter drops
+    TEST_ASSERT_EQUAL_UINT32(0, outputQueue->GetDroppedSentences(NMEA_OUTPUT_BT));
+    TEST_ASSERT_EQUAL_UINT32(0, outputQueue->GetDroppedSentences(NMEA_OUTPUT_USB));
+}
+
+static void test_token_bucket()
+{
+    // 100B/s with one second of burst : three 27 bytes sentences fit in the initial credit, not four
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_BT, true, NMEA_FILTER_ALL, 100);
+    for (int i = 0; i < 4; i++)
+    {
+        outputQueue->WriteSentence(NMEA_ID_MWV, MWV_SENTENCE);
+    }
+    outputQueue->Flush();
+    TEST_ASSERT_EQUAL_UINT32(3, btStream.nbWrites);
+    TEST_ASSERT_EQUAL_UINT32(1, outputQueue->GetDroppedSentences(NMEA_OUTPUT_BT));
+    // Unlimited output gets all of them
+    TEST_ASSERT_EQUAL_UINT32(4, usbStream.nbWrites);
+
+    // 19 bytes left + 250ms at 100B/s = 44 bytes : one more sentence
+    NativeTime_us() += 250000;
+    outputQueue->WriteSentence(NMEA_ID_MWV, MWV_SENTENCE);
+    outputQueue->WriteSentence(NMEA_ID_MWV, MWV_SENTENCE);
+    outputQueue->Flush();
+    TEST_ASSERT_EQUAL_UINT32(4, btStream.nbWrites);
+    TEST_ASSERT_EQUAL_UINT32(2, outputQueue->GetDroppedSentences(NMEA_OUTPUT_BT));
+
+    // A 20 bytes sentence fits in the 17 + 10 bytes available 100ms later
+    NativeTime_us() += 100000;
+    outputQueue->WriteSentence(NMEA_ID_DPT, DPT_SENTENCE);
+    outputQueue->Flush();
+    TEST_ASSERT_EQUAL_UINT32(5, btStream.nbWrites);
+
+    // Credit is capped to one second of throughput after a long silence
+    NativeTime_us() += 60000000;
+    for (int i = 0; i < 5; i++)
+    {
+        outputQueue->WriteSentence(NMEA_ID_MWV, MWV_SENTENCE);
+    }
+    outputQueue->Flush();
+    TEST_ASSERT_EQUAL_UINT32(8, btStream.nbWrites);
+    TEST_ASSERT_EQUAL_UINT32(4, outputQueue->GetDroppedSentences(NMEA_OUTPUT_BT));
+}
+
+static void test_sustained_rate()
+{
+    // Sentences offered at twice the output rate : the output settles at its nominal throughput
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_BT, true, NMEA_FILTER_ALL, 280);
+    for (int i = 0; i < 200; i++)
+    {
+        outputQueue->WriteSentence(NMEA_ID_MWV, MWV_SENTENCE);
+        outputQueue->Flush();
+        NativeTime_us() += 50000;
+    }
+
+    // Initial burst of 280 bytes plus 9.95s at 280B/s, in 27 bytes sentences
+    TEST_ASSERT_EQUAL_UINT32(113, btStream.nbWrites);
+    TEST_ASSERT_EQUAL_UINT32(87, outputQueue->GetDroppedSentences(NMEA_OUTPUT_BT));
+}
+
+static void test_latency_measured_at_write()
+{
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_BT, true, NMEA_FILTER_ALL, 0);
+
+    // Latency runs from data reception to the write of the sentence, including the time spent in the queue
+    uint32_t rxTime_us = micros();
+    outputQueue->WriteSentence(NMEA_ID_MWV, MWV_SENTENCE, NMEA_OUT_MWV_R, rxTime_us);
+    NativeTime_us() += 7000;
+    outputQueue->Flush();
+
+    LatencyHistogram *latency = outputQueue->GetLatencyHistogram(NMEA_OUT_MWV_R);
+    TEST_ASSERT_EQUAL_UINT32(1, latency->GetCount());
+    TEST_ASSERT_EQUAL_UINT32(7000, latency->GetMax());
+
+    // Forwarded sentences and sentences written to no output are not measured
+    outputQueue->WriteSentence(NMEA_ID_GGA, GGA_SENTENCE);
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_USB, true, NMEA_FILTER_ALL & ~NMEA_FILTER(NMEA_ID_DPT), 0);
+    outputQueue->ConfigureOutput(NMEA_OUTPUT_BT, false, NMEA_FILTER_ALL, 0);
+    outputQueue->WriteSentence(NMEA_ID_DPT, DPT_SENTENCE, NMEA_OUT_DPT, micros());
+    outputQueue->Flush();
+    TEST_ASSERT_EQUAL_UINT32(1, latency->GetCount());
+    TEST_ASSERT_EQUAL_UINT32(0, outputQueue->GetLatencyHistogram(NMEA_OUT_DPT)->GetCount());
+
+    outputQueue->ResetLatencyStats();
+    TEST_ASSERT_EQUAL_UINT32(0, latency->GetCount());
+}
+
+static void test_queue_overflow()
+{
+    char longSentence[NMEA_SENTENCE_MAX_LENGTH + 2];
+
+    for (int i = 0; i < NMEA_OUTPUT_QUEUE_SIZE + 2; i++)
+    {
+        outputQueue->WriteSentence(NMEA_ID_DPT, DPT_SENTENCE);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, outputQueue->GetQueueOverflows());
+
+    // Too long sentences are ignored
+    memset(longSentence, 'A', sizeof(longSentence) - 1);
+    longSentence[sizeof(longSentence) - 1] = 0;
+    outputQueue->Flush();
+    outputQueue->WriteSentence(NMEA_ID_DPT, longSentence);
+    outputQueue->Flush();
+    TEST_ASSERT_EQUAL_UINT32(NMEA_OUTPUT_QUEUE_SIZE, usbStream.nbWrites);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sentences_are_terminated_and_written_once);
+    RUN_TEST(test_sentence_filter);
+    RUN_TEST(test_token_bucket);
+    RUN_TEST(test_sustained_rate);
+    RUN_TEST(test_latency_measured_at_write);
+    RUN_TEST(test_queue_overflow);
+    return UNITY_END();
+}
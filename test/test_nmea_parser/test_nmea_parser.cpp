@@ -0,0 +1,103 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Host tests of NMEA sentence parsing                           *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "NmeaParser.h"
+
+#include <unity.h>
+
+/***************************************************************************/
+/*                                Tests                                    */
+/***************************************************************************/
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_gll_valid_fix()
+{
+    NmeaGLL_t gll;
+
+    TEST_ASSERT_TRUE(NmeaParser::ParseGLL("$GPGLL,4916.45,N,12311.12,W,225444,A", &gll));
+    TEST_ASSERT_TRUE(gll.latitudeValid);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 49.274167f, gll.latitude_deg);
+    TEST_ASSERT_TRUE(gll.longitudeValid);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, -123.185333f, gll.longitude_deg);
+    TEST_ASSERT_TRUE(gll.timeValid);
+    TEST_ASSERT_EQUAL_INT(22, gll.hour);
+    TEST_ASSERT_EQUAL_INT(54, gll.minute);
+}
+
+static void test_gll_mode_indicator()
+{
+    NmeaGLL_t gll;
+
+    // NMEA 2.3 sentence with mode indicator and checksum, as sent by u-blox receivers
+    TEST_ASSERT_TRUE(NmeaParser::ParseGLL("$GNGLL,4717.11399,S,00833.91590,E,092321.00,A,A*6F", &gll));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, -47.285233f, gll.latitude_deg);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 8.565265f, gll.longitude_deg);
+    TEST_ASSERT_EQUAL_INT(9, gll.hour);
+    TEST_ASSERT_EQUAL_INT(23, gll.minute);
+}
+
+static void test_gll_void_status()
+{
+    NmeaGLL_t gll;
+
+    TEST_ASSERT_FALSE(NmeaParser::ParseGLL("$GPGLL,4916.45,N,12311.12,W,225444,V", &gll));
+    TEST_ASSERT_FALSE(NmeaParser::ParseGLL("$GNGLL,,,,,092321.00,V,N*4A", &gll));
+    // Truncated sentence without status
+    TEST_ASSERT_FALSE(NmeaParser::ParseGLL("$GPGLL,4916.45,N,12311.12,W", &gll));
+}
+
+static void test_gll_empty_fields()
+{
+    NmeaGLL_t gll;
+
+    TEST_ASSERT_TRUE(NmeaParser::ParseGLL("$GPGLL,,,12311.12,E,,A", &gll));
+    TEST_ASSERT_FALSE(gll.latitudeValid);
+    TEST_ASSERT_TRUE(gll.longitudeValid);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 123.185333f, gll.longitude_deg);
+    TEST_ASSERT_FALSE(gll.timeValid);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_gll_valid_fix);
+    RUN_TEST(test_gll_mode_indicator);
+    RUN_TEST(test_gll_void_status);
+    RUN_TEST(test_gll_empty_fields);
+    return UNITY_END();
+}
@@ -0,0 +1,272 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Host tests & benchmark of the compass vector math             *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "TestNoise.h"
+#include "VectorMath.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define NB_ATAN2_POINTS     2000000
+#define NB_HEADING_SAMPLES  100000
+#define NB_BENCHMARK_PASSES 20
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+static vec upSamples[NB_HEADING_SAMPLES];
+static vec magSamples[NB_HEADING_SAMPLES];
+// Keeps the benchmark results alive so that the compiler does not remove the loops
+static volatile float benchmarkSink;
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+// Tilt compensated heading as computed by NavCompass, with the forward vector along X
+static float FastHeading(vec const &up, vec const &mag)
+{
+    vec E = VecCross(mag, up);
+    vec N = VecCross(up, E);
+
+    float heading = FastAtan2(E.x, N.x) * VECMATH_RAD_TO_DEG;
+    return (heading < 0) ? heading + 360 : heading;
+}
+
+// Same heading computed with libm
+static float LibmHeading(vec const &up, vec const &mag)
+{
+    float upNorm = 1.0f / sqrtf(VecDot(up, up));
+    vec   u      = VecScale(up, upNorm);
+    vec   E      = VecCross(mag, u);
+    vec   N      = VecCross(u, E);
+
+    float heading = atan2f(E.x, N.x) * VECMATH_RAD_TO_DEG;
+    return (heading < 0) ? heading + 360 : heading;
+}
+
+// Double precision reference heading
+static double ReferenceHeading(vec const &up, vec const &mag)
+{
+    double n  = sqrt((double)up.x * up.x + (double)up.y * up.y + (double)up.z * up.z);
+    double ux = up.x / n, uy = up.y / n, uz = up.z / n;
+    double ex = mag.y * uz - mag.z * uy;
+    double ey = mag.z * ux - mag.x * uz;
+    double ez = mag.x * uy - mag.y * ux;
+    double nx = uy * ez - uz * ey;
+
+    double heading = atan2(ex, nx) * 180.0 / M_PI;
+    return (heading < 0) ? heading + 360 : heading;
+}
+
+static double HeadingError(double a_deg, double b_deg)
+{
+    return fabs(fmod(a_deg - b_deg + 540.0, 360.0) - 180.0);
+}
+
+static uint64_t CycleCount()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void PrintBenchmark(char const *name, double elapsed_ns, uint64_t cycles, uint32_t nbSamples)
+{
+    char message[96];
+
+    snprintf(message, sizeof(message), "%s : %.1fns, %.0f cycles per sample", name, elapsed_ns / nbSamples, (double)cycles / nbSamples);
+    TEST_MESSAGE(message);
+}
+
+/***************************************************************************/
+/*                                Tests                                    */
+/***************************************************************************/
+
+void setUp()
+{
+    SeedNoise(12345);
+}
+
+void tearDown()
+{
+}
+
+static void test_inv_sqrt_accuracy()
+{
+    double maxError = 0;
+
+    // Logarithmic sweep over most of the float range
+    for (double x = 1e-30; x < 1e30; x *= 1.0001)
+    {
+        double error = fabs(FastInvSqrt((float)x) * sqrt((double)(float)x) - 1.0);
+        maxError     = fmax(maxError, error);
+    }
+
+    char message[64];
+    snprintf(message, sizeof(message), "FastInvSqrt max relative error %.2e", maxError);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN_FLOAT(5e-6f, maxError);
+}
+
+static void test_atan2_accuracy()
+{
+    double maxError = 0;
+
+    for (uint32_t i = 0; i < NB_ATAN2_POINTS; i++)
+    {
+        // Random magnitudes over several decades so that all octants and ratios are covered
+        float  y     = UniformNoise() * powf(10.0f, 3.0f * UniformNoise());
+        float  x     = UniformNoise() * powf(10.0f, 3.0f * UniformNoise());
+        double error = fabs(FastAtan2(y, x) - atan2((double)y, (double)x));
+        maxError     = fmax(maxError, error);
+    }
+
+    char message[64];
+    snprintf(message, sizeof(message), "FastAtan2 max error %.2e rad", maxError);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN_FLOAT(2e-5f, maxError);
+
+    // Axes and diagonals
+    TEST_ASSERT_FLOAT_WITHIN(2e-5f, 0.0f, FastAtan2(0.0f, 1.0f));
+    TEST_ASSERT_FLOAT_WITHIN(2e-5f, VECMATH_PI_F / 2, FastAtan2(1.0f, 0.0f));
+    TEST_ASSERT_FLOAT_WITHIN(2e-5f, -VECMATH_PI_F / 2, FastAtan2(-1.0f, 0.0f));
+    TEST_ASSERT_FLOAT_WITHIN(2e-5f, VECMATH_PI_F, FastAtan2(0.0f, -1.0f));
+    TEST_ASSERT_FLOAT_WITHIN(2e-5f, -3 * VECMATH_PI_F / 4, FastAtan2(-1.0f, -1.0f));
+    TEST_ASSERT_FALSE(isnan(FastAtan2(0.0f, 0.0f)));
+}
+
+static void test_vector_operations()
+{
+    vec a = {1.0f, 2.0f, 3.0f};
+    vec b = {-2.0f, 0.5f, 4.0f};
+    vec c = VecCross(a, b);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 11.0f, VecDot(a, b));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 6.5f, c.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -10.0f, c.y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 4.5f, c.z);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, VecDot(c, a));
+
+    vec n = VecNormalize(a);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.0f, VecDot(n, n));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 2.0f, n.y / n.x);
+
+    // Null vector does not produce NaN nor infinity
+    vec zero = VecNormalize({0.0f, 0.0f, 0.0f});
+    TEST_ASSERT_TRUE(isfinite(zero.x) && isfinite(zero.y) && isfinite(zero.z));
+}
+
+static void test_heading_accuracy()
+{
+    double maxError = 0;
+
+    for (uint32_t i = 0; i < NB_HEADING_SAMPLES; i++)
+    {
+        // Heel & pitch up to 30 degrees, inclination from 0 to 70 degrees, any heading
+        float heading = VECMATH_PI_F * UniformNoise();
+        float dip     = 0.6f + 0.6f * UniformNoise();
+        upSamples[i]  = {0.5f * UniformNoise(), 0.5f * UniformNoise(), 1.0f};
+        vec mag       = {cosf(heading) * cosf(dip), -sinf(heading) * cosf(dip), -sinf(dip)};
+        // Magnetic field is given in the sensor frame : rotate it by the tilt of the up vector
+        vec up        = VecNormalize(upSamples[i]);
+        vec east      = VecNormalize(VecCross({1.0f, 0.0f, 0.0f}, up));
+        vec north     = VecCross(east, up);
+        magSamples[i] = {mag.x * north.x - mag.y * east.x + mag.z * up.x, mag.x * north.y - mag.y * east.y + mag.z * up.y,
+                         mag.x * north.z - mag.y * east.z + mag.z * up.z};
+
+        double error = HeadingError(FastHeading(VecNormalize(upSamples[i]), magSamples[i]), ReferenceHeading(upSamples[i], magSamples[i]));
+        maxError     = fmax(maxError, error);
+    }
+
+    char message[64];
+    snprintf(message, sizeof(message), "Heading max error %.2e deg", maxError);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_THAN_FLOAT(2e-3f, maxError);
+}
+
+static void test_heading_benchmark()
+{
+    float    sum = 0;
+    uint64_t cycles;
+
+    // Samples are the ones generated by the accuracy test
+    auto start = std::chrono::steady_clock::now();
+    cycles     = CycleCount();
+    for (uint32_t pass = 0; pass < NB_BENCHMARK_PASSES; pass++)
+    {
+        for (uint32_t i = 0; i < NB_HEADING_SAMPLES; i++)
+        {
+            sum += FastHeading(VecNormalize(upSamples[i]), magSamples[i]);
+        }
+    }
+    cycles            = CycleCount() - cycles;
+    double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    PrintBenchmark("VectorMath heading", elapsed_ns, cycles, NB_BENCHMARK_PASSES * NB_HEADING_SAMPLES);
+
+    start  = std::chrono::steady_clock::now();
+    cycles = CycleCount();
+    for (uint32_t pass = 0; pass < NB_BENCHMARK_PASSES; pass++)
+    {
+        for (uint32_t i = 0; i < NB_HEADING_SAMPLES; i++)
+        {
+            sum += LibmHeading(upSamples[i], magSamples[i]);
+        }
+    }
+    cycles     = CycleCount() - cycles;
+    elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    PrintBenchmark("libm heading", elapsed_ns, cycles, NB_BENCHMARK_PASSES * NB_HEADING_SAMPLES);
+
+    benchmarkSink = sum;
+    TEST_ASSERT_TRUE(isfinite(sum));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_inv_sqrt_accuracy);
+    RUN_TEST(test_atan2_accuracy);
+    RUN_TEST(test_vector_operations);
+    RUN_TEST(test_heading_accuracy);
+    RUN_TEST(test_heading_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,314 @@
+/***************************************************************************
+ *                                                                         *
+ * Project:  MicroNav                                                      *
+ * Purpose:  Replay a compass capture through the firmware heading code    *
+ * Author:   Ronan Demoment                                                *
+ *                                                                         *
+ ***************************************************************************
+ *   Copyright (C) 2021 by Ronan Demoment                                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+
+/*
+  Usage : compass_replay [--heading-filter-ms <ms>] [--no-gyro] <capture.csv | -> > replay.csv
+
+  Build : pio run -e compass_replay, the program is then .pio/build/compass_replay/program
+
+  The capture is the console output of the "Compass data capture" menu. Lines which are not capture records (console
+  messages, NMEA sentences) are ignored. Samples are processed by the CompassFusion and DeviationTable code of the
+  firmware, so that a replay with the captured configuration gives back the captured heading. Filter changes are tried
+  from the command line or by changing CompassFusion and rebuilding. The replayed heading is printed next to the
+  captured one together with the magnetic course over ground, and a summary of the differences is printed on stderr.
+*/
+
+/***************************************************************************/
+/*                              Includes                                   */
+/***************************************************************************/
+
+#include "CompassFusion.h"
+#include "DeviationTable.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/***************************************************************************/
+/*                              Constants                                  */
+/***************************************************************************/
+
+#define REPLAY_LINE_SIZE      256
+#define REPLAY_MAX_FIELDS     16
+// Acceleration samples read in the same FIFO access share the same time stamp, larger blocks are split
+#define REPLAY_MAX_ACC_BLOCK  64
+#define REPLAY_CONFIG_FIELDS  15
+
+/***************************************************************************/
+/*                                Types                                    */
+/***************************************************************************/
+
+// Running statistics of an angle difference
+typedef struct
+{
+    uint32_t count;
+    double   sum;
+    double   sum2;
+    float    max;
+} ReplayStats_t;
+
+/***************************************************************************/
+/*                               Globals                                   */
+/***************************************************************************/
+
+static CompassFusion  fusion;
+static DeviationTable deviationTable;
+static vec            accBlock[REPLAY_MAX_ACC_BLOCK];
+static vec            gyroBlock[REPLAY_MAX_ACC_BLOCK];
+static uint32_t       accBlockSize;
+static uint32_t       accBlockTime_us;
+static bool           useGyro = true;
+
+/***************************************************************************/
+/*                              Functions                                  */
+/***************************************************************************/
+
+// Split a CSV line in place, keeping empty fields
+static uint32_t SplitFields(char *line, char **fields)
+{
+    uint32_t nbFields = 0;
+
+    line[strcspn(line, "\r\n")] = 0;
+    while (nbFields < REPLAY_MAX_FIELDS)
+    {
+        fields[nbFields++] = line;
+        line               = strchr(line, ',');
+        if (line == nullptr)
+        {
+            break;
+        }
+        *line++ = 0;
+    }
+
+    return nbFields;
+}
+
+// Parse a numeric field, NAN if empty
+static float FieldValue(char const *field)
+{
+    return (field[0] == 0) ? NAN : strtof(field, nullptr);
+}
+
+// Signed difference between two angles, within [-180, 180[
+static float AngleDiff(float a_deg, float b_deg)
+{
+    return fmodf(a_deg - b_deg + 540.0f, 360.0f) - 180.0f;
+}
+
+static void AddStat(ReplayStats_t *stats, float value)
+{
+    stats->count++;
+    stats->sum += value;
+    stats->sum2 += value * value;
+    stats->max = fmaxf(stats->max, fabsf(value));
+}
+
+// Print a CSV field, left empty for invalid values
+static void PrintField(float value, char const *separator)
+{
+    if (isnan(value))
+    {
+        printf("%s", separator);
+    }
+    else
+    {
+        printf("%.2f%s", value, separator);
+    }
+}
+
+static void FlushAccBlock()
+{
+    if (accBlockSize > 0)
+    {
+        fusion.AddAccSamples(accBlockTime_us, accBlock, useGyro ? gyroBlock : nullptr, accBlockSize);
+        accBlockSize = 0;
+    }
+}
+
+/*
+  Apply the compass configuration line of the capture :
+  C,<heading vector>,<heading filter ms>,<hard iron x,y,z>,<soft iron matrix, row major>
+*/
+static void Configure(char **fields, int32_t headingFilter_ms)
+{
+    // Same order as CompassHdgVec_t
+    static const vec forwardVectors[] = {{1.0f, 0.0f, 0.0f},  {0.0f, 1.0f, 0.0f},  {0.0f, 0.0f, 1.0f},
+                                         {-1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}};
+    float            softIron[9];
+    uint32_t         hdgVector = strtoul(fields[1], nullptr, 10) % (sizeof(forwardVectors) / sizeof(forwardVectors[0]));
+
+    for (int i = 0; i < 9; i++)
+    {
+        softIron[i] = FieldValue(fields[6 + i]);
+    }
+    if (headingFilter_ms < 0)
+    {
+        headingFilter_ms = strtol(fields[2], nullptr, 10);
+    }
+
+    fusion.SetForwardVector(forwardVectors[hdgVector]);
+    fusion.SetCalibration({FieldValue(fields[3]), FieldValue(fields[4]), FieldValue(fields[5])}, softIron);
+    fusion.SetHeadingFilter(headingFilter_ms / 1000.0f);
+}
+
+int main(int argc, char **argv)
+{
+    char const   *captureName      = nullptr;
+    int32_t       headingFilter_ms = -1;
+    bool          configured       = false;
+    float         nav[4]           = {NAN, NAN, NAN, NAN};
+    ReplayStats_t captureStats     = {};
+    ReplayStats_t courseStats      = {};
+    char          line[REPLAY_LINE_SIZE];
+    char         *fields[REPLAY_MAX_FIELDS];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "--heading-filter-ms") == 0) && (i + 1 < argc))
+        {
+            headingFilter_ms = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--no-gyro") == 0)
+        {
+            useGyro = false;
+        }
+        else
+        {
+            captureName = argv[i];
+        }
+    }
+    if (captureName == nullptr)
+    {
+        fprintf(stderr, "Usage : %s [--heading-filter-ms <ms>] [--no-gyro] <capture.csv | ->\n", argv[0]);
+        return 1;
+    }
+
+    FILE *capture = (strcmp(captureName, "-") == 0) ? stdin : fopen(captureName, "r");
+    if (capture == nullptr)
+    {
+        perror(captureName);
+        return 1;
+    }
+
+    printf("time_s,captured_hdg,replayed_hdg,roll,pitch,rot,mag_course,sog,published_hdg\n");
+
+    while (fgets(line, sizeof(line), capture) != nullptr)
+    {
+        uint32_t nbFields = SplitFields(line, fields);
+        char     type     = (strlen(fields[0]) == 1) ? fields[0][0] : 0;
+
+        if ((type == 'C') && (nbFields == REPLAY_CONFIG_FIELDS))
+        {
+            Configure(fields, headingFilter_ms);
+            configured = true;
+            continue;
+        }
+        if (((type != 'A') && (type != 'M') && (type != 'N')) || (nbFields < 6) || !configured)
+        {
+            continue;
+        }
+
+        uint32_t time_us = strtoul(fields[1], nullptr, 10);
+        if ((type != 'A') || (time_us != accBlockTime_us) || (accBlockSize == REPLAY_MAX_ACC_BLOCK))
+        {
+            FlushAccBlock();
+        }
+
+        if ((type == 'A') && (nbFields >= 8))
+        {
+            accBlock[accBlockSize]  = {FieldValue(fields[2]), FieldValue(fields[3]), FieldValue(fields[4])};
+            gyroBlock[accBlockSize] = {FieldValue(fields[5]), FieldValue(fields[6]), FieldValue(fields[7])};
+            accBlockTime_us         = time_us;
+            accBlockSize++;
+        }
+        else if (type == 'N')
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                nav[i] = FieldValue(fields[2 + i]);
+            }
+        }
+        else if ((type == 'M') && (nbFields >= 6) && (fusion.GetNbAccSamples() > 0))
+        {
+            float captured_deg = FieldValue(fields[5]);
+            float course_deg   = fmodf(nav[0] - nav[2] + 360.0f, 360.0f);
+
+            fusion.AddMagSample(time_us, {FieldValue(fields[2]), FieldValue(fields[3]), FieldValue(fields[4])});
+            float heading_deg = fusion.GetHeading();
+
+            if (!isnan(captured_deg))
+            {
+                AddStat(&captureStats, AngleDiff(heading_deg, captured_deg));
+            }
+            // Samples from which the firmware would learn deviation : moving straight at speed
+            if (!isnan(course_deg) && !isnan(nav[1]) && deviationTable.Learn(heading_deg, course_deg, nav[1], fusion.GetRateOfTurn()))
+            {
+                AddStat(&courseStats, AngleDiff(heading_deg, course_deg));
+            }
+
+            printf("%.2f,", time_us / 1000000.0);
+            PrintField(captured_deg, ",");
+            PrintField(heading_deg, ",");
+            PrintField(fusion.GetRoll(), ",");
+            PrintField(fusion.GetPitch(), ",");
+            PrintField(fusion.GetRateOfTurn(), ",");
+            PrintField(course_deg, ",");
+            PrintField(nav[1], ",");
+            PrintField(nav[3], "\n");
+        }
+    }
+    FlushAccBlock();
+
+    if (!configured)
+    {
+        fprintf(stderr, "No compass configuration line in capture\n");
+        return 1;
+    }
+
+    fprintf(stderr, "%u magnetic samples replayed\n", (unsigned)fusion.GetNbMagSamples());
+    if (captureStats.count > 0)
+    {
+        fprintf(stderr, "Replayed - captured heading : RMS %.2f°, max %.2f°\n", sqrt(captureStats.sum2 / captureStats.count), captureStats.max);
+    }
+    if (courseStats.count > 0)
+    {
+        fprintf(stderr, "Replayed heading - magnetic course (%u samples) : mean %.2f°, RMS %.2f°\n", (unsigned)courseStats.count,
+                courseStats.sum / courseStats.count, sqrt(courseStats.sum2 / courseStats.count));
+        fprintf(stderr, "Learned deviation :");
+        for (uint32_t i = 0; i < DEVIATION_NB_SECTORS; i++)
+        {
+            if (deviationTable.GetSectorSamples(i) > 0)
+            {
+                fprintf(stderr, " %u°:%+.1f", (unsigned)(i * 360 / DEVIATION_NB_SECTORS), deviationTable.GetSectorDeviation(i));
+            }
+        }
+        fprintf(stderr, "\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+#
+# Project:  MicroNav
+# Purpose:  Generate the World Magnetic Model table of MagneticModel.cpp from a WMM.COF file
+# Author:   Ronan Demoment
+#
+# Copyright (C) 2021 by Ronan Demoment
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# Usage: wmm_table.py [options] WMM.COF
+#
+# WMM.COF is the coefficient file published by NOAA with each release of the World Magnetic Model. The coefficient
+# table and the epoch of MagneticModel.cpp are printed on stdout, to be pasted in place of the previous ones.
+#
+# --check compares them with the ones of MagneticModel.cpp and fails on any difference, so that the table shipped in
+# the firmware is known to be the one of the COF file.
+#
+# --test-values evaluates the COF file in double precision at the points of the test value file published with the
+# model (WMM20xx_TEST_VALUES.txt) and fails if a declination differs from the published one.
+
+import argparse
+import math
+import re
+import sys
+
+MAX_DEGREE = 12
+# Reference radius of the model, in km
+REFERENCE_RADIUS_KM = 6371.2
+# WGS84 ellipsoid
+WGS84_A_KM = 6378.137
+WGS84_F = 1 / 298.257223563
+# Test values are published with two decimals
+TEST_VALUE_TOLERANCE_DEG = 0.01
+
+
+def read_cof(path):
+    epoch = None
+    name = None
+    coefficients = []
+    with open(path) as cof:
+        for line in cof:
+            fields = line.split()
+            if not fields or fields[0].startswith('9999'):
+                continue
+            if epoch is None:
+                epoch = fields[0]
+                name = fields[1]
+                continue
+            n, m = int(fields[0]), int(fields[1])
+            coefficients.append((n, m, fields[2], fields[3], fields[4], fields[5]))
+    expected = [(n, m) for n in range(1, MAX_DEGREE + 1) for m in range(n + 1)]
+    if [(c[0], c[1]) for c in coefficients] != expected:
+        sys.exit('%s: coefficients are not ordered by degree then order up to degree %d' % (path, MAX_DEGREE))
+    return epoch, name, coefficients
+
+
+def format_table(epoch, name, coefficients):
+    lines = ['#define MAGMODEL_EPOCH %sf' % epoch]
+    lines.append('// %s Schmidt semi-normalized coefficients, ordered by degree then order starting at n = 1, m = 0'
+                 % name.replace('-', ''))
+    lines.append('static const MagModelCoefficient_t wmmCoefficients[MAGMODEL_NB_TERMS - 1] = {')
+    for n, m, g, h, g_dot, h_dot in coefficients:
+        lines.append('    {%8sf, %7sf, %5sf, %5sf}, // %2d %2d' % (g, h, g_dot, h_dot, n, m))
+    lines.append('};')
+    return lines
+
+
+def source_table(path):
+    with open(path) as source:
+        text = source.read()
+    epoch = re.search(r'^#define MAGMODEL_EPOCH .*$', text, re.MULTILINE)
+    table = re.search(r'^// \S+ Schmidt semi-normalized.*?^};$', text, re.MULTILINE | re.DOTALL)
+    if epoch is None or table is None:
+        sys.exit('%s: epoch or coefficient table not found' % path)
+    return [epoch.group(0)] + table.group(0).split('\n')
+
+
+def declination(coefficients, epoch, latitude_deg, longitude_deg, year, altitude_km):
+    dt = year - float(epoch)
+    e2 = WGS84_F * (2 - WGS84_F)
+    phi = math.radians(latitude_deg)
+    lam = math.radians(longitude_deg)
+
+    # Geodetic to geocentric spherical coordinates
+    rc = WGS84_A_KM / math.sqrt(1 - e2 * math.sin(phi) ** 2)
+    p = (rc + altitude_km) * math.cos(phi)
+    z = (rc * (1 - e2) + altitude_km) * math.sin(phi)
+    r = math.hypot(p, z)
+    phic = math.asin(z / r)
+    s, c = math.sin(phic), math.cos(phic)
+
+    # Schmidt semi-normalized associated Legendre functions and their derivatives
+    size = MAX_DEGREE + 1
+    pnm = [[0.0] * size for _ in range(size)]
+    dpnm = [[0.0] * size for _ in range(size)]
+    pnm[0][0] = 1.0
+    for n in range(1, size):
+        for m in range(n + 1):
+            if m == n:
+                k = 1.0 if n == 1 else math.sqrt((2 * n - 1) / (2 * n))
+                pnm[n][n] = k * c * pnm[n - 1][n - 1]
+                dpnm[n][n] = k * (c * dpnm[n - 1][n - 1] - s * pnm[n - 1][n - 1])
+            else:
+                k = math.sqrt((n - 1) ** 2 - m * m) if m <= n - 2 else 0.0
+                p2 = pnm[n - 2][m] if m <= n - 2 else 0.0
+                dp2 = dpnm[n - 2][m] if m <= n - 2 else 0.0
+                d = math.sqrt(n * n - m * m)
+                pnm[n][m] = ((2 * n - 1) * s * pnm[n - 1][m] - k * p2) / d
+                dpnm[n][m] = ((2 * n - 1) * (c * pnm[n - 1][m] + s * dpnm[n - 1][m]) - k * dp2) / d
+
+    x = y = zc = 0.0
+    for n, m, g, h, g_dot, h_dot in coefficients:
+        g = float(g) + float(g_dot) * dt
+        h = float(h) + float(h_dot) * dt
+        ratio = (REFERENCE_RADIUS_KM / r) ** (n + 2)
+        cm, sm = math.cos(m * lam), math.sin(m * lam)
+        x -= ratio * (g * cm + h * sm) * dpnm[n][m]
+        y += ratio * m * (g * sm - h * cm) * pnm[n][m] / c
+        zc -= (n + 1) * ratio * (g * cm + h * sm) * pnm[n][m]
+
+    # Rotate north component back to the geodetic frame
+    psi = phic - phi
+    x = x * math.cos(psi) - zc * math.sin(psi)
+    return math.degrees(math.atan2(y, x))
+
+
+def check_test_values(path, epoch, coefficients):
+    nb_values = 0
+    nb_errors = 0
+    with open(path) as values:
+        for line in values:
+            fields = line.split()
+            if not fields or fields[0].startswith('#'):
+                continue
+            # Date, height (km), latitude, longitude, X, Y, Z, H, F, I, D, ...
+            year, altitude_km, latitude_deg, longitude_deg = (float(f) for f in fields[0:4])
+            expected_deg = float(fields[10])
+            computed_deg = declination(coefficients, epoch, latitude_deg, longitude_deg, year, altitude_km)
+            nb_values += 1
+            if abs(computed_deg - expected_deg) > TEST_VALUE_TOLERANCE_DEG:
+                nb_errors += 1
+                print('%s %.1f %.1f %.1f : D = %.2f, expected %.2f' % (fields[0], altitude_km, latitude_deg,
+                                                                      longitude_deg, computed_deg, expected_deg))
+    print('%d test values, %d errors' % (nb_values, nb_errors), file=sys.stderr)
+    return nb_errors == 0 and nb_values > 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the World Magnetic Model table of MagneticModel.cpp')
+    parser.add_argument('cof', help='WMM.COF coefficient file')
+    parser.add_argument('--check', metavar='SOURCE', help='compare with the table of MagneticModel.cpp')
+    parser.add_argument('--test-values', metavar='FILE', help='check the COF file against published test values')
+    args = parser.parse_args()
+
+    epoch, name, coefficients = read_cof(args.cof)
+    table = format_table(epoch, name, coefficients)
+
+    success = True
+    if args.test_values:
+        success = check_test_values(args.test_values, epoch, coefficients) and success
+    if args.check:
+        source = source_table(args.check)
+        for generated, shipped in zip(table, source):
+            if generated != shipped:
+                print('COF    : %s\nSource : %s' % (generated, shipped))
+        if len(source) != len(table):
+            print('Source table has %d lines, %d expected' % (len(source), len(table)))
+        print('%s table %s %s' % (name, 'matches' if source == table else 'differs from', args.check), file=sys.stderr)
+        success = (source == table) and success
+    if not args.test_values and not args.check:
+        print('\n'.join(table))
+
+    return 0 if success else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())